@@ -0,0 +1,133 @@
+/**
+ * @file OverheadBenchmark.cpp
+ * @brief 比较编译期特化与类型擦除两种请求路径的单请求开销
+ *
+ * 传输使用NullTransport，不产生网络流量，测得的时间全部是引擎自身的开销。
+ * 类型擦除路径复刻特化之前的写法：虚函数传输、std::function节奏与结果回调、
+ * 互斥锁保护的统计；特化路径为BasicLoadTester的内联组合。
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "../include/BasicLoadTester.h"
+
+namespace {
+
+/**
+ * @class ErasedTransport
+ * @brief 类型擦除的传输接口
+ */
+class ErasedTransport {
+public:
+    virtual ~ErasedTransport() = default;
+    virtual TransferResult perform() = 0;
+};
+
+class ErasedNullTransport : public ErasedTransport {
+public:
+    TransferResult perform() override { return transport.perform(); }
+
+private:
+    NullTransport transport;
+};
+
+/**
+ * @class ErasedLoadTester
+ * @brief 每个环节都经过一次间接调用的请求循环
+ */
+class ErasedLoadTester {
+public:
+    ErasedLoadTester(std::unique_ptr<ErasedTransport> transportImpl,
+                     std::function<bool(int64_t&)> pacerImpl,
+                     std::function<void(int, const TransferResult&)> sinkImpl)
+        : transport(std::move(transportImpl)), pacer(std::move(pacerImpl)), sink(std::move(sinkImpl)) {}
+
+    uint64_t run(std::atomic<int>& requestIds, int quota, const std::function<bool()>& keepRunning) {
+        uint64_t completed = 0;
+        int64_t lagNs = 0;
+        while (keepRunning() && pacer(lagNs)) {
+            int requestId = requestIds.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (requestId > quota) break;
+
+            TransferResult result = transport->perform();
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                sketch.add(result.elapsedNs / 1e6);
+            }
+            sink(requestId, result);
+            completed++;
+        }
+        return completed;
+    }
+
+private:
+    std::unique_ptr<ErasedTransport> transport;
+    std::function<bool(int64_t&)> pacer;
+    std::function<void(int, const TransferResult&)> sink;
+    std::mutex statsMutex;
+    DDSketch sketch;
+};
+
+/**
+ * @brief 运行一次并返回每个请求的平均纳秒数
+ */
+template <class Run>
+double nanosPerRequest(int requests, Run&& run) {
+    std::atomic<int> requestIds(0);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t completed = run(requestIds, requests);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (completed == 0) return 0.0;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / static_cast<double>(completed);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int requests = argc > 1 ? std::atoi(argv[1]) : 5000000;
+    if (requests <= 0) {
+        std::fprintf(stderr, "用法: %s [请求数]\n", argv[0]);
+        return 1;
+    }
+
+    // 结果回调累加状态码，防止编译器把整条路径优化掉
+    uint64_t checksum = 0;
+
+    double erased = nanosPerRequest(requests, [&](std::atomic<int>& requestIds, int quota) {
+        ErasedLoadTester tester(
+            std::make_unique<ErasedNullTransport>(),
+            [](int64_t& lagNs) { lagNs = 0; return true; },
+            [&checksum](int, const TransferResult& result) { checksum += result.statusCode; });
+        return tester.run(requestIds, quota, [] { return true; });
+    });
+
+    double specialized = nanosPerRequest(requests, [&](std::atomic<int>& requestIds, int quota) {
+        auto sink = makeCallbackSink(
+            [](int, int64_t) {},
+            [&checksum](int, const TransferResult& result) { checksum += result.statusCode; });
+        BasicLoadTester<NullTransport, NoPacer, SketchStats, decltype(sink)> tester(
+            NullTransport(), NoPacer(), SketchStats(), std::move(sink));
+        return tester.run(requestIds, quota, [] { return true; });
+    });
+
+    double bare = nanosPerRequest(requests, [](std::atomic<int>& requestIds, int quota) {
+        BasicLoadTester<NullTransport, NoPacer, NullStats, NullSink> tester(
+            NullTransport(1000000), NoPacer(), NullStats(), NullSink());
+        return tester.run(requestIds, quota, [] { return true; });
+    });
+
+    std::printf("请求数: %d\n", requests);
+    std::printf("  类型擦除（虚函数+std::function+互斥锁+DDSketch）: %8.2f 纳秒/请求\n", erased);
+    std::printf("  编译期特化（NoPacer+SketchStats+CallbackSink）:   %8.2f 纳秒/请求\n", specialized);
+    std::printf("  编译期特化（NoPacer+NullStats+NullSink）:         %8.2f 纳秒/请求\n", bare);
+    if (specialized > 0) {
+        std::printf("  特化路径节省: %.2f 纳秒/请求 (%.1fx)\n", erased - specialized, erased / specialized);
+    }
+    std::printf("  校验和: %llu\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
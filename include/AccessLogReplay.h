@@ -0,0 +1,325 @@
+/**
+ * @file AccessLogReplay.h
+ * @brief nginx/Apache访问日志按原始、缩放或压缩的时间间隔回放的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include "EventLoopBase.h"
+#include "MappedFile.h"
+
+/**
+ * @struct ReplayOptions
+ * @brief 访问日志回放配置
+ */
+struct ReplayOptions {
+    std::string path;               ///< 访问日志文件（combined或common格式），为空表示不回放
+    double speed = 1.0;             ///< 时间倍率：1为原始间隔，2为两倍速；不大于0时不按时间，尽快发出
+    int maxInFlight = 256;          ///< 每个工作线程同时进行的请求上限，尽快模式下即并发数
+    bool sendUserAgent = true;      ///< 是否带上日志中的User-Agent
+
+    /**
+     * @brief 是否启用回放
+     */
+    bool enabled() const { return !path.empty(); }
+
+    /**
+     * @brief 是否按日志时间回放
+     */
+    bool timed() const { return speed > 0; }
+};
+
+/**
+ * @struct AccessLogEntry
+ * @brief 一行访问日志中回放需要的字段，视图指向日志原文
+ */
+struct AccessLogEntry {
+    int64_t epochSeconds = 0;       ///< 请求时间（UTC秒）
+    std::string_view method;        ///< 请求方法
+    std::string_view target;        ///< 请求目标（路径与查询串）
+    std::string_view userAgent;     ///< User-Agent，日志中没有或为"-"时为空
+};
+
+/**
+ * @class AccessLogParser
+ * @brief combined/common格式的单行解析
+ *
+ * 格式：host ident user [10/Oct/2000:13:55:36 -0700] "GET /path HTTP/1.1" status bytes "referer" "agent"。
+ * 分隔符用findByte按16字节一组查找，字段不复制；被转义的引号（\"）不结束字段。
+ */
+class AccessLogParser {
+public:
+    /**
+     * @brief 解析一行
+     * @param begin 行首
+     * @param end 行尾（不含换行）
+     * @param entry 输出字段
+     * @return 时间与请求行都有效时返回true
+     */
+    static bool parseLine(const char* begin, const char* end, AccessLogEntry& entry);
+
+    /**
+     * @brief 解析"10/Oct/2000:13:55:36 -0700"形式的时间
+     * @param text 方括号内的文本
+     * @param epochSeconds 输出UTC秒
+     * @return 格式有效时返回true
+     */
+    static bool parseTimestamp(std::string_view text, int64_t& epochSeconds);
+};
+
+/**
+ * @struct ReplayRecord
+ * @brief 排好发出时刻的一个回放请求，视图指向映射的日志
+ */
+struct ReplayRecord {
+    int64_t offsetNs;               ///< 相对日志第一条请求的原始时间(纳秒)
+    std::string_view method;        ///< 请求方法
+    std::string_view target;        ///< 请求目标
+    std::string_view userAgent;     ///< User-Agent
+};
+
+/**
+ * @struct ReplayStats
+ * @brief 回放的解析与发出计数
+ */
+struct ReplayStats {
+    uint64_t lines = 0;             ///< 已读取的行数
+    uint64_t requests = 0;          ///< 解析出的请求数
+    uint64_t malformed = 0;         ///< 无法解析而跳过的非空行
+    uint64_t outOfOrder = 0;        ///< 时间早于前一条、按前一条所在秒回放的请求
+    uint64_t dispatched = 0;        ///< 已发出的请求
+    int64_t logSpanNs = 0;          ///< 已解析请求在日志中的时间跨度(纳秒)
+    int64_t replaySpanNs = 0;       ///< 从回放开始到最后一个请求发出的实际时长(纳秒)
+    bool finished = false;          ///< 日志是否已读完
+};
+
+/**
+ * @class ReplayFeed
+ * @brief 解析线程：顺序读取映射的日志，按发出时刻排好后分批交给各工作线程
+ *
+ * 日志的时间只精确到秒，同一秒内的请求在这一秒内均匀展开；时间倒退的行并入当前秒。
+ * 请求按顺序轮流分给各工作线程，每个线程一个有界的批队列：队列满时解析线程等待；
+ * 解析位置之后足够远的已读部分随即移出内存，因此内存只与队列容量有关，多GB的日志也不整体读入。
+ */
+class ReplayFeed {
+public:
+    static constexpr size_t BATCH_SIZE = 256;       ///< 每批请求数
+    static constexpr size_t QUEUE_BATCHES = 64;     ///< 每个工作线程最多积压的批数
+    static constexpr size_t RELEASE_LAG = 64u << 20;    ///< 已读部分落后解析位置超过此字节数后移出内存
+    static constexpr size_t RELEASE_CHUNK = 16u << 20;  ///< 每次移出的最小字节数
+
+    ReplayFeed() = default;
+    ~ReplayFeed();
+
+    ReplayFeed(const ReplayFeed&) = delete;
+    ReplayFeed& operator=(const ReplayFeed&) = delete;
+
+    /**
+     * @brief 映射日志文件
+     * @param filePath 日志路径
+     * @param workers 工作线程数
+     * @param error 失败时写入原因
+     * @return 映射成功时返回true
+     */
+    bool open(const std::string& filePath, int workers, std::string& error);
+
+    /**
+     * @brief 以当前时刻为回放起点启动解析线程
+     */
+    void start();
+
+    /**
+     * @brief 停止并等待解析线程
+     */
+    void stop();
+
+    /**
+     * @brief 取出下一批请求（不阻塞）
+     * @param worker 工作线程序号
+     * @param batch 输出批，原内容被替换
+     * @return 有批可取时返回true
+     */
+    bool tryPop(int worker, std::vector<ReplayRecord>& batch);
+
+    /**
+     * @brief 日志已读完且该线程的队列已取空
+     */
+    bool exhausted(int worker);
+
+    /**
+     * @brief 回放起点，日志第一条请求在此刻发出
+     */
+    std::chrono::steady_clock::time_point getStartTime() const { return startTime; }
+
+    /**
+     * @brief 日志文件大小(字节)
+     */
+    uint64_t getFileBytes() const { return file.size(); }
+
+    /**
+     * @brief 解析计数（dispatched与replaySpanNs由工作线程填写）
+     */
+    ReplayStats getStats() const;
+
+private:
+    /**
+     * @struct WorkerQueue
+     * @brief 一个工作线程的有界批队列
+     */
+    struct WorkerQueue {
+        std::mutex mutex;                               ///< 队列互斥锁
+        std::condition_variable notFull;                ///< 队列有空位通知
+        std::deque<std::vector<ReplayRecord>> batches;  ///< 待发出的批
+    };
+
+    /**
+     * @brief 解析线程主体
+     */
+    void parseAll();
+
+    /**
+     * @brief 把同一秒的请求在这一秒内均匀展开并分给各工作线程
+     */
+    void emitSecond(std::vector<AccessLogEntry>& group, int64_t second);
+
+    /**
+     * @brief 把一批请求放入工作线程的队列，队列满时等待
+     * @return 被停止时返回false
+     */
+    bool push(size_t worker);
+
+    MappedFile file;                                    ///< 映射的日志
+    std::vector<std::unique_ptr<WorkerQueue>> queues;   ///< 每个工作线程一个队列
+    std::vector<std::vector<ReplayRecord>> pending;     ///< 解析线程正在填充的批
+    size_t nextWorker = 0;                              ///< 下一个请求分给的工作线程
+    int64_t firstSecond = -1;                           ///< 日志第一条请求的秒
+    std::thread parser;                                 ///< 解析线程
+    std::atomic<bool> stopping{false};                  ///< 停止标志
+    std::atomic<bool> finished{false};                  ///< 日志已读完且所有批已入队
+    std::atomic<uint64_t> lines{0};                     ///< 已读取的行数
+    std::atomic<uint64_t> requests{0};                  ///< 解析出的请求数
+    std::atomic<uint64_t> malformed{0};                 ///< 无法解析的行数
+    std::atomic<uint64_t> outOfOrder{0};                ///< 时间倒退的请求数
+    std::atomic<int64_t> lastOffsetNs{0};               ///< 最后一个请求的原始时间偏移
+    std::chrono::steady_clock::time_point startTime;    ///< 回放起点
+};
+
+/**
+ * @class ReplayLoop
+ * @brief 在单个线程中按计划时刻发出回放请求（开环）
+ *
+ * 请求到点就发，不等前一个请求完成，由一个curl multi句柄驱动；同时进行的请求
+ * 受maxInFlight约束，句柄与连接在请求之间复用。发出时刻晚于计划的部分作为调度延迟上报，
+ * 发生器跟不上日志速率时可以从中看出，而不会悄悄降低回放速率。
+ */
+class ReplayLoop : public EventLoopBase {
+public:
+    /**
+     * @brief 发出请求前调用，返回请求ID；返回值小于等于0表示不再发出新请求
+     * @param lagNs 实际发出时刻晚于计划时刻的纳秒数
+     */
+    using DispatchHandler = std::function<int(int64_t lagNs)>;
+
+    /**
+     * @brief 请求完成时调用
+     * @param easy 完成的curl句柄（可用于curl_easy_getinfo）
+     * @param result 传输结果
+     * @param requestId 发出时分配的请求ID
+     * @param elapsedNs 响应时间(纳秒)
+     */
+    using CompletionHandler = std::function<void(CURL* easy, CURLcode result, int requestId, int64_t elapsedNs)>;
+
+    /**
+     * @brief 构造函数
+     * @param replayFeed 解析线程（生命周期须长于本对象）
+     * @param workerIndex 工作线程序号
+     * @param options 回放配置
+     * @param requestTimeoutMs 单个请求的超时(毫秒)
+     */
+    ReplayLoop(ReplayFeed& replayFeed, int workerIndex, const ReplayOptions& options, int requestTimeoutMs);
+    ~ReplayLoop();
+
+    ReplayLoop(const ReplayLoop&) = delete;
+    ReplayLoop& operator=(const ReplayLoop&) = delete;
+
+    /**
+     * @brief run()因停止而返回时仍在进行中、被放弃的请求数
+     */
+    int getCancelledCount() const { return cancelledCount; }
+
+    /**
+     * @brief 本循环发出的请求数
+     */
+    uint64_t getDispatchedCount() const { return dispatched; }
+
+    /**
+     * @brief 本循环最后一个请求的发出时刻，没有发出过时为回放起点
+     */
+    std::chrono::steady_clock::time_point getLastDispatch() const { return lastDispatch; }
+
+    /**
+     * @brief 在当前线程运行事件循环，直到running为false、日志回放完或配额用完
+     * @param url 测试URL，去掉末尾的/后与日志中的请求目标拼接
+     * @param running 运行标志
+     * @param dispatch 请求发出回调
+     * @param complete 请求完成回调
+     */
+    void run(const std::string& url, const std::atomic<bool>& running,
+             const DispatchHandler& dispatch, const CompletionHandler& complete);
+
+private:
+    /**
+     * @struct Slot
+     * @brief 一个并发位：复用的curl句柄与当前请求
+     */
+    struct Slot {
+        CURL* easy = nullptr;                                   ///< 复用的curl句柄（保持连接）
+        std::chrono::steady_clock::time_point requestStart;     ///< 当前请求的开始时间
+        int requestId = 0;                                      ///< 当前请求ID
+    };
+
+    /**
+     * @brief 取下一条待发出的请求，当前批用完时从队列取下一批
+     * @return 没有可发出的请求时返回nullptr
+     */
+    const ReplayRecord* peek();
+
+    /**
+     * @brief 用空闲的并发位发出一个请求
+     */
+    void startRequest(const ReplayRecord& record, int requestId);
+
+    /**
+     * @brief 处理multi句柄上完成的传输
+     */
+    void collectCompleted(const CompletionHandler& complete);
+
+    ReplayFeed& feed;                   ///< 解析线程
+    int worker;                         ///< 工作线程序号
+    ReplayOptions options;              ///< 回放配置
+    long timeoutMs;                     ///< 单个请求的超时(毫秒)
+    CURLM* multi;                       ///< curl multi句柄
+    std::vector<Slot> slots;            ///< 并发位
+    std::vector<size_t> freeSlots;      ///< 空闲的并发位
+    std::vector<ReplayRecord> batch;    ///< 当前批
+    size_t batchPos;                    ///< 当前批中下一条的位置
+    std::string baseUrl;                ///< 请求URL的前缀
+    std::string urlBuffer;              ///< 拼接URL的暂存
+    std::string fieldBuffer;            ///< 方法与User-Agent的暂存（curl会复制）
+    int cancelledCount;                 ///< 停止时被放弃的请求数
+    int inFlight;                       ///< 进行中的请求数
+    uint64_t dispatched;                ///< 已发出的请求数
+    std::chrono::steady_clock::time_point lastDispatch; ///< 最后一个请求的发出时刻
+};
@@ -0,0 +1,128 @@
+/**
+ * @file AutoTuner.h
+ * @brief 在延迟SLO约束下自动寻找最大可持续吞吐量的控制器的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct SloTarget
+ * @brief 服务等级目标：某个延迟分位数与错误率的上限
+ */
+struct SloTarget {
+    double latencyQuantile = 0.99;  ///< 约束的延迟分位数
+    double latencyMs = 200.0;       ///< 分位数上限(毫秒)
+    double maxErrorRate = 0.001;    ///< 错误率上限(比例)
+
+    /**
+     * @brief 解析形如"p99 < 200ms and errors < 0.1%"的目标
+     *
+     * 片段以逗号、分号或and分隔；未出现的约束保持默认值。
+     * @param text 目标文本
+     * @param target 输出的目标
+     * @return 至少解析出一个约束且没有无法识别的片段时返回true
+     */
+    static bool parse(const std::string& text, SloTarget& target);
+
+    /**
+     * @brief 可读的目标描述，例如"p99<200ms, errors<0.1%"
+     */
+    std::string describe() const;
+};
+
+/**
+ * @struct AutoTuneOptions
+ * @brief 自动调优配置
+ */
+struct AutoTuneOptions {
+    bool enabled = false;           ///< 是否启用自动调优
+    SloTarget slo;                  ///< 服务等级目标
+    double initialRps = 100.0;      ///< 第一次探测的速率(请求/秒)
+    double maxRps = 100000.0;       ///< 探测速率上限(请求/秒)
+    int probeMs = 5000;             ///< 每次探测的测量时长(毫秒)
+    int settleMs = 1000;            ///< 改变速率后丢弃的过渡时长(毫秒)
+    int maxSteps = 20;              ///< 最多探测次数
+    double precision = 0.05;        ///< 二分区间相对宽度小于该值时收敛
+};
+
+/**
+ * @struct ProbeStep
+ * @brief 一次探测的结果，也是吞吐量-延迟曲线上的一个点
+ */
+struct ProbeStep {
+    double targetRps = 0.0;         ///< 目标速率(请求/秒)
+    double achievedRps = 0.0;       ///< 实际完成速率(请求/秒)
+    double p50Ms = 0.0;             ///< 中位数延迟(毫秒)
+    double sloLatencyMs = 0.0;      ///< SLO约束分位数的延迟(毫秒)
+    double errorRate = 0.0;         ///< 错误率(比例)
+    uint64_t requests = 0;          ///< 测量窗口内完成的请求数
+    bool withinSlo = false;         ///< 是否满足SLO且跟上了目标速率
+};
+
+/**
+ * @class AutoTuner
+ * @brief 先倍增速率直到违反SLO，再在最后满足与首个违反的速率之间二分
+ *
+ * 控制器只做决策，不发请求也不计时：调用者按currentRate()施加负载，
+ * 测量一个窗口后调用record()，直到返回false。
+ */
+class AutoTuner {
+public:
+    /**
+     * @brief 构造函数
+     * @param options 自动调优配置
+     */
+    explicit AutoTuner(const AutoTuneOptions& options);
+
+    /**
+     * @brief 当前应施加的速率(请求/秒)
+     */
+    double currentRate() const { return rate; }
+
+    /**
+     * @brief 记录当前速率下的测量结果并决定下一次探测
+     * @param step 测量结果（targetRps与withinSlo由控制器填写）
+     * @return 还需要继续探测时返回true
+     */
+    bool record(ProbeStep step);
+
+    /**
+     * @brief 是否已经收敛
+     */
+    bool isConverged() const { return converged; }
+
+    /**
+     * @brief 满足SLO的探测中实际完成速率的最大值，没有满足的探测时为0
+     */
+    double sustainableRps() const;
+
+    /**
+     * @brief 曲线拐点：按速率排序后，首个约束分位数超过最低速率处两倍的探测
+     * @return 拐点在getSteps()中的下标，没有拐点时为-1
+     */
+    int kneeIndex() const;
+
+    /**
+     * @brief 按探测顺序排列的全部结果
+     */
+    const std::vector<ProbeStep>& getSteps() const { return steps; }
+
+private:
+    AutoTuneOptions options;        ///< 自动调优配置
+    std::vector<ProbeStep> steps;   ///< 探测记录
+    double rate;                    ///< 当前速率
+    double lowRate;                 ///< 已知满足SLO的最高速率
+    double highRate;                ///< 已知违反SLO的最低速率，0表示尚未找到
+    bool converged;                 ///< 是否收敛
+};
+
+/**
+ * @brief 生成吞吐量-延迟曲线与结论的可读报告
+ * @param tuner 已结束的控制器
+ * @param slo 服务等级目标
+ * @return 多行文本报告
+ */
+std::string formatAutoTuneReport(const AutoTuner& tuner, const SloTarget& slo);
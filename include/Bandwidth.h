@@ -0,0 +1,65 @@
+/**
+ * @file Bandwidth.h
+ * @brief 流量统计与下载吞吐量模式的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include "DDSketch.h"
+
+/**
+ * @struct ThroughputOptions
+ * @brief 下载吞吐量模式配置
+ *
+ * 启用后同步HTTP请求之间不插入间隔，接收缓冲区加大到receiveBufferKB，
+ * 并按请求统计首字节时间、末字节时间与下载速率。连接复用仍由连接策略决定，
+ * 测持续带宽时应配合每连接请求数为0（长连接）使用。
+ */
+struct ThroughputOptions {
+    bool enabled = false;           ///< 是否启用吞吐量模式
+    int receiveBufferKB = 512;      ///< curl接收缓冲区大小(KB)，受libcurl上限约束
+};
+
+/**
+ * @struct BandwidthSecond
+ * @brief 一秒内完成的请求的发送与接收字节
+ */
+struct BandwidthSecond {
+    uint64_t bytesSent = 0;         ///< 发送字节（请求头与请求体）
+    uint64_t bytesReceived = 0;     ///< 接收字节（响应头与线路上的响应体）
+};
+
+/**
+ * @struct BandwidthStats
+ * @brief 吞吐量模式下按请求统计的首/末字节时间与下载速率
+ *
+ * 下载速率为响应体字节除以末字节时间，与curl的speed_download口径一致。
+ * MB按10^6字节计算，便于与网络带宽(Gbit/s)换算。
+ */
+struct BandwidthStats {
+    uint64_t transfers = 0;         ///< 计入的成功传输数
+    uint64_t bodyBytes = 0;         ///< 响应体字节
+    DDSketch firstByte;             ///< 首字节时间(毫秒)
+    DDSketch lastByte;              ///< 末字节时间(毫秒)
+    DDSketch throughput;            ///< 单个请求的下载速率(MB/s)
+
+    /**
+     * @brief 记录一个成功的传输
+     * @param bodyBytes 响应体字节
+     * @param firstByteNs 从请求开始到收到第一个字节(纳秒)
+     * @param lastByteNs 从请求开始到收完最后一个字节(纳秒)
+     */
+    void record(uint64_t bodyBytes, int64_t firstByteNs, int64_t lastByteNs);
+
+    /**
+     * @brief 合并另一份统计
+     */
+    void merge(const BandwidthStats& other);
+
+    /**
+     * @brief 字节数与时长换算为MB/s
+     */
+    static double megabytesPerSecond(uint64_t bytes, double seconds) {
+        return seconds > 0 ? bytes / 1e6 / seconds : 0.0;
+    }
+};
@@ -0,0 +1,671 @@
+/**
+ * @file BasicLoadTester.h
+ * @brief 按策略在编译期组合的压测引擎模板
+ *
+ * 一次请求拆成四个策略：Transport发出请求，Pacer决定何时发出，Stats记录结果，
+ * Sink接收调度与完成事件。策略都是模板参数，调用在编译期确定并可内联，
+ * 热路径上没有虚调用和std::function。LoadTester按运行时配置选择一个实例化，
+ * 对界面保持原有接口。
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <curl/curl.h>
+#include "Bandwidth.h"
+#include "Cancellation.h"
+#include "ConnectionChurn.h"
+#include "ContentDecoding.h"
+#include "DDSketch.h"
+#include "RateLimiter.h"
+#include "RequestResult.h"
+#include "Tracer.h"
+#include "UrlList.h"
+
+/**
+ * @struct TransferResult
+ * @brief 一次传输的结果
+ */
+struct TransferResult {
+    static constexpr uint32_t TEST_URL = UINT32_MAX;    ///< endpoint的默认值：请求的是测试URL
+
+    CURLcode code = CURLE_OK;   ///< 传输结果
+    int statusCode = 0;         ///< HTTP状态码，传输失败时为0
+    int64_t elapsedNs = 0;      ///< 响应时间(纳秒)
+    bool cancelled = false;     ///< 停止测试时被中断，不计入统计
+    bool newConnection = false; ///< 本次传输新建了连接
+    bool reconnect = false;     ///< 新连接替换了同一传输对象之前的连接
+    int64_t tcpHandshakeNs = 0; ///< TCP握手耗时(纳秒)，仅新建连接时有效
+    int64_t tlsHandshakeNs = 0; ///< TLS握手耗时(纳秒)，没有TLS时为0
+    int64_t connectReadyNs = 0; ///< 从请求开始到连接可用的耗时(纳秒)
+    uint64_t wireBytes = 0;     ///< 线路上收到的响应体字节，仅协商压缩时统计
+    uint64_t decodedBytes = 0;  ///< 解码后的响应体字节，仅协商压缩时统计
+    int64_t decodeNs = 0;       ///< 解码耗时(纳秒)
+    ContentEncoding contentEncoding = ContentEncoding::IDENTITY;  ///< 响应的Content-Encoding
+    DecodeStatus decodeStatus = DecodeStatus::OK;                 ///< 解码结果
+    uint64_t bytesSent = 0;     ///< 发送字节（请求头与请求体）
+    uint64_t bytesReceived = 0; ///< 接收字节（响应头与线路上的响应体）
+    uint64_t bodyBytes = 0;     ///< 线路上的响应体字节
+    int64_t firstByteNs = 0;    ///< 从请求开始到收到第一个响应字节(纳秒)
+    uint32_t endpoint = TEST_URL;   ///< 本次请求URL的驻留编号，由逐请求换URL的传输填写
+};
+
+/**
+ * @brief 从已结束的传输读取是否新建了连接及握手耗时
+ * @param curl 已结束的curl句柄
+ * @param result 写入newConnection与各项耗时
+ */
+inline void readConnectionTiming(CURL* curl, TransferResult& result) {
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    result.newConnection = connects > 0;
+    if (!result.newConnection) return;
+
+    curl_off_t nameLookupUs = 0, connectUs = 0, appConnectUs = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookupUs);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connectUs);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnectUs);
+    result.tcpHandshakeNs = std::max<int64_t>(0, connectUs - nameLookupUs) * 1000;
+    result.tlsHandshakeNs = appConnectUs > 0 ? std::max<int64_t>(0, appConnectUs - connectUs) * 1000 : 0;
+    result.connectReadyNs = std::max(connectUs, appConnectUs) * 1000;
+}
+
+/**
+ * @brief 从已结束的传输读取收发字节数与首字节时间
+ *
+ * 较小的请求体与请求头在同一次发送中发出，会同时计入REQUEST_SIZE与SIZE_UPLOAD，
+ * 因此发送字节取两者中较大的一个：小请求体不重复计数，大请求体只少算请求头。
+ * @param curl 已结束的curl句柄
+ * @param result 写入字节数与首字节时间
+ */
+inline void readTransferSize(CURL* curl, TransferResult& result) {
+    long requestSize = 0, headerSize = 0;
+    curl_off_t uploaded = 0, downloaded = 0, startTransferUs = 0;
+    curl_easy_getinfo(curl, CURLINFO_REQUEST_SIZE, &requestSize);
+    curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &headerSize);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransferUs);
+    result.bytesSent = static_cast<uint64_t>(std::max<curl_off_t>(requestSize, uploaded));
+    result.bodyBytes = static_cast<uint64_t>(std::max<curl_off_t>(0, downloaded));
+    result.bytesReceived = static_cast<uint64_t>(std::max(0L, headerSize)) + result.bodyBytes;
+    result.firstByteNs = startTransferUs * 1000;
+}
+
+/**
+ * @brief 从已结束传输的解码器读取线路字节、解码字节与解码耗时
+ * @param decoder 本次传输使用的解码器
+ * @param result 写入压缩相关字段
+ */
+inline void readDecodeResult(const ContentDecoder& decoder, TransferResult& result) {
+    result.wireBytes = decoder.getWireBytes();
+    result.decodedBytes = decoder.getDecodedBytes();
+    result.decodeNs = decoder.getDecodeNs();
+    result.contentEncoding = decoder.getEncoding();
+    result.decodeStatus = decoder.getStatus();
+}
+
+/**
+ * @brief 从事件循环中结束的传输生成传输结果：状态码、建连信息与收发字节数
+ * @param curl 已结束的curl句柄
+ * @param code 传输结果码
+ * @param elapsedNs 事件循环测得的耗时(纳秒)
+ * @return 传输结果，压缩相关字段由调用方按需补充
+ */
+inline TransferResult readFinishedTransfer(CURL* curl, CURLcode code, int64_t elapsedNs) {
+    TransferResult result;
+    result.code = code;
+    result.elapsedNs = elapsedNs;
+    if (code == CURLE_OK) {
+        long responseCode = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+        result.statusCode = static_cast<int>(responseCode);
+    }
+    readConnectionTiming(curl, result);
+    readTransferSize(curl, result);
+    return result;
+}
+
+// ---------------------------------------------------------------- Transport
+
+/**
+ * @class CurlEasyTransport
+ * @brief 复用一个curl easy句柄同步传输，按连接策略决定何时重新建连
+ *
+ * 默认每个请求都建立新连接，与原同步模式一致。连接缓存只保留一个连接：
+ * 达到每连接请求数的最后一个请求设置FORBID_REUSE，传输结束即关闭；
+ * 超过连接寿命或遇到重连风暴时设置FRESH_CONNECT，新连接建立后旧连接被挤出缓存关闭。
+ * 给出取消源时，传输由本对象私有的multi句柄驱动并阻塞在curl_multi_poll上，
+ * 取消源唤醒后立即移除传输，而不是等到请求超时。
+ * 设置了压缩协商时自行发送Accept-Encoding并关闭curl的自动解码，由ContentDecoder解码计数。
+ * 响应体不保存，写回调只确认收到；字节数从curl的传输信息读取。
+ */
+class CurlEasyTransport {
+public:
+    /**
+     * @brief 构造函数
+     * @param targetUrl 请求的URL
+     * @param timeoutMs 单个请求的超时(毫秒)，0表示不限
+     * @param cancellation 取消源，nullptr表示传输不可中断
+     */
+    CurlEasyTransport(std::string targetUrl, int timeoutMs, CancellationSource* cancellation = nullptr)
+        : url(std::move(targetUrl)),
+          timeout(timeoutMs),
+          cancel(cancellation),
+          multi(cancellation ? curl_multi_init() : nullptr) {
+        if (multi) {
+            curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, 1L);
+            cancel->registerMulti(multi);
+        }
+    }
+
+    ~CurlEasyTransport() {
+        if (curl) curl_easy_cleanup(curl);
+        if (headers) curl_slist_free_all(headers);
+        if (multi) {
+            cancel->unregisterMulti(multi);
+            curl_multi_cleanup(multi);
+        }
+    }
+
+    CurlEasyTransport(CurlEasyTransport&& other) noexcept
+        : url(std::move(other.url)),
+          timeout(other.timeout),
+          receiveBufferBytes(other.receiveBufferBytes),
+          cancel(other.cancel),
+          multi(other.multi),
+          curl(other.curl),
+          policy(other.policy),
+          storms(other.storms),
+          stormGeneration(other.stormGeneration),
+          requestsOnConnection(other.requestsOnConnection),
+          connectionOpen(other.connectionOpen),
+          connectionOpenedAt(other.connectionOpenedAt),
+          connectionsOpened(other.connectionsOpened),
+          compression(std::move(other.compression)),
+          decoder(std::move(other.decoder)),
+          headers(other.headers) {
+        other.multi = nullptr;
+        other.curl = nullptr;
+        other.headers = nullptr;
+    }
+
+    CurlEasyTransport(const CurlEasyTransport&) = delete;
+    CurlEasyTransport& operator=(const CurlEasyTransport&) = delete;
+    CurlEasyTransport& operator=(CurlEasyTransport&&) = delete;
+
+    /**
+     * @brief 设置连接复用策略（在第一次perform()之前调用）
+     * @param options 连接策略
+     * @param stormCounter 重连风暴计数，变化时下一个请求重新建连；nullptr表示不响应风暴
+     */
+    void setConnectionPolicy(const ConnectionOptions& options, const std::atomic<uint32_t>* stormCounter) {
+        policy = options;
+        storms = stormCounter;
+        if (storms) stormGeneration = storms->load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 设置压缩协商（在第一次perform()之前调用）
+     * @param options Accept-Encoding配置，未启用时保持curl的默认行为
+     */
+    void setCompression(const CompressionOptions& options) { compression = options; }
+
+    /**
+     * @brief 设置吞吐量模式的接收缓冲区（在第一次perform()之前调用）
+     * @param options 吞吐量模式配置，未启用时保持curl的默认缓冲区
+     */
+    void setThroughput(const ThroughputOptions& options) {
+        receiveBufferBytes = options.enabled ? static_cast<long>(options.receiveBufferKB) * 1024 : 0;
+    }
+
+    /**
+     * @brief 更换下一个请求的URL；同一主机的连接照常复用
+     * @param targetUrl 新的URL
+     */
+    void setUrl(std::string_view targetUrl) {
+        url.assign(targetUrl.data(), targetUrl.size());
+        if (curl) curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    }
+
+    /**
+     * @brief 发出一个请求并等待完成或被取消
+     */
+    TransferResult perform() {
+        TransferResult result;
+        if (!curl && !initHandle()) {
+            result.code = CURLE_FAILED_INIT;
+            return result;
+        }
+
+        decoder.reset();
+        auto start = std::chrono::steady_clock::now();
+        bool lastOnConnection = policy.requestsPerConnection > 0 &&
+                                requestsOnConnection + 1 >= policy.requestsPerConnection;
+        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, needsFreshConnection(start) ? 1L : 0L);
+        curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, lastOnConnection ? 1L : 0L);
+
+        {
+            TRACE_SPAN("curl_easy_perform");
+            result.code = multi ? performCancellable(result.cancelled) : curl_easy_perform(curl);
+        }
+        result.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (result.code == CURLE_OK) {
+            long responseCode = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+            result.statusCode = static_cast<int>(responseCode);
+        }
+        trackConnection(result, start, lastOnConnection);
+        readTransferSize(curl, result);
+        if (compression.enabled()) readDecodeResult(decoder, result);
+        return result;
+    }
+
+private:
+    static constexpr int MAX_POLL_MS = 1000;    ///< 无事件时的最长等待，取消靠唤醒而不靠它
+
+    static size_t discardBody(char*, size_t size, size_t nmemb, void*) {
+        return size * nmemb;
+    }
+
+    /**
+     * @brief 创建easy句柄并设置不随请求变化的选项
+     */
+    bool initHandle() {
+        curl = curl_easy_init();
+        if (!curl) return false;
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout);
+        curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, 1L);
+        if (receiveBufferBytes > 0) {
+            // 不超过libcurl允许的最大接收缓冲区
+            curl_easy_setopt(curl, CURLOPT_BUFFERSIZE, std::min<long>(receiveBufferBytes, CURL_MAX_READ_SIZE));
+        }
+        if (compression.enabled()) {
+            headers = curl_slist_append(nullptr, ("Accept-Encoding: " + compression.acceptEncoding).c_str());
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+            curl_easy_setopt(curl, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ContentDecoder::headerCallback);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &decoder);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, ContentDecoder::writeCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &decoder);
+        }
+        return true;
+    }
+
+    /**
+     * @brief 当前连接是否超过寿命或遇到了重连风暴
+     */
+    bool needsFreshConnection(std::chrono::steady_clock::time_point now) {
+        if (!connectionOpen) return false;
+        if (storms) {
+            uint32_t generation = storms->load(std::memory_order_relaxed);
+            if (generation != stormGeneration) {
+                stormGeneration = generation;
+                return true;
+            }
+        }
+        return policy.maxConnectionAgeMs > 0 &&
+               now - connectionOpenedAt >= std::chrono::milliseconds(policy.maxConnectionAgeMs);
+    }
+
+    /**
+     * @brief 读取建连信息并更新当前连接的请求数与寿命
+     */
+    void trackConnection(TransferResult& result, std::chrono::steady_clock::time_point start, bool lastOnConnection) {
+        readConnectionTiming(curl, result);
+        if (result.newConnection) {
+            result.reconnect = connectionsOpened > 0;
+            connectionsOpened++;
+            connectionOpenedAt = start;
+            requestsOnConnection = 0;
+        }
+        requestsOnConnection++;
+        // 失败或被中断的传输不一定留下可复用的连接，下一次按新连接计算
+        connectionOpen = result.code == CURLE_OK && !lastOnConnection;
+        if (!connectionOpen) requestsOnConnection = 0;
+    }
+
+    /**
+     * @brief 在私有multi句柄上完成一次传输，取消时移除传输并置位cancelled
+     */
+    CURLcode performCancellable(bool& cancelled) {
+        curl_multi_add_handle(multi, curl);
+
+        CURLcode code = CURLE_FAILED_INIT;
+        while (true) {
+            int stillRunning = 0;
+            if (curl_multi_perform(multi, &stillRunning) != CURLM_OK) break;
+            if (stillRunning == 0) {
+                int remaining = 0;
+                while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+                    if (message->msg == CURLMSG_DONE) code = message->data.result;
+                }
+                break;
+            }
+            if (cancel->isCancelled()) {
+                cancelled = true;
+                code = CURLE_ABORTED_BY_CALLBACK;
+                break;
+            }
+            curl_multi_poll(multi, nullptr, 0, MAX_POLL_MS, nullptr);
+        }
+
+        curl_multi_remove_handle(multi, curl);
+        return code;
+    }
+
+    std::string url;                ///< 请求的URL
+    long timeout;                   ///< 超时(毫秒)
+    long receiveBufferBytes = 0;    ///< curl接收缓冲区大小，0表示默认
+    CancellationSource* cancel;     ///< 取消源（可为空）
+    CURLM* multi;                   ///< 私有multi句柄，仅在可取消时创建
+    CURL* curl = nullptr;           ///< 复用的easy句柄，第一次请求时创建
+    ConnectionOptions policy;       ///< 连接复用策略
+    const std::atomic<uint32_t>* storms = nullptr;  ///< 重连风暴计数（可为空）
+    uint32_t stormGeneration = 0;   ///< 已响应的风暴计数
+    int requestsOnConnection = 0;   ///< 当前连接上已发出的请求数
+    bool connectionOpen = false;    ///< 上一个请求结束后是否留有可复用的连接
+    std::chrono::steady_clock::time_point connectionOpenedAt;   ///< 当前连接的建立时刻
+    uint64_t connectionsOpened = 0; ///< 本对象建立过的连接数
+    CompressionOptions compression; ///< 压缩协商配置
+    ContentDecoder decoder;         ///< 响应体解码与计数
+    curl_slist* headers = nullptr;  ///< Accept-Encoding请求头
+};
+
+/**
+ * @class UrlListTransport
+ * @brief 每个请求前从URL列表选一行，交给CurlEasyTransport发出
+ *
+ * URL直接从映射的文件复制到传输对象复用的缓冲区，请求路径上不分配内存；
+ * 结果的endpoint为该行在EndpointTable中的列表编号。
+ */
+class UrlListTransport {
+public:
+    /**
+     * @brief 构造函数
+     * @param inner 实际发出请求的传输
+     * @param urlPicker 本线程的URL选择器
+     */
+    UrlListTransport(CurlEasyTransport inner, UrlPicker urlPicker)
+        : transport(std::move(inner)), picker(std::move(urlPicker)) {}
+
+    TransferResult perform() {
+        size_t line = picker.next();
+        transport.setUrl(picker.getList().line(line));
+        TransferResult result = transport.perform();
+        result.endpoint = EndpointTable::listEndpoint(line);
+        return result;
+    }
+
+private:
+    CurlEasyTransport transport;    ///< 实际发出请求的传输
+    UrlPicker picker;               ///< 本线程的URL选择器
+};
+
+/**
+ * @class NullTransport
+ * @brief 不发请求，立即返回固定结果；用于测量引擎自身的单请求开销
+ */
+class NullTransport {
+public:
+    /**
+     * @brief 构造函数
+     * @param reportedNs 报告的响应时间(纳秒)
+     * @param reportedStatus 报告的HTTP状态码
+     */
+    explicit NullTransport(int64_t reportedNs = 1000000, int reportedStatus = 200)
+        : latencyNs(reportedNs), status(reportedStatus) {}
+
+    TransferResult perform() const {
+        TransferResult result;
+        result.statusCode = status;
+        result.elapsedNs = latencyNs;
+        return result;
+    }
+
+private:
+    int64_t latencyNs;      ///< 报告的响应时间
+    int status;             ///< 报告的状态码
+};
+
+// ---------------------------------------------------------------- Pacer
+// acquire(keepRunning, lagNs)阻塞到允许发出下一个请求，keepRunning()为假时返回false；
+// lagNs输出实际发出时刻晚于计划时刻的纳秒数。release()在请求完成后调用。
+
+/**
+ * @class NoPacer
+ * @brief 不限速，请求完成后立即发出下一个
+ */
+class NoPacer {
+public:
+    template <class KeepRunning>
+    bool acquire(KeepRunning&&, int64_t& lagNs) {
+        lagNs = 0;
+        return true;
+    }
+
+    void release() {}
+};
+
+/**
+ * @class FixedDelayPacer
+ * @brief 每个请求完成后等待固定间隔再发出下一个
+ */
+class FixedDelayPacer {
+public:
+    /**
+     * @brief 构造函数
+     * @param interRequestDelay 请求间隔
+     */
+    explicit FixedDelayPacer(std::chrono::nanoseconds interRequestDelay)
+        : delay(interRequestDelay), intendedStart(std::chrono::steady_clock::now()) {}
+
+    template <class KeepRunning>
+    bool acquire(KeepRunning&& keepRunning, int64_t& lagNs) {
+        waitForSpacing();
+        if (!keepRunning()) return false;
+        lagNs = lagSinceIntended(std::chrono::steady_clock::now());
+        return true;
+    }
+
+    void release() { intendedStart = std::chrono::steady_clock::now() + delay; }
+
+protected:
+    /**
+     * @brief 睡到上一个请求后的间隔结束
+     */
+    void waitForSpacing() {
+        if (std::chrono::steady_clock::now() < intendedStart) {
+            TRACE_SPAN("interRequestSleep");
+            std::this_thread::sleep_until(intendedStart);
+        }
+    }
+
+    int64_t lagSinceIntended(std::chrono::steady_clock::time_point now) const {
+        return std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(now - intendedStart).count());
+    }
+
+    std::chrono::nanoseconds delay;                         ///< 请求间隔
+    std::chrono::steady_clock::time_point intendedStart;    ///< 计划发出时刻
+};
+
+/**
+ * @class RateLimitedPacer
+ * @brief 在固定间隔之外还要从限流器取得令牌
+ *
+ * 被限流时睡到下一个令牌可用，分段睡眠以便及时响应停止；计划发出时刻随之推迟。
+ */
+class RateLimitedPacer : public FixedDelayPacer {
+public:
+    /**
+     * @brief 构造函数
+     * @param interRequestDelay 请求间隔
+     * @param rateLimiter 限流器（生命周期须长于本对象）
+     * @param urlEndpoint 请求URL的驻留编号
+     */
+    RateLimitedPacer(std::chrono::nanoseconds interRequestDelay, RateLimiter& rateLimiter, uint32_t urlEndpoint)
+        : FixedDelayPacer(interRequestDelay), limiter(rateLimiter), endpoint(urlEndpoint) {}
+
+    template <class KeepRunning>
+    bool acquire(KeepRunning&& keepRunning, int64_t& lagNs) {
+        waitForSpacing();
+        TRACE_SPAN("rateLimit");
+        while (true) {
+            if (!keepRunning()) return false;
+            auto now = std::chrono::steady_clock::now();
+            int64_t waitNs = limiter.acquire(endpoint, now);
+            if (waitNs <= 0) {
+                lagNs = lagSinceIntended(now);
+                return true;
+            }
+            intendedStart = now + std::chrono::nanoseconds(waitNs);
+            std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<int64_t>(waitNs, MAX_SLEEP_NS)));
+        }
+    }
+
+private:
+    static constexpr int64_t MAX_SLEEP_NS = 100000000;   ///< 单次睡眠上限
+
+    RateLimiter& limiter;   ///< 限流器
+    uint32_t endpoint;      ///< URL驻留编号
+};
+
+// ---------------------------------------------------------------- Stats
+
+/**
+ * @class NullStats
+ * @brief 不记录；由Sink自行统计时使用
+ */
+class NullStats {
+public:
+    void record(const TransferResult&) {}
+};
+
+/**
+ * @class SketchStats
+ * @brief 引擎私有的DDSketch与计数，单线程写入无需加锁
+ */
+class SketchStats {
+public:
+    void record(const TransferResult& result) {
+        sketch.add(result.elapsedNs / 1e6);
+        completed++;
+        if (result.code != CURLE_OK || result.statusCode < 200 || result.statusCode >= 300) failed++;
+    }
+
+    const DDSketch& getSketch() const { return sketch; }
+    uint64_t getCompleted() const { return completed; }
+    uint64_t getFailed() const { return failed; }
+
+private:
+    DDSketch sketch;        ///< 响应时间(毫秒)
+    uint64_t completed = 0; ///< 完成数
+    uint64_t failed = 0;    ///< 非2xx与传输错误数
+};
+
+// ---------------------------------------------------------------- Sink
+
+/**
+ * @class NullSink
+ * @brief 丢弃所有事件
+ */
+class NullSink {
+public:
+    void dispatched(int, int64_t) {}
+    void completed(int, const TransferResult&) {}
+};
+
+/**
+ * @class CallbackSink
+ * @brief 把事件转给两个可调用对象；类型是模板参数，lambda可被内联
+ */
+template <class OnDispatch, class OnComplete>
+class CallbackSink {
+public:
+    CallbackSink(OnDispatch dispatchHandler, OnComplete completeHandler)
+        : onDispatch(std::move(dispatchHandler)), onComplete(std::move(completeHandler)) {}
+
+    void dispatched(int requestId, int64_t lagNs) { onDispatch(requestId, lagNs); }
+    void completed(int requestId, const TransferResult& result) { onComplete(requestId, result); }
+
+private:
+    OnDispatch onDispatch;  ///< 请求发出时调用，参数为请求ID和调度延迟
+    OnComplete onComplete;  ///< 请求完成时调用，参数为请求ID和传输结果
+};
+
+/**
+ * @brief 由两个可调用对象构造CallbackSink，省去写出lambda类型
+ */
+template <class OnDispatch, class OnComplete>
+CallbackSink<OnDispatch, OnComplete> makeCallbackSink(OnDispatch onDispatch, OnComplete onComplete) {
+    return CallbackSink<OnDispatch, OnComplete>(std::move(onDispatch), std::move(onComplete));
+}
+
+// ---------------------------------------------------------------- Engine
+
+/**
+ * @class BasicLoadTester
+ * @brief 单个工作线程的闭环压测引擎
+ *
+ * 每个工作线程持有一个实例，策略对象均为本线程私有；跨线程共享的只有请求ID计数器。
+ * @tparam Transport 提供TransferResult perform()
+ * @tparam Pacer 提供bool acquire(keepRunning, int64_t& lagNs)与void release()
+ * @tparam Stats 提供void record(const TransferResult&)
+ * @tparam Sink 提供void dispatched(int, int64_t)与void completed(int, const TransferResult&)；
+ *              被取消的请求也交给completed，由Sink区分
+ */
+template <class Transport, class Pacer, class Stats, class Sink>
+class BasicLoadTester {
+public:
+    BasicLoadTester(Transport transportPolicy, Pacer pacerPolicy, Stats statsPolicy, Sink sinkPolicy)
+        : transport(std::move(transportPolicy)),
+          pacer(std::move(pacerPolicy)),
+          stats(std::move(statsPolicy)),
+          sink(std::move(sinkPolicy)) {}
+
+    /**
+     * @brief 循环发出请求，直到请求ID超出配额或keepRunning()为假
+     * @param requestIds 各线程共享的请求ID计数器，同时充当已发出请求的配额计数
+     * @param quota 请求总数
+     * @param keepRunning 返回是否继续的可调用对象
+     * @return 本实例完成的请求数
+     */
+    template <class KeepRunning>
+    uint64_t run(std::atomic<int>& requestIds, int quota, KeepRunning&& keepRunning) {
+        uint64_t completed = 0;
+        int64_t lagNs = 0;
+        while (keepRunning() && pacer.acquire(keepRunning, lagNs)) {
+            int requestId = requestIds.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (requestId > quota) break;
+
+            sink.dispatched(requestId, lagNs);
+            TransferResult result = transport.perform();
+            if (!result.cancelled) stats.record(result);
+            sink.completed(requestId, result);
+            pacer.release();
+            completed++;
+        }
+        return completed;
+    }
+
+    Transport& getTransport() { return transport; }
+    Pacer& getPacer() { return pacer; }
+    Stats& getStats() { return stats; }
+    Sink& getSink() { return sink; }
+
+private:
+    Transport transport;    ///< 传输策略
+    Pacer pacer;            ///< 节奏策略
+    Stats stats;            ///< 统计策略
+    Sink sink;              ///< 结果去向
+};
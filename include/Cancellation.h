@@ -0,0 +1,53 @@
+/**
+ * @file Cancellation.h
+ * @brief 中断进行中传输的取消源的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <curl/curl.h>
+
+/**
+ * @class CancellationSource
+ * @brief 一次测试的取消信号
+ *
+ * 等待I/O的线程都阻塞在curl_multi_poll上，把各自的multi句柄登记到这里；
+ * cancel()置位标志后对每个句柄调用curl_multi_wakeup，阻塞的poll立即返回，
+ * 线程看到标志后移除进行中的传输。唤醒是粘滞的，即使在poll之前到达也不会丢失。
+ */
+class CancellationSource {
+public:
+    /**
+     * @brief 清除取消标志（测试开始前、没有线程等待时调用）
+     */
+    void reset() { cancelled.store(false, std::memory_order_release); }
+
+    /**
+     * @brief 置位取消标志并唤醒所有登记的multi句柄
+     */
+    void cancel();
+
+    /**
+     * @brief 是否已取消
+     */
+    bool isCancelled() const { return cancelled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 登记一个multi句柄，取消时唤醒它
+     * @param multi 句柄，在注销之前必须保持有效
+     */
+    void registerMulti(CURLM* multi);
+
+    /**
+     * @brief 注销multi句柄（销毁句柄之前调用）
+     * @param multi 句柄
+     */
+    void unregisterMulti(CURLM* multi);
+
+private:
+    std::atomic<bool> cancelled{false};     ///< 取消标志
+    std::vector<CURLM*> handles;            ///< 登记的multi句柄
+    std::mutex handlesMutex;                ///< 句柄列表互斥锁
+};
@@ -0,0 +1,56 @@
+/**
+ * @file ConnectionChurn.h
+ * @brief 连接复用策略与建连统计的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include "DDSketch.h"
+
+/**
+ * @struct ConnectionOptions
+ * @brief 同步请求的连接复用策略
+ *
+ * 默认每个连接只发一个请求，与原同步模式一致；调大后在连接上保持keep-alive，
+ * 达到请求数或连接寿命后关闭并重新建连。重连风暴按间隔让所有连接同时断开。
+ */
+struct ConnectionOptions {
+    int requestsPerConnection = 1;      ///< 每个连接最多发出的请求数，0表示不限
+    int maxConnectionAgeMs = 0;         ///< 连接最长寿命(毫秒)，0表示不限
+    int reconnectStormIntervalMs = 0;   ///< 重连风暴间隔(毫秒)，0表示不触发
+
+    /**
+     * @brief 是否为默认的每请求一个连接且不触发风暴
+     */
+    bool isDefault() const {
+        return requestsPerConnection == 1 && maxConnectionAgeMs <= 0 && reconnectStormIntervalMs <= 0;
+    }
+};
+
+/**
+ * @struct ConnectionStats
+ * @brief 建连次数与握手耗时
+ */
+struct ConnectionStats {
+    uint64_t opened = 0;            ///< 新建的连接数
+    uint64_t reconnects = 0;        ///< 替换已有连接的建连次数
+    uint64_t storms = 0;            ///< 触发的重连风暴次数
+    DDSketch tcpHandshake;          ///< TCP握手耗时(毫秒)
+    DDSketch tlsHandshake;          ///< TLS握手耗时(毫秒)，仅HTTPS
+    DDSketch reconnectLatency;      ///< 重连时从请求开始到连接可用的耗时(毫秒)
+
+    /**
+     * @brief 记录一次新建连接
+     * @param reconnect 是否替换了已有连接
+     * @param tcpNs TCP握手耗时(纳秒)
+     * @param tlsNs TLS握手耗时(纳秒)，0表示没有TLS
+     * @param readyNs 从请求开始到连接可用的耗时(纳秒)
+     */
+    void record(bool reconnect, int64_t tcpNs, int64_t tlsNs, int64_t readyNs);
+
+    /**
+     * @brief 合并另一份统计
+     * @param other 另一份统计
+     */
+    void merge(const ConnectionStats& other);
+};
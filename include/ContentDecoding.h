@@ -0,0 +1,176 @@
+/**
+ * @file ContentDecoding.h
+ * @brief 响应压缩协商、解码与线路/解码字节统计的声明
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @enum ContentEncoding
+ * @brief 响应的Content-Encoding
+ */
+enum class ContentEncoding : uint8_t {
+    IDENTITY,   ///< 未压缩
+    GZIP,       ///< gzip / x-gzip
+    DEFLATE,    ///< deflate（zlib格式或裸deflate）
+    BROTLI,     ///< br
+    OTHER,      ///< 其他或多重编码，不解码
+    COUNT
+};
+
+/**
+ * @enum DecodeStatus
+ * @brief 一个响应体的解码结果
+ */
+enum class DecodeStatus : uint8_t {
+    OK,             ///< 已解码或无需解码
+    FAILED,         ///< 数据损坏或不完整
+    UNSUPPORTED     ///< 本构建不支持该编码，只统计线路字节
+};
+
+/**
+ * @struct CompressionOptions
+ * @brief 压缩协商配置
+ */
+struct CompressionOptions {
+    std::string acceptEncoding;     ///< Accept-Encoding请求头的值，如"gzip, deflate, br"；空表示不协商
+
+    /**
+     * @brief 是否协商压缩并统计解码开销
+     */
+    bool enabled() const { return !acceptEncoding.empty(); }
+};
+
+/**
+ * @struct EncodingStats
+ * @brief 同一种编码的响应的字节与解码耗时
+ */
+struct EncodingStats {
+    uint64_t responses = 0;         ///< 响应数
+    uint64_t wireBytes = 0;         ///< 线路上收到的响应体字节（压缩后）
+    uint64_t decodedBytes = 0;      ///< 解码后的字节
+    int64_t decodeNs = 0;           ///< 解码耗时(纳秒)
+    uint64_t failed = 0;            ///< 解码失败的响应数
+    uint64_t unsupported = 0;       ///< 未能解码的响应数
+
+    /**
+     * @brief 压缩比（解码后字节/线路字节），没有线路字节时为0
+     */
+    double ratio() const { return wireBytes > 0 ? static_cast<double>(decodedBytes) / wireBytes : 0.0; }
+
+    /**
+     * @brief 每解码出1MB的耗时(毫秒)
+     */
+    double decodeMsPerMB() const {
+        return decodedBytes > 0 ? decodeNs / 1e6 / (decodedBytes / (1024.0 * 1024.0)) : 0.0;
+    }
+
+    void merge(const EncodingStats& other);
+};
+
+/**
+ * @struct CompressionStats
+ * @brief 按编码分类的响应字节与解码耗时
+ */
+struct CompressionStats {
+    EncodingStats encodings[static_cast<size_t>(ContentEncoding::COUNT)];   ///< 按ContentEncoding下标
+
+    /**
+     * @brief 记录一个响应
+     */
+    void record(ContentEncoding encoding, uint64_t wireBytes, uint64_t decodedBytes, int64_t decodeNs,
+                DecodeStatus status);
+
+    /**
+     * @brief 合并另一份统计
+     */
+    void merge(const CompressionStats& other);
+
+    /**
+     * @brief 所有编码的合计
+     */
+    EncodingStats total() const;
+
+    /**
+     * @brief 获取某种编码的统计
+     */
+    const EncodingStats& of(ContentEncoding encoding) const { return encodings[static_cast<size_t>(encoding)]; }
+
+    /**
+     * @brief 编码名称，用于日志
+     */
+    static const char* name(ContentEncoding encoding);
+};
+
+/**
+ * @class ContentDecoder
+ * @brief 在curl回调中逐块解码一个响应体，只计数不保留解码结果
+ *
+ * 由调用方关闭curl自带的解码（CURLOPT_HTTP_CONTENT_DECODING为0）并自行发送Accept-Encoding，
+ * 这样写回调收到的就是线路上的字节，解码耗时只计解码调用本身。gzip与deflate用zlib解码，
+ * deflate自动识别zlib头与裸deflate；br需要以LOADTESTER_BROTLI编译，否则只统计线路字节。
+ * 解码状态在对象内复用，每个响应只重置而不重新分配；解码输出写入线程共用的暂存区后丢弃。
+ */
+class ContentDecoder {
+public:
+    ContentDecoder();
+    ~ContentDecoder();
+
+    ContentDecoder(ContentDecoder&& other) noexcept;
+    ContentDecoder& operator=(ContentDecoder&& other) noexcept;
+    ContentDecoder(const ContentDecoder&) = delete;
+    ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+    /**
+     * @brief 开始一个新的传输，清零计数
+     */
+    void reset();
+
+    /**
+     * @brief 处理一行响应头；遇到状态行时重新开始（重定向与1xx响应各有一组响应头）
+     */
+    void onHeader(const char* data, size_t length);
+
+    /**
+     * @brief 处理一块线路上的响应体
+     */
+    void onBody(const char* data, size_t length);
+
+    /**
+     * @brief curl响应头回调，userdata为ContentDecoder*
+     */
+    static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+
+    /**
+     * @brief curl写回调，userdata为ContentDecoder*
+     */
+    static size_t writeCallback(char* buffer, size_t size, size_t nmemb, void* userdata);
+
+    ContentEncoding getEncoding() const { return encoding; }
+    uint64_t getWireBytes() const { return wireBytes; }
+    uint64_t getDecodedBytes() const { return decodedBytes; }
+    int64_t getDecodeNs() const { return decodeNs; }
+
+    /**
+     * @brief 当前响应的解码结果；压缩流未结束也算失败
+     */
+    DecodeStatus getStatus() const;
+
+private:
+    struct Inflater;
+
+    void decode(const char* data, size_t length);
+
+    std::unique_ptr<Inflater> inflater;     ///< 解码器状态，第一次遇到压缩响应时创建
+    ContentEncoding encoding;               ///< 当前响应的编码
+    DecodeStatus status;                    ///< 当前响应的解码结果
+    bool streamStarted;                     ///< 当前响应的解码流是否已初始化
+    bool streamEnded;                       ///< 压缩流是否已完整结束
+    uint64_t wireBytes;                     ///< 线路字节
+    uint64_t decodedBytes;                  ///< 解码后字节
+    int64_t decodeNs;                       ///< 解码耗时(纳秒)
+};
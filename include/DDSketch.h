@@ -0,0 +1,143 @@
+/**
+ * @file DDSketch.h
+ * @brief 相对误差可保证的可合并分位数草图(DDSketch)的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class DDSketch
+ * @brief 对数分桶的分位数草图
+ *
+ * 任意分位数的估计值与真实值的相对误差不超过relativeAccuracy。
+ * 相同精度的草图可以跨线程、跨运行、跨机器合并，合并结果与直接记录所有样本相同。
+ * 以毫秒为单位时，1%精度覆盖1微秒到数分钟只需约一千个桶。
+ */
+class DDSketch {
+public:
+    /**
+     * @brief 构造函数
+     * @param relativeAccuracy 相对精度，取值(0, 1)，默认1%
+     * @param maxBins 最大桶数，超出时合并最小的桶（只影响最低端分位数的精度）
+     */
+    explicit DDSketch(double relativeAccuracy = 0.01, size_t maxBins = 4096);
+
+    /**
+     * @brief 记录一个值
+     * @param value 值（非负，通常为毫秒）
+     * @param count 记录次数
+     */
+    void add(double value, uint64_t count = 1);
+
+    /**
+     * @brief 合并另一个草图
+     * @param other 另一个草图
+     * @return 如果两者精度一致并成功合并返回true，否则返回false
+     */
+    bool merge(const DDSketch& other);
+
+    /**
+     * @brief 估计分位数
+     * @param q 分位数，取值[0, 1]
+     * @return 估计值；草图为空时返回0
+     */
+    double quantile(double q) const;
+
+    /**
+     * @brief 清空草图
+     */
+    void clear();
+
+    /**
+     * @brief 遍历所有非空桶（按值从小到大）
+     * @param visitor 回调函数，接收桶下界、桶上界和计数；零桶的上下界均为0
+     */
+    template <typename Visitor>
+    void forEachBin(Visitor visitor) const {
+        if (zeroCount > 0) {
+            visitor(0.0, 0.0, zeroCount);
+        }
+        for (size_t i = 0; i < bins.size(); ++i) {
+            if (bins[i] > 0) {
+                int key = binOffset + static_cast<int>(i);
+                visitor(lowerBound(key), lowerBound(key + 1), bins[i]);
+            }
+        }
+    }
+
+    uint64_t getCount() const { return count; }             ///< 样本总数
+    double getSum() const { return sum; }                   ///< 样本总和
+    double getMin() const { return count ? minValue : 0.0; } ///< 精确最小值
+    double getMax() const { return count ? maxValue : 0.0; } ///< 精确最大值
+    double getAverage() const { return count ? sum / count : 0.0; } ///< 平均值
+    double getRelativeAccuracy() const { return relativeAccuracy; } ///< 相对精度
+    size_t getBinCount() const { return bins.size(); }      ///< 当前桶数组长度
+
+    /**
+     * @brief 序列化为紧凑的二进制格式（变长整数编码）
+     * @return 二进制数据
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief 从二进制数据恢复草图
+     * @param data 由serialize()生成的数据
+     * @param sketch 输出草图
+     * @return 如果数据有效返回true，否则返回false且不修改sketch
+     */
+    static bool deserialize(const std::string& data, DDSketch& sketch);
+
+    /**
+     * @brief 保存到文件
+     * @param filePath 文件路径
+     * @return 如果成功返回true
+     */
+    bool saveToFile(const std::string& filePath) const;
+
+    /**
+     * @brief 从文件加载并合并到当前草图
+     * @param filePath 文件路径
+     * @return 如果文件有效且合并成功返回true
+     */
+    bool mergeFromFile(const std::string& filePath);
+
+private:
+    /**
+     * @brief 计算值所在的桶编号
+     */
+    int keyOf(double value) const;
+
+    /**
+     * @brief 计算桶的下界
+     */
+    double lowerBound(int key) const;
+
+    /**
+     * @brief 计算桶的代表值（相对误差最小的点）
+     */
+    double representative(int key) const;
+
+    /**
+     * @brief 确保桶数组覆盖指定编号，必要时合并最低端的桶
+     * @return 该编号在数组中的下标
+     */
+    size_t binIndex(int key);
+
+private:
+    double relativeAccuracy;        ///< 相对精度
+    double gamma;                   ///< 桶的比例因子 (1+a)/(1-a)
+    double logGamma;                ///< ln(gamma)
+    double minIndexableValue;       ///< 小于该值的样本计入零桶
+    size_t maxBins;                 ///< 最大桶数
+
+    std::vector<uint64_t> bins;     ///< 连续的桶计数
+    int binOffset;                  ///< bins[0]对应的桶编号
+    uint64_t zeroCount;             ///< 零桶计数
+    uint64_t count;                 ///< 样本总数
+    double sum;                     ///< 样本总和
+    double minValue;                ///< 最小值
+    double maxValue;                ///< 最大值
+};
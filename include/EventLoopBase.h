@@ -0,0 +1,89 @@
+/**
+ * @file EventLoopBase.h
+ * @brief 各单线程事件循环共用的停止、排空与周期回调接线
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "Cancellation.h"
+
+/**
+ * @class EventLoopBase
+ * @brief 虚拟用户、WebSocket、流式请求与日志回放事件循环的公共部分
+ *
+ * 这些循环都在一个工作线程上阻塞于curl_multi_poll：停止由取消源唤醒，
+ * 排空靠每轮检查标志，因此无事件时的等待不超过MAX_POLL_MS；每轮开始时调用
+ * 周期回调做采样。派生类只负责自己的连接状态与run()。
+ */
+class EventLoopBase {
+public:
+    /**
+     * @brief 事件循环每轮调用一次，用于在本线程上做周期性采样
+     */
+    using TickHandler = std::function<void(std::chrono::steady_clock::time_point now)>;
+
+    /**
+     * @brief 设置每轮事件循环的回调（在run()之前调用）
+     * @param handler 回调，为空表示不调用
+     */
+    void setTickHandler(TickHandler handler) { tick = std::move(handler); }
+
+    /**
+     * @brief 登记取消源，停止时由它唤醒阻塞的curl_multi_poll（在run()之前调用）
+     * @param source 取消源，nullptr表示只靠轮询超时响应停止
+     */
+    void setCancellation(CancellationSource* source) { cancellation = source; }
+
+    /**
+     * @brief 设置排空标志：置位后不再发出新请求，进行中的请求结束后run()返回（在run()之前调用）
+     * @param flag 排空标志，nullptr表示不支持排空
+     */
+    void setDrainFlag(const std::atomic<bool>* flag) { draining = flag; }
+
+protected:
+    EventLoopBase() = default;
+    ~EventLoopBase() = default;
+
+    EventLoopBase(const EventLoopBase&) = delete;
+    EventLoopBase& operator=(const EventLoopBase&) = delete;
+
+    static constexpr int MAX_POLL_MS = 100; ///< 无事件时的最长等待，保证能及时响应排空；停止由取消源唤醒
+
+    /**
+     * @brief 按下一个定时器的等待时间计算本轮poll的超时
+     * @param waitMs 距下一个定时器的毫秒数，-1表示没有定时器
+     */
+    static int pollTimeoutMs(int waitMs) {
+        return waitMs < 0 ? MAX_POLL_MS : std::min(waitMs, MAX_POLL_MS);
+    }
+
+    /**
+     * @brief 时长换算为纳秒
+     */
+    static int64_t toNs(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    }
+
+    /**
+     * @brief 丢弃响应体的写回调
+     */
+    static size_t discardBody(char*, size_t size, size_t nmemb, void*) {
+        return size * nmemb;
+    }
+
+    /**
+     * @brief 排空标志是否已置位
+     */
+    bool isDraining() const {
+        return draining && draining->load(std::memory_order_relaxed);
+    }
+
+    TickHandler tick;                               ///< 每轮事件循环的回调
+    CancellationSource* cancellation = nullptr;     ///< 取消源（可为空）
+    const std::atomic<bool>* draining = nullptr;    ///< 排空标志（可为空）
+};
@@ -0,0 +1,235 @@
+/**
+ * @file EventStream.h
+ * @brief 服务器推送事件(SSE)与长轮询流式模式的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "DDSketch.h"
+#include "EventLoopBase.h"
+#include "TimerWheel.h"
+
+/**
+ * @struct StreamingOptions
+ * @brief 流式模式配置
+ */
+struct StreamingOptions {
+    bool enabled = false;           ///< 是否启用流式模式
+    int streams = 0;                ///< 同时保持的流数，0表示每个工作线程一个
+    int streamDurationMs = 0;       ///< 单个流保持的最长时间(毫秒)，到时由客户端结束并重连；0表示直到服务端关闭
+    int reconnectDelayMs = 0;       ///< 流结束后重新连接前的等待(毫秒)
+    int rampUpMs = 0;               ///< 所有流在该时长内均匀建立(毫秒)
+    std::string timestampField;     ///< 事件中携带发送时间戳的字段名（SSE字段或data中的JSON键），空表示不统计端到端延迟
+};
+
+/**
+ * @struct StreamStats
+ * @brief 流与事件的计数和延迟分布
+ */
+struct StreamStats {
+    uint64_t streams = 0;           ///< 结束的流数
+    uint64_t failedStreams = 0;     ///< 出错结束（含非2xx状态码）的流数
+    uint64_t events = 0;            ///< 收到的事件数
+    uint64_t bytes = 0;             ///< 收到的流字节数
+    uint64_t skewedTimestamps = 0;  ///< 时间戳晚于本机时钟的事件数（时钟不同步），延迟按0记录
+    DDSketch firstEvent;            ///< 从发起请求到第一个事件(毫秒)
+    DDSketch interEventGap;         ///< 同一流位上相邻事件的间隔(毫秒)，长轮询时含重连时间
+    DDSketch eventLag;              ///< 事件时间戳到收到事件的端到端延迟(毫秒)
+
+    /**
+     * @brief 合并另一份统计
+     */
+    void merge(const StreamStats& other);
+};
+
+/**
+ * @class EventStreamParser
+ * @brief 逐块解析SSE帧，不缓存流内容
+ *
+ * 只保留当前行的前若干字节（用于识别字段名和提取时间戳），其余字节看过即丢。
+ * 空行结束一个事件；以冒号开头的注释行（心跳）不算事件。非SSE响应（长轮询）
+ * 整个响应体算一个事件，在传输结束时由finish()分派。
+ */
+class EventStreamParser {
+public:
+    /**
+     * @brief 事件回调
+     * @param timestampNs 事件携带的时间戳（自纪元起的纳秒），没有时为-1
+     */
+    using EventHandler = std::function<void(int64_t timestampNs)>;
+
+    /**
+     * @brief 构造函数
+     * @param timestampField 时间戳字段名，空表示不提取
+     */
+    explicit EventStreamParser(std::string timestampField = std::string());
+
+    /**
+     * @brief 开始解析一个新的响应
+     * @param eventStream 响应是否为text/event-stream
+     */
+    void reset(bool eventStream);
+
+    /**
+     * @brief 解析一块响应体
+     */
+    void feed(const char* data, size_t length, const EventHandler& onEvent);
+
+    /**
+     * @brief 响应结束：长轮询响应在此分派唯一的事件
+     */
+    void finish(const EventHandler& onEvent);
+
+    /**
+     * @brief 从文本中解析时间戳字段，按数量级识别秒、毫秒、微秒或纳秒
+     * @param text 一行文本
+     * @param field 字段名
+     * @param asJsonKey true时查找"field":值，false时text本身就是值
+     * @return 自纪元起的纳秒，没有找到或无法解析时为-1
+     */
+    static int64_t parseTimestamp(const std::string& text, const std::string& field, bool asJsonKey);
+
+private:
+    void endLine(const EventHandler& onEvent);
+
+    std::string field;          ///< 时间戳字段名
+    std::string line;           ///< 当前行的前缀（有上限）
+    bool eventStream;           ///< 是否按SSE解析
+    bool hasData;               ///< 当前事件是否已有data行
+    bool skipLineFeed;          ///< 上一个字符是\r，紧随的\n不再结束一行
+    bool bodySeen;              ///< 长轮询响应是否收到过字节
+    int64_t timestampNs;        ///< 当前事件的时间戳，没有时为-1
+};
+
+/**
+ * @class StreamLoop
+ * @brief 在单个线程中保持一组长时间打开的流式请求
+ *
+ * 每个流位持有一个curl easy句柄，所有传输由同一个multi句柄驱动。响应体在写回调里
+ * 交给EventStreamParser逐块解析，记录首个事件时间、事件间隔和端到端延迟；流结束
+ * （服务端关闭、达到保持时长或长轮询响应返回）后按重连间隔发起下一个请求。
+ * 流式请求不受普通请求超时限制：超时只用于建连，以及在该时长内一个字节都没收到时判定为停滞。
+ */
+class StreamLoop : public EventLoopBase {
+public:
+    /**
+     * @brief 发起流式请求前调用，返回请求ID；返回值小于等于0表示不再发起
+     * @param lagNs 实际发起时刻晚于计划时刻的纳秒数
+     */
+    using DispatchHandler = std::function<int(int64_t lagNs)>;
+
+    /**
+     * @brief 一个流结束时调用
+     * @param easy 结束的curl句柄（可用于curl_easy_getinfo）
+     * @param result 传输结果；达到保持时长由客户端结束时为CURLE_OK
+     * @param requestId 发起时分配的请求ID
+     * @param elapsedNs 到第一个事件的时间；没有收到事件时为整个流的持续时间(纳秒)
+     */
+    using CompletionHandler = std::function<void(CURL* easy, CURLcode result, int requestId, int64_t elapsedNs)>;
+
+    /**
+     * @brief 构造函数
+     * @param firstStream 本循环第一个流位的全局序号
+     * @param streamCount 本循环负责的流位数
+     * @param totalStreams 所有循环的流位总数（用于计算爬坡时间）
+     * @param options 流式模式配置
+     * @param requestTimeoutMs 建连超时与停滞判定时长(毫秒)
+     */
+    StreamLoop(int firstStream, int streamCount, int totalStreams, const StreamingOptions& options,
+               int requestTimeoutMs);
+    ~StreamLoop();
+
+    StreamLoop(const StreamLoop&) = delete;
+    StreamLoop& operator=(const StreamLoop&) = delete;
+
+    /**
+     * @brief run()因停止而返回时仍打开、被放弃的流数
+     */
+    int getCancelledCount() const { return cancelledCount; }
+
+    /**
+     * @brief 在当前线程运行事件循环，直到running为false或所有流位结束
+     * @param url 流式端点URL
+     * @param running 运行标志
+     * @param dispatch 流发起回调
+     * @param complete 流结束回调
+     */
+    void run(const std::string& url, const std::atomic<bool>& running,
+             const DispatchHandler& dispatch, const CompletionHandler& complete);
+
+    /**
+     * @brief 获取本循环的流与事件统计
+     */
+    const StreamStats& getStats() const { return stats; }
+
+    /**
+     * @brief 获取本循环的定时器精度统计
+     */
+    const TimerStats& getTimerStats() const { return timers.getStats(); }
+
+private:
+    /**
+     * @enum StreamState
+     * @brief 流位状态
+     */
+    enum class StreamState : uint8_t {
+        WAITING,    ///< 等待建立或重连
+        OPEN,       ///< 请求进行中
+        FINISHED    ///< 不再发起请求
+    };
+
+    /**
+     * @enum TimerKind
+     * @brief 定时器用途，编码在令牌中
+     */
+    enum class TimerKind : uint8_t {
+        WAKE,       ///< 发起下一个请求
+        DEADLINE    ///< 达到保持时长
+    };
+
+    /**
+     * @struct Stream
+     * @brief 单个流位的全部状态
+     */
+    struct Stream {
+        StreamLoop* owner = nullptr;                            ///< 所属循环（供curl回调使用）
+        CURL* easy = nullptr;                                   ///< 复用的curl句柄
+        EventStreamParser parser;                               ///< 增量解析器
+        std::chrono::steady_clock::time_point requestStart;     ///< 当前请求的开始时间
+        std::chrono::steady_clock::time_point intendedStart;    ///< 当前请求的计划发起时间
+        std::chrono::steady_clock::time_point lastEvent;        ///< 上一个事件的到达时间
+        int64_t firstEventNs = -1;                              ///< 当前请求到第一个事件的时间，未收到时为-1
+        int requestId = 0;                                      ///< 当前请求ID
+        uint32_t generation = 0;                                ///< 状态版本号，用于作废过期定时器
+        bool hasLastEvent = false;                              ///< lastEvent是否有效
+        StreamState state = StreamState::WAITING;               ///< 当前状态
+    };
+
+    static size_t onHeader(char* buffer, size_t size, size_t nitems, void* userdata);
+    static size_t onBody(char* buffer, size_t size, size_t nmemb, void* userdata);
+    static uint64_t makeToken(TimerKind kind, size_t index, uint32_t generation);
+    void onEvent(Stream& stream, int64_t timestampNs);
+    void onTimer(uint64_t token, const DispatchHandler& dispatch, const CompletionHandler& complete);
+    void startStream(size_t index, const DispatchHandler& dispatch);
+    void finishStream(size_t index, CURLcode result, const CompletionHandler& complete);
+    void collectCompleted(const CompletionHandler& complete);
+
+private:
+    CURLM* multi;                       ///< curl multi句柄
+    std::vector<Stream> streamSlots;    ///< 本循环的流位
+    StreamingOptions options;           ///< 流式模式配置
+    long timeoutMs;                     ///< 建连超时与停滞判定时长(毫秒)
+    curl_slist* headers;                ///< 所有流共用的请求头（Accept: text/event-stream）
+    TimerWheel timers;                  ///< 爬坡、重连与保持时长
+    int cancelledCount;                 ///< 停止时被放弃的流数
+    int inFlight;                       ///< 打开的流数
+    bool accepting;                     ///< 是否仍允许发起新的流
+    StreamStats stats;                  ///< 流与事件统计
+};
@@ -0,0 +1,104 @@
+/**
+ * @file GeneratorHealth.h
+ * @brief 负载发生器自身饱和检测的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DDSketch.h"
+
+/**
+ * @struct ThreadUsage
+ * @brief 线程自启动以来的累计资源使用
+ */
+struct ThreadUsage {
+    int64_t cpuNs = 0;                  ///< 线程CPU时间(纳秒)
+    int64_t runQueueNs = 0;             ///< 可运行但在运行队列中等待的时间(纳秒)，不支持时为0
+    int64_t involuntarySwitches = 0;    ///< 非自愿上下文切换次数，不支持时为0
+};
+
+/**
+ * @brief 读取当前线程的累计资源使用
+ *
+ * Linux上CPU时间取自CLOCK_THREAD_CPUTIME_ID，非自愿切换取自getrusage(RUSAGE_THREAD)，
+ * 运行队列等待取自/proc/thread-self/schedstat；Windows上只有GetThreadTimes给出的CPU时间。
+ * @return 累计资源使用
+ */
+ThreadUsage sampleCurrentThreadUsage();
+
+/**
+ * @struct HealthThresholds
+ * @brief 判定发生器饱和的阈值，任意一项超出即视为该窗口饱和
+ */
+struct HealthThresholds {
+    double maxDispatchLagMs = 10.0;         ///< 调度延迟P99上限(毫秒)
+    double maxThreadCpuPercent = 90.0;      ///< 单个工作线程CPU占用上限(%)
+    double maxRunQueuePercent = 10.0;       ///< 单个工作线程在运行队列中等待的时间占比上限(%)
+    double maxInvoluntarySwitchesPerSec = 1000.0; ///< 单个工作线程每秒非自愿切换上限
+};
+
+/**
+ * @struct HealthWindow
+ * @brief 一个检测窗口内的发生器健康指标
+ */
+struct HealthWindow {
+    double dispatchLagP99Ms = 0.0;          ///< 计划发送与实际发送之差的P99(毫秒)
+    double maxThreadCpuPercent = 0.0;       ///< 最忙工作线程的CPU占用(%)
+    double maxRunQueuePercent = 0.0;        ///< 最大的运行队列等待占比(%)
+    double maxInvoluntarySwitchesPerSec = 0.0; ///< 最大的每秒非自愿切换次数
+    bool saturated = false;                 ///< 是否超出任一阈值
+    std::string reason;                     ///< 超出的指标，未饱和时为空
+};
+
+/**
+ * @struct HealthReport
+ * @brief 整个运行的发生器健康汇总
+ */
+struct HealthReport {
+    int windows = 0;                        ///< 检测窗口数
+    int saturatedWindows = 0;               ///< 饱和窗口数
+    HealthWindow worst;                     ///< 各指标在所有窗口中的最大值
+    std::string firstReason;                ///< 第一次饱和的原因
+
+    /**
+     * @brief 结果是否可信：任一窗口饱和则不可信
+     */
+    bool untrustworthy() const { return saturatedWindows > 0; }
+};
+
+/**
+ * @class GeneratorHealth
+ * @brief 按窗口评估发生器是否饱和并累计汇总
+ *
+ * 调用者负责采集：每个窗口提供调度延迟草图和各工作线程的资源使用增量。
+ * 本类不加锁，由调用者保证串行访问。
+ */
+class GeneratorHealth {
+public:
+    /**
+     * @brief 清空汇总并设置阈值
+     * @param thresholds 饱和阈值
+     */
+    void reset(const HealthThresholds& thresholds);
+
+    /**
+     * @brief 评估一个窗口并计入汇总
+     * @param dispatchLagMs 窗口内的调度延迟(毫秒)
+     * @param usageDeltas 各工作线程在窗口内的资源使用增量
+     * @param windowSeconds 窗口时长(秒)
+     * @return 该窗口的指标
+     */
+    HealthWindow evaluate(const DDSketch& dispatchLagMs, const std::vector<ThreadUsage>& usageDeltas,
+                          double windowSeconds);
+
+    /**
+     * @brief 获取汇总
+     */
+    const HealthReport& getReport() const { return report; }
+
+private:
+    HealthThresholds thresholds;    ///< 饱和阈值
+    HealthReport report;            ///< 运行汇总
+};
@@ -0,0 +1,80 @@
+/**
+ * @file LatencyHistogram.h
+ * @brief 与HdrHistogram编码兼容的响应时间直方图的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class LatencyHistogram
+ * @brief HdrHistogram布局的整数直方图
+ *
+ * 桶布局与HdrHistogram完全一致（最小可区分值1，3位有效数字），
+ * 因此可以输出标准的V2压缩编码，供HdrHistogram工具链直接读取。
+ * 记录操作是O(1)的数组下标计算，不分配内存。
+ */
+class LatencyHistogram {
+public:
+    /**
+     * @brief 构造函数
+     * @param highestTrackableValue 可记录的最大值，超出的值按最大值记录
+     */
+    explicit LatencyHistogram(int64_t highestTrackableValue = 3600LL * 1000 * 1000);
+
+    /**
+     * @brief 记录一个值
+     * @param value 值（非负整数，通常为微秒）
+     * @param count 记录次数
+     */
+    void record(int64_t value, int64_t count = 1);
+
+    /**
+     * @brief 清空所有计数
+     */
+    void reset();
+
+    /**
+     * @brief 合并另一个布局相同的直方图
+     * @param other 另一个直方图
+     */
+    void add(const LatencyHistogram& other);
+
+    /**
+     * @brief 估计分位数
+     * @param q 分位数，取值[0, 1]
+     * @return 分位数所在桶内的最大等价值；直方图为空时返回0
+     */
+    int64_t valueAtQuantile(double q) const;
+
+    int64_t getTotalCount() const { return totalCount; }    ///< 样本总数
+    int64_t getMinValue() const { return totalCount ? minValue : 0; } ///< 最小值
+    int64_t getMaxValue() const { return maxValue; }        ///< 最大值
+    double getMean() const;                                 ///< 平均值（按桶中点估计）
+
+    /**
+     * @brief 生成HdrHistogram V2压缩编码并转为Base64
+     * @return Base64字符串，可直接写入HdrHistogram区间日志
+     */
+    std::string encodeCompressedBase64() const;
+
+private:
+    int countsIndexFor(int64_t value) const;
+    int64_t valueFromIndex(int index) const;
+    int64_t highestEquivalentValue(int64_t value) const;
+
+private:
+    static const int SIGNIFICANT_DIGITS = 3;
+    static const int SUB_BUCKET_COUNT_MAGNITUDE = 11;     ///< ceil(log2(2 * 10^3))
+    static const int SUB_BUCKET_HALF_COUNT_MAGNITUDE = 10;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_COUNT_MAGNITUDE;
+    static const int SUB_BUCKET_HALF_COUNT = SUB_BUCKET_COUNT / 2;
+
+    int64_t highestTrackableValue;  ///< 可记录的最大值
+    std::vector<int64_t> counts;    ///< 计数数组
+    int64_t totalCount;             ///< 样本总数
+    int64_t minValue;               ///< 最小值
+    int64_t maxValue;               ///< 最大值
+};
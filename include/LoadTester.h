@@ -13,41 +13,60 @@
 #include <fstream>
 #include <functional>
 #include <deque>
+#include <condition_variable>
+#include <memory>
+#include "AccessLogReplay.h"
+#include "AutoTuner.h"
+#include "Bandwidth.h"
+#include "BasicLoadTester.h"
+#include "Cancellation.h"
+#include "ConnectionChurn.h"
+#include "DDSketch.h"
+#include "EventStream.h"
+#include "GeneratorHealth.h"
+#include "RateLimiter.h"
+#include "RequestResult.h"
+#include "ResultExporter.h"
+#include "RunSummary.h"
+#include "StatsSnapshot.h"
+#include "StatusNotifier.h"
+#include "SteadyState.h"
+#include "TcpTransport.h"
+#include "ThreadAffinity.h"
+#include "UrlList.h"
+#include "VirtualUserLoop.h"
+#include "WebSocketLoop.h"
 
 /**
- * @enum RequestStatus
- * @brief 请求状态枚举
+ * @enum StatsBackend
+ * @brief 响应时间统计后端
  */
-enum class RequestStatus {
-    SUCCESS,    ///< 请求成功 (2xx状态码)
-    FAILED,     ///< 请求失败 (非2xx状态码)
-    REQ_ERROR   ///< 请求出错 (连接错误等)
+enum class StatsBackend {
+    RAW_SAMPLES,    ///< 保存全部原始样本（图表可用，内存随请求数增长）
+    SKETCH          ///< 按线程分片的DDSketch（内存固定，分位数相对误差有保证）
 };
 
 /**
- * @struct RequestResult
- * @brief 单个请求的结果
+ * @struct WorkerStats
+ * @brief 单个工作线程的放置位置与吞吐量
  */
-struct RequestResult {
-    int id;                             ///< 请求ID
-    RequestStatus status;               ///< 请求状态
-    int statusCode;                     ///< HTTP状态码 (如果可用)
-    std::string url;                    ///< 请求的URL
-    double responseTime;                ///< 响应时间(毫秒)
-    std::string errorMessage;           ///< 错误信息(如果有)
-    std::chrono::system_clock::time_point timestamp; ///< 请求时间戳
-
-    RequestResult(int _id, RequestStatus _status, int _code,
-                 const std::string& _url, double _time,
-                 const std::string& _error = "")
-        : id(_id), status(_status), statusCode(_code), url(_url),
-          responseTime(_time), errorMessage(_error),
-          timestamp(std::chrono::system_clock::now()) {}
+struct WorkerStats {
+    int workerIndex;                ///< 工作线程序号
+    int core;                       ///< 启动时所在的核心(-1表示未知)
+    int numaNode;                   ///< 核心所属的NUMA节点
+    bool pinned;                    ///< 是否成功绑定到核心
+    uint64_t completedRequests;     ///< 该线程完成的请求数
+    double requestsPerSecond;       ///< 该线程的平均吞吐量
+    uint64_t bytesReceived;         ///< 该线程接收的字节
+    double receiveMegabytesPerSecond; ///< 该线程的平均接收速率(MB/s)；吞吐量模式下即该线程连接的速率
 };
 
 /**
  * @class LoadTester
  * @brief 负载测试工具核心类，用于执行HTTP请求测试
+ *
+ * 对界面的类型擦除外观：运行时按配置选择BasicLoadTester的策略组合或虚拟用户事件循环，
+ * 每种组合的请求路径在编译期特化。
  */
 class LoadTester {
 public:
@@ -73,6 +92,10 @@ public:
 
     /**
      * @brief 停止当前运行的测试
+     *
+     * 先停止发起新请求，在排空时限内等待进行中的请求完成；时限到达（或未设置时限）后
+     * 唤醒所有阻塞在传输上的线程并中断剩余请求，几毫秒内返回，不再等待请求超时。
+     * 被中断的请求计入getCancelledRequests()，不计入完成数和延迟统计。
      */
     void stop();
 
@@ -102,19 +125,35 @@ public:
 
     /**
      * @brief 检查测试是否正在运行
+     *
+     * 在stop()发布最终快照、写完导出与摘要之前一直返回true，返回false后读到的都是最终结果。
      * @return 如果测试正在运行返回true，否则返回false
      */
     bool isTestRunning() const;
 
     /**
      * @brief 设置状态更新回调函数
-     * @param callback 回调函数，接收完成请求数、总请求数和成功率作为参数
+     * @param callback 回调函数，接收完成请求数、总请求数和成功率作为参数；
+     *                 由聚合线程按通知间隔调用，不再每个请求调用一次
      */
     void setStatusCallback(std::function<void(int, int, double)> callback);
 
+    /**
+     * @brief 设置合并状态通知回调函数
+     * @param callback 回调函数，接收自上次通知以来的批量增量；由聚合线程按通知间隔调用
+     */
+    void setStatusUpdateCallback(std::function<void(const StatusUpdate&)> callback);
+
+    /**
+     * @brief 设置状态通知的最小间隔
+     * @param intervalMs 通知间隔（毫秒），小于1时按1处理
+     */
+    void setStatusNotifyInterval(int intervalMs);
+
     /**
      * @brief 设置单个请求结果回调函数
-     * @param callback 回调函数，接收RequestResult对象
+     * @param callback 回调函数，接收RequestResult对象；在各工作线程中对每个请求直接调用，
+     *                 可能并发执行，高吞吐场景应改用setStatusUpdateCallback
      */
     void setRequestCallback(std::function<void(const RequestResult&)> callback);
 
@@ -125,6 +164,291 @@ public:
      */
     std::vector<RequestResult> getRecentResults(int count = 10) const;
 
+    /**
+     * @brief 设置统计快照的发布间隔
+     * @param intervalMs 发布间隔（毫秒），小于1时按1处理
+     */
+    void setStatsPublishInterval(int intervalMs);
+
+    /**
+     * @brief 获取最近一次发布的统计快照
+     * @return 统计快照，可在任意线程无锁读取
+     */
+    StatsSnapshot getStatsSnapshot() const;
+
+    /**
+     * @brief 设置响应时间统计后端（测试运行期间设置无效）
+     * @param backend 统计后端
+     */
+    void setStatsBackend(StatsBackend backend);
+
+    /**
+     * @brief 获取当前的响应时间统计后端
+     * @return 统计后端
+     */
+    StatsBackend getStatsBackend() const;
+
+    /**
+     * @brief 获取合并所有线程分片后的响应时间草图（仅SKETCH后端有数据）
+     * @return 响应时间草图（毫秒）
+     */
+    DDSketch getLatencySketch() const;
+
+    /**
+     * @brief 设置结构化结果导出（下一次start()时生效）
+     * @param options 导出配置
+     */
+    void setExportOptions(const ExportOptions& options);
+
+    /**
+     * @brief 设置线程的CPU放置策略（下一次start()时生效）
+     * @param options 放置策略
+     */
+    void setAffinityOptions(const AffinityOptions& options);
+
+    /**
+     * @brief 设置虚拟用户模式（下一次start()时生效）
+     *
+     * 启用后start()的线程数表示事件循环线程数，虚拟用户平均分配到各循环上。
+     * @param options 虚拟用户配置
+     */
+    void setVirtualUserOptions(const VirtualUserOptions& options);
+
+    /**
+     * @brief 设置单个请求的截止时间（下一次start()时生效）
+     * @param timeoutMs 截止时间（毫秒），小于1时按1处理
+     */
+    void setRequestTimeout(int timeoutMs);
+
+    /**
+     * @brief 获取虚拟用户事件循环的定时器精度统计（测试结束后完整）
+     * @return 合并所有事件循环后的统计
+     */
+    TimerStats getTimerStats() const;
+
+    /**
+     * @brief 设置多步骤场景（下一次start()时生效）
+     *
+     * 场景只在虚拟用户模式下执行；未启用虚拟用户时每个线程运行一个虚拟用户。
+     * @param scenario 场景，没有步骤时恢复为对测试URL的单个GET
+     */
+    void setScenario(const Scenario& scenario);
+
+    /**
+     * @brief 获取场景的分步统计与事务统计（测试结束后完整）
+     * @return 合并所有事件循环后的统计
+     */
+    ScenarioStats getScenarioStats() const;
+
+    /**
+     * @brief 设置全局与按端点的限流（下一次start()时生效）
+     * @param options 限流配置，未设置任何速率时不限流
+     */
+    void setRateLimitOptions(const RateLimitOptions& options);
+
+    /**
+     * @brief 获取各令牌桶的放行与限流次数
+     * @return 全局桶在前，其后按规则顺序排列的端点桶
+     */
+    std::vector<RateLimitStats> getRateLimitStats() const;
+
+    /**
+     * @brief 设置自动调优（下一次start()时生效）
+     *
+     * 启用后由控制线程通过全局限流速率施加负载，逐步探测满足SLO的最大吞吐量，
+     * 收敛后不再发起新请求。请求数仍作为总配额上限。
+     * @param options 自动调优配置
+     */
+    void setAutoTuneOptions(const AutoTuneOptions& options);
+
+    /**
+     * @brief 获取自动调优已完成的探测（吞吐量-延迟曲线）
+     * @return 按探测顺序排列的结果
+     */
+    std::vector<ProbeStep> getAutoTuneSteps() const;
+
+    /**
+     * @brief 设置判定负载发生器自身饱和的阈值（下一次start()时生效）
+     * @param thresholds 饱和阈值
+     */
+    void setHealthThresholds(const HealthThresholds& thresholds);
+
+    /**
+     * @brief 获取负载发生器的健康汇总（调度延迟、线程CPU、运行队列等待、非自愿切换）
+     * @return 汇总；untrustworthy()为true时本次结果不可信
+     */
+    HealthReport getGeneratorHealth() const;
+
+    /**
+     * @brief 设置追踪输出文件（下一次start()时生效）
+     *
+     * 只在以LOADTESTER_TRACING编译时有效：测试期间记录各线程的热路径区间，
+     * 停止时写出Chrome trace / Perfetto JSON。
+     * @param filePath 输出文件路径，为空表示不追踪
+     */
+    void setTraceFile(const std::string& filePath);
+
+    /**
+     * @brief 设置原始TCP模式的分帧、请求模板与流水线深度（下一次start()时生效）
+     *
+     * 测试URL为tcp://主机:端口或tcps://主机:端口时，每个工作线程保持一个持久连接，
+     * 按模板发出请求并按分帧匹配响应；结果进入与HTTP相同的统计、历史与导出流程。
+     * @param options 原始TCP配置
+     */
+    void setTcpOptions(const TcpOptions& options);
+
+    /**
+     * @brief 设置响应压缩协商（下一次start()时生效）
+     *
+     * 请求带上配置的Accept-Encoding，响应由本程序解码，线路字节、解码后字节与解码耗时
+     * 按编码分别统计；场景模式交给curl解码，只协商不统计。
+     * @param options Accept-Encoding配置，空表示不协商
+     */
+    void setCompressionOptions(const CompressionOptions& options);
+
+    /**
+     * @brief 获取按编码分类的响应字节与解码耗时
+     * @return 合并所有工作线程后的统计
+     */
+    CompressionStats getCompressionStats() const;
+
+    /**
+     * @brief 设置WebSocket模式的连接数、发送间隔与消息模板（下一次start()时生效）
+     *
+     * 测试URL为ws://时，连接按序号平均分配到各工作线程的事件循环并保持打开，
+     * 每条消息的往返耗时作为一次请求计入统计，回复超时与连接断开计为失败。
+     * @param options WebSocket配置
+     */
+    void setWebSocketOptions(const WebSocketOptions& options);
+
+    /**
+     * @brief 获取WebSocket连接的建立、失败、断开与消息计数
+     * @return 合并已结束事件循环后的统计
+     */
+    WebSocketStats getWebSocketStats() const;
+
+    /**
+     * @brief 设置SSE/长轮询流式模式（下一次start()时生效）
+     *
+     * 启用后HTTP测试URL被当作流式端点：流按序号平均分配到各工作线程的事件循环并保持打开，
+     * 每个流计为一次请求，响应时间为到第一个事件的时间；流结束后按重连间隔重新发起。
+     * 请求超时只用于建连和停滞判定，不限制流的总时长。
+     * @param options 流式模式配置
+     */
+    void setStreamingOptions(const StreamingOptions& options);
+
+    /**
+     * @brief 获取流与事件的计数、首事件时间、事件间隔与端到端延迟
+     * @return 合并已结束事件循环后的统计
+     */
+    StreamStats getStreamStats() const;
+
+    /**
+     * @brief 设置同步请求的连接复用策略（下一次start()时生效）
+     *
+     * 虚拟用户模式下连接由事件循环的连接池管理，不受此策略影响，但仍统计建连与握手耗时。
+     * @param options 每连接请求数、连接寿命与重连风暴间隔
+     */
+    void setConnectionOptions(const ConnectionOptions& options);
+
+    /**
+     * @brief 获取建连次数、握手耗时与重连延迟
+     * @return 合并所有工作线程后的统计
+     */
+    ConnectionStats getConnectionStats() const;
+
+    /**
+     * @brief 设置预热/冷却测量窗口与稳态检测（下一次start()时生效）
+     *
+     * 窗口外完成的请求照常计入完成数、日志和导出，但最终的延迟分位数、吞吐量和成功率
+     * 只统计窗口内的请求。自动检测时稳态之前的部分视为预热。
+     * @param options 测量窗口配置
+     */
+    void setMeasurementWindowOptions(const MeasurementWindowOptions& options);
+
+    /**
+     * @brief 获取本次测试采用的测量窗口（测试结束后有效）
+     * @return 以秒为单位的窗口，未启用时覆盖整个测试
+     */
+    MeasurementWindow getMeasurementWindow() const;
+
+    /**
+     * @brief 设置停止时的排空时限（下一次stop()时生效）
+     * @param timeoutMs 等待进行中请求完成的最长时间(毫秒)，0表示立即中断
+     */
+    void setDrainTimeout(int timeoutMs);
+
+    /**
+     * @brief 获取停止时被中断的进行中请求数
+     */
+    int getCancelledRequests() const;
+
+    /**
+     * @brief 获取每个工作线程的放置位置与吞吐量
+     * @return 按工作线程序号排列的统计
+     */
+    std::vector<WorkerStats> getWorkerStats() const;
+
+    /**
+     * @brief 获取每秒完成请求数序列
+     * @return 从测试开始起每个完整秒内完成的请求数
+     */
+    std::vector<uint32_t> getThroughputSeries() const;
+
+    /**
+     * @brief 获取每秒收发字节序列
+     * @return 从测试开始起每个完整秒内完成的请求的发送与接收字节
+     */
+    std::vector<BandwidthSecond> getBandwidthSeries() const;
+
+    /**
+     * @brief 设置下载吞吐量模式（下一次start()时生效）
+     *
+     * 只作用于同步HTTP请求：请求之间不插入间隔，加大接收缓冲区，
+     * 并统计首字节时间、末字节时间与单个请求的下载速率分布。
+     * @param options 吞吐量模式配置
+     */
+    void setThroughputOptions(const ThroughputOptions& options);
+
+    /**
+     * @brief 获取吞吐量模式下的首/末字节时间与下载速率分布
+     * @return 合并所有工作线程后的统计
+     */
+    BandwidthStats getBandwidthStats() const;
+
+    /**
+     * @brief 设置URL列表（下一次start()时生效）
+     *
+     * 只作用于HTTP单请求模式（同步请求与不带场景的虚拟用户）：start()时映射文件并建立行索引，
+     * 每个请求按选择方式从列表中取一个URL，测试URL只用于日志和限流规则的匹配。
+     * 结果中的URL为实际请求的行，导出时从映射中读取，不逐行驻留。
+     * @param options URL列表配置，未设置文件时只请求测试URL
+     */
+    void setUrlListOptions(const UrlListOptions& options);
+
+    /**
+     * @brief 设置访问日志回放（下一次start()时生效）
+     *
+     * 只作用于HTTP测试URL：start()时映射日志，由解析线程边读边把请求按原始时间间隔（除以倍率）
+     * 排好，轮流分给各工作线程的事件循环按时发出；倍率不大于0时不按时间、尽快发出。
+     * 请求URL为测试URL去掉末尾的/后接日志中的路径，结果统一记在测试URL下。
+     * 启用后流式、虚拟用户、场景与URL列表本次不生效，日志回放完后工作线程结束。
+     * @param options 回放配置，未设置文件时不回放
+     */
+    void setReplayOptions(const ReplayOptions& options);
+
+    /**
+     * @brief 获取回放的解析与发出计数
+     * @return 解析线程的计数加上已结束事件循环的发出数与回放时长
+     */
+    ReplayStats getReplayStats() const;
+
+    /**
+     * @brief 生成本次运行的摘要，用于持久化和运行间对比
+     * @return 运行摘要
+     */
+    RunSummary buildRunSummary() const;
+
     /**
      * @brief 获取最小响应时间
      * @return 最小响应时间（毫秒）
@@ -157,11 +481,6 @@ public:
     static std::string readLogFile(const std::string& logFilePath);
 
 private:
-    /**
-     * @brief 写入回调函数，用于接收HTTP响应
-     */
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
-
     /**
      * @brief 记录日志
      * @param message 日志消息
@@ -169,38 +488,186 @@ private:
     void log(const std::string& message);
 
     /**
-     * @brief 发送单个HTTP请求
+     * @brief 在当前工作线程以同步请求运行，直到配额用完或停止
+     *
+     * 按传输与节奏策略实例化BasicLoadTester，结果交给completeRequest。
+     * @tparam Transport 传输策略
+     * @tparam Pacer 节奏策略
+     * @param workerIndex 工作线程序号
+     * @param transport 传输策略对象
+     * @param pacer 节奏策略对象
+     */
+    template <class Transport, class Pacer>
+    void runSynchronous(int workerIndex, Transport transport, Pacer pacer);
+
+    /**
+     * @brief 统计一个已结束的请求并生成结果（同步请求和虚拟用户共用）
+     * @param workerIndex 工作线程序号
+     * @param requestId 请求ID
+     * @param endpoint URL驻留编号
+     * @param transfer 传输结果、状态码与响应时间
      * @return 请求结果
      */
-    RequestResult makeRequest();
+    RequestResult completeRequest(int workerIndex, int requestId, uint32_t endpoint, const TransferResult& transfer);
+
+    /**
+     * @brief 在当前工作线程运行一个事件循环，直到配额用完、排空或停止
+     *
+     * 各事件循环共用的接线：登记取消源与排空标志、按间隔采样资源使用、
+     * 以请求ID作为配额计数分配请求，结束后累计被放弃的请求数。
+     * @tparam Loop 事件循环类型，派生自EventLoopBase
+     * @tparam Complete 完成回调类型，参数与Loop::CompletionHandler一致
+     * @param workerIndex 工作线程序号
+     * @param loop 已配置好的事件循环
+     * @param complete 完成回调
+     */
+    template <class Loop, class Complete>
+    void runEventLoop(int workerIndex, Loop& loop, Complete complete);
+
+    /**
+     * @brief 在当前工作线程运行本线程负责的虚拟用户
+     * @param workerIndex 工作线程序号
+     */
+    void runVirtualUsers(int workerIndex);
+
+    /**
+     * @brief 在当前工作线程运行本线程负责的WebSocket连接
+     * @param workerIndex 工作线程序号
+     */
+    void runWebSockets(int workerIndex);
+
+    /**
+     * @brief 在当前工作线程运行本线程负责的流式请求
+     * @param workerIndex 工作线程序号
+     */
+    void runStreams(int workerIndex);
+
+    /**
+     * @brief 在当前工作线程按计划时刻发出分给本线程的回放请求
+     * @param workerIndex 工作线程序号
+     */
+    void runReplay(int workerIndex);
 
     /**
      * @brief 添加请求结果到历史记录
+     * @param workerIndex 产生结果的工作线程序号
      * @param result 请求结果
      */
-    void addResult(const RequestResult& result);
+    void addResult(int workerIndex, const RequestResult& result);
 
     /**
      * @brief 工作线程函数
+     * @param workerIndex 工作线程序号
      */
-    void workerThread();
+    void workerThread(int workerIndex);
 
     /**
-     * @brief 计算响应时间统计信息
+     * @brief 记录单个请求的响应时间到运行中统计
+     * @param workerIndex 工作线程序号
+     * @param elapsedNs 响应时间（纳秒）
      */
-    void calculateStatistics();
+    void recordResponseTime(int workerIndex, int64_t elapsedNs);
+
+    /**
+     * @brief 聚合线程函数，按发布间隔发布统计快照
+     */
+    void aggregatorThread();
+
+    /**
+     * @brief 自动调优控制线程函数：设置速率、测量窗口、决定下一次探测
+     */
+    void autoTuneThread();
+
+    /**
+     * @brief 取出并清空所有分片自上次调用以来的探测窗口数据
+     * @return 窗口内的请求数、错误率与延迟分位数（实际速率由调用者填写）
+     */
+    ProbeStep takeProbeWindow();
+
+    /**
+     * @brief 按配置映射URL列表并登记到驻留表（start()时调用，未启用或模式不适用时清空）
+     * @return 映射或建立索引失败时返回false
+     */
+    bool loadUrlList();
+
+    /**
+     * @brief 按配置映射访问日志并准备解析线程（start()时调用）
+     * @return 映射失败时返回false
+     */
+    bool loadReplayLog();
+
+    /**
+     * @brief 记录一次请求的调度延迟（实际发起时间晚于计划时间的部分）
+     * @param workerIndex 工作线程序号
+     * @param lagNs 调度延迟(纳秒)
+     */
+    void recordDispatchLag(int workerIndex, int64_t lagNs);
+
+    /**
+     * @brief 在工作线程上读取本线程的资源使用并写入分片
+     * @param workerIndex 工作线程序号
+     */
+    void sampleWorkerUsage(int workerIndex);
+
+    /**
+     * @brief 汇总上一个窗口的调度延迟与资源使用增量并评估发生器是否饱和（聚合线程调用）
+     */
+    void evaluateGeneratorHealth();
+
+    /**
+     * @brief 采样当前统计并发布快照
+     * @param finalSnapshot 是否为测试结束时的最终快照
+     */
+    void publishSnapshot(bool finalSnapshot = false);
+
+    /**
+     * @brief 将已经过去的完整秒的完成数追加到吞吐序列
+     */
+    void sampleThroughput();
+
+    /**
+     * @brief 汇总所有分片至今的收发字节
+     */
+    BandwidthSecond totalBandwidth() const;
+
+    /**
+     * @brief 取出各分片上一秒的窗口数据追加为一个秒桶，自动检测时送入稳态检测（调用者持有seriesMutex）
+     * @return 本次调用检测到稳态时返回true
+     */
+    bool closeSecondBucket();
+
+    /**
+     * @brief 追加最后一个不满一秒的秒桶并确定测量窗口（停止时调用）
+     */
+    void finishMeasurementWindow();
+
+    /**
+     * @brief 合并测量窗口内的秒桶
+     * @return 窗口内的请求数、成功数与延迟
+     */
+    SecondBucket mergeMeasuredBuckets() const;
+
+    /**
+     * @brief 将合并后的状态通知分发给已设置的回调
+     * @param update 合并后的状态通知
+     */
+    void dispatchStatusUpdate(const StatusUpdate& update);
 
 private:
     // 初始化顺序应与构造函数中的初始化顺序相匹配
-    bool isRunning;                            ///< 测试是否正在运行
+    std::atomic<bool> isRunning;               ///< 工作线程与聚合线程是否继续运行（stop()中最先清除）
+    std::atomic<bool> testActive;              ///< 测试是否在进行，stop()发布最终快照并收尾后才清除
     std::atomic<int> completedRequests;        ///< 已完成的请求数
     std::atomic<int> successfulRequests;       ///< 成功的请求数
     std::atomic<int> requestIdCounter;         ///< 请求ID计数器
-    double minResponseTime;                    ///< 最小响应时间
-    double maxResponseTime;                    ///< 最大响应时间
-    double avgResponseTime;                    ///< 平均响应时间
+    std::atomic<int64_t> minResponseTimeNs;    ///< 最小响应时间(纳秒)
+    std::atomic<int64_t> maxResponseTimeNs;    ///< 最大响应时间(纳秒)
+    std::atomic<int64_t> totalResponseTimeNs;  ///< 响应时间总和(纳秒)
+    std::atomic<int64_t> timedRequests;        ///< 已计入响应时间的请求数
+    std::atomic<int> statsPublishIntervalMs;   ///< 快照发布间隔(毫秒)
 
     std::string url;                           ///< 测试URL
+    uint32_t urlEndpoint;                      ///< 测试URL的驻留编号
     int numThreads;                            ///< 线程数
     int totalRequests;                         ///< 总请求数
     std::vector<std::thread> threads;          ///< 工作线程
@@ -209,13 +676,113 @@ private:
     std::chrono::time_point<std::chrono::system_clock> startTime;  ///< 测试开始时间
     std::chrono::time_point<std::chrono::system_clock> endTime;    ///< 测试结束时间
 
+    SeqLock<StatsSnapshot> statsSnapshot;      ///< 已发布的统计快照
+    uint64_t snapshotVersion;                  ///< 下一次发布的版本号(仅发布方访问)
+    std::thread aggregator;                    ///< 聚合线程
+    std::mutex aggregatorMutex;                ///< 聚合线程唤醒互斥锁
+    std::condition_variable aggregatorWakeup;  ///< 停止时唤醒聚合线程
+
+    ExportOptions exportOptions;               ///< 结果导出配置
+    ResultExporter exporter;                   ///< 后台结果导出器
+
+    std::vector<uint32_t> completedPerSecond;  ///< 每秒完成请求数序列
+    int lastSampledCompleted;                  ///< 上次采样时的完成数(仅聚合线程访问)
+    std::vector<BandwidthSecond> bandwidthPerSecond; ///< 每秒收发字节序列（受seriesMutex保护）
+    BandwidthSecond lastSampledBandwidth;      ///< 上次采样时的累计收发字节(仅聚合线程访问)
+    MeasurementWindowOptions measurementOptions; ///< 测量窗口配置
+    std::vector<SecondBucket> secondBuckets;   ///< 每秒的完成数与延迟（仅启用测量窗口时，受seriesMutex保护）
+    SteadyStateDetector steadyDetector;        ///< 稳态检测（受seriesMutex保护）
+    MeasurementWindow measurementWindow;       ///< 停止时确定的测量窗口（受seriesMutex保护）
+    mutable std::mutex seriesMutex;            ///< 吞吐序列互斥锁
+
     std::vector<double> responseTimes;         ///< 响应时间数组
     mutable std::mutex responseTimesMutex;     ///< 响应时间互斥锁 (mutable以允许const方法使用)
 
-    std::deque<RequestResult> requestHistory;  ///< 请求历史记录
-    mutable std::mutex historyMutex;           ///< 历史记录互斥锁 (mutable以允许const方法使用)
-    static const size_t MAX_HISTORY_SIZE = 100; ///< 最大历史记录数量
-
+    /**
+     * @brief 单个工作线程的统计分片
+     *
+     * 由工作线程在绑定核心之后自行分配，按首次访问策略落在本地NUMA节点上；
+     * 按缓存行对齐，避免相邻线程的计数器伪共享。锁只在聚合时才会有竞争。
+     */
+    struct alignas(64) WorkerShard {
+        std::mutex mutex;                      ///< 分片互斥锁
+        DDSketch sketch;                       ///< 分片草图（毫秒）
+        std::atomic<uint64_t> completed{0};    ///< 该线程完成的请求数
+        DDSketch probeSketch;                  ///< 当前探测窗口的延迟（毫秒，仅自动调优）
+        uint64_t probeCompleted = 0;           ///< 当前探测窗口完成的请求数
+        uint64_t probeFailed = 0;              ///< 当前探测窗口未成功的请求数
+        DDSketch secondSketch;                 ///< 当前秒的延迟（毫秒，仅启用测量窗口时）
+        uint64_t secondCompleted = 0;          ///< 当前秒完成的请求数
+        uint64_t secondSuccessful = 0;         ///< 当前秒成功的请求数
+        DDSketch lagSketch;                    ///< 当前健康窗口的调度延迟（毫秒）
+        RecentResultRing history{MAX_HISTORY_SIZE}; ///< 该线程最近的请求结果（读取不加锁）
+        ConnectionStats connections;           ///< 建连次数与握手耗时
+        CompressionStats compression;          ///< 按编码分类的响应字节与解码耗时
+        BandwidthStats bandwidth;              ///< 首/末字节时间与下载速率（仅吞吐量模式）
+        std::atomic<uint64_t> bytesSent{0};    ///< 该线程完成的请求的发送字节
+        std::atomic<uint64_t> bytesReceived{0}; ///< 该线程完成的请求的接收字节
+        std::atomic<int64_t> cpuNs{0};         ///< 线程累计CPU时间（由工作线程写入）
+        std::atomic<int64_t> runQueueNs{0};    ///< 线程累计运行队列等待时间
+        std::atomic<int64_t> involuntarySwitches{0}; ///< 线程累计非自愿上下文切换
+        ThreadUsage lastUsage;                 ///< 上一个健康窗口结束时的资源使用(仅聚合线程访问)
+        int core = -1;                         ///< 启动时所在的核心
+        int numaNode = 0;                      ///< 核心所属的NUMA节点
+        bool pinned = false;                   ///< 是否成功绑定
+    };
+    StatsBackend statsBackend;                 ///< 响应时间统计后端
+    AffinityOptions affinityOptions;           ///< 线程放置策略
+    VirtualUserOptions virtualUserOptions;     ///< 虚拟用户配置
+    int requestTimeoutMs;                      ///< 单个请求的截止时间(毫秒)
+    Scenario scenario;                         ///< 多步骤场景
+    TimerStats timerStats;                     ///< 已结束事件循环的定时器统计
+    ScenarioStats scenarioStats;               ///< 已结束事件循环的场景统计
+    RateLimitOptions rateLimitOptions;         ///< 限流配置
+    RateLimiter rateLimiter;                   ///< 所有工作线程共享的无锁限流器
+    AutoTuneOptions autoTuneOptions;           ///< 自动调优配置
+    std::thread autoTuner;                     ///< 自动调优控制线程
+    std::atomic<bool> autoTuneFinished;        ///< 自动调优已结束，不再发起新请求
+    std::vector<ProbeStep> autoTuneSteps;      ///< 已完成的探测（受loopStatsMutex保护）
+    std::string autoTuneReport;                ///< 自动调优报告（受loopStatsMutex保护）
+    std::string traceFile;                     ///< 追踪输出文件
+    ConnectionOptions connectionOptions;       ///< 同步请求的连接复用策略
+    TcpOptions tcpOptions;                     ///< 原始TCP模式配置
+    CompressionOptions compressionOptions;     ///< 响应压缩协商配置
+    bool decodeResponses;                      ///< 本次测试是否自行解码响应并统计（start()时确定）
+    ThroughputOptions throughputOptions;       ///< 下载吞吐量模式配置
+    UrlListOptions urlListOptions;             ///< URL列表配置
+    UrlListOptions activeUrlList;              ///< 本次测试使用的URL列表配置（随机种子已确定）
+    std::shared_ptr<UrlList> urlList;          ///< 本次测试映射的URL列表，未启用时为空
+    std::atomic<uint64_t> urlCursor;           ///< 顺序与打乱模式下所有线程共用的游标
+    ReplayOptions replayOptions;               ///< 访问日志回放配置
+    std::unique_ptr<ReplayFeed> replayFeed;    ///< 本次测试的回放解析线程，未回放时为空
+    ReplayStats replayStats;                   ///< 已结束事件循环的发出数与回放时长（受loopStatsMutex保护）
+    WebSocketOptions webSocketOptions;         ///< WebSocket模式配置
+    WebSocketStats webSocketStats;             ///< 已结束事件循环的WebSocket统计（受loopStatsMutex保护）
+    StreamingOptions streamingOptions;         ///< 流式模式配置
+    StreamStats streamStats;                   ///< 已结束事件循环的流式统计（受loopStatsMutex保护）
+    std::atomic<uint32_t> reconnectStorms;     ///< 已触发的重连风暴次数（由聚合线程递增）
+    CancellationSource cancellation;           ///< 停止时中断进行中的传输
+    std::atomic<bool> draining;                ///< 停止中：不再发起新请求
+    std::atomic<int> cancelledRequests;        ///< 停止时被中断的请求数
+    std::atomic<int> drainTimeoutMs;           ///< 停止时的排空时限(毫秒)
+    HealthThresholds healthThresholds;         ///< 发生器饱和阈值
+    GeneratorHealth generatorHealth;           ///< 发生器健康汇总
+    mutable std::mutex healthMutex;            ///< 发生器健康汇总互斥锁
+    std::chrono::steady_clock::time_point lastHealthCheck; ///< 上一个健康窗口的结束时刻
+    static const int HEALTH_WINDOW_MS = 1000;  ///< 健康检测窗口长度
+    static const int USAGE_SAMPLE_INTERVAL_MS = 100; ///< 工作线程写入资源使用的间隔
+    mutable std::mutex loopStatsMutex;         ///< 事件循环统计互斥锁
+    std::vector<std::unique_ptr<WorkerShard>> workerShards; ///< 每个工作线程一个分片
+    std::mutex shardsMutex;                    ///< 分片就绪计数互斥锁
+    std::condition_variable shardsReady;       ///< 所有分片就绪通知
+    int readyWorkers;                          ///< 已分配分片的工作线程数
+    std::condition_variable workersExited;     ///< 工作线程退出通知（受shardsMutex保护）
+    int exitedWorkers;                         ///< 已退出请求循环的工作线程数
+
+    static const size_t MAX_HISTORY_SIZE = 100; ///< 每个工作线程保留的历史记录数量
+
+    StatusNotifier statusNotifier;             ///< 合并式状态通知器
     std::function<void(int, int, double)> statusCallback;  ///< 状态更新回调函数
+    std::function<void(const StatusUpdate&)> statusUpdateCallback; ///< 合并状态通知回调函数
     std::function<void(const RequestResult&)> requestCallback; ///< 请求结果回调函数
 };
\ No newline at end of file
@@ -0,0 +1,118 @@
+/**
+ * @file MappedFile.h
+ * @brief 只读内存映射文件与按16字节一组查找字节的辅助函数
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOADTESTER_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @enum MappedAccess
+ * @brief 映射后的访问模式提示
+ */
+enum class MappedAccess {
+    WHOLE,          ///< 整个文件都会用到，提前读入
+    SEQUENTIAL      ///< 从头到尾读一遍，读过的页可以尽早回收
+};
+
+/**
+ * @class MappedFile
+ * @brief 只读映射整个文件，映射在对象销毁或close()前一直有效
+ *
+ * 文件内容不复制到堆上，由操作系统按页读入和回收，大于内存的文件也可以顺序处理。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief 映射文件
+     * @param filePath 文件路径
+     * @param access 访问模式提示
+     * @param error 失败时写入原因
+     * @return 成功且文件非空时返回true
+     */
+    bool open(const std::string& filePath, MappedAccess access, std::string& error);
+
+    /**
+     * @brief 解除映射
+     */
+    void close();
+
+    /**
+     * @brief 把[offset, offset+bytes)内的整页移出本进程的内存占用，映射仍有效，再次访问时从文件重新读入
+     */
+    void release(size_t offset, size_t bytes);
+
+    /**
+     * @brief 映射的文件内容
+     */
+    const char* data() const { return view; }
+
+    /**
+     * @brief 文件大小(字节)
+     */
+    size_t size() const { return length; }
+
+private:
+    const char* view = nullptr;     ///< 映射的文件内容
+    size_t length = 0;              ///< 文件大小
+};
+
+/**
+ * @brief 最低的置位位置（mask不为0）
+ */
+inline unsigned lowestSetBit(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+/**
+ * @brief 16个字节中等于c的位置掩码，第i位对应p[i]
+ */
+inline uint32_t matchBytes16(const char* p, char c) {
+#ifdef LOADTESTER_SSE2
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < 16; ++i) mask |= static_cast<uint32_t>(p[i] == c) << i;
+    return mask;
+#endif
+}
+
+/**
+ * @brief 在[begin, end)中查找第一个c
+ * @return 找到的位置，没有时为end
+ */
+inline const char* findByte(const char* begin, const char* end, char c) {
+    const char* p = begin;
+    while (end - p >= 16) {
+        uint32_t mask = matchBytes16(p, c);
+        if (mask != 0) return p + lowestSetBit(mask);
+        p += 16;
+    }
+    const void* found = std::memchr(p, c, static_cast<size_t>(end - p));
+    return found ? static_cast<const char*>(found) : end;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file RateLimiter.h
+ * @brief 无锁的全局与按端点令牌桶限流器的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @struct RateLimit
+ * @brief 单个端点的限流规则：URL中包含pattern的请求共享该速率
+ */
+struct RateLimit {
+    std::string pattern;            ///< URL子串，例如"/search"
+    double requestsPerSecond = 0;   ///< 速率上限(请求/秒)
+};
+
+/**
+ * @struct RateLimitOptions
+ * @brief 限流配置
+ */
+struct RateLimitOptions {
+    double globalRequestsPerSecond = 0;     ///< 全局速率上限，0表示不限
+    std::vector<RateLimit> endpointLimits;  ///< 按端点的速率上限
+    int burstMs = 10;                       ///< 允许的突发量（按该时长内的令牌数计）
+
+    /**
+     * @brief 是否启用了任何限流
+     */
+    bool enabled() const { return globalRequestsPerSecond > 0 || !endpointLimits.empty(); }
+
+    /**
+     * @brief 解析"模式=速率"的逗号分隔列表，例如"/search=2000,/checkout=500"
+     * @param text 规则列表
+     * @return 解析出的规则，忽略无法解析的片段
+     */
+    static std::vector<RateLimit> parseEndpointLimits(const std::string& text);
+};
+
+/**
+ * @struct RateLimitStats
+ * @brief 单个令牌桶的放行与限流统计
+ */
+struct RateLimitStats {
+    std::string name;               ///< 桶名称（全局或端点模式）
+    double requestsPerSecond;       ///< 速率上限
+    uint64_t admitted;              ///< 放行的请求数
+    uint64_t throttled;             ///< 被推迟的次数
+    double throttledWaitMs;         ///< 被推迟的总等待时间(毫秒)
+};
+
+/**
+ * @class TokenBucket
+ * @brief 基于GCRA（通用信元速率算法）的无锁令牌桶
+ *
+ * 整个桶的状态只是一个原子的“理论到达时间”，每次获取令牌是一次CAS，
+ * 多线程在10万级每秒的速率下也不需要互斥锁，且没有后台补充令牌的线程。
+ */
+class alignas(64) TokenBucket {
+public:
+    /**
+     * @brief 构造函数
+     * @param requestsPerSecond 速率上限
+     * @param burstNs 允许的突发量（按该时长内的令牌数计，纳秒）
+     */
+    TokenBucket(double requestsPerSecond, int64_t burstNs);
+
+    /**
+     * @brief 运行中修改速率，已发放的令牌不受影响
+     * @param requestsPerSecond 新的速率上限
+     */
+    void setRate(double requestsPerSecond);
+
+    /**
+     * @brief 尝试获取一个令牌
+     * @param nowNs 当前时间(steady_clock纳秒)
+     * @return 0表示已放行，否则为需要等待的纳秒数
+     */
+    int64_t tryAcquire(int64_t nowNs);
+
+    /**
+     * @brief 归还刚获取的令牌（上层限流拒绝时使用）
+     */
+    void refund();
+
+    /**
+     * @brief 记录一次推迟
+     * @param waitNs 推迟的纳秒数
+     */
+    void recordThrottle(int64_t waitNs);
+
+    /**
+     * @brief 获取统计
+     * @param name 桶名称
+     */
+    RateLimitStats getStats(const std::string& name) const;
+
+private:
+    std::atomic<int64_t> theoreticalArrival;    ///< 下一个令牌的理论到达时间(纳秒)
+    std::atomic<int64_t> emissionIntervalNs;    ///< 每个令牌的间隔(纳秒)
+    std::atomic<int64_t> burstToleranceNs;      ///< 突发容差(纳秒)
+    int64_t burstWindowNs;                      ///< 突发量对应的时长(纳秒)
+    std::atomic<uint64_t> admitted;             ///< 放行数
+    std::atomic<uint64_t> throttled;            ///< 推迟次数
+    std::atomic<int64_t> throttledWaitNs;       ///< 推迟总时长
+};
+
+/**
+ * @class RateLimiter
+ * @brief 全局桶与端点桶组成的两级限流器
+ *
+ * 请求需要同时从所属端点的桶和全局桶各取得一个令牌；端点桶放行而全局桶拒绝时
+ * 归还端点令牌。端点到桶的映射在测试开始前绑定，运行期间只读，查询无锁。
+ */
+class RateLimiter {
+public:
+    RateLimiter() = default;
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * @brief 按配置重建所有令牌桶并清空端点绑定（测试开始前调用）
+     * @param options 限流配置
+     */
+    void configure(const RateLimitOptions& options);
+
+    /**
+     * @brief 把端点绑定到第一个匹配其URL的规则（测试开始前调用）
+     * @param endpoint URL驻留编号
+     * @param url 端点URL
+     */
+    void bindEndpoint(uint32_t endpoint, const std::string& url);
+
+    /**
+     * @brief 是否启用了任何限流
+     */
+    bool enabled() const { return globalBucket != nullptr || !endpointBuckets.empty(); }
+
+    /**
+     * @brief 为一个请求获取令牌
+     * @param endpoint URL驻留编号
+     * @param now 当前时间
+     * @return 0表示已放行，否则为至少需要等待的纳秒数
+     */
+    int64_t acquire(uint32_t endpoint, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief 运行中修改全局速率（自动调优使用），未配置全局桶时无效
+     * @param requestsPerSecond 新的全局速率上限
+     */
+    void setGlobalRate(double requestsPerSecond);
+
+    /**
+     * @brief 获取各令牌桶的统计（全局桶在前）
+     */
+    std::vector<RateLimitStats> getStats() const;
+
+private:
+    std::unique_ptr<TokenBucket> globalBucket;                  ///< 全局桶
+    std::vector<std::unique_ptr<TokenBucket>> endpointBuckets;  ///< 按规则顺序的端点桶
+    std::vector<std::string> bucketNames;                       ///< 端点桶名称
+    std::vector<int> bucketOfEndpoint;                          ///< 端点编号到端点桶下标(-1表示不限)
+    RateLimitOptions options;                                   ///< 当前配置
+};
@@ -0,0 +1,138 @@
+/**
+ * @file RequestResult.h
+ * @brief 请求状态、请求结果与URL驻留表的定义
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @enum RequestStatus
+ * @brief 请求状态枚举
+ */
+enum class RequestStatus : uint8_t {
+    SUCCESS,    ///< 请求成功 (2xx状态码)
+    FAILED,     ///< 请求失败 (非2xx状态码)
+    REQ_ERROR   ///< 请求出错 (连接错误等)
+};
+
+class UrlList;
+
+/**
+ * @class EndpointTable
+ * @brief 进程内的URL驻留表：每个不同的URL只保存一次，结果中只记录编号
+ *
+ * 驻留只在测试准备阶段发生（测试URL、场景步骤），查询只在显示和导出时发生，
+ * 请求路径上不访问此表。URL列表中的行不驻留：编号最高位为1时低31位即行号，
+ * 查询时直接读取登记的列表。
+ */
+class EndpointTable {
+public:
+    static constexpr uint32_t LIST_ENDPOINT_BASE = 0x80000000u;    ///< URL列表行的编号起点
+
+    /**
+     * @brief URL列表第line行的编号
+     */
+    static uint32_t listEndpoint(size_t line) { return LIST_ENDPOINT_BASE | static_cast<uint32_t>(line); }
+
+    /**
+     * @brief 编号是否指向URL列表中的行
+     */
+    static bool isListEndpoint(uint32_t index) { return index >= LIST_ENDPOINT_BASE; }
+
+    /**
+     * @brief 获取单例实例
+     */
+    static EndpointTable& getInstance();
+
+    EndpointTable(const EndpointTable&) = delete;
+    EndpointTable& operator=(const EndpointTable&) = delete;
+
+    /**
+     * @brief 驻留一个URL
+     * @param url URL
+     * @return URL的编号，相同URL总是返回相同编号
+     */
+    uint32_t intern(std::string_view url);
+
+    /**
+     * @brief 查询编号对应的URL
+     * @param index URL编号
+     * @return URL，编号无效时返回空字符串
+     */
+    std::string lookup(uint32_t index) const;
+
+    /**
+     * @brief 登记URL列表，替换之前登记的列表
+     * @param list URL列表，nullptr表示不再登记
+     */
+    void attachList(std::shared_ptr<const UrlList> list);
+
+private:
+    EndpointTable() = default;
+
+    std::vector<std::string> urls;                      ///< 按编号排列的URL
+    std::unordered_map<std::string, uint32_t> indices;  ///< URL到编号的映射
+    std::shared_ptr<const UrlList> urlList;             ///< 登记的URL列表
+    mutable std::shared_mutex mutex;                    ///< 读写锁
+};
+
+/**
+ * @struct RequestResult
+ * @brief 单个请求的结果（48字节定长记录，可按字节复制）
+ *
+ * URL只保存驻留表编号，错误只保存CURLcode，时间戳为单调时钟纳秒；
+ * 转换为字符串和墙上时间只在显示或导出时进行。
+ */
+struct RequestResult {
+    int64_t timestampNs;                ///< 请求完成时刻(steady_clock纳秒)
+    int64_t responseTimeNs;             ///< 响应时间(纳秒)
+    uint64_t bytesReceived;             ///< 接收字节（响应头与线路上的响应体）
+    int32_t id;                         ///< 请求ID
+    uint32_t endpoint;                  ///< URL在EndpointTable中的编号
+    uint32_t bytesSent;                 ///< 发送字节（请求头与请求体），超出32位时饱和
+    int16_t statusCode;                 ///< HTTP状态码 (如果可用)
+    uint16_t errorCode;                 ///< CURLcode，0表示没有错误
+    RequestStatus status;               ///< 请求状态
+
+    RequestResult() = default;
+
+    RequestResult(int _id, RequestStatus _status, int _code, uint32_t _endpoint,
+                  int64_t _responseTimeNs, int _errorCode = 0)
+        : timestampNs(std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now().time_since_epoch()).count()),
+          responseTimeNs(_responseTimeNs), bytesReceived(0), id(_id), endpoint(_endpoint), bytesSent(0),
+          statusCode(static_cast<int16_t>(_code)), errorCode(static_cast<uint16_t>(_errorCode)),
+          status(_status) {}
+
+    /**
+     * @brief 响应时间(毫秒)
+     */
+    double responseTimeMs() const { return responseTimeNs / 1e6; }
+
+    /**
+     * @brief 请求的URL（查询驻留表）
+     */
+    std::string url() const { return EndpointTable::getInstance().lookup(endpoint); }
+
+    /**
+     * @brief 错误信息，没有错误时返回空字符串
+     */
+    const char* errorMessage() const;
+
+    /**
+     * @brief 请求完成时刻的墙上时间
+     */
+    std::chrono::system_clock::time_point wallClock() const;
+};
+
+static_assert(sizeof(RequestResult) == 48, "RequestResult应保持48字节");
+static_assert(std::is_trivially_copyable<RequestResult>::value, "RequestResult应可按字节复制");
@@ -0,0 +1,177 @@
+/**
+ * @file ResultExporter.h
+ * @brief 结构化结果导出器的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "RequestResult.h"
+#include "SpscRing.h"
+
+/**
+ * @struct ExportOptions
+ * @brief 导出配置，路径为空表示不导出该格式
+ */
+struct ExportOptions {
+    std::string csvPath;            ///< 每个请求一行的CSV文件
+    std::string jsonlPath;          ///< 每个请求一行的JSON Lines文件
+    std::string intervalPath;       ///< 每个区间一行的汇总CSV文件
+    std::string hdrLogPath;         ///< HdrHistogram区间日志文件
+    int intervalMs = 1000;          ///< 区间长度(毫秒)
+    int queueCapacity = 16384;      ///< 每个工作线程的待写队列容量，写满时丢弃新结果并计数
+
+    /**
+     * @brief 是否启用了任何导出
+     */
+    bool enabled() const {
+        return !csvPath.empty() || !jsonlPath.empty() || !intervalPath.empty() || !hdrLogPath.empty();
+    }
+};
+
+/**
+ * @class ResultExporter
+ * @brief 在后台线程中将请求结果流式写入多种结构化格式
+ *
+ * 每个工作线程有自己的有界单生产者队列，提交结果不加锁；队列写满时丢弃
+ * 新结果并计数，不阻塞发请求的线程。格式化（std::to_chars）和大块写盘
+ * 全部在导出线程完成。区间按结果自身的完成时刻划分，而不是按导出线程
+ * 取出它们的时刻。
+ */
+class ResultExporter {
+public:
+    ResultExporter();
+    ~ResultExporter();
+
+    ResultExporter(const ResultExporter&) = delete;
+    ResultExporter& operator=(const ResultExporter&) = delete;
+
+    /**
+     * @brief 打开导出文件并启动导出线程
+     * @param options 导出配置
+     * @param startTime 测试开始时间，作为区间时间戳的基准
+     * @param producers 提交结果的工作线程数，每个线程一个队列
+     * @return 如果所有文件都成功打开返回true，否则返回false且不启动导出线程
+     */
+    bool open(const ExportOptions& options, std::chrono::system_clock::time_point startTime, size_t producers);
+
+    /**
+     * @brief 设置导出线程绑定的核心（下一次open()时生效）
+     * @param core 核心编号，-1表示不绑定
+     */
+    void setThreadCore(int core) { threadCore = core; }
+
+    /**
+     * @brief 写出剩余数据、关闭文件并停止导出线程
+     */
+    void close();
+
+    /**
+     * @brief 导出器是否处于打开状态
+     */
+    bool isOpen() const { return running; }
+
+    /**
+     * @brief 提交一个请求结果，不加锁（每个producer只能由一个线程调用）
+     * @param producer 工作线程编号，小于open()时给出的数量
+     * @param result 请求结果
+     */
+    void record(size_t producer, const RequestResult& result);
+
+    /**
+     * @brief 获取已写出的请求数
+     */
+    uint64_t getExportedCount() const { return exportedCount; }
+
+    /**
+     * @brief 获取因队列写满而丢弃的请求数
+     */
+    uint64_t getDroppedCount() const { return droppedCount; }
+
+    /**
+     * @brief 标记负载发生器在当前区间内饱和（线程安全）
+     *
+     * 区间汇总中该区间的generator_saturated列为1，关闭时HdrHistogram日志末尾写入标记。
+     */
+    void markGeneratorSaturated();
+
+    /**
+     * @brief 获取最近一次打开失败的文件路径
+     */
+    const std::string& getLastError() const { return lastError; }
+
+private:
+    /**
+     * @brief 带大缓冲区的输出文件
+     */
+    struct BufferedFile {
+        std::ofstream stream;       ///< 文件流
+        std::string buffer;         ///< 待写出的数据
+
+        bool isOpen() const { return stream.is_open(); }
+        void flushIfLarge();
+        void flush();
+    };
+
+    /**
+     * @brief 一个工作线程的待写队列
+     */
+    struct alignas(64) ProducerQueue {
+        explicit ProducerQueue(size_t capacity) : ring(capacity) {}
+
+        SpscRing<RequestResult> ring;   ///< 待写出的结果
+        size_t sinceWake = 0;           ///< 上次唤醒导出线程后写入的数量(仅生产者访问)
+    };
+
+    void sinkThread();
+    void writeRecords(std::vector<RequestResult>& records);
+    void closeInterval(std::chrono::system_clock::time_point intervalEnd);
+    void writeHeaders();
+
+    /**
+     * @brief 查询URL驻留编号对应的URL（导出线程内缓存）
+     */
+    const std::string& endpointUrl(uint32_t endpoint);
+
+private:
+    ExportOptions options;                          ///< 导出配置
+    std::chrono::system_clock::time_point startTime; ///< 测试开始时间
+    std::chrono::system_clock::time_point intervalStart; ///< 当前区间开始时间
+
+    BufferedFile csvFile;                           ///< 请求CSV
+    BufferedFile jsonlFile;                         ///< 请求JSONL
+    BufferedFile intervalFile;                      ///< 区间汇总
+    BufferedFile hdrLogFile;                        ///< HdrHistogram区间日志
+
+    LatencyHistogram intervalHistogram;             ///< 当前区间的响应时间直方图(微秒)
+    int intervalSuccessful;                         ///< 当前区间成功数
+    int intervalFailed;                             ///< 当前区间失败数
+    int intervalErrors;                             ///< 当前区间错误数
+    uint64_t intervalBytesSent;                     ///< 当前区间完成的请求的发送字节
+    uint64_t intervalBytesReceived;                 ///< 当前区间完成的请求的接收字节
+    std::atomic<bool> intervalSaturated;            ///< 当前区间内发生器是否饱和
+    std::atomic<bool> runSaturated;                 ///< 本次运行中发生器是否饱和过
+
+    std::vector<std::string> endpointUrls;          ///< 已查询的URL(仅导出线程访问)
+    std::vector<bool> endpointKnown;                ///< 对应编号是否已查询
+    std::string listUrl;                            ///< 最近一次查询的URL列表行(仅导出线程访问)
+    std::vector<std::unique_ptr<ProducerQueue>> queues; ///< 每个工作线程一个待写队列
+    size_t wakeThreshold;                           ///< 单个队列积压到该数量时唤醒导出线程
+    std::mutex wakeMutex;                           ///< 导出线程休眠与关闭用的互斥锁
+    std::condition_variable wakeup;                 ///< 唤醒导出线程
+    std::atomic<bool> wakeRequested;                ///< 有队列积压较多
+    std::atomic<uint64_t> droppedCount;             ///< 因队列写满而丢弃的请求数
+    std::thread sink;                               ///< 导出线程
+    std::atomic<bool> running;                      ///< 导出线程是否运行
+    std::atomic<uint64_t> exportedCount;            ///< 已写出的请求数
+    std::string lastError;                          ///< 打开失败的文件
+    int threadCore;                                 ///< 导出线程绑定的核心
+};
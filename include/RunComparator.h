@@ -0,0 +1,78 @@
+/**
+ * @file RunComparator.h
+ * @brief 运行间回归检测的声明
+ */
+#pragma once
+
+#include <string>
+#include "RunSummary.h"
+
+/**
+ * @struct ComparisonOptions
+ * @brief 回归判定参数
+ */
+struct ComparisonOptions {
+    double latencyThresholdPercent = 10.0;      ///< 分位数变化超过该百分比才视为回归
+    double throughputThresholdPercent = 10.0;   ///< 吞吐量下降超过该百分比才视为回归
+    double errorRateThresholdPoints = 1.0;      ///< 错误率上升超过该百分点才视为回归
+    double significanceLevel = 0.01;            ///< 显著性水平
+};
+
+/**
+ * @struct QuantileShift
+ * @brief 单个分位数的变化
+ */
+struct QuantileShift {
+    double baseline = 0.0;          ///< 基线值(毫秒)
+    double current = 0.0;           ///< 当前值(毫秒)
+    double changePercent = 0.0;     ///< 相对变化百分比（正数表示变慢）
+};
+
+/**
+ * @struct RunComparison
+ * @brief 两次运行的对比结果
+ */
+struct RunComparison {
+    QuantileShift p50;                  ///< 中位数变化
+    QuantileShift p99;                  ///< P99变化
+    double ksStatistic = 0.0;           ///< 两样本KS检验统计量D
+    double ksPValue = 1.0;              ///< KS检验p值
+    double mannWhitneyZ = 0.0;          ///< Mann-Whitney U检验的z值（正数表示当前更慢）
+    double mannWhitneyPValue = 1.0;     ///< Mann-Whitney U检验的双侧p值
+    double baselineThroughput = 0.0;    ///< 基线平均吞吐量(每秒请求数)
+    double currentThroughput = 0.0;     ///< 当前平均吞吐量(每秒请求数)
+    double throughputDelta = 0.0;       ///< 吞吐量差值（当前-基线）
+    double throughputCiLow = 0.0;       ///< 吞吐量差值95%置信区间下界
+    double throughputCiHigh = 0.0;      ///< 吞吐量差值95%置信区间上界
+    double errorRateDelta = 0.0;        ///< 错误率变化(百分点)
+    bool latencyRegression = false;     ///< 延迟是否回归
+    bool throughputRegression = false;  ///< 吞吐量是否回归
+    bool errorRegression = false;       ///< 错误率是否回归
+
+    /**
+     * @brief 是否存在任何回归
+     */
+    bool hasRegression() const {
+        return latencyRegression || throughputRegression || errorRegression;
+    }
+};
+
+/**
+ * @brief 对比两次运行
+ *
+ * 所有检验都直接在草图的桶上计算，耗时只与桶数有关，与样本数无关。
+ * 两个草图必须使用相同的相对精度，否则分布检验结果为默认值。
+ * @param baseline 基线运行
+ * @param current 当前运行
+ * @param options 判定参数
+ * @return 对比结果
+ */
+RunComparison compareRuns(const RunSummary& baseline, const RunSummary& current,
+                          const ComparisonOptions& options = ComparisonOptions());
+
+/**
+ * @brief 生成可读的对比报告
+ * @param comparison 对比结果
+ * @return 多行文本报告
+ */
+std::string formatComparisonReport(const RunComparison& comparison);
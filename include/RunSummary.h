@@ -0,0 +1,86 @@
+/**
+ * @file RunSummary.h
+ * @brief 单次测试运行摘要的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DDSketch.h"
+
+/**
+ * @struct RunSummary
+ * @brief 一次测试运行的可持久化摘要：计数器、每秒吞吐序列和响应时间草图
+ *
+ * 摘要只保存聚合后的数据，与原始样本数量无关，千万级请求的运行也只有几KB。
+ */
+struct RunSummary {
+    std::string url;                        ///< 测试URL
+    int threads = 0;                        ///< 线程数
+    int totalRequests = 0;                  ///< 计划请求数
+    int completedRequests = 0;              ///< 已完成的请求数
+    int successfulRequests = 0;             ///< 成功的请求数
+    int64_t startTimeMs = 0;                ///< 开始时间(Unix毫秒)
+    int64_t durationMs = 0;                 ///< 持续时间(毫秒)
+    std::vector<uint32_t> completedPerSecond; ///< 每秒完成的请求数
+    DDSketch latency;                       ///< 响应时间草图(毫秒)
+    bool generatorSaturated = false;        ///< 负载发生器是否饱和（结果不可信）
+    std::string saturationReason;           ///< 第一次饱和的原因
+    int measureStartSecond = 0;             ///< 测量窗口第一个计入的秒
+    int measureEndSecond = 0;               ///< 测量窗口第一个不计入的秒，0表示未划分窗口
+    int measuredRequests = 0;               ///< 测量窗口内的请求数
+    int measuredSuccessful = 0;             ///< 测量窗口内成功的请求数
+    bool steadyStateDetected = false;       ///< 测量开始处是否由稳态检测确定
+
+    /**
+     * @brief 是否划分了测量窗口（草图只包含窗口内的请求）
+     */
+    bool hasMeasurementWindow() const { return measureEndSecond > 0; }
+
+    /**
+     * @brief 测量窗口内的每秒完成数，未划分窗口时为整个序列
+     * @return 每秒完成的请求数
+     */
+    std::vector<uint32_t> measuredPerSecond() const;
+
+    /**
+     * @brief 计算错误率（非成功请求占比，划分了测量窗口时只统计窗口内）
+     * @return 错误率百分比
+     */
+    double errorRate() const;
+
+    /**
+     * @brief 计算平均吞吐量（划分了测量窗口时只统计窗口内）
+     * @return 每秒请求数
+     */
+    double throughput() const;
+
+    /**
+     * @brief 序列化为二进制格式
+     * @return 二进制数据
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief 从二进制数据恢复摘要
+     * @param data 由serialize()生成的数据
+     * @param summary 输出摘要
+     * @return 如果数据有效返回true
+     */
+    static bool deserialize(const std::string& data, RunSummary& summary);
+
+    /**
+     * @brief 保存到文件
+     * @param filePath 文件路径
+     * @return 如果成功返回true
+     */
+    bool saveToFile(const std::string& filePath) const;
+
+    /**
+     * @brief 从文件加载
+     * @param filePath 文件路径
+     * @return 如果文件存在且有效返回true
+     */
+    bool loadFromFile(const std::string& filePath);
+};
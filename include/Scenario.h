@@ -0,0 +1,250 @@
+/**
+ * @file Scenario.h
+ * @brief 多步骤会话场景、会话状态与分步统计的声明
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <curl/curl.h>
+#include "DDSketch.h"
+
+/**
+ * @struct Extraction
+ * @brief 从响应中提取一个值保存为会话变量
+ */
+struct Extraction {
+    /**
+     * @enum Source
+     * @brief 提取来源
+     */
+    enum class Source {
+        HEADER,     ///< 响应头（名称不区分大小写）
+        JSON        ///< JSON响应体（以点分隔的路径，数组用下标，如data.items.0.id）
+    };
+
+    std::string variable;           ///< 保存到的变量名
+    Source source = Source::JSON;   ///< 提取来源
+    std::string path;               ///< 响应头名称或JSON路径
+};
+
+/**
+ * @struct ScenarioStep
+ * @brief 场景中的一个请求步骤；URL、请求头和请求体中的${变量}在发送前替换
+ */
+struct ScenarioStep {
+    std::string name;                       ///< 步骤名称
+    std::string method = "GET";             ///< 请求方法
+    std::string url;                        ///< 请求URL模板
+    std::vector<std::string> headers;       ///< 请求头模板（"名称: 值"）
+    std::string body;                       ///< 请求体模板
+    std::vector<Extraction> extractions;    ///< 响应值提取
+};
+
+/**
+ * @struct Scenario
+ * @brief 按顺序执行的多步骤事务，例如登录、取令牌、调用接口
+ *
+ * 文件格式与配置文件相同（#开头为注释），每个[Step]小节定义一个步骤：
+ * @code
+ * name=login-flow
+ * [Step]
+ * name=login
+ * method=POST
+ * url=http://host/login
+ * header=Content-Type: application/json
+ * body={"user":"u${vu}"}
+ * extract=token:json:data.token
+ * [Step]
+ * name=profile
+ * url=http://host/me
+ * header=Authorization: Bearer ${token}
+ * @endcode
+ * 内置变量：${vu}为虚拟用户编号，${iteration}为该用户的事务序号。
+ */
+struct Scenario {
+    std::string name;                       ///< 场景名称
+    std::vector<ScenarioStep> steps;        ///< 按顺序执行的步骤
+
+    /**
+     * @brief 是否定义了步骤
+     */
+    bool enabled() const { return !steps.empty(); }
+
+    /**
+     * @brief 从文件加载场景
+     * @param filePath 场景文件路径
+     * @return 如果文件可读且至少包含一个有URL的步骤返回true
+     */
+    bool loadFromFile(const std::string& filePath);
+};
+
+/**
+ * @struct StepStats
+ * @brief 单个步骤（或整个事务）的统计
+ */
+struct StepStats {
+    std::string name;               ///< 步骤或场景名称
+    uint64_t count = 0;             ///< 执行次数
+    uint64_t successful = 0;        ///< 成功次数
+    uint64_t failed = 0;            ///< HTTP非2xx或提取失败次数
+    uint64_t errors = 0;            ///< 传输错误次数
+    DDSketch latency;               ///< 响应时间（毫秒）
+
+    /**
+     * @brief 合并另一份统计
+     */
+    void merge(const StepStats& other);
+};
+
+/**
+ * @struct ScenarioStats
+ * @brief 场景的分步统计与事务统计
+ */
+struct ScenarioStats {
+    std::vector<StepStats> steps;   ///< 按步骤顺序的统计
+    StepStats transactions;         ///< 完整事务的统计（从第一步开始到最后一步结束）
+
+    /**
+     * @brief 按场景初始化各步骤名称
+     */
+    void reset(const Scenario& scenario);
+
+    /**
+     * @brief 合并另一份统计（步骤数不同时按较短者合并）
+     */
+    void merge(const ScenarioStats& other);
+};
+
+/**
+ * @enum StepOutcome
+ * @brief 一个步骤结束后会话的去向
+ */
+enum class StepOutcome {
+    NEXT_STEP,              ///< 继续下一步
+    TRANSACTION_SUCCEEDED,  ///< 最后一步成功，事务完成
+    TRANSACTION_FAILED      ///< 本步骤失败，事务中止
+};
+
+/**
+ * @class ScenarioSession
+ * @brief 单个虚拟用户的会话状态
+ *
+ * 会话变量、响应头和响应体都分配在每个会话独占的单调内存池中，池的前几KB
+ * 内嵌在会话对象里；每个事务开始时整体释放，长时间运行的会话不会造成堆碎片。
+ * Cookie由该用户独占的curl句柄的Cookie引擎保存，同样在每个事务开始时清空。
+ */
+class ScenarioSession {
+public:
+    /**
+     * @brief 构造函数
+     * @param scenario 场景（生命周期须长于会话）
+     * @param userId 虚拟用户全局编号
+     */
+    ScenarioSession(const Scenario& scenario, int userId);
+    ~ScenarioSession();
+
+    ScenarioSession(const ScenarioSession&) = delete;
+    ScenarioSession& operator=(const ScenarioSession&) = delete;
+
+    /**
+     * @brief 当前是否处于事务第一步之前
+     */
+    bool atTransactionStart() const { return stepIndex == 0; }
+
+    /**
+     * @brief 当前步骤序号
+     */
+    size_t currentStep() const { return stepIndex; }
+
+    /**
+     * @brief 开始新事务：清空Cookie与会话变量并释放内存池
+     * @param easy 该用户的curl句柄
+     */
+    void beginTransaction(CURL* easy);
+
+    /**
+     * @brief 按当前步骤配置curl句柄
+     * @param easy 该用户的curl句柄
+     */
+    void prepareStep(CURL* easy);
+
+    /**
+     * @brief 结束当前步骤：提取变量并记录统计
+     * @param easy 该用户的curl句柄
+     * @param result 传输结果
+     * @param elapsedNs 本步骤响应时间(纳秒)
+     * @param stats 记录到的统计
+     * @return 会话的去向
+     */
+    StepOutcome finishStep(CURL* easy, CURLcode result, int64_t elapsedNs, ScenarioStats& stats);
+
+    /**
+     * @brief 放弃进行中的事务（请求配额用完或阶段结束），不计入统计
+     */
+    void abandonTransaction();
+
+private:
+    using VariableMap = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
+
+    /**
+     * @brief 一个事务内的全部可变状态，整体分配在内存池中
+     */
+    struct TransactionState {
+        explicit TransactionState(std::pmr::memory_resource* arena)
+            : variables(arena), headers(arena), body(arena), scratch(arena) {}
+
+        VariableMap variables;          ///< 会话变量
+        std::pmr::string headers;       ///< 当前步骤的响应头
+        std::pmr::string body;          ///< 当前步骤的响应体（仅在需要提取时保存）
+        std::pmr::string scratch;       ///< 模板展开缓冲
+    };
+
+    static size_t headerCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+    static size_t bodyCallback(char* buffer, size_t size, size_t nmemb, void* userdata);
+
+    /**
+     * @brief 展开模板中的${变量}，结果写入state->scratch
+     */
+    const std::pmr::string& expand(const std::string& text);
+
+    /**
+     * @brief 执行当前步骤的全部提取
+     * @return 所有值都提取成功返回true
+     */
+    bool applyExtractions(const ScenarioStep& step);
+
+    /**
+     * @brief 释放当前步骤的请求头链表
+     */
+    void freeHeaderList();
+
+private:
+    const Scenario& scenario;                       ///< 场景
+    int userId;                                     ///< 虚拟用户编号
+    uint64_t iteration;                             ///< 已开始的事务数
+    size_t stepIndex;                               ///< 当前步骤
+    std::chrono::steady_clock::time_point transactionStart; ///< 本事务开始时间
+    curl_slist* headerList;                         ///< 当前步骤的请求头
+    bool captureBody;                               ///< 当前步骤是否保存响应体
+    std::array<std::byte, 2048> initialBuffer;      ///< 内存池的内嵌初始块
+    std::pmr::monotonic_buffer_resource arena;      ///< 会话内存池
+    std::optional<TransactionState> state;          ///< 当前事务状态
+};
+
+/**
+ * @brief 按以点分隔的路径在JSON文本中查找值
+ * @param json JSON文本
+ * @param path 路径，对象用键名、数组用下标，例如data.items.0.id
+ * @param out 找到时写入值：字符串去掉引号并反转义，其他类型保留原文
+ * @return 找到返回true
+ */
+bool findJsonValue(std::string_view json, std::string_view path, std::pmr::string& out);
@@ -0,0 +1,96 @@
+/**
+ * @file SpscRing.h
+ * @brief 单生产者单消费者的有界无锁环形队列
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @class SpscRing
+ * @brief 定长的单生产者单消费者队列，写满时push()失败而不阻塞
+ *
+ * 容量向上取整为2的幂，下标对容量取模用按位与完成。生产者与消费者的
+ * 下标各占一个缓存行，并各自缓存对方下标的最近值，只在看起来满/空时才
+ * 重新读取，稳态下两个线程不会在同一缓存行上来回争用。
+ *
+ * @tparam T 元素类型，需可默认构造与复制
+ */
+template <class T>
+class SpscRing {
+public:
+    /**
+     * @brief 构造函数
+     * @param minCapacity 最少可容纳的元素数
+     */
+    explicit SpscRing(size_t minCapacity) {
+        capacity = 2;
+        while (capacity < minCapacity) capacity <<= 1;
+        mask = capacity - 1;
+        slots.reset(new T[capacity]);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief 追加一个元素（仅生产者线程调用）
+     * @param value 元素
+     * @return 队列已满时返回false，元素未写入
+     */
+    bool push(const T& value) {
+        size_t tail = producer.tail.load(std::memory_order_relaxed);
+        if (tail - producer.cachedHead >= capacity) {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            if (tail - producer.cachedHead >= capacity) return false;
+        }
+        slots[tail & mask] = value;
+        producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 取出当前所有元素（仅消费者线程调用）
+     * @param consume 对每个元素调用一次，按写入顺序
+     * @return 取出的元素数
+     */
+    template <class Consumer>
+    size_t drain(Consumer&& consume) {
+        size_t head = consumer.head.load(std::memory_order_relaxed);
+        size_t tail = producer.tail.load(std::memory_order_acquire);
+        for (size_t i = head; i != tail; ++i) {
+            consume(slots[i & mask]);
+        }
+        consumer.head.store(tail, std::memory_order_release);
+        return tail - head;
+    }
+
+    /**
+     * @brief 当前元素数的近似值（任意线程可调用）
+     */
+    size_t size() const {
+        return producer.tail.load(std::memory_order_acquire) - consumer.head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 容量
+     */
+    size_t getCapacity() const { return capacity; }
+
+private:
+    struct alignas(64) ProducerSide {
+        std::atomic<size_t> tail{0};    ///< 下一个写入位置
+        size_t cachedHead = 0;          ///< 最近读到的消费者下标
+    };
+    struct alignas(64) ConsumerSide {
+        std::atomic<size_t> head{0};    ///< 下一个读取位置
+    };
+
+    ProducerSide producer;              ///< 生产者独占的缓存行
+    ConsumerSide consumer;              ///< 消费者独占的缓存行
+    size_t capacity;                    ///< 容量（2的幂）
+    size_t mask;                        ///< 下标掩码
+    std::unique_ptr<T[]> slots;         ///< 元素存储
+};
@@ -0,0 +1,119 @@
+/**
+ * @file StatsSnapshot.h
+ * @brief 实时统计快照结构及序列锁(seqlock)发布器
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @struct StatsSnapshot
+ * @brief 测试运行期间的统计快照，由聚合线程定期整体发布
+ *
+ * 所有字段在同一时刻采样，读取方拿到的一定是某一次完整发布的结果，
+ * 不会出现完成数与响应时间来自不同时刻的情况。
+ */
+struct StatsSnapshot {
+    uint64_t version;               ///< 快照版本号，每次发布递增
+    int64_t elapsedMs;              ///< 测试已运行时间(毫秒)
+    int completedRequests;          ///< 已完成的请求数
+    int successfulRequests;         ///< 成功的请求数
+    int totalRequests;              ///< 总请求数
+    double successRate;             ///< 成功率百分比
+    double minResponseTime;         ///< 最小响应时间(毫秒)
+    double maxResponseTime;         ///< 最大响应时间(毫秒)
+    double avgResponseTime;         ///< 平均响应时间(毫秒)
+    double p50ResponseTime;         ///< 响应时间中位数(毫秒)，原始样本后端只在最终快照中提供
+    double p90ResponseTime;         ///< 响应时间P90(毫秒)
+    double p99ResponseTime;         ///< 响应时间P99(毫秒)
+    double requestsPerSecond;       ///< 自测试开始以来的平均吞吐量
+    uint64_t bytesSent;             ///< 已完成请求的发送字节
+    uint64_t bytesReceived;         ///< 已完成请求的接收字节
+    double receiveMegabytesPerSecond; ///< 自测试开始以来的平均接收速率(MB/s)
+    int measuredRequests;           ///< 测量窗口内的请求数，启用窗口时最终快照的延迟、吞吐量和成功率只统计这部分
+    int64_t measureStartMs;         ///< 测量窗口开始(相对测试开始，毫秒)
+    int64_t measureEndMs;           ///< 测量窗口结束(相对测试开始，毫秒)
+    bool steadyStateDetected;       ///< 测量开始处是否由稳态检测确定
+    bool running;                   ///< 发布时测试是否仍在运行
+};
+
+/**
+ * @class SeqLock
+ * @brief 单写者、多读者的序列锁
+ *
+ * 写者从不阻塞；读者在写者发布期间重试，不持有任何锁。
+ * 数据以原子字的形式保存，因此并发读写在C++内存模型下不构成数据竞争。
+ * @tparam T 必须是可平凡拷贝的类型
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock要求T可平凡拷贝");
+
+public:
+    SeqLock() : sequence(0) {
+        for (auto& word : words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /**
+     * @brief 发布新值（只允许一个写者调用）
+     * @param value 要发布的值
+     */
+    void publish(const T& value) {
+        uint64_t buffer[WORD_COUNT] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        uint64_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORD_COUNT; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief 读取最近一次完整发布的值
+     * @return 发布值的副本
+     */
+    T read() const {
+        uint64_t buffer[WORD_COUNT];
+        uint64_t before, after;
+
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORD_COUNT; ++i) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief 获取已完成的发布次数
+     * @return 发布次数
+     */
+    uint64_t publishCount() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence;                ///< 序列号，奇数表示写入中
+    std::atomic<uint64_t> words[WORD_COUNT];       ///< 按8字节切分的数据
+};
@@ -0,0 +1,198 @@
+/**
+ * @file StatusNotifier.h
+ * @brief 合并式状态通知器的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "RequestResult.h"
+#include "StatsSnapshot.h"
+
+/**
+ * @struct StatusUpdate
+ * @brief 一次合并后的状态通知，包含自上次通知以来的增量
+ */
+struct StatusUpdate {
+    int completedRequests = 0;              ///< 已完成的请求数
+    int totalRequests = 0;                  ///< 总请求数
+    double successRate = 0.0;               ///< 成功率百分比
+    int deltaCompleted = 0;                 ///< 本批次完成的请求数
+    int deltaSuccessful = 0;                ///< 本批次成功的请求数
+    int deltaFailed = 0;                    ///< 本批次失败的请求数 (非2xx)
+    int deltaErrors = 0;                    ///< 本批次出错的请求数 (连接错误等)
+    int droppedResults = 0;                 ///< 因批次容量限制而未携带的结果数
+    std::vector<RequestResult> recentResults; ///< 本批次最近的请求结果（最新的在前）
+};
+
+/**
+ * @class RecentResultRing
+ * @brief 单写者的最近结果环，读者不加锁
+ *
+ * 写者按序号覆盖最旧的槽位，每个槽位是一个序列锁，读者拿到的一定是某次
+ * 完整写入的结果；读完后再核对写入计数，丢弃读取期间可能已被覆盖的槽位。
+ * 比容量多留一个槽位给正在写入的结果，没有并发写入时总能读到最近capacity个。
+ */
+class RecentResultRing {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 保留的最近结果数
+     */
+    explicit RecentResultRing(size_t capacity);
+
+    /**
+     * @brief 写入一个结果（只允许一个写者调用）
+     * @param result 请求结果
+     */
+    void push(const RequestResult& result);
+
+    /**
+     * @brief 读取序号不小于from且仍在环中的结果（任意线程可调用）
+     * @param from 起始序号，0表示环中全部
+     * @param out 结果按写入顺序追加到这里
+     * @return 读取开始时的写入计数，可作为下一次的from
+     */
+    uint64_t collect(uint64_t from, std::vector<RequestResult>& out) const;
+
+    /**
+     * @brief 已写入的结果总数
+     */
+    uint64_t writtenCount() const { return written.load(std::memory_order_acquire); }
+
+private:
+    size_t capacity;                                    ///< 保留的结果数，槽位数为capacity + 1
+    std::unique_ptr<SeqLock<RequestResult>[]> slots;    ///< 槽位，序号i写入第i % (capacity + 1)个
+    std::atomic<uint64_t> written;                      ///< 已写入的结果数
+};
+
+/**
+ * @class StatusNotifier
+ * @brief 将高频的请求结果合并为限频的状态通知
+ *
+ * 每个工作线程有自己的分片：record()只更新本分片的单写者计数并写入
+ * 最近结果环，不加任何锁。驱动线程周期性调用poll()，按间隔从各分片
+ * 收集增量，每个间隔最多投递一次通知。时间点由调用方传入，不依赖任何
+ * 界面框架，便于在任意前端或测试中使用。
+ */
+class StatusNotifier {
+public:
+    using Callback = std::function<void(const StatusUpdate&)>;
+
+    /**
+     * @brief 构造函数
+     * @param maxBatchedResults 每次通知最多携带的请求结果数量
+     */
+    explicit StatusNotifier(size_t maxBatchedResults = 10);
+
+    /**
+     * @brief 设置通知回调
+     * @param callback 回调函数，在调用poll()/flush()的线程中执行
+     */
+    void setCallback(Callback callback);
+
+    /**
+     * @brief 设置最小通知间隔
+     * @param interval 通知间隔
+     */
+    void setInterval(std::chrono::milliseconds interval);
+
+    /**
+     * @brief 获取最小通知间隔
+     * @return 通知间隔
+     */
+    std::chrono::milliseconds getInterval() const;
+
+    /**
+     * @brief 清空所有待投递的数据并按工作线程数重建分片（不得与record()并发调用）
+     * @param shardCount 分片数，即调用record()的线程数
+     */
+    void reset(size_t shardCount = 1);
+
+    /**
+     * @brief 记录一个请求结果，不加锁（每个分片只能由一个线程调用）
+     * @param shard 分片编号，小于reset()时给出的数量
+     * @param result 请求结果
+     */
+    void record(size_t shard, const RequestResult& result);
+
+    /**
+     * @brief 如果距上次通知已超过间隔且有新数据，则投递一次通知
+     * @param now 当前时间
+     * @param completed 已完成的请求数
+     * @param total 总请求数
+     * @param successRate 成功率百分比
+     * @return 如果投递了通知返回true
+     */
+    bool poll(std::chrono::steady_clock::time_point now, int completed, int total, double successRate);
+
+    /**
+     * @brief 无视间隔立即投递所有待投递数据（即使没有新结果也会投递一次）
+     * @param completed 已完成的请求数
+     * @param total 总请求数
+     * @param successRate 成功率百分比
+     */
+    void flush(int completed, int total, double successRate);
+
+    /**
+     * @brief 获取已投递的通知次数
+     * @return 通知次数
+     */
+    size_t getDeliveredCount() const;
+
+private:
+    /**
+     * @brief 单个工作线程的计数与最近结果
+     *
+     * 计数只由所属线程写入，用普通的读改写而不是原子加；收集方记住上次读到的值，
+     * 两次之差即增量，因此写者与收集方之间没有任何读改写竞争。
+     */
+    struct alignas(64) Shard {
+        explicit Shard(size_t recentCapacity) : recent(recentCapacity) {}
+
+        std::atomic<uint64_t> completed{0};     ///< 完成数
+        std::atomic<uint64_t> successful{0};    ///< 成功数
+        std::atomic<uint64_t> failed{0};        ///< 失败数 (非2xx)
+        std::atomic<uint64_t> errors{0};        ///< 错误数
+        RecentResultRing recent;                ///< 最近的结果
+
+        /**
+         * @brief 收集方上次读到的值（只由持有pendingMutex的收集方访问）
+         */
+        struct alignas(64) Seen {
+            uint64_t completed = 0;
+            uint64_t successful = 0;
+            uint64_t failed = 0;
+            uint64_t errors = 0;
+            uint64_t recent = 0;
+        } seen;
+    };
+
+    /**
+     * @brief 从各分片收集自上次以来的增量（调用方持有pendingMutex）
+     */
+    void collect();
+
+    /**
+     * @brief 取出待投递数据并调用回调
+     */
+    void deliver(int completed, int total, double successRate);
+
+private:
+    const size_t maxBatchedResults;         ///< 每批最多携带的结果数
+    mutable std::mutex pendingMutex;        ///< 保护收集状态与待投递数据，只在poll()/flush()等控制路径上持有
+    std::vector<std::unique_ptr<Shard>> shards; ///< 每个工作线程一个分片
+    std::vector<RequestResult> pendingResults; ///< 已收集、待投递的结果
+    StatusUpdate pendingDelta;              ///< 已收集、待投递的增量计数
+    std::chrono::milliseconds interval;     ///< 最小通知间隔
+    std::chrono::steady_clock::time_point lastDelivery; ///< 上次投递时间
+    size_t deliveredCount;                  ///< 已投递次数
+
+    std::mutex callbackMutex;               ///< 保证回调不会并发执行
+    Callback callback;                      ///< 通知回调
+};
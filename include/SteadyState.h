@@ -0,0 +1,106 @@
+/**
+ * @file SteadyState.h
+ * @brief 预热/冷却测量窗口与稳态检测的声明
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "DDSketch.h"
+
+/**
+ * @struct MeasurementWindowOptions
+ * @brief 测量窗口配置：窗口外的请求照常记录，但不计入最终的延迟、吞吐量和成功率
+ */
+struct MeasurementWindowOptions {
+    int warmUpMs = 0;               ///< 开头排除的预热时长(毫秒)
+    int coolDownMs = 0;             ///< 结尾排除的冷却时长(毫秒)
+    bool autoDetect = false;        ///< 自动检测稳态，稳态之前的部分视为预热
+    int stableSeconds = 5;          ///< 判定稳态所需的连续秒数
+    double maxVariation = 0.10;     ///< 稳定窗口内每秒吞吐量与中位数延迟的变异系数上限
+
+    /**
+     * @brief 是否需要按秒分桶以划分测量窗口
+     */
+    bool enabled() const { return warmUpMs > 0 || coolDownMs > 0 || autoDetect; }
+};
+
+/**
+ * @struct SecondBucket
+ * @brief 一秒内完成的请求
+ */
+struct SecondBucket {
+    DDSketch latency;               ///< 响应时间(毫秒)
+    uint64_t completed = 0;         ///< 完成数
+    uint64_t successful = 0;        ///< 成功数
+};
+
+/**
+ * @class SteadyStateDetector
+ * @brief 在每秒吞吐量和中位数延迟序列上寻找第一个稳定窗口
+ *
+ * 最近stableSeconds秒内吞吐量与中位数延迟的变异系数（标准差/均值）都不超过阈值、
+ * 且每秒都有请求完成时判定进入稳态，测量从该窗口的第一秒开始。
+ */
+class SteadyStateDetector {
+public:
+    /**
+     * @brief 构造函数
+     * @param stableSeconds 稳定窗口长度(秒)
+     * @param maxVariation 变异系数上限
+     */
+    explicit SteadyStateDetector(int stableSeconds = 5, double maxVariation = 0.10);
+
+    /**
+     * @brief 加入下一秒的样本
+     * @param completed 该秒完成的请求数
+     * @param p50Ms 该秒的中位数延迟(毫秒)
+     * @return 本次调用首次判定稳态时返回true
+     */
+    bool add(uint64_t completed, double p50Ms);
+
+    /**
+     * @brief 是否已进入稳态
+     */
+    bool isSteady() const { return steadyStart >= 0; }
+
+    /**
+     * @brief 稳态开始的秒序号，尚未进入稳态时为-1
+     */
+    int getSteadyStart() const { return steadyStart; }
+
+private:
+    int stableSeconds;                  ///< 稳定窗口长度
+    double maxVariation;                ///< 变异系数上限
+    std::vector<double> throughput;     ///< 每秒完成数
+    std::vector<double> medians;        ///< 每秒中位数延迟
+    int steadyStart;                    ///< 稳态开始的秒序号
+};
+
+/**
+ * @struct MeasurementWindow
+ * @brief 最终采用的测量窗口，以秒桶为单位的左闭右开区间
+ */
+struct MeasurementWindow {
+    int startSecond = 0;            ///< 第一个计入的秒
+    int endSecond = 0;              ///< 第一个不计入的秒
+    bool steadyStateDetected = false; ///< 开始处是否由稳态检测确定
+
+    /**
+     * @brief 窗口是否为空
+     */
+    bool empty() const { return endSecond <= startSecond; }
+};
+
+/**
+ * @brief 根据配置、秒桶数和检测到的稳态确定测量窗口
+ *
+ * 开始处取预热结束与稳态开始中较晚者；自动检测但未进入稳态时退回到预热结束。
+ * 冷却从最后一个秒桶向前扣除。
+ * @param options 测量窗口配置
+ * @param bucketCount 秒桶数（最后一个可能不满一秒）
+ * @param steadyStart 稳态开始的秒序号，-1表示未检测到
+ * @return 测量窗口
+ */
+MeasurementWindow resolveMeasurementWindow(const MeasurementWindowOptions& options, int bucketCount,
+                                           int steadyStart);
@@ -0,0 +1,144 @@
+/**
+ * @file TcpTransport.h
+ * @brief 按行或长度前缀分帧的原始TCP请求/响应传输的声明
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "BasicLoadTester.h"
+#include "Cancellation.h"
+
+/**
+ * @enum TcpFraming
+ * @brief 请求与响应的分帧方式
+ */
+enum class TcpFraming {
+    LINE,           ///< 以分隔符结尾（默认换行）
+    LENGTH_PREFIX   ///< 大端长度头后跟帧体，长度不含头部
+};
+
+/**
+ * @struct TcpOptions
+ * @brief 原始TCP模式配置，URL为tcp://主机:端口（tcps://为TLS）时启用
+ */
+struct TcpOptions {
+    TcpFraming framing = TcpFraming::LINE;  ///< 分帧方式
+    std::string delimiter = "\n";           ///< 行模式的帧分隔符
+    int lengthBytes = 4;                    ///< 长度头字节数（1、2或4）
+    std::string payload = "PING {seq}";     ///< 请求模板，{seq}替换为连接内序号，{conn}替换为连接序号
+    int pipelineDepth = 1;                  ///< 每个连接上同时未应答的请求数
+
+    /**
+     * @brief 解析分帧方式名称
+     * @param text "line"或"length"
+     * @param framing 输出分帧方式
+     * @return 名称有效时返回true
+     */
+    static bool parseFraming(const std::string& text, TcpFraming& framing);
+
+    /**
+     * @brief 展开配置文本中的转义序列（\n、\r、\t、\\、\xHH）
+     * @param text 配置文本
+     * @return 展开后的字节串
+     */
+    static std::string unescape(const std::string& text);
+};
+
+/**
+ * @brief 判断URL是否使用原始TCP模式
+ * @param url 测试URL
+ * @return 以tcp://或tcps://开头时返回true
+ */
+bool isTcpUrl(const std::string& url);
+
+/**
+ * @class TcpTransport
+ * @brief 在一个持久TCP连接上按模板发出请求、按分帧匹配响应的传输策略
+ *
+ * 连接由libcurl以CONNECT_ONLY建立，收发走curl_easy_send/curl_easy_recv，
+ * 因此同样支持TLS并能读取建连耗时。每次perform()先把未应答的请求补足到流水线深度，
+ * 再等待最早的一个响应，返回它从发出到收到的耗时；响应按发送顺序匹配。
+ * 建连与等待都在私有multi句柄上进行，阻塞在curl_multi_poll上，取消源唤醒后立即返回。
+ * 连接出错或超时后，其余未应答的请求在随后的perform()中逐个以同一错误码返回，之后才重新建连。
+ * 结束时每个连接最多有pipelineDepth-1个已发出的请求不再等待响应。
+ */
+class TcpTransport {
+public:
+    /**
+     * @brief 构造函数
+     * @param url tcp://主机:端口 或 tcps://主机:端口
+     * @param options 分帧与流水线配置
+     * @param timeoutMs 建连与等待单个响应的超时(毫秒)
+     * @param connectionIndex 连接序号，用于模板中的{conn}
+     * @param cancellation 取消源，nullptr表示等待不可中断
+     */
+    TcpTransport(const std::string& url, const TcpOptions& options, int timeoutMs, int connectionIndex,
+                 CancellationSource* cancellation = nullptr);
+    ~TcpTransport();
+
+    TcpTransport(TcpTransport&& other) noexcept;
+    TcpTransport(const TcpTransport&) = delete;
+    TcpTransport& operator=(const TcpTransport&) = delete;
+    TcpTransport& operator=(TcpTransport&&) = delete;
+
+    /**
+     * @brief 补足流水线并等待最早一个请求的响应
+     * @return 响应匹配时状态码记为200；连接失败、断开或超时时为对应的CURLcode
+     */
+    TransferResult perform();
+
+private:
+    /**
+     * @brief 请求模板的一段：字面量或占位符
+     */
+    struct TemplatePart {
+        enum Kind { LITERAL, SEQUENCE, CONNECTION } kind;
+        std::string text;
+    };
+
+    /**
+     * @brief 一个已发出、尚未应答的请求
+     */
+    struct OutstandingRequest {
+        std::chrono::steady_clock::time_point sentAt;   ///< 发出时刻
+        size_t bytes;                                   ///< 请求帧字节（含长度头）
+    };
+
+    bool connect(TransferResult& result);
+    CURLcode connectCancellable(bool& cancelled);
+    void disconnect();
+    void failPipeline(CURLcode code, bool cancelled);
+    TransferResult takeFailed();
+    void appendRequest();
+    CURLcode flushSend();
+    bool extractResponse(size_t& frameBytes);
+    CURLcode receiveSome();
+    bool waitSocket(int events, int waitMs, bool& cancelled);
+
+    std::string curlUrl;                    ///< 交给libcurl建连的URL
+    TcpOptions options;                     ///< 分帧与流水线配置
+    std::vector<TemplatePart> parts;        ///< 预先拆分的请求模板
+    int timeoutMs;                          ///< 超时(毫秒)
+    int connectionIndex;                    ///< 连接序号
+    CancellationSource* cancel;             ///< 取消源（可为空）
+    CURLM* multi;                           ///< 私有multi句柄，只用于可唤醒的等待
+    CURL* curl;                             ///< CONNECT_ONLY句柄，断开时为空
+    curl_socket_t socket;                   ///< 已建立连接的套接字
+    uint64_t sequence;                      ///< 连接内的请求序号
+    uint64_t connectionsOpened;             ///< 建立过的连接数
+    std::string sendBuffer;                 ///< 待发送的字节
+    size_t sendOffset;                      ///< 已发送到的位置
+    std::string recvBuffer;                 ///< 已收到但未解析的字节
+    size_t recvOffset;                      ///< 已解析到的位置
+    std::deque<OutstandingRequest> outstanding; ///< 未应答的请求，按发出顺序
+    std::deque<OutstandingRequest> failed;  ///< 随连接一起失败、尚未返回结果的请求
+    CURLcode failedCode;                    ///< 这些请求的错误码
+    bool failedCancelled;                   ///< 失败是否由取消引起
+    std::chrono::steady_clock::time_point failedAt; ///< 发现失败的时刻
+    TransferResult pendingConnect;          ///< 新建连接的耗时，计入下一个返回的结果
+};
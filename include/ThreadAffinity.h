@@ -0,0 +1,53 @@
+/**
+ * @file ThreadAffinity.h
+ * @brief 线程CPU亲和性与NUMA拓扑工具函数
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * @struct AffinityOptions
+ * @brief 测试线程的CPU放置策略，核心编号为-1或列表为空表示不绑定
+ */
+struct AffinityOptions {
+    std::vector<int> workerCores;   ///< 工作线程依次轮流绑定的核心列表
+    int aggregatorCore = -1;        ///< 聚合线程绑定的核心
+    int exporterCore = -1;          ///< 导出(日志写盘)线程绑定的核心
+
+    /**
+     * @brief 是否设置了任何绑定
+     */
+    bool enabled() const {
+        return !workerCores.empty() || aggregatorCore >= 0 || exporterCore >= 0;
+    }
+};
+
+/**
+ * @brief 解析核心列表字符串，例如 "0-3,8,10-11"
+ * @param text 核心列表字符串
+ * @param badToken 非空时写入第一个被拒绝的片段（格式错误、负数或超出本机核心数）
+ * @return 核心编号列表，被拒绝的片段不计入
+ */
+std::vector<int> parseCoreList(const std::string& text, std::string* badToken = nullptr);
+
+/**
+ * @brief 将当前线程绑定到指定核心
+ * @param core 核心编号，小于0时不做任何操作
+ * @return 如果绑定成功（或无需绑定）返回true
+ */
+bool pinCurrentThread(int core);
+
+/**
+ * @brief 获取当前线程正在运行的核心
+ * @return 核心编号，无法获取时返回-1
+ */
+int currentCpu();
+
+/**
+ * @brief 获取核心所属的NUMA节点
+ * @param core 核心编号
+ * @return NUMA节点编号，无法获取或非NUMA系统返回0
+ */
+int numaNodeOfCpu(int core);
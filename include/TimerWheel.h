@@ -0,0 +1,135 @@
+/**
+ * @file TimerWheel.h
+ * @brief 分层时间轮定时器的声明
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @struct TimerStats
+ * @brief 定时器精度统计：实际触发时间相对到期时间的延迟
+ */
+struct TimerStats {
+    uint64_t firedTimers = 0;       ///< 已触发的定时器数
+    uint64_t lateTimers = 0;        ///< 延迟超过一个刻度的定时器数
+    int64_t totalLatenessNs = 0;    ///< 延迟总和(纳秒)
+    int64_t maxLatenessNs = 0;      ///< 最大延迟(纳秒)
+
+    /**
+     * @brief 平均延迟(毫秒)
+     */
+    double meanLatenessMs() const {
+        return firedTimers > 0 ? totalLatenessNs / 1e6 / firedTimers : 0.0;
+    }
+
+    /**
+     * @brief 合并另一份统计
+     */
+    void merge(const TimerStats& other);
+};
+
+/**
+ * @class TimerWheel
+ * @brief 毫秒刻度的四层时间轮
+ *
+ * 每层256个槽，依次覆盖256毫秒、65秒、4.6小时和约50天；添加定时器和每个刻度的
+ * 推进都是O(1)，到达低层边界时把上一层对应槽中的定时器逐级下放。定时器不支持
+ * 取消，调用方在令牌中携带版本号，触发时自行判断是否已过期作废。
+ */
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 定时器触发回调
+     * @param token 添加定时器时传入的令牌
+     */
+    using Handler = std::function<void(uint64_t token)>;
+
+    /**
+     * @brief 构造函数
+     * @param origin 第0个刻度对应的时间
+     */
+    explicit TimerWheel(Clock::time_point origin = Clock::now());
+
+    /**
+     * @brief 添加定时器；到期时间早于当前刻度时在下一次推进时触发
+     * @param expiry 到期时间（向上取整到刻度）
+     * @param token 触发时传回的令牌
+     */
+    void schedule(Clock::time_point expiry, uint64_t token);
+
+    /**
+     * @brief 推进到指定时间并按到期顺序触发所有到期的定时器
+     * @param now 当前时间
+     * @param handler 触发回调（回调中可以继续添加定时器）
+     * @return 本次触发的定时器数
+     */
+    size_t advance(Clock::time_point now, const Handler& handler);
+
+    /**
+     * @brief 距离下一个可能到期的刻度的毫秒数
+     * @param now 当前时间
+     * @return 没有定时器时返回-1
+     */
+    int nextTimeoutMs(Clock::time_point now) const;
+
+    /**
+     * @brief 等待中的定时器数
+     */
+    size_t size() const { return pendingCount; }
+
+    /**
+     * @brief 获取定时器精度统计
+     */
+    const TimerStats& getStats() const { return stats; }
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 8;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const uint64_t SLOT_MASK = SLOTS - 1;
+
+    /**
+     * @brief 单个定时器
+     */
+    struct Timer {
+        uint64_t expiryTick;        ///< 到期刻度
+        uint64_t token;             ///< 调用方令牌
+    };
+
+    using Slot = std::vector<Timer>;
+
+    /**
+     * @brief 把定时器放入与当前刻度距离对应的层和槽
+     */
+    void insert(const Timer& timer);
+
+    /**
+     * @brief 把指定层当前槽中的定时器下放到低层
+     */
+    void cascade(int level);
+
+    /**
+     * @brief 把时间换算为刻度（向上取整）
+     */
+    uint64_t toTick(Clock::time_point time) const;
+
+    /**
+     * @brief 到指定时间为止已经完全过去的刻度数（向下取整）
+     */
+    uint64_t elapsedTicks(Clock::time_point time) const;
+
+private:
+    Clock::time_point origin;                               ///< 第0个刻度的时间
+    uint64_t currentTick;                                   ///< 已处理到的刻度
+    std::array<std::array<Slot, SLOTS>, LEVELS> wheels;     ///< 各层的槽
+    size_t pendingCount;                                    ///< 等待中的定时器数
+    Slot firing;                                            ///< 正在触发的定时器（复用缓冲）
+    TimerStats stats;                                       ///< 精度统计
+};
@@ -0,0 +1,179 @@
+/**
+ * @file Tracer.h
+ * @brief 热路径区间追踪与Chrome trace格式导出的声明
+ *
+ * 追踪只在定义了LOADTESTER_TRACING时编译进来（CMake选项LOADTESTER_TRACING）。
+ * 未定义时TRACE_SPAN和TRACE_THREAD_NAME展开为空语句，热路径上没有任何代码。
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef LOADTESTER_TRACING
+/// 记录从此处到作用域结束的区间，name必须是字符串字面量
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name)
+/// 为当前线程命名，显示在时间线的线程标题上
+#define TRACE_THREAD_NAME(name) Tracer::getInstance().setThreadName(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+/**
+ * @struct TraceEvent
+ * @brief 一个已结束的区间
+ */
+struct TraceEvent {
+    const char* name;       ///< 区间名称（字符串字面量，不复制）
+    int64_t startNs;        ///< 开始时刻(steady_clock纳秒)
+    int64_t durationNs;     ///< 持续时间(纳秒)
+};
+
+/**
+ * @class Tracer
+ * @brief 进程内的区间追踪器
+ *
+ * 每个线程第一次记录时领取一块定长缓冲区，此后只有该线程写入，发布时用
+ * release存储更新计数，导出方acquire读取计数，记录路径上不加锁。缓冲区写满后
+ * 丢弃新区间并计数。缓冲区在clear()之前不会被其他线程复用，导出时线程已退出也能读取。
+ */
+class Tracer {
+public:
+    /**
+     * @brief 获取单例实例
+     */
+    static Tracer& getInstance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief 编译时是否包含追踪
+     */
+    static constexpr bool compiledIn() {
+#ifdef LOADTESTER_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief 运行时开启或关闭记录
+     * @param enabled 是否记录
+     */
+    void setEnabled(bool enabled) { active.store(enabled, std::memory_order_relaxed); }
+
+    /**
+     * @brief 当前是否记录
+     */
+    static bool isActive() { return active.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 丢弃所有已记录的区间（测试开始前、没有线程在记录时调用）
+     */
+    void clear();
+
+    /**
+     * @brief 记录一个区间（由TraceSpan调用）
+     * @param name 区间名称
+     * @param startNs 开始时刻(纳秒)
+     * @param endNs 结束时刻(纳秒)
+     */
+    void record(const char* name, int64_t startNs, int64_t endNs);
+
+    /**
+     * @brief 为当前线程命名
+     * @param name 线程名称
+     */
+    void setThreadName(const std::string& name);
+
+    /**
+     * @brief 以Chrome trace / Perfetto可读的JSON格式写出所有区间
+     * @param filePath 输出文件路径
+     * @return 写入成功返回true
+     */
+    bool writeChromeTrace(const std::string& filePath) const;
+
+    /**
+     * @brief 已记录的区间数
+     */
+    uint64_t getEventCount() const;
+
+    /**
+     * @brief 因缓冲区写满而丢弃的区间数
+     */
+    uint64_t getDroppedCount() const;
+
+    /**
+     * @brief 当前时刻(steady_clock纳秒)
+     */
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    /**
+     * @struct ThreadBuffer
+     * @brief 单个线程的定长区间缓冲区
+     */
+    struct ThreadBuffer {
+        std::vector<TraceEvent> events;     ///< 预先分配的区间数组
+        std::atomic<size_t> count{0};       ///< 已发布的区间数
+        std::atomic<uint64_t> dropped{0};   ///< 丢弃的区间数
+        std::string threadName;             ///< 线程名称（受registryMutex保护）
+        int threadId = 0;                   ///< 导出时使用的线程编号
+        bool owned = false;                 ///< 是否仍被某个线程持有（受registryMutex保护）
+    };
+
+    struct BufferLease;
+
+    Tracer() = default;
+
+    /**
+     * @brief 获取当前线程的缓冲区，第一次调用时领取
+     */
+    ThreadBuffer* threadBuffer();
+
+    /**
+     * @brief 线程退出时归还缓冲区，数据保留到下一次clear()
+     */
+    void releaseBuffer(ThreadBuffer* buffer);
+
+    static std::atomic<bool> active;                        ///< 是否记录
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;     ///< 所有缓冲区
+    std::vector<ThreadBuffer*> freeBuffers;                 ///< 已清空、可领取的缓冲区
+    int nextThreadId = 1;                                   ///< 下一个线程编号
+    mutable std::mutex registryMutex;                       ///< 缓冲区登记互斥锁
+};
+
+/**
+ * @class TraceSpan
+ * @brief 作用域区间：构造时记下开始时刻，析构时记录整个区间
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* spanName)
+        : name(spanName), startNs(Tracer::isActive() ? Tracer::now() : -1) {}
+
+    ~TraceSpan() {
+        if (startNs >= 0) Tracer::getInstance().record(name, startNs, Tracer::now());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;   ///< 区间名称
+    int64_t startNs;    ///< 开始时刻，-1表示未记录
+};
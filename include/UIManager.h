@@ -33,6 +33,7 @@ private:
     // 常量
     static const int UPDATE_TIMER_ID = 1;
     static const int UPDATE_INTERVAL = 250;  // 毫秒
+    static const int NOTIFY_INTERVAL = 100;  // 状态通知最小间隔(毫秒)
     static const int MAX_VISIBLE_REQUESTS = 10; // 可视化请求列表的最大数量
 
     // 窗口和控件句柄
@@ -66,6 +67,9 @@ private:
     // UI状态
     bool updateTimerActive;
 
+    // 后台执行停止与收尾的线程，完成后投递WM_USER + 2
+    std::thread stopThread;
+
     // 窗口过程静态函数和静态实例指针
     static UIManager* instance;
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -76,7 +80,7 @@ private:
     bool createMainWindow();
     bool createControls();
     void initializeListView();
-    void updateListView(const RequestResult& result);
+    void updateListView(const std::vector<RequestResult>& results);
     void updateListView();
 
     // 对话框函数
@@ -89,6 +93,7 @@ private:
     LRESULT handleCommand(WPARAM wParam, LPARAM lParam);
     void handleStartTest();
     void handleStopTest();
+    void handleTestStopped();
     void handleViewLog();
     void handleExit();
 
@@ -96,7 +101,7 @@ private:
     void updateStatus(int completed, int total, double successRate);
     void showTestResults();
     void updateControlsState(bool testRunning);
-    void handleRequestResult(const RequestResult& result);
+    void handleStatusUpdate(const StatusUpdate& update);
 
     // 配置函数
     void saveCurrentConfig();
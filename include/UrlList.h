@@ -0,0 +1,182 @@
+/**
+ * @file UrlList.h
+ * @brief 内存映射的URL列表与按顺序、均匀随机、Zipf、无放回打乱选择URL的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+/**
+ * @enum UrlSelection
+ * @brief 从URL列表中选择下一个URL的方式
+ */
+enum class UrlSelection : uint8_t {
+    SEQUENTIAL,     ///< 所有线程共用一个游标按行顺序循环
+    RANDOM,         ///< 均匀随机（有放回）
+    ZIPF,           ///< Zipf分布：第k行被选中的概率正比于1/k^s，文件中越靠前越热
+    SHUFFLED        ///< 随机顺序无放回：每一轮每行恰好一次，下一轮换一个顺序
+};
+
+/**
+ * @struct UrlListOptions
+ * @brief URL列表配置，设置了文件时HTTP单请求模式每个请求从列表中取一个URL
+ */
+struct UrlListOptions {
+    std::string path;                               ///< URL列表文件，每行一个URL，空行和#开头的行忽略
+    UrlSelection selection = UrlSelection::SEQUENTIAL;  ///< 选择方式
+    double zipfSkew = 1.0;                          ///< Zipf指数s，不大于0时退化为均匀随机
+    uint64_t seed = 0;                              ///< 随机种子，0表示每次运行不同
+
+    /**
+     * @brief 是否启用URL列表
+     */
+    bool enabled() const { return !path.empty(); }
+
+    /**
+     * @brief 解析选择方式名称
+     * @param text "sequential"、"random"、"zipf"或"shuffled"
+     * @param selection 输出选择方式
+     * @return 名称有效时返回true
+     */
+    static bool parseSelection(const std::string& text, UrlSelection& selection);
+
+    /**
+     * @brief 选择方式的名称，用于日志
+     */
+    static const char* selectionName(UrlSelection selection);
+};
+
+/**
+ * @class UrlList
+ * @brief 只读映射的URL列表文件与行索引
+ *
+ * URL不复制到堆上：文件整体映射进地址空间，索引只为每行保存一个8字节条目
+ * （高40位为偏移，低24位为长度），一千万行约占80MB。索引由多个线程分段扫描换行符建立，
+ * 每段用SSE2每次比较16字节；映射在对象销毁前一直有效，line()返回的视图可随时使用。
+ */
+class UrlList {
+public:
+    static constexpr size_t MAX_LINES = 0x7FFFFFFF;             ///< 行数上限（受驻留编号范围约束）
+    static constexpr size_t MAX_LINE_LENGTH = (1u << 24) - 1;   ///< 单行长度上限，更长的行被跳过
+    static constexpr uint64_t MAX_FILE_BYTES = 1ull << 40;      ///< 文件大小上限
+
+    UrlList() = default;
+
+    UrlList(const UrlList&) = delete;
+    UrlList& operator=(const UrlList&) = delete;
+
+    /**
+     * @brief 映射文件并建立行索引
+     * @param filePath 文件路径
+     * @param error 失败时写入原因
+     * @return 成功且至少有一个URL时返回true
+     */
+    bool open(const std::string& filePath, std::string& error);
+
+    /**
+     * @brief URL条数
+     */
+    size_t size() const { return entries.size(); }
+
+    /**
+     * @brief 第index个URL（不含行尾和首尾空白）
+     */
+    std::string_view line(size_t index) const {
+        uint64_t entry = entries[index];
+        return std::string_view(file.data() + (entry >> 24), static_cast<size_t>(entry & MAX_LINE_LENGTH));
+    }
+
+    /**
+     * @brief 映射的文件大小(字节)
+     */
+    uint64_t getFileBytes() const { return file.size(); }
+
+    /**
+     * @brief 因超过长度上限被跳过的行数
+     */
+    size_t getSkippedLines() const { return skippedLines; }
+
+private:
+    /**
+     * @brief 解除映射并清空索引
+     */
+    void close();
+
+    MappedFile file;                    ///< 映射的文件
+    std::vector<uint64_t> entries;      ///< 每行的偏移与长度
+    size_t skippedLines = 0;            ///< 被跳过的超长行
+};
+
+/**
+ * @class UrlPicker
+ * @brief 单个工作线程从URL列表中选择下一行
+ *
+ * 顺序与无放回模式通过所有线程共用的原子游标协调，保证全局按行循环、每轮不重复；
+ * 随机与Zipf模式只用本线程的随机数发生器，不访问共享状态。
+ * Zipf采用拒绝-反演采样，打乱采用以轮次为密钥的Feistel置换，都不需要按行数分配的表，
+ * 一千万行的列表也不增加启动时间和内存。
+ */
+class UrlPicker {
+public:
+    /**
+     * @brief 构造函数
+     * @param urlList URL列表（生命周期须长于本对象）
+     * @param options 选择方式、Zipf指数与种子
+     * @param sharedCursor 所有线程共用的游标，测试开始时清零
+     * @param workerIndex 工作线程序号，用于区分各线程的随机序列
+     */
+    UrlPicker(const UrlList& urlList, const UrlListOptions& options, std::atomic<uint64_t>& sharedCursor,
+              int workerIndex);
+
+    /**
+     * @brief 选择下一行
+     * @return 行号
+     */
+    size_t next();
+
+    /**
+     * @brief 所属的URL列表
+     */
+    const UrlList& getList() const { return list; }
+
+private:
+    /**
+     * @brief [0, size)内均匀分布的行号
+     */
+    size_t uniform();
+
+    /**
+     * @brief 按Zipf分布抽取的排名，1为最热
+     */
+    size_t zipfRank();
+
+    /**
+     * @brief 第pass轮打乱顺序中位置position上的行号
+     */
+    size_t shuffled(uint64_t position, uint64_t pass) const;
+
+    /**
+     * @brief Zipf拒绝-反演采样的辅助函数，见Hörmann与Derflinger(1996)
+     */
+    double zipfH(double x) const;
+    double zipfHIntegral(double x) const;
+    double zipfHIntegralInverse(double x) const;
+
+    const UrlList& list;                ///< URL列表
+    UrlSelection selection;             ///< 选择方式
+    std::atomic<uint64_t>& cursor;      ///< 共用游标
+    uint64_t seed;                      ///< 打乱顺序的密钥种子
+    std::mt19937_64 rng;                ///< 本线程的随机数发生器
+    double skew;                        ///< Zipf指数
+    double hIntegralX1 = 0;             ///< H(1.5) - 1
+    double hIntegralN = 0;              ///< H(n + 0.5)
+    double acceptThreshold = 0;         ///< 免检接受的阈值
+    unsigned halfBits = 1;              ///< Feistel置换每半边的位数
+};
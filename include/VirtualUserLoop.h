@@ -0,0 +1,260 @@
+/**
+ * @file VirtualUserLoop.h
+ * @brief 基于curl multi事件循环的虚拟用户运行时的声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "ContentDecoding.h"
+#include "EventLoopBase.h"
+#include "RateLimiter.h"
+#include "RequestResult.h"
+#include "Scenario.h"
+#include "TimerWheel.h"
+#include "UrlList.h"
+
+/**
+ * @struct ThinkTime
+ * @brief 思考时间分布
+ */
+struct ThinkTime {
+    /**
+     * @enum Distribution
+     * @brief 分布类型
+     */
+    enum class Distribution {
+        FIXED,          ///< 固定为ms
+        UNIFORM,        ///< 在[ms, maxMs]内均匀分布
+        EXPONENTIAL     ///< 均值为ms的指数分布（泊松到达）
+    };
+
+    Distribution distribution = Distribution::FIXED;   ///< 分布类型
+    int ms = 0;                                         ///< 固定值、均匀分布下限或指数分布均值(毫秒)
+    int maxMs = 0;                                      ///< 均匀分布上限(毫秒)
+
+    /**
+     * @brief 抽取一次思考时间
+     * @param rng 随机数发生器
+     * @return 思考时间(毫秒)
+     */
+    int64_t sample(std::mt19937_64& rng) const;
+
+    /**
+     * @brief 从名称解析分布类型（fixed/uniform/exponential），无法识别时为FIXED
+     */
+    static Distribution parseDistribution(const std::string& name);
+};
+
+/**
+ * @struct VirtualUserOptions
+ * @brief 虚拟用户模式配置，virtualUsers为0表示使用传统的每线程同步请求模式
+ */
+struct VirtualUserOptions {
+    int virtualUsers = 0;           ///< 虚拟用户总数
+    ThinkTime thinkTime;            ///< 两次请求之间的思考时间
+    int pacingMs = 0;               ///< 固定节奏：相邻两次迭代（事务或单个请求）开始的间隔(毫秒)，大于0时代替思考时间
+    int rampUpMs = 0;               ///< 所有虚拟用户在该时长内均匀启动(毫秒)
+    int durationMs = 0;             ///< 阶段时长：超过后不再发起新请求(毫秒)，0表示不限
+
+    /**
+     * @brief 是否启用虚拟用户模式
+     */
+    bool enabled() const { return virtualUsers > 0; }
+};
+
+/**
+ * @class VirtualUserLoop
+ * @brief 在单个线程中复用一组虚拟用户
+ *
+ * 每个虚拟用户是一个很小的状态机（空闲 -> 请求中 -> 思考中），只持有
+ * 一个可复用的curl easy句柄；等待I/O和思考时间时不占用线程。句柄连同保持的
+ * 连接约占8KB堆内存，TLS连接约60KB（另有内核套接字缓冲区）；句柄不在用户之间
+ * 共享，以保留各自的连接与Cookie罐。所有虚拟用户
+ * 的传输由同一个curl multi句柄驱动，思考时间、请求截止时间和阶段超时都由
+ * 同一个分层时间轮调度，少量事件循环线程即可承载上万并发会话。
+ */
+class VirtualUserLoop : public EventLoopBase {
+public:
+    /**
+     * @brief 请求发起前调用，返回请求ID；返回值小于等于0表示不再发起新请求
+     * @param lagNs 实际发起时刻晚于计划时刻（思考时间、节奏或限流结束）的纳秒数
+     */
+    using DispatchHandler = std::function<int(int64_t lagNs)>;
+
+    /**
+     * @brief 请求完成时调用
+     * @param easy 完成的curl句柄（可用于curl_easy_getinfo）
+     * @param result 传输结果，超过截止时间为CURLE_OPERATION_TIMEDOUT
+     * @param requestId 发起时分配的请求ID
+     * @param endpoint 请求URL（场景模式下为步骤URL模板）的驻留编号
+     * @param elapsedNs 响应时间(纳秒)
+     * @param decoder 本次响应的解码计数，未协商压缩时为nullptr
+     */
+    using CompletionHandler = std::function<void(CURL* easy, CURLcode result, int requestId, uint32_t endpoint,
+                                                 int64_t elapsedNs, const ContentDecoder* decoder)>;
+
+    /**
+     * @brief 构造函数
+     * @param firstUserId 本循环第一个虚拟用户的全局编号
+     * @param userCount 本循环负责的虚拟用户数
+     * @param totalUsers 所有循环的虚拟用户总数（用于计算爬坡启动时间）
+     * @param options 虚拟用户配置
+     * @param requestTimeoutMs 单个请求的截止时间(毫秒)
+     */
+    VirtualUserLoop(int firstUserId, int userCount, int totalUsers, const VirtualUserOptions& options,
+                    int requestTimeoutMs);
+    ~VirtualUserLoop();
+
+    VirtualUserLoop(const VirtualUserLoop&) = delete;
+    VirtualUserLoop& operator=(const VirtualUserLoop&) = delete;
+
+    /**
+     * @brief 让每个虚拟用户循环执行多步骤场景（在run()之前调用）
+     * @param scenario 场景，nullptr表示每次请求都是对run()中URL的单个GET
+     */
+    void setScenario(const Scenario* scenario);
+
+    /**
+     * @brief 发起请求前向限流器取令牌（在run()之前调用）
+     * @param limiter 共享的限流器，nullptr表示不限流；被推迟的用户按等待时间重新排入时间轮
+     */
+    void setRateLimiter(RateLimiter* limiter) { rateLimiter = limiter; }
+
+    /**
+     * @brief 协商响应压缩（在run()之前调用）
+     *
+     * 单请求模式下每个用户自带解码器，由它解码并统计线路字节与解码耗时；
+     * 场景模式需要解码后的响应体做提取，交给curl自动解码，不统计解码开销。
+     * @param options Accept-Encoding配置
+     */
+    void setCompression(const CompressionOptions& options) { compression = options; }
+
+    /**
+     * @brief 单请求模式下每个请求从URL列表中选一个URL（在run()之前调用）
+     * @param picker 本循环的URL选择器，nullptr表示只请求run()中的URL；场景模式下忽略
+     */
+    void setUrlPicker(UrlPicker* picker) { urlPicker = picker; }
+
+    /**
+     * @brief run()因停止而返回时仍在进行中、被放弃的请求数
+     */
+    int getCancelledCount() const { return cancelledCount; }
+
+    /**
+     * @brief 在当前线程运行事件循环，直到running为false或所有虚拟用户结束
+     * @param url 请求URL
+     * @param running 运行标志
+     * @param dispatch 请求发起回调
+     * @param complete 请求完成回调
+     */
+    void run(const std::string& url, const std::atomic<bool>& running,
+             const DispatchHandler& dispatch, const CompletionHandler& complete);
+
+    /**
+     * @brief 获取本循环的定时器精度统计
+     */
+    const TimerStats& getTimerStats() const { return timers.getStats(); }
+
+    /**
+     * @brief 获取本循环的场景分步统计（未设置场景时为空）
+     */
+    const ScenarioStats& getScenarioStats() const { return scenarioStats; }
+
+private:
+    /**
+     * @enum UserState
+     * @brief 虚拟用户状态
+     */
+    enum class UserState : uint8_t {
+        WAITING,    ///< 等待启动或思考中
+        IN_FLIGHT,  ///< 请求进行中
+        FINISHED    ///< 不再发起请求
+    };
+
+    /**
+     * @enum TimerKind
+     * @brief 定时器用途，编码在令牌中
+     */
+    enum class TimerKind : uint8_t {
+        WAKE,       ///< 思考时间结束
+        DEADLINE,   ///< 请求截止时间
+        PHASE       ///< 阶段超时
+    };
+
+    /**
+     * @struct VirtualUser
+     * @brief 单个虚拟用户的全部状态
+     */
+    struct VirtualUser {
+        CURL* easy = nullptr;                                   ///< 复用的curl句柄（保持连接）
+        std::chrono::steady_clock::time_point requestStart;     ///< 当前请求的开始时间
+        std::chrono::steady_clock::time_point intendedStart;    ///< 下一个请求的计划发起时间
+        std::chrono::steady_clock::time_point iterationStart;   ///< 当前迭代的计划开始时间，固定节奏从它计时
+        std::unique_ptr<ScenarioSession> session;               ///< 场景会话（仅场景模式）
+        std::unique_ptr<ContentDecoder> decoder;                ///< 响应解码计数（仅协商压缩的单请求模式）
+        int requestId = 0;                                      ///< 当前请求ID
+        uint32_t endpoint = 0;                                  ///< 当前请求URL的驻留编号（仅URL列表）
+        uint32_t generation = 0;                                ///< 状态版本号，用于作废过期定时器
+        UserState state = UserState::WAITING;                   ///< 当前状态
+    };
+
+    /**
+     * @brief 生成定时器令牌
+     */
+    static uint64_t makeToken(TimerKind kind, size_t userIndex, uint32_t generation);
+
+    /**
+     * @brief 处理一个到期的定时器
+     */
+    void onTimer(uint64_t token, const DispatchHandler& dispatch, const CompletionHandler& complete);
+
+    /**
+     * @brief 安排虚拟用户在指定时刻醒来，该时刻即下一个请求的计划发起时间
+     */
+    void scheduleWake(size_t userIndex, std::chrono::steady_clock::time_point wakeAt);
+
+    /**
+     * @brief 为空闲的虚拟用户发起下一个请求
+     */
+    void startRequest(size_t userIndex, const DispatchHandler& dispatch);
+
+    /**
+     * @brief 结束虚拟用户当前的请求并安排下一次请求
+     */
+    void finishRequest(size_t userIndex, CURLcode result, const CompletionHandler& complete,
+                       const DispatchHandler& dispatch);
+
+    /**
+     * @brief 处理multi句柄上完成的传输
+     */
+    void collectCompleted(const CompletionHandler& complete, const DispatchHandler& dispatch);
+
+private:
+    CURLM* multi;                       ///< curl multi句柄
+    std::vector<VirtualUser> users;     ///< 本循环的虚拟用户
+    int firstUserId;                    ///< 本循环第一个虚拟用户的全局编号
+    const Scenario* scenario;           ///< 多步骤场景
+    RateLimiter* rateLimiter;           ///< 限流器（可为空）
+    CompressionOptions compression;     ///< 压缩协商配置
+    curl_slist* encodingHeader;         ///< 所有用户共用的Accept-Encoding请求头
+    int cancelledCount;                 ///< 停止时被放弃的请求数
+    ScenarioStats scenarioStats;        ///< 场景分步统计
+    std::vector<uint32_t> stepEndpoints; ///< 各步骤URL模板的驻留编号
+    uint32_t urlEndpoint;               ///< 单请求模式URL的驻留编号
+    UrlPicker* urlPicker;               ///< URL列表选择器（可为空）
+    std::string urlBuffer;              ///< 从列表取出的URL，设置给curl前的暂存
+    TimerWheel timers;                  ///< 思考时间、截止时间和阶段超时
+    VirtualUserOptions options;         ///< 虚拟用户配置
+    std::chrono::milliseconds requestTimeout; ///< 单个请求的截止时间
+    std::mt19937_64 rng;                ///< 思考时间随机数发生器
+    int inFlight;                       ///< 进行中的请求数
+    bool accepting;                     ///< 是否仍允许发起新请求
+};
@@ -0,0 +1,236 @@
+/**
+ * @file WebSocketLoop.h
+ * @brief 在单个线程中维持大量WebSocket连接并按速率收发消息的事件循环声明
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+#include "BasicLoadTester.h"
+#include "DDSketch.h"
+#include "EventLoopBase.h"
+#include "TimerWheel.h"
+
+/**
+ * @struct WebSocketOptions
+ * @brief WebSocket模式配置，URL为ws://时启用
+ */
+struct WebSocketOptions {
+    int connections = 0;                    ///< 连接总数，0表示每个工作线程一个
+    int messageIntervalMs = 1000;           ///< 每个连接发送消息的间隔(毫秒)
+    std::string payload = "ping {id}";      ///< 消息模板，{id}替换为"连接序号.消息序号"，{seq}为消息序号，{conn}为连接序号
+    bool correlate = false;                 ///< 按回复中包含的{id}匹配（模板不含{id}时无效）；否则回复按发送顺序匹配最早的未应答消息（回显）
+    int rampUpMs = 0;                       ///< 所有连接在该时长内均匀建立(毫秒)
+};
+
+/**
+ * @struct WebSocketStats
+ * @brief 连接建立、断开与消息计数
+ */
+struct WebSocketStats {
+    uint64_t opened = 0;            ///< 完成升级的连接数
+    uint64_t failed = 0;            ///< 建连或升级失败的连接数
+    uint64_t dropped = 0;           ///< 打开后被对端关闭或出错断开的连接数
+    uint64_t messagesSent = 0;      ///< 发出的消息数
+    uint64_t unmatchedReplies = 0;  ///< 没有对应未应答消息的服务端消息数
+    DDSketch connectLatency;        ///< TCP建连耗时(毫秒)
+    DDSketch upgradeLatency;        ///< 从开始建连到收到101的耗时(毫秒)
+
+    /**
+     * @brief 合并另一份统计
+     */
+    void merge(const WebSocketStats& other);
+};
+
+/**
+ * @brief 判断URL是否使用WebSocket模式
+ * @param url 测试URL
+ * @return 以ws://或wss://开头时返回true
+ */
+bool isWebSocketUrl(const std::string& url);
+
+/**
+ * @class WebSocketLoop
+ * @brief 在单个线程中维持一组WebSocket连接
+ *
+ * 每个连接只是一个非阻塞套接字和一个很小的状态机（建连 -> 升级 -> 打开 -> 关闭），
+ * 接收走所有连接共用的缓冲区，只有跨越两次接收的不完整帧才复制到连接自己的缓冲区，
+ * 因此空闲连接不持有堆内存，几万个空闲连接只占用几MB；帧的编解码在本类中完成，
+ * 不为每个连接创建curl句柄（本项目使用的libcurl也未启用ws协议）。套接字登记在常驻的就绪集合中，
+ * 只在关注的事件变化时更新：Linux上是epoll，epoll描述符作为curl_multi_poll唯一的附加描述符等待，
+ * 醒来后只取回就绪的连接；其他平台维护一份原地增删的curl_waitfd数组。两种方式都可以像虚拟用户循环
+ * 一样被取消源唤醒。发送节奏、连接爬坡、建连升级超时和回复超时都由同一个分层时间轮调度，
+ * 每个连接最多挂一个回复超时定时器（对应最早的未应答消息），不再定期扫描所有连接。
+ * 连接打开后在[0, 发送间隔)内随机错开第一条消息，之后按固定间隔发送；断开的连接不重连。
+ * 只支持明文ws://。
+ */
+class WebSocketLoop : public EventLoopBase {
+public:
+    /**
+     * @brief 发送消息前调用，返回请求ID；返回值小于等于0表示不再发送新消息
+     * @param lagNs 实际发送时刻晚于计划时刻的纳秒数
+     */
+    using DispatchHandler = std::function<int(int64_t lagNs)>;
+
+    /**
+     * @brief 消息得到回复、超时、连接断开或被取消时调用
+     * @param requestId 发送时分配的请求ID
+     * @param result 往返耗时与结果，回复超时为CURLE_OPERATION_TIMEDOUT，连接断开为CURLE_RECV_ERROR
+     */
+    using CompletionHandler = std::function<void(int requestId, const TransferResult& result)>;
+
+    /**
+     * @brief 构造函数
+     * @param firstIndex 本循环第一个连接的全局序号
+     * @param connectionCount 本循环负责的连接数
+     * @param totalConnections 所有循环的连接总数（用于计算爬坡时间）
+     * @param options WebSocket配置
+     * @param requestTimeoutMs 建连、升级与等待回复的超时(毫秒)
+     */
+    WebSocketLoop(int firstIndex, int connectionCount, int totalConnections, const WebSocketOptions& options,
+                  int requestTimeoutMs);
+    ~WebSocketLoop();
+
+    WebSocketLoop(const WebSocketLoop&) = delete;
+    WebSocketLoop& operator=(const WebSocketLoop&) = delete;
+
+    /**
+     * @brief run()因停止而返回时仍未得到回复、被放弃的消息数
+     */
+    int getCancelledCount() const { return cancelledCount; }
+
+    /**
+     * @brief 在当前线程运行事件循环，直到running为false或不再有消息可发且没有未应答的消息
+     * @param url ws://主机[:端口][/路径]
+     * @param running 运行标志
+     * @param dispatch 消息发送回调
+     * @param complete 消息结束回调
+     */
+    void run(const std::string& url, const std::atomic<bool>& running,
+             const DispatchHandler& dispatch, const CompletionHandler& complete);
+
+    /**
+     * @brief 获取本循环的连接与消息统计
+     */
+    const WebSocketStats& getStats() const { return stats; }
+
+    /**
+     * @brief 获取本循环的定时器精度统计
+     */
+    const TimerStats& getTimerStats() const { return timers.getStats(); }
+
+private:
+    /**
+     * @enum ConnectionState
+     * @brief 连接状态
+     */
+    enum class ConnectionState : uint8_t {
+        WAITING,    ///< 等待爬坡时间到达
+        CONNECTING, ///< 非阻塞connect进行中
+        UPGRADING,  ///< 已发送升级请求，等待101
+        OPEN,       ///< 可以收发消息
+        CLOSED      ///< 已关闭（失败、断开或结束）
+    };
+
+    /**
+     * @enum TimerKind
+     * @brief 定时器用途，编码在令牌中
+     */
+    enum class TimerKind : uint8_t {
+        CONNECT,    ///< 爬坡时间到达，开始建连
+        SEND,       ///< 发送下一条消息
+        HANDSHAKE,  ///< 建连与升级的截止时刻
+        REPLY       ///< 最早的未应答消息的截止时刻
+    };
+
+    /**
+     * @struct ReadySocket
+     * @brief 一次等待中就绪的连接
+     */
+    struct ReadySocket {
+        size_t index;               ///< 连接下标
+        short events;               ///< 就绪事件（CURL_WAIT_POLLIN/CURL_WAIT_POLLOUT）
+    };
+
+    /**
+     * @struct PendingMessage
+     * @brief 一条未应答的消息
+     */
+    struct PendingMessage {
+        uint64_t sequence;          ///< 消息序号
+        int requestId;              ///< 请求ID
+        std::chrono::steady_clock::time_point sentAt;   ///< 发送时刻
+        size_t bytes;               ///< 消息负载字节
+    };
+
+    /**
+     * @struct Connection
+     * @brief 单个连接的全部状态，空闲时不持有堆内存
+     */
+    struct Connection {
+        curl_socket_t socket = CURL_SOCKET_BAD;             ///< 套接字
+        std::chrono::steady_clock::time_point connectStart; ///< 开始建连的时刻
+        std::chrono::steady_clock::time_point nextSend;     ///< 下一条消息的计划发送时刻
+        std::string inbound;                                ///< 跨越多次接收的不完整帧
+        std::string outbound;                               ///< 未发出的出站字节
+        std::string message;                                ///< 分片消息的已收部分
+        std::vector<PendingMessage> pending;                ///< 未应答的消息，按发送顺序
+        uint64_t sequence = 0;                              ///< 下一条消息的序号
+        uint32_t watchSlot = 0;                             ///< 在curl_waitfd数组中的位置（非Linux）
+        short watchedEvents = 0;                            ///< 已登记的关注事件，0表示未登记
+        ConnectionState state = ConnectionState::WAITING;   ///< 当前状态
+        bool replyTimerArmed = false;                       ///< 是否已有回复超时定时器
+    };
+
+    static uint64_t makeToken(TimerKind kind, size_t index);
+    bool resolve(const std::string& url);
+    void onTimer(uint64_t token, const DispatchHandler& dispatch, const CompletionHandler& complete);
+    void startConnect(size_t index, const CompletionHandler& complete);
+    void onConnected(size_t index, const CompletionHandler& complete);
+    void sendMessage(size_t index, const DispatchHandler& dispatch, const CompletionHandler& complete);
+    void queueFrame(Connection& connection, uint8_t opcode, const char* data, size_t length);
+    bool flush(Connection& connection);
+    void onReadable(size_t index, const CompletionHandler& complete);
+    size_t consume(size_t index, const char* data, size_t length, const CompletionHandler& complete);
+    void onMessage(Connection& connection, const char* data, size_t length, const CompletionHandler& complete);
+    void armReplyTimer(size_t index);
+    void expireReplies(size_t index, std::chrono::steady_clock::time_point now, const CompletionHandler& complete);
+    void watch(size_t index);
+    void unwatch(size_t index);
+    void waitForSockets(int timeoutMs);
+    void closeConnection(size_t index, CURLcode reason, const CompletionHandler& complete);
+    std::string renderPayload(size_t index, uint64_t sequence) const;
+    std::string messageId(size_t index, uint64_t sequence) const;
+
+private:
+    CURLM* multi;                       ///< 只用于可唤醒等待的multi句柄
+    std::vector<Connection> connections; ///< 本循环的连接
+    int firstConnection;                ///< 本循环第一个连接的全局序号
+    WebSocketOptions options;           ///< WebSocket配置
+    std::chrono::milliseconds timeout;  ///< 建连、升级与回复超时
+    std::chrono::milliseconds interval; ///< 消息发送间隔
+    std::string upgradeRequest;         ///< 预先生成的升级请求（不含密钥行）
+    std::vector<char> address;          ///< 解析得到的对端地址(sockaddr)
+    int addressFamily;                  ///< 地址族
+    std::vector<char> readBuffer;       ///< 所有连接共用的接收缓冲区
+#ifdef __linux__
+    int readiness;                      ///< 常驻的epoll就绪集合
+#else
+    std::vector<curl_waitfd> waitFds;   ///< 常驻的等待集合，关闭的连接与末尾交换后移除
+    std::vector<size_t> waitIndexes;    ///< waitFds对应的连接下标
+#endif
+    std::vector<ReadySocket> ready;     ///< 本轮就绪的连接
+    TimerWheel timers;                  ///< 爬坡、发送节奏与各类超时
+    std::mt19937_64 rng;                ///< 掩码与密钥的随机数
+    int cancelledCount;                 ///< 停止时被放弃的消息数
+    size_t inFlight;                    ///< 所有连接上未应答的消息数
+    size_t activeConnections;           ///< 尚未关闭的连接数（含等待建连的）
+    bool accepting;                     ///< 是否还会发送新消息
+    WebSocketStats stats;               ///< 连接与消息统计
+};
@@ -0,0 +1,477 @@
+/**
+ * @file AccessLogReplay.cpp
+ * @brief 访问日志解析、回放排程与回放事件循环的实现
+ */
+#include "../include/AccessLogReplay.h"
+#include "../include/Tracer.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+const int STARVED_POLL_MS = 1;          // 解析线程尚未跟上时的等待
+const int64_t NS_PER_SECOND = 1000000000;
+
+// 读取text[pos, pos+count)上的十进制数字
+bool readDigits(std::string_view text, size_t pos, size_t count, int& value) {
+    value = 0;
+    for (size_t i = pos; i < pos + count; ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+int monthFromName(std::string_view name) {
+    static const char* const names[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    for (int i = 0; i < 12; ++i) {
+        if (name == names[i]) return i + 1;
+    }
+    return 0;
+}
+
+// 公历日期到1970-01-01的天数，见Howard Hinnant的days_from_civil
+int64_t daysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// 查找结束引号：前面紧跟奇数个反斜杠的引号是被转义的
+const char* findQuote(const char* begin, const char* end) {
+    const char* p = begin;
+    while ((p = findByte(p, end, '"')) != end) {
+        size_t slashes = 0;
+        for (const char* q = p; q > begin && q[-1] == '\\'; --q) slashes++;
+        if (slashes % 2 == 0) return p;
+        ++p;
+    }
+    return end;
+}
+
+// 代理日志中的绝对形式（http://host/path）只保留路径部分
+std::string_view originForm(std::string_view target) {
+    if (!target.empty() && target[0] == '/') return target;
+    size_t scheme = target.find("://");
+    if (scheme == std::string_view::npos || target.compare(0, 4, "http") != 0) return {};
+    size_t path = target.find('/', scheme + 3);
+    return path == std::string_view::npos ? std::string_view("/") : target.substr(path);
+}
+
+// 还原日志对引号字段的转义：Apache写作\"与\\，nginx写作\xHH
+void assignUnescaped(std::string& output, std::string_view text) {
+    output.clear();
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 >= text.size()) {
+            output.push_back(text[i]);
+        } else if (text[i + 1] == 'x' && i + 3 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 2])) &&
+                   std::isxdigit(static_cast<unsigned char>(text[i + 3]))) {
+            auto hex = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : (c | 0x20) - 'a' + 10; };
+            output.push_back(static_cast<char>(hex(text[i + 2]) * 16 + hex(text[i + 3])));
+            i += 3;
+        } else {
+            output.push_back(text[++i]);
+        }
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- AccessLogParser
+
+bool AccessLogParser::parseTimestamp(std::string_view text, int64_t& epochSeconds) {
+    // 10/Oct/2000:13:55:36 -0700，时区可省略（按UTC）
+    if (text.size() != 20 && text.size() != 26) return false;
+    if (text[2] != '/' || text[6] != '/' || text[11] != ':' || text[14] != ':' || text[17] != ':') return false;
+    int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+    int month = monthFromName(text.substr(3, 3));
+    if (month == 0 || !readDigits(text, 0, 2, day) || !readDigits(text, 7, 4, year) ||
+        !readDigits(text, 12, 2, hour) || !readDigits(text, 15, 2, minute) || !readDigits(text, 18, 2, second)) {
+        return false;
+    }
+    if (day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) return false;
+
+    int offsetSeconds = 0;
+    if (text.size() == 26) {
+        int zoneHours = 0, zoneMinutes = 0;
+        if (text[20] != ' ' || (text[21] != '+' && text[21] != '-') ||
+            !readDigits(text, 22, 2, zoneHours) || !readDigits(text, 24, 2, zoneMinutes)) {
+            return false;
+        }
+        offsetSeconds = (zoneHours * 3600 + zoneMinutes * 60) * (text[21] == '-' ? -1 : 1);
+    }
+    epochSeconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offsetSeconds;
+    return true;
+}
+
+bool AccessLogParser::parseLine(const char* begin, const char* end, AccessLogEntry& entry) {
+    const char* timeOpen = findByte(begin, end, '[');
+    if (timeOpen == end) return false;
+    const char* timeClose = findByte(timeOpen + 1, end, ']');
+    if (timeClose == end ||
+        !parseTimestamp(std::string_view(timeOpen + 1, static_cast<size_t>(timeClose - timeOpen - 1)),
+                        entry.epochSeconds)) {
+        return false;
+    }
+
+    // 请求行是时间之后的第一个引号字段："GET /path HTTP/1.1"
+    const char* requestBegin = findByte(timeClose + 1, end, '"');
+    if (requestBegin == end) return false;
+    requestBegin++;
+    const char* requestEnd = findQuote(requestBegin, end);
+    if (requestEnd == end) return false;
+
+    const char* methodEnd = findByte(requestBegin, requestEnd, ' ');
+    if (methodEnd == requestBegin || methodEnd == requestEnd) return false;
+    for (const char* p = requestBegin; p < methodEnd; ++p) {
+        if (*p < 'A' || *p > 'Z') return false;
+    }
+    const char* targetBegin = methodEnd + 1;
+    const char* targetEnd = findByte(targetBegin, requestEnd, ' ');
+    std::string_view target = originForm(std::string_view(targetBegin, static_cast<size_t>(targetEnd - targetBegin)));
+    if (target.empty()) return false;
+    entry.method = std::string_view(requestBegin, static_cast<size_t>(methodEnd - requestBegin));
+    entry.target = target;
+
+    // combined格式在状态码与字节数之后还有引用页和User-Agent两个引号字段，common格式没有
+    entry.userAgent = std::string_view();
+    const char* refererBegin = findByte(requestEnd + 1, end, '"');
+    const char* refererEnd = refererBegin == end ? end : findQuote(refererBegin + 1, end);
+    const char* agentBegin = refererEnd == end ? end : findByte(refererEnd + 1, end, '"');
+    const char* agentEnd = agentBegin == end ? end : findQuote(agentBegin + 1, end);
+    if (agentEnd != end) {
+        std::string_view agent(agentBegin + 1, static_cast<size_t>(agentEnd - agentBegin - 1));
+        if (agent != "-") entry.userAgent = agent;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- ReplayFeed
+
+ReplayFeed::~ReplayFeed() {
+    stop();
+}
+
+bool ReplayFeed::open(const std::string& filePath, int workers, std::string& error) {
+    stop();
+    if (!file.open(filePath, MappedAccess::SEQUENTIAL, error)) return false;
+
+    queues.clear();
+    for (int i = 0; i < std::max(1, workers); ++i) queues.push_back(std::make_unique<WorkerQueue>());
+    pending.assign(queues.size(), std::vector<ReplayRecord>());
+    nextWorker = 0;
+    firstSecond = -1;
+    stopping = false;
+    finished = false;
+    lines = 0;
+    requests = 0;
+    malformed = 0;
+    outOfOrder = 0;
+    lastOffsetNs = 0;
+    return true;
+}
+
+void ReplayFeed::start() {
+    startTime = std::chrono::steady_clock::now();
+    parser = std::thread(&ReplayFeed::parseAll, this);
+}
+
+void ReplayFeed::stop() {
+    stopping = true;
+    for (auto& queue : queues) {
+        // 持锁后通知，避免解析线程在检查标志与进入等待之间错过唤醒
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->notFull.notify_all();
+    }
+    if (parser.joinable()) parser.join();
+}
+
+bool ReplayFeed::tryPop(int worker, std::vector<ReplayRecord>& batch) {
+    WorkerQueue& queue = *queues[static_cast<size_t>(worker) % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.batches.empty()) return false;
+        batch = std::move(queue.batches.front());
+        queue.batches.pop_front();
+    }
+    queue.notFull.notify_one();
+    return true;
+}
+
+bool ReplayFeed::exhausted(int worker) {
+    if (!finished.load(std::memory_order_acquire)) return false;
+    WorkerQueue& queue = *queues[static_cast<size_t>(worker) % queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    return queue.batches.empty();
+}
+
+ReplayStats ReplayFeed::getStats() const {
+    ReplayStats stats;
+    stats.lines = lines.load(std::memory_order_relaxed);
+    stats.requests = requests.load(std::memory_order_relaxed);
+    stats.malformed = malformed.load(std::memory_order_relaxed);
+    stats.outOfOrder = outOfOrder.load(std::memory_order_relaxed);
+    stats.logSpanNs = lastOffsetNs.load(std::memory_order_relaxed);
+    stats.finished = finished.load(std::memory_order_acquire);
+    return stats;
+}
+
+void ReplayFeed::parseAll() {
+    TRACE_SPAN("replayParse");
+    const char* data = file.data();
+    const char* end = data + file.size();
+    std::vector<AccessLogEntry> group;
+    AccessLogEntry entry;
+    int64_t second = 0;
+    bool haveSecond = false;
+    size_t released = 0;
+
+    for (const char* line = data; line < end && !stopping.load(std::memory_order_relaxed);) {
+        // 队列中的请求仍引用落后不远的行，留出余量；即使被引用的页已移出，访问时也只是从文件重新读入
+        size_t position = static_cast<size_t>(line - data);
+        if (position >= released + RELEASE_LAG + RELEASE_CHUNK) {
+            file.release(released, position - RELEASE_LAG - released);
+            released = position - RELEASE_LAG;
+        }
+        const char* newline = findByte(line, end, '\n');
+        const char* lineEnd = (newline > line && newline[-1] == '\r') ? newline - 1 : newline;
+        if (lineEnd > line) {
+            lines.fetch_add(1, std::memory_order_relaxed);
+            if (!AccessLogParser::parseLine(line, lineEnd, entry)) {
+                malformed.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                if (!haveSecond) {
+                    second = entry.epochSeconds;
+                    haveSecond = true;
+                } else if (entry.epochSeconds > second) {
+                    emitSecond(group, second);
+                    second = entry.epochSeconds;
+                } else if (entry.epochSeconds < second) {
+                    // 日志按写入顺序排列，慢请求可能排在更晚开始的请求之后；不回退时间
+                    outOfOrder.fetch_add(1, std::memory_order_relaxed);
+                }
+                group.push_back(entry);
+            }
+        }
+        line = newline + 1;
+    }
+    if (!group.empty()) emitSecond(group, second);
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (!pending[i].empty() && !push(i)) break;
+    }
+    finished.store(true, std::memory_order_release);
+}
+
+void ReplayFeed::emitSecond(std::vector<AccessLogEntry>& group, int64_t second) {
+    if (group.empty() || stopping.load(std::memory_order_relaxed)) {
+        group.clear();
+        return;
+    }
+    if (firstSecond < 0) firstSecond = second;
+
+    int64_t base = (second - firstSecond) * NS_PER_SECOND;
+    int64_t step = NS_PER_SECOND / static_cast<int64_t>(group.size());
+    for (size_t i = 0; i < group.size(); ++i) {
+        const AccessLogEntry& source = group[i];
+        std::vector<ReplayRecord>& records = pending[nextWorker];
+        records.push_back({base + step * static_cast<int64_t>(i), source.method, source.target, source.userAgent});
+        if (records.size() >= BATCH_SIZE && !push(nextWorker)) break;
+        nextWorker = (nextWorker + 1) % pending.size();
+    }
+    requests.fetch_add(group.size(), std::memory_order_relaxed);
+    lastOffsetNs.store(base + step * static_cast<int64_t>(group.size() - 1), std::memory_order_relaxed);
+    group.clear();
+}
+
+bool ReplayFeed::push(size_t worker) {
+    WorkerQueue& queue = *queues[worker];
+    {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        queue.notFull.wait(lock, [&] {
+            return stopping.load(std::memory_order_relaxed) || queue.batches.size() < QUEUE_BATCHES;
+        });
+        if (stopping.load(std::memory_order_relaxed)) return false;
+        queue.batches.push_back(std::move(pending[worker]));
+    }
+    pending[worker] = std::vector<ReplayRecord>();
+    pending[worker].reserve(BATCH_SIZE);
+    return true;
+}
+
+// ---------------------------------------------------------------- ReplayLoop
+
+ReplayLoop::ReplayLoop(ReplayFeed& replayFeed, int workerIndex, const ReplayOptions& replayOptions,
+                       int requestTimeoutMs)
+    : feed(replayFeed),
+      worker(workerIndex),
+      options(replayOptions),
+      timeoutMs(std::max(1, requestTimeoutMs)),
+      multi(curl_multi_init()),
+      batchPos(0),
+      cancelledCount(0),
+      inFlight(0),
+      dispatched(0),
+      lastDispatch(replayFeed.getStartTime()) {
+    slots.resize(static_cast<size_t>(std::max(1, options.maxInFlight)));
+    // 倒序放入，先用编号小的并发位，连接集中在少数句柄上
+    for (size_t i = slots.size(); i-- > 0;) {
+        Slot& slot = slots[i];
+        slot.easy = curl_easy_init();
+        if (!slot.easy) continue;
+        curl_easy_setopt(slot.easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(slot.easy, CURLOPT_PRIVATE, &slot);
+        curl_easy_setopt(slot.easy, CURLOPT_WRITEFUNCTION, discardBody);
+        curl_easy_setopt(slot.easy, CURLOPT_TIMEOUT_MS, timeoutMs);
+        freeSlots.push_back(i);
+    }
+}
+
+ReplayLoop::~ReplayLoop() {
+    for (auto& slot : slots) {
+        if (!slot.easy) continue;
+        if (slot.requestId != 0) curl_multi_remove_handle(multi, slot.easy);
+        curl_easy_cleanup(slot.easy);
+    }
+    if (multi) curl_multi_cleanup(multi);
+}
+
+void ReplayLoop::run(const std::string& url, const std::atomic<bool>& running,
+                     const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    if (!multi || freeSlots.empty()) return;
+
+    baseUrl = url;
+    while (!baseUrl.empty() && baseUrl.back() == '/') baseUrl.pop_back();
+    auto startTime = feed.getStartTime();
+    bool accepting = true;
+    if (cancellation) cancellation->registerMulti(multi);
+
+    while (running && (accepting || inFlight > 0)) {
+        if (isDraining()) accepting = false;
+        auto now = std::chrono::steady_clock::now();
+        if (tick) tick(now);
+
+        int pollMs = MAX_POLL_MS;
+        while (accepting && !freeSlots.empty()) {
+            const ReplayRecord* record = peek();
+            if (!record) {
+                if (feed.exhausted(worker)) {
+                    accepting = false;
+                } else {
+                    pollMs = STARVED_POLL_MS;
+                }
+                break;
+            }
+
+            int64_t lagNs = 0;
+            if (options.timed()) {
+                auto due = startTime + std::chrono::nanoseconds(
+                    static_cast<int64_t>(static_cast<double>(record->offsetNs) / options.speed));
+                now = std::chrono::steady_clock::now();
+                if (due > now) {
+                    auto waitMs = std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count() + 1;
+                    pollMs = static_cast<int>(std::min<int64_t>(waitMs, MAX_POLL_MS));
+                    break;
+                }
+                lagNs = toNs(now - due);
+            }
+
+            int requestId = dispatch(lagNs);
+            if (requestId <= 0) {
+                // 请求配额已用完或自动调优已结束
+                accepting = false;
+                break;
+            }
+            startRequest(*record, requestId);
+            batchPos++;
+        }
+        if (!accepting && inFlight == 0) break;
+
+        {
+            TRACE_SPAN("curl_multi_perform");
+            int stillRunning = 0;
+            curl_multi_perform(multi, &stillRunning);
+        }
+        collectCompleted(complete);
+
+        TRACE_SPAN("curl_multi_poll");
+        curl_multi_poll(multi, nullptr, 0, pollMs, nullptr);
+    }
+
+    if (cancellation) cancellation->unregisterMulti(multi);
+
+    // 因停止而退出时仍在进行中的请求由析构函数移除，这里只计数
+    cancelledCount = inFlight;
+}
+
+const ReplayRecord* ReplayLoop::peek() {
+    if (batchPos >= batch.size()) {
+        batch.clear();
+        batchPos = 0;
+        if (!feed.tryPop(worker, batch) || batch.empty()) return nullptr;
+    }
+    return &batch[batchPos];
+}
+
+void ReplayLoop::startRequest(const ReplayRecord& record, int requestId) {
+    TRACE_SPAN("startRequest");
+    size_t index = freeSlots.back();
+    freeSlots.pop_back();
+    Slot& slot = slots[index];
+
+    // curl复制字符串选项，暂存可以立即复用
+    urlBuffer.assign(baseUrl).append(record.target);
+    curl_easy_setopt(slot.easy, CURLOPT_URL, urlBuffer.c_str());
+    if (record.method == "HEAD") {
+        curl_easy_setopt(slot.easy, CURLOPT_CUSTOMREQUEST, nullptr);
+        curl_easy_setopt(slot.easy, CURLOPT_NOBODY, 1L);
+    } else {
+        // 日志中没有请求体，其他方法以不带请求体的GET形式发出、只替换方法名
+        curl_easy_setopt(slot.easy, CURLOPT_HTTPGET, 1L);
+        if (record.method == "GET") {
+            curl_easy_setopt(slot.easy, CURLOPT_CUSTOMREQUEST, nullptr);
+        } else {
+            fieldBuffer.assign(record.method);
+            curl_easy_setopt(slot.easy, CURLOPT_CUSTOMREQUEST, fieldBuffer.c_str());
+        }
+    }
+    if (options.sendUserAgent && !record.userAgent.empty()) {
+        assignUnescaped(fieldBuffer, record.userAgent);
+        curl_easy_setopt(slot.easy, CURLOPT_USERAGENT, fieldBuffer.c_str());
+    } else {
+        curl_easy_setopt(slot.easy, CURLOPT_USERAGENT, nullptr);
+    }
+
+    slot.requestId = requestId;
+    slot.requestStart = std::chrono::steady_clock::now();
+    curl_multi_add_handle(multi, slot.easy);
+    inFlight++;
+    dispatched++;
+    lastDispatch = slot.requestStart;
+}
+
+void ReplayLoop::collectCompleted(const CompletionHandler& complete) {
+    int remaining = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+        if (message->msg != CURLMSG_DONE) continue;
+
+        CURL* easy = message->easy_handle;
+        CURLcode result = message->data.result;
+        Slot* slot = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char**>(&slot));
+        if (!slot) continue;
+
+        // 移除后句柄保留连接缓存，下次添加时复用同一连接
+        curl_multi_remove_handle(multi, easy);
+        int64_t elapsedNs = toNs(std::chrono::steady_clock::now() - slot->requestStart);
+        complete(easy, result, slot->requestId, elapsedNs);
+
+        slot->requestId = 0;
+        freeSlots.push_back(static_cast<size_t>(slot - slots.data()));
+        inFlight--;
+    }
+}
@@ -0,0 +1,197 @@
+/**
+ * @file AutoTuner.cpp
+ * @brief 在延迟SLO约束下自动寻找最大可持续吞吐量的控制器的实现
+ */
+#include "../include/AutoTuner.h"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+const double MIN_ACHIEVED_RATIO = 0.9;  // 实际速率低于目标的该比例视为未跟上
+const double KNEE_FACTOR = 2.0;         // 延迟超过低负载时的该倍数视为拐点
+
+/**
+ * @brief 解析"<数值单位"形式的上限，成功时返回true
+ */
+bool parseBound(const std::string& text, double& value, std::string& unit) {
+    if (text.empty() || text[0] != '<') return false;
+    size_t pos = 1;
+    if (pos < text.size() && text[pos] == '=') pos++;
+    try {
+        size_t used = 0;
+        value = std::stod(text.substr(pos), &used);
+        unit = text.substr(pos + used);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace
+
+bool SloTarget::parse(const std::string& text, SloTarget& target) {
+    SloTarget parsed = target;
+    bool any = false;
+
+    // 统一为小写、逗号分隔且没有空白，"and"与分号都视为分隔符
+    std::string lowered;
+    for (char c : text) {
+        lowered += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    for (size_t pos; (pos = lowered.find(" and ")) != std::string::npos;) {
+        lowered.replace(pos, 5, ",");
+    }
+    std::string normalized;
+    for (char c : lowered) {
+        if (c == ';') c = ',';
+        if (!std::isspace(static_cast<unsigned char>(c))) normalized += c;
+    }
+
+    std::stringstream ss(normalized);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty()) continue;
+
+        size_t lt = part.find('<');
+        if (lt == std::string::npos) return false;
+        std::string name = part.substr(0, lt);
+        double value = 0.0;
+        std::string unit;
+        if (!parseBound(part.substr(lt), value, unit) || value < 0) return false;
+
+        if (name.size() > 1 && name[0] == 'p') {
+            // p99、p99.9：分位数按百分比给出
+            double percentile = 0.0;
+            try {
+                percentile = std::stod(name.substr(1));
+            } catch (...) {
+                return false;
+            }
+            if (percentile <= 0 || percentile >= 100) return false;
+            if (unit == "s") value *= 1000.0;
+            else if (!unit.empty() && unit != "ms") return false;
+            parsed.latencyQuantile = percentile / 100.0;
+            parsed.latencyMs = value;
+        } else if (name == "errors" || name == "error" || name == "errorrate") {
+            if (unit == "%") value /= 100.0;
+            else if (!unit.empty()) return false;
+            parsed.maxErrorRate = value;
+        } else {
+            return false;
+        }
+        any = true;
+    }
+
+    if (any) target = parsed;
+    return any;
+}
+
+std::string SloTarget::describe() const {
+    std::ostringstream ss;
+    ss << "p" << latencyQuantile * 100.0 << "<" << latencyMs << "ms, errors<" << maxErrorRate * 100.0 << "%";
+    return ss.str();
+}
+
+AutoTuner::AutoTuner(const AutoTuneOptions& tuneOptions)
+    : options(tuneOptions),
+      rate(std::max(1.0, std::min(tuneOptions.initialRps, tuneOptions.maxRps))),
+      lowRate(0.0),
+      highRate(0.0),
+      converged(false) {
+}
+
+bool AutoTuner::record(ProbeStep step) {
+    if (converged) return false;
+
+    step.targetRps = rate;
+    step.withinSlo = step.requests > 0 &&
+                     step.sloLatencyMs <= options.slo.latencyMs &&
+                     step.errorRate <= options.slo.maxErrorRate &&
+                     step.achievedRps >= rate * MIN_ACHIEVED_RATIO;
+    steps.push_back(step);
+
+    if (step.withinSlo) {
+        lowRate = rate;
+    } else {
+        highRate = rate;
+    }
+
+    if (highRate == 0.0) {
+        // 倍增阶段：一直满足SLO则翻倍，达到上限仍满足即为结论
+        if (rate >= options.maxRps) {
+            converged = true;
+        } else {
+            rate = std::min(rate * 2.0, options.maxRps);
+        }
+    } else {
+        // 二分阶段：区间足够窄时收敛
+        double next = (lowRate + highRate) / 2.0;
+        if (highRate - lowRate <= options.precision * highRate || next < 1.0) {
+            converged = true;
+        } else {
+            rate = next;
+        }
+    }
+
+    if (static_cast<int>(steps.size()) >= options.maxSteps) {
+        converged = true;
+    }
+    return !converged;
+}
+
+double AutoTuner::sustainableRps() const {
+    double best = 0.0;
+    for (const auto& step : steps) {
+        if (step.withinSlo) best = std::max(best, step.achievedRps);
+    }
+    return best;
+}
+
+int AutoTuner::kneeIndex() const {
+    std::vector<int> order;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (steps[i].requests > 0) order.push_back(static_cast<int>(i));
+    }
+    if (order.size() < 2) return -1;
+
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return steps[a].targetRps < steps[b].targetRps;
+    });
+
+    double baseline = steps[order.front()].sloLatencyMs;
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (steps[order[i]].sloLatencyMs > baseline * KNEE_FACTOR) return order[i];
+    }
+    return -1;
+}
+
+std::string formatAutoTuneReport(const AutoTuner& tuner, const SloTarget& slo) {
+    const auto& steps = tuner.getSteps();
+    int knee = tuner.kneeIndex();
+
+    std::ostringstream ss;
+    ss << "自动调优 (" << slo.describe() << "):\n";
+    ss << "  步骤  目标速率  实际速率  P50(毫秒)  P" << slo.latencyQuantile * 100.0
+       << "(毫秒)  错误率  结果\n";
+    ss << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const ProbeStep& step = steps[i];
+        ss << "  " << std::setw(4) << i + 1 << "  " << std::setw(8) << step.targetRps << "  "
+           << std::setw(8) << step.achievedRps << "  " << std::setw(9) << step.p50Ms << "  "
+           << std::setw(9) << step.sloLatencyMs << "  " << std::setw(5) << std::setprecision(3)
+           << step.errorRate * 100.0 << "%" << std::setprecision(1) << "  "
+           << (step.withinSlo ? "满足" : "违反") << (static_cast<int>(i) == knee ? " <- 拐点" : "") << "\n";
+    }
+
+    double sustainable = tuner.sustainableRps();
+    if (sustainable > 0) {
+        ss << "  结论: 最大可持续吞吐量约 " << sustainable << " 请求/秒";
+    } else {
+        ss << "  结论: 最低探测速率即违反SLO";
+    }
+    ss << (tuner.isConverged() ? "" : "（未收敛）") << "\n";
+    return ss.str();
+}
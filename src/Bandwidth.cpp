@@ -0,0 +1,21 @@
+/**
+ * @file Bandwidth.cpp
+ * @brief 流量统计与下载吞吐量模式的实现
+ */
+#include "../include/Bandwidth.h"
+
+void BandwidthStats::record(uint64_t bytes, int64_t firstByteNs, int64_t lastByteNs) {
+    transfers++;
+    bodyBytes += bytes;
+    firstByte.add(firstByteNs / 1e6);
+    lastByte.add(lastByteNs / 1e6);
+    throughput.add(megabytesPerSecond(bytes, lastByteNs / 1e9));
+}
+
+void BandwidthStats::merge(const BandwidthStats& other) {
+    transfers += other.transfers;
+    bodyBytes += other.bodyBytes;
+    firstByte.merge(other.firstByte);
+    lastByte.merge(other.lastByte);
+    throughput.merge(other.throughput);
+}
@@ -0,0 +1,28 @@
+/**
+ * @file Cancellation.cpp
+ * @brief 中断进行中传输的取消源的实现
+ */
+#include "../include/Cancellation.h"
+#include <algorithm>
+
+void CancellationSource::cancel() {
+    cancelled.store(true, std::memory_order_release);
+
+    // 持锁唤醒，保证句柄在唤醒期间不会被注销销毁
+    std::lock_guard<std::mutex> lock(handlesMutex);
+    for (CURLM* multi : handles) {
+        curl_multi_wakeup(multi);
+    }
+}
+
+void CancellationSource::registerMulti(CURLM* multi) {
+    if (!multi) return;
+    std::lock_guard<std::mutex> lock(handlesMutex);
+    handles.push_back(multi);
+}
+
+void CancellationSource::unregisterMulti(CURLM* multi) {
+    if (!multi) return;
+    std::lock_guard<std::mutex> lock(handlesMutex);
+    handles.erase(std::remove(handles.begin(), handles.end(), multi), handles.end());
+}
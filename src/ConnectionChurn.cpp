@@ -0,0 +1,24 @@
+/**
+ * @file ConnectionChurn.cpp
+ * @brief 连接复用策略与建连统计的实现
+ */
+#include "../include/ConnectionChurn.h"
+
+void ConnectionStats::record(bool reconnect, int64_t tcpNs, int64_t tlsNs, int64_t readyNs) {
+    opened++;
+    tcpHandshake.add(tcpNs / 1e6);
+    if (tlsNs > 0) tlsHandshake.add(tlsNs / 1e6);
+    if (reconnect) {
+        reconnects++;
+        reconnectLatency.add(readyNs / 1e6);
+    }
+}
+
+void ConnectionStats::merge(const ConnectionStats& other) {
+    opened += other.opened;
+    reconnects += other.reconnects;
+    storms += other.storms;
+    tcpHandshake.merge(other.tcpHandshake);
+    tlsHandshake.merge(other.tlsHandshake);
+    reconnectLatency.merge(other.reconnectLatency);
+}
@@ -0,0 +1,254 @@
+/**
+ * @file ContentDecoding.cpp
+ * @brief 响应压缩解码与字节统计的实现
+ */
+#include "../include/ContentDecoding.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <vector>
+#include <zlib.h>
+#ifdef LOADTESTER_BROTLI
+#include <brotli/decode.h>
+#endif
+
+namespace {
+
+const size_t SCRATCH_BYTES = 64 * 1024;     // 解码输出暂存区大小
+const int ZLIB_AUTO_HEADER = 15 + 32;       // 自动识别gzip与zlib头
+const int ZLIB_RAW = -15;                   // 裸deflate
+
+// 解码输出只计数，同一线程的所有解码器共用一块暂存区
+unsigned char* scratchBuffer() {
+    thread_local std::vector<unsigned char> buffer(SCRATCH_BYTES);
+    return buffer.data();
+}
+
+ContentEncoding parseEncoding(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (value.empty() || value == "identity") return ContentEncoding::IDENTITY;
+    if (value == "gzip" || value == "x-gzip") return ContentEncoding::GZIP;
+    if (value == "deflate") return ContentEncoding::DEFLATE;
+    if (value == "br") return ContentEncoding::BROTLI;
+    return ContentEncoding::OTHER;
+}
+
+} // namespace
+
+void EncodingStats::merge(const EncodingStats& other) {
+    responses += other.responses;
+    wireBytes += other.wireBytes;
+    decodedBytes += other.decodedBytes;
+    decodeNs += other.decodeNs;
+    failed += other.failed;
+    unsupported += other.unsupported;
+}
+
+void CompressionStats::record(ContentEncoding encoding, uint64_t wireBytes, uint64_t decodedBytes, int64_t decodeNs,
+                              DecodeStatus status) {
+    EncodingStats& stats = encodings[static_cast<size_t>(encoding)];
+    stats.responses++;
+    stats.wireBytes += wireBytes;
+    stats.decodedBytes += decodedBytes;
+    stats.decodeNs += decodeNs;
+    if (status == DecodeStatus::FAILED) stats.failed++;
+    if (status == DecodeStatus::UNSUPPORTED) stats.unsupported++;
+}
+
+void CompressionStats::merge(const CompressionStats& other) {
+    for (size_t i = 0; i < static_cast<size_t>(ContentEncoding::COUNT); ++i) {
+        encodings[i].merge(other.encodings[i]);
+    }
+}
+
+EncodingStats CompressionStats::total() const {
+    EncodingStats sum;
+    for (const auto& stats : encodings) {
+        sum.merge(stats);
+    }
+    return sum;
+}
+
+const char* CompressionStats::name(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::IDENTITY: return "identity";
+        case ContentEncoding::GZIP: return "gzip";
+        case ContentEncoding::DEFLATE: return "deflate";
+        case ContentEncoding::BROTLI: return "br";
+        default: return "other";
+    }
+}
+
+/**
+ * @brief 跨响应复用的解码器状态
+ */
+struct ContentDecoder::Inflater {
+    z_stream zlib{};            ///< gzip/deflate解码流
+    bool zlibReady = false;     ///< zlib流是否已初始化
+    bool rawDeflate = false;    ///< 当前deflate响应是否为裸deflate
+#ifdef LOADTESTER_BROTLI
+    BrotliDecoderState* brotli = nullptr;   ///< br解码流，每个响应重新创建
+#endif
+
+    ~Inflater() {
+        if (zlibReady) inflateEnd(&zlib);
+#ifdef LOADTESTER_BROTLI
+        if (brotli) BrotliDecoderDestroyInstance(brotli);
+#endif
+    }
+};
+
+ContentDecoder::ContentDecoder()
+    : encoding(ContentEncoding::IDENTITY),
+      status(DecodeStatus::OK),
+      streamStarted(false),
+      streamEnded(false),
+      wireBytes(0),
+      decodedBytes(0),
+      decodeNs(0) {}
+
+ContentDecoder::~ContentDecoder() = default;
+ContentDecoder::ContentDecoder(ContentDecoder&& other) noexcept = default;
+ContentDecoder& ContentDecoder::operator=(ContentDecoder&& other) noexcept = default;
+
+void ContentDecoder::reset() {
+    encoding = ContentEncoding::IDENTITY;
+    status = DecodeStatus::OK;
+    streamStarted = false;
+    streamEnded = false;
+    wireBytes = 0;
+    decodedBytes = 0;
+    decodeNs = 0;
+}
+
+void ContentDecoder::onHeader(const char* data, size_t length) {
+    static const char prefix[] = "content-encoding:";
+    const size_t prefixLength = sizeof(prefix) - 1;
+
+    if (length >= 5 && std::equal(data, data + 5, "HTTP/")) {
+        reset();
+        return;
+    }
+    if (length < prefixLength) return;
+    for (size_t i = 0; i < prefixLength; ++i) {
+        if (std::tolower(static_cast<unsigned char>(data[i])) != prefix[i]) return;
+    }
+
+    std::string value(data + prefixLength, length - prefixLength);
+    size_t first = value.find_first_not_of(" \t");
+    size_t last = value.find_last_not_of(" \t\r\n");
+    value = first == std::string::npos ? std::string() : value.substr(first, last - first + 1);
+
+    encoding = parseEncoding(value);
+#ifndef LOADTESTER_BROTLI
+    if (encoding == ContentEncoding::BROTLI) status = DecodeStatus::UNSUPPORTED;
+#endif
+    if (encoding == ContentEncoding::OTHER) status = DecodeStatus::UNSUPPORTED;
+}
+
+void ContentDecoder::onBody(const char* data, size_t length) {
+    wireBytes += length;
+    if (encoding == ContentEncoding::IDENTITY) {
+        decodedBytes += length;
+        return;
+    }
+    if (status != DecodeStatus::OK || streamEnded) return;
+
+    auto start = std::chrono::steady_clock::now();
+    decode(data, length);
+    decodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ContentDecoder::decode(const char* data, size_t length) {
+    if (!inflater) inflater = std::make_unique<Inflater>();
+    unsigned char* out = scratchBuffer();
+
+#ifdef LOADTESTER_BROTLI
+    if (encoding == ContentEncoding::BROTLI) {
+        if (!streamStarted) {
+            if (inflater->brotli) BrotliDecoderDestroyInstance(inflater->brotli);
+            inflater->brotli = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+            streamStarted = true;
+        }
+        if (!inflater->brotli) {
+            status = DecodeStatus::FAILED;
+            return;
+        }
+        size_t availableIn = length;
+        const uint8_t* nextIn = reinterpret_cast<const uint8_t*>(data);
+        while (true) {
+            size_t availableOut = SCRATCH_BYTES;
+            uint8_t* nextOut = out;
+            BrotliDecoderResult result =
+                BrotliDecoderDecompressStream(inflater->brotli, &availableIn, &nextIn, &availableOut, &nextOut, nullptr);
+            decodedBytes += SCRATCH_BYTES - availableOut;
+            if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+                streamEnded = true;
+                return;
+            }
+            if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) return;
+            if (result == BROTLI_DECODER_RESULT_ERROR) {
+                status = DecodeStatus::FAILED;
+                return;
+            }
+        }
+    }
+#endif
+
+    z_stream& zlib = inflater->zlib;
+    if (!streamStarted) {
+        int rc = inflater->zlibReady ? inflateReset2(&zlib, ZLIB_AUTO_HEADER) : inflateInit2(&zlib, ZLIB_AUTO_HEADER);
+        if (rc != Z_OK) {
+            status = DecodeStatus::FAILED;
+            return;
+        }
+        inflater->zlibReady = true;
+        inflater->rawDeflate = false;
+        streamStarted = true;
+    }
+
+    zlib.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zlib.avail_in = static_cast<uInt>(length);
+    while (zlib.avail_in > 0) {
+        zlib.next_out = out;
+        zlib.avail_out = static_cast<uInt>(SCRATCH_BYTES);
+        int rc = inflate(&zlib, Z_NO_FLUSH);
+        decodedBytes += SCRATCH_BYTES - zlib.avail_out;
+
+        if (rc == Z_STREAM_END) {
+            streamEnded = true;
+            return;
+        }
+        if (rc == Z_DATA_ERROR && encoding == ContentEncoding::DEFLATE && !inflater->rawDeflate &&
+            decodedBytes == 0 && wireBytes == length) {
+            // 有些服务器的deflate不带zlib头，从第一块重新按裸deflate解码
+            inflateReset2(&zlib, ZLIB_RAW);
+            inflater->rawDeflate = true;
+            zlib.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            zlib.avail_in = static_cast<uInt>(length);
+            continue;
+        }
+        if (rc != Z_OK && rc != Z_BUF_ERROR) {
+            status = DecodeStatus::FAILED;
+            return;
+        }
+        if (zlib.avail_out != 0) return;
+    }
+}
+
+DecodeStatus ContentDecoder::getStatus() const {
+    bool compressed = encoding != ContentEncoding::IDENTITY;
+    if (status == DecodeStatus::OK && compressed && wireBytes > 0 && !streamEnded) return DecodeStatus::FAILED;
+    return status;
+}
+
+size_t ContentDecoder::headerCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    static_cast<ContentDecoder*>(userdata)->onHeader(buffer, size * nitems);
+    return size * nitems;
+}
+
+size_t ContentDecoder::writeCallback(char* buffer, size_t size, size_t nmemb, void* userdata) {
+    static_cast<ContentDecoder*>(userdata)->onBody(buffer, size * nmemb);
+    return size * nmemb;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file DDSketch.cpp
+ * @brief 可合并分位数草图(DDSketch)的实现
+ */
+#include "../include/DDSketch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+namespace {
+
+const char SKETCH_MAGIC[3] = {'D', 'D', 'S'};
+const uint8_t SKETCH_VERSION = 1;
+
+void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void writeDouble(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((bits >> (i * 8)) & 0xFF));
+    }
+}
+
+/**
+ * @brief 二进制数据的顺序读取器，越界时置失败标志
+ */
+struct ByteReader {
+    const std::string& data;
+    size_t pos;
+    bool ok;
+
+    explicit ByteReader(const std::string& input) : data(input), pos(0), ok(true) {}
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= data.size()) {
+                ok = false;
+                return 0;
+            }
+            uint8_t byte = static_cast<uint8_t>(data[pos++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    double readDouble() {
+        if (pos + 8 > data.size()) {
+            ok = false;
+            return 0.0;
+        }
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos++])) << (i * 8);
+        }
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+} // namespace
+
+DDSketch::DDSketch(double accuracy, size_t binLimit)
+    : relativeAccuracy(accuracy > 0.0 && accuracy < 1.0 ? accuracy : 0.01),
+      gamma((1.0 + relativeAccuracy) / (1.0 - relativeAccuracy)),
+      logGamma(std::log(gamma)),
+      minIndexableValue(1e-6),
+      maxBins(std::max<size_t>(binLimit, 16)),
+      binOffset(0),
+      zeroCount(0),
+      count(0),
+      sum(0.0),
+      minValue(std::numeric_limits<double>::max()),
+      maxValue(0.0) {
+}
+
+void DDSketch::add(double value, uint64_t n) {
+    if (n == 0 || !std::isfinite(value) || value < 0.0) return;  // 过滤NaN与无穷大，避免keyOf溢出
+
+    if (value < minIndexableValue) {
+        zeroCount += n;
+    } else {
+        bins[binIndex(keyOf(value))] += n;
+    }
+
+    count += n;
+    sum += value * n;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+bool DDSketch::merge(const DDSketch& other) {
+    if (std::fabs(other.relativeAccuracy - relativeAccuracy) > 1e-12) {
+        return false;
+    }
+    if (other.count == 0) return true;
+
+    for (size_t i = 0; i < other.bins.size(); ++i) {
+        if (other.bins[i] > 0) {
+            bins[binIndex(other.binOffset + static_cast<int>(i))] += other.bins[i];
+        }
+    }
+
+    zeroCount += other.zeroCount;
+    count += other.count;
+    sum += other.sum;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+    return true;
+}
+
+double DDSketch::quantile(double q) const {
+    if (count == 0) return 0.0;
+
+    q = std::min(1.0, std::max(0.0, q));
+    double rank = q * (count - 1);
+
+    uint64_t seen = zeroCount;
+    if (rank < seen) return 0.0;
+
+    for (size_t i = 0; i < bins.size(); ++i) {
+        seen += bins[i];
+        if (rank < seen) {
+            double estimate = representative(binOffset + static_cast<int>(i));
+            // 真实值一定落在[min, max]内，夹紧不会增大误差
+            return std::min(maxValue, std::max(minValue, estimate));
+        }
+    }
+    return maxValue;
+}
+
+void DDSketch::clear() {
+    bins.clear();
+    binOffset = 0;
+    zeroCount = 0;
+    count = 0;
+    sum = 0.0;
+    minValue = std::numeric_limits<double>::max();
+    maxValue = 0.0;
+}
+
+std::string DDSketch::serialize() const {
+    std::string out;
+    out.reserve(64 + bins.size() * 2);
+
+    out.append(SKETCH_MAGIC, sizeof(SKETCH_MAGIC));
+    out.push_back(static_cast<char>(SKETCH_VERSION));
+    writeDouble(out, relativeAccuracy);
+    writeVarint(out, maxBins);
+    writeVarint(out, zeroCount);
+    writeVarint(out, count);
+    writeDouble(out, sum);
+    writeDouble(out, getMin());
+    writeDouble(out, getMax());
+
+    // 去掉首尾的空桶
+    size_t first = 0;
+    size_t last = bins.size();
+    while (first < last && bins[first] == 0) ++first;
+    while (last > first && bins[last - 1] == 0) --last;
+
+    int64_t offset = binOffset + static_cast<int64_t>(first);
+    writeVarint(out, (static_cast<uint64_t>(offset) << 1) ^ static_cast<uint64_t>(offset >> 63));
+    writeVarint(out, last - first);
+    for (size_t i = first; i < last; ++i) {
+        writeVarint(out, bins[i]);
+    }
+    return out;
+}
+
+bool DDSketch::deserialize(const std::string& data, DDSketch& sketch) {
+    if (data.size() < sizeof(SKETCH_MAGIC) + 1 ||
+        std::memcmp(data.data(), SKETCH_MAGIC, sizeof(SKETCH_MAGIC)) != 0 ||
+        static_cast<uint8_t>(data[sizeof(SKETCH_MAGIC)]) != SKETCH_VERSION) {
+        return false;
+    }
+
+    ByteReader reader(data);
+    reader.pos = sizeof(SKETCH_MAGIC) + 1;
+
+    double accuracy = reader.readDouble();
+    uint64_t binLimit = reader.readVarint();
+    if (!reader.ok || !(accuracy > 0.0 && accuracy < 1.0) || binLimit > (1u << 24)) {
+        return false;
+    }
+
+    DDSketch result(accuracy, static_cast<size_t>(binLimit));
+    result.zeroCount = reader.readVarint();
+    result.count = reader.readVarint();
+    result.sum = reader.readDouble();
+    double minStored = reader.readDouble();
+    result.maxValue = reader.readDouble();
+    uint64_t zigzag = reader.readVarint();
+    uint64_t binCount = reader.readVarint();
+    if (!reader.ok || binCount > result.maxBins || binCount > data.size()) {
+        return false;
+    }
+
+    int64_t offset = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    if (offset < std::numeric_limits<int>::min() / 2 || offset > std::numeric_limits<int>::max() / 2) {
+        return false;
+    }
+    result.binOffset = static_cast<int>(offset);
+    result.bins.resize(static_cast<size_t>(binCount));
+
+    uint64_t binTotal = result.zeroCount;
+    for (auto& bin : result.bins) {
+        bin = reader.readVarint();
+        binTotal += bin;
+    }
+    if (!reader.ok || reader.pos != data.size() || binTotal != result.count) {
+        return false;
+    }
+
+    if (result.count > 0) {
+        result.minValue = minStored;
+    } else {
+        result.maxValue = 0.0;
+    }
+    sketch = result;
+    return true;
+}
+
+bool DDSketch::saveToFile(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string data = serialize();
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+bool DDSketch::mergeFromFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    DDSketch loaded;
+    if (!deserialize(data, loaded)) {
+        return false;
+    }
+    return merge(loaded);
+}
+
+int DDSketch::keyOf(double value) const {
+    return static_cast<int>(std::ceil(std::log(value) / logGamma));
+}
+
+double DDSketch::lowerBound(int key) const {
+    return std::exp((key - 1) * logGamma);
+}
+
+double DDSketch::representative(int key) const {
+    return 2.0 * std::exp(key * logGamma) / (gamma + 1.0);
+}
+
+size_t DDSketch::binIndex(int key) {
+    if (bins.empty()) {
+        bins.assign(1, 0);
+        binOffset = key;
+        return 0;
+    }
+
+    int low = binOffset;
+    int high = binOffset + static_cast<int>(bins.size()) - 1;
+    if (key >= low && key <= high) {
+        return static_cast<size_t>(key - low);
+    }
+
+    int newLow = std::min(low, key);
+    int newHigh = std::max(high, key);
+    if (static_cast<size_t>(newHigh - newLow + 1) > maxBins) {
+        // 超出桶数上限时保留高端，最低端的桶合并到新的最低桶中
+        newLow = newHigh - static_cast<int>(maxBins) + 1;
+    }
+
+    std::vector<uint64_t> resized(static_cast<size_t>(newHigh - newLow + 1), 0);
+    for (size_t i = 0; i < bins.size(); ++i) {
+        int oldKey = std::max(binOffset + static_cast<int>(i), newLow);
+        resized[static_cast<size_t>(oldKey - newLow)] += bins[i];
+    }
+    bins.swap(resized);
+    binOffset = newLow;
+
+    return static_cast<size_t>(std::max(key, newLow) - newLow);
+}
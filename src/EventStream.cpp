@@ -0,0 +1,411 @@
+/**
+ * @file EventStream.cpp
+ * @brief SSE解析与流式事件循环的实现
+ */
+#include "../include/EventStream.h"
+#include "../include/Tracer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+const size_t MAX_LINE_BYTES = 4096;     // 每行只保留的前缀长度
+
+// 不区分大小写地判断一行响应头是否以name开头
+bool headerIs(const char* data, size_t length, const char* name) {
+    size_t i = 0;
+    for (; name[i] != '\0'; ++i) {
+        if (i >= length || std::tolower(static_cast<unsigned char>(data[i])) != name[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void StreamStats::merge(const StreamStats& other) {
+    streams += other.streams;
+    failedStreams += other.failedStreams;
+    events += other.events;
+    bytes += other.bytes;
+    skewedTimestamps += other.skewedTimestamps;
+    firstEvent.merge(other.firstEvent);
+    interEventGap.merge(other.interEventGap);
+    eventLag.merge(other.eventLag);
+}
+
+// ---------------------------------------------------------------- EventStreamParser
+
+EventStreamParser::EventStreamParser(std::string timestampField)
+    : field(std::move(timestampField)),
+      eventStream(true),
+      hasData(false),
+      skipLineFeed(false),
+      bodySeen(false),
+      timestampNs(-1) {}
+
+void EventStreamParser::reset(bool isEventStream) {
+    line.clear();
+    eventStream = isEventStream;
+    hasData = false;
+    skipLineFeed = false;
+    bodySeen = false;
+    timestampNs = -1;
+}
+
+void EventStreamParser::feed(const char* data, size_t length, const EventHandler& onEvent) {
+    if (!eventStream) {
+        // 长轮询只需要在响应体里找时间戳，找到后其余字节不再扫描
+        bodySeen = bodySeen || length > 0;
+        if (field.empty() || timestampNs >= 0) return;
+    }
+
+    const char* end = data + length;
+    const char* cursor = data;
+    while (cursor < end) {
+        if (skipLineFeed) {
+            skipLineFeed = false;
+            if (*cursor == '\n') {
+                ++cursor;
+                continue;
+            }
+        }
+        const char* lineEnd = std::find_if(cursor, end, [](char c) { return c == '\n' || c == '\r'; });
+        size_t keep = std::min<size_t>(static_cast<size_t>(lineEnd - cursor), MAX_LINE_BYTES - line.size());
+        line.append(cursor, keep);
+        if (lineEnd == end) break;
+
+        skipLineFeed = *lineEnd == '\r';
+        cursor = lineEnd + 1;
+        endLine(onEvent);
+    }
+}
+
+void EventStreamParser::finish(const EventHandler& onEvent) {
+    if (eventStream) {
+        // 流在事件中途结束时，未以空行结束的事件按规范丢弃
+        line.clear();
+        return;
+    }
+    if (!line.empty()) endLine(onEvent);
+    if (bodySeen) onEvent(timestampNs);
+    bodySeen = false;
+}
+
+void EventStreamParser::endLine(const EventHandler& onEvent) {
+    if (!eventStream) {
+        if (timestampNs < 0) timestampNs = parseTimestamp(line, field, true);
+        line.clear();
+        return;
+    }
+
+    if (line.empty()) {
+        if (hasData) onEvent(timestampNs);
+        hasData = false;
+        timestampNs = -1;
+        return;
+    }
+    if (line[0] == ':') {
+        // 注释行，常用作心跳
+        line.clear();
+        return;
+    }
+
+    size_t colon = line.find(':');
+    size_t nameLength = colon == std::string::npos ? line.size() : colon;
+    size_t valueStart = colon == std::string::npos ? line.size() : colon + 1;
+    if (valueStart < line.size() && line[valueStart] == ' ') valueStart++;
+
+    if (line.compare(0, nameLength, "data") == 0 && nameLength == 4) {
+        hasData = true;
+        if (!field.empty() && timestampNs < 0) timestampNs = parseTimestamp(line.substr(valueStart), field, true);
+    } else if (!field.empty() && line.compare(0, nameLength, field) == 0 && nameLength == field.size()) {
+        timestampNs = parseTimestamp(line.substr(valueStart), field, false);
+    }
+    line.clear();
+}
+
+int64_t EventStreamParser::parseTimestamp(const std::string& text, const std::string& field, bool asJsonKey) {
+    if (field.empty()) return -1;
+
+    size_t pos = 0;
+    if (asJsonKey) {
+        std::string key = "\"" + field + "\"";
+        size_t at = text.find(key);
+        if (at == std::string::npos) return -1;
+        pos = text.find_first_not_of(" \t", at + key.size());
+        if (pos == std::string::npos || text[pos] != ':') return -1;
+        pos = text.find_first_not_of(" \t", pos + 1);
+        if (pos != std::string::npos && text[pos] == '"') pos++;
+    } else {
+        pos = text.find_first_not_of(" \t");
+    }
+    if (pos == std::string::npos) return -1;
+
+    const char* start = text.c_str() + pos;
+    char* end = nullptr;
+    double value = std::strtod(start, &end);
+    if (end == start || !(value > 0)) return -1;
+
+    // 按数量级识别单位：纳秒、微秒、毫秒，否则为秒（可带小数）
+    if (value >= 1e17) return static_cast<int64_t>(value);
+    if (value >= 1e14) return static_cast<int64_t>(value * 1e3);
+    if (value >= 1e11) return static_cast<int64_t>(value * 1e6);
+    return static_cast<int64_t>(value * 1e9);
+}
+
+// ---------------------------------------------------------------- StreamLoop
+
+StreamLoop::StreamLoop(int firstStream, int streamCount, int totalStreams, const StreamingOptions& streamingOptions,
+                       int requestTimeoutMs)
+    : multi(curl_multi_init()),
+      options(streamingOptions),
+      timeoutMs(std::max(1, requestTimeoutMs)),
+      headers(nullptr),
+      cancelledCount(0),
+      inFlight(0),
+      accepting(true) {
+    streamSlots.resize(std::max(0, streamCount));
+
+    // 按全局编号在爬坡时长内均匀错开建立时间
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < streamSlots.size(); ++i) {
+        Stream& stream = streamSlots[i];
+        stream.owner = this;
+        stream.easy = curl_easy_init();
+        stream.parser = EventStreamParser(options.timestampField);
+        int64_t offsetMs = totalStreams > 0
+            ? static_cast<int64_t>(options.rampUpMs) * (firstStream + static_cast<int>(i)) / totalStreams : 0;
+        stream.intendedStart = now + std::chrono::milliseconds(offsetMs);
+        timers.schedule(stream.intendedStart, makeToken(TimerKind::WAKE, i, stream.generation));
+    }
+}
+
+StreamLoop::~StreamLoop() {
+    for (auto& stream : streamSlots) {
+        if (!stream.easy) continue;
+        if (stream.state == StreamState::OPEN) {
+            curl_multi_remove_handle(multi, stream.easy);
+        }
+        curl_easy_cleanup(stream.easy);
+    }
+    if (multi) curl_multi_cleanup(multi);
+    if (headers) curl_slist_free_all(headers);
+}
+
+uint64_t StreamLoop::makeToken(TimerKind kind, size_t index, uint32_t generation) {
+    // 高32位为版本号，其后4位为用途，低28位为流位序号
+    return (static_cast<uint64_t>(generation) << 32) |
+           (static_cast<uint64_t>(kind) << 28) |
+           (static_cast<uint64_t>(index) & 0x0FFFFFFF);
+}
+
+size_t StreamLoop::onHeader(char* buffer, size_t size, size_t nitems, void* userdata) {
+    auto* stream = static_cast<Stream*>(userdata);
+    size_t length = size * nitems;
+    // 每组响应头（重定向、1xx）从状态行重新开始；只有text/event-stream按SSE解析
+    if (headerIs(buffer, length, "http/")) {
+        stream->parser.reset(false);
+    } else if (headerIs(buffer, length, "content-type:")) {
+        std::string value(buffer, length);
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (value.find("text/event-stream") != std::string::npos) stream->parser.reset(true);
+    }
+    return length;
+}
+
+size_t StreamLoop::onBody(char* buffer, size_t size, size_t nmemb, void* userdata) {
+    auto* stream = static_cast<Stream*>(userdata);
+    size_t length = size * nmemb;
+    stream->owner->stats.bytes += length;
+    stream->parser.feed(buffer, length, [stream](int64_t timestampNs) {
+        stream->owner->onEvent(*stream, timestampNs);
+    });
+    return length;
+}
+
+void StreamLoop::onEvent(Stream& stream, int64_t timestampNs) {
+    auto now = std::chrono::steady_clock::now();
+    stats.events++;
+    if (stream.firstEventNs < 0) {
+        stream.firstEventNs = toNs(now - stream.requestStart);
+        stats.firstEvent.add(stream.firstEventNs / 1e6);
+    }
+    if (stream.hasLastEvent) {
+        stats.interEventGap.add(toNs(now - stream.lastEvent) / 1e6);
+    }
+    stream.lastEvent = now;
+    stream.hasLastEvent = true;
+
+    if (timestampNs >= 0) {
+        int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        int64_t lagNs = wallNs - timestampNs;
+        if (lagNs < 0) {
+            stats.skewedTimestamps++;
+            lagNs = 0;
+        }
+        stats.eventLag.add(lagNs / 1e6);
+    }
+}
+
+void StreamLoop::run(const std::string& url, const std::atomic<bool>& running,
+                     const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    if (!multi) return;
+
+    headers = curl_slist_append(headers, "Accept: text/event-stream");
+    headers = curl_slist_append(headers, "Cache-Control: no-cache");
+    // 停滞判定：整段超时时长内一个字节都没收到（心跳注释也算）
+    long stallSeconds = std::max(1L, timeoutMs / 1000);
+
+    for (auto& stream : streamSlots) {
+        if (!stream.easy) {
+            stream.state = StreamState::FINISHED;
+            continue;
+        }
+        curl_easy_setopt(stream.easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(stream.easy, CURLOPT_PRIVATE, &stream);
+        curl_easy_setopt(stream.easy, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(stream.easy, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(stream.easy, CURLOPT_HEADERFUNCTION, onHeader);
+        curl_easy_setopt(stream.easy, CURLOPT_HEADERDATA, &stream);
+        curl_easy_setopt(stream.easy, CURLOPT_WRITEFUNCTION, onBody);
+        curl_easy_setopt(stream.easy, CURLOPT_WRITEDATA, &stream);
+        curl_easy_setopt(stream.easy, CURLOPT_CONNECTTIMEOUT_MS, timeoutMs);
+        curl_easy_setopt(stream.easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(stream.easy, CURLOPT_LOW_SPEED_TIME, stallSeconds);
+    }
+
+    auto handler = [&](uint64_t token) { onTimer(token, dispatch, complete); };
+    if (cancellation) cancellation->registerMulti(multi);
+
+    while (running && (accepting || inFlight > 0)) {
+        if (accepting && isDraining()) {
+            // 排空时不再等待服务端关闭，打开的流由客户端结束，与达到保持时长相同
+            accepting = false;
+            for (size_t i = 0; i < streamSlots.size(); ++i) {
+                if (streamSlots[i].state != StreamState::OPEN) continue;
+                curl_multi_remove_handle(multi, streamSlots[i].easy);
+                finishStream(i, CURLE_OK, complete);
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (tick) tick(now);
+        {
+            TRACE_SPAN("timers");
+            timers.advance(now, handler);
+        }
+        if (!accepting && inFlight == 0) break;
+
+        {
+            TRACE_SPAN("curl_multi_perform");
+            int stillRunning = 0;
+            curl_multi_perform(multi, &stillRunning);
+        }
+        collectCompleted(complete);
+
+        int waitMs = timers.nextTimeoutMs(std::chrono::steady_clock::now());
+        int pollMs = pollTimeoutMs(waitMs);
+        TRACE_SPAN("curl_multi_poll");
+        curl_multi_poll(multi, nullptr, 0, pollMs, nullptr);
+    }
+
+    if (cancellation) cancellation->unregisterMulti(multi);
+
+    // 因停止而退出时仍打开的流由析构函数移除，这里只计数
+    for (const auto& stream : streamSlots) {
+        if (stream.state == StreamState::OPEN) cancelledCount++;
+    }
+}
+
+void StreamLoop::onTimer(uint64_t token, const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    auto kind = static_cast<TimerKind>((token >> 28) & 0xF);
+    size_t index = static_cast<size_t>(token & 0x0FFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(token >> 32);
+
+    Stream& stream = streamSlots[index];
+    if (stream.generation != generation) return;
+
+    if (kind == TimerKind::WAKE && stream.state == StreamState::WAITING) {
+        startStream(index, dispatch);
+    } else if (kind == TimerKind::DEADLINE && stream.state == StreamState::OPEN) {
+        // 达到保持时长由客户端结束；连响应头都没收到时按超时处理
+        long responseCode = 0;
+        curl_easy_getinfo(stream.easy, CURLINFO_RESPONSE_CODE, &responseCode);
+        curl_multi_remove_handle(multi, stream.easy);
+        finishStream(index, responseCode > 0 ? CURLE_OK : CURLE_OPERATION_TIMEDOUT, complete);
+    }
+}
+
+void StreamLoop::startStream(size_t index, const DispatchHandler& dispatch) {
+    Stream& stream = streamSlots[index];
+
+    int requestId = 0;
+    if (accepting) {
+        auto lag = std::chrono::steady_clock::now() - stream.intendedStart;
+        requestId = dispatch(std::max<int64_t>(0, toNs(lag)));
+    }
+    if (requestId <= 0) {
+        accepting = false;
+        stream.state = StreamState::FINISHED;
+        return;
+    }
+
+    stream.parser.reset(false);
+    stream.firstEventNs = -1;
+    stream.hasLastEvent = false;
+    stream.requestId = requestId;
+    stream.requestStart = std::chrono::steady_clock::now();
+    stream.state = StreamState::OPEN;
+    stream.generation++;
+    curl_multi_add_handle(multi, stream.easy);
+    inFlight++;
+
+    if (options.streamDurationMs > 0) {
+        timers.schedule(stream.requestStart + std::chrono::milliseconds(options.streamDurationMs),
+                        makeToken(TimerKind::DEADLINE, index, stream.generation));
+    }
+}
+
+void StreamLoop::finishStream(size_t index, CURLcode result, const CompletionHandler& complete) {
+    TRACE_SPAN("finishStream");
+    Stream& stream = streamSlots[index];
+    stream.parser.finish([&stream](int64_t timestampNs) { stream.owner->onEvent(stream, timestampNs); });
+
+    auto now = std::chrono::steady_clock::now();
+    int64_t elapsedNs = stream.firstEventNs >= 0 ? stream.firstEventNs : toNs(now - stream.requestStart);
+
+    long responseCode = 0;
+    curl_easy_getinfo(stream.easy, CURLINFO_RESPONSE_CODE, &responseCode);
+    stats.streams++;
+    if (result != CURLE_OK || responseCode < 200 || responseCode >= 300) stats.failedStreams++;
+
+    complete(stream.easy, result, stream.requestId, elapsedNs);
+
+    inFlight--;
+    stream.generation++;
+    if (!accepting) {
+        stream.state = StreamState::FINISHED;
+        return;
+    }
+    stream.state = StreamState::WAITING;
+    stream.intendedStart = now + std::chrono::milliseconds(std::max(0, options.reconnectDelayMs));
+    timers.schedule(stream.intendedStart, makeToken(TimerKind::WAKE, index, stream.generation));
+}
+
+void StreamLoop::collectCompleted(const CompletionHandler& complete) {
+    int remaining = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+        if (message->msg != CURLMSG_DONE) continue;
+
+        CURL* easy = message->easy_handle;
+        CURLcode result = message->data.result;
+        Stream* stream = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char**>(&stream));
+        if (!stream) continue;
+
+        curl_multi_remove_handle(multi, easy);
+        finishStream(static_cast<size_t>(stream - streamSlots.data()), result, complete);
+    }
+}
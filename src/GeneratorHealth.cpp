@@ -0,0 +1,96 @@
+/**
+ * @file GeneratorHealth.cpp
+ * @brief 负载发生器自身饱和检测的实现
+ */
+#include "../include/GeneratorHealth.h"
+#include <algorithm>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+#endif
+
+ThreadUsage sampleCurrentThreadUsage() {
+    ThreadUsage usage;
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (GetThreadTimes(GetCurrentThread(), &creation, &exitTime, &kernel, &user)) {
+        auto ticks = [](const FILETIME& time) {
+            return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        };
+        // FILETIME以100纳秒为单位
+        usage.cpuNs = (ticks(kernel) + ticks(user)) * 100;
+    }
+#else
+    timespec cpu;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0) {
+        usage.cpuNs = static_cast<int64_t>(cpu.tv_sec) * 1000000000 + cpu.tv_nsec;
+    }
+#ifdef RUSAGE_THREAD
+    rusage resources;
+    if (getrusage(RUSAGE_THREAD, &resources) == 0) {
+        usage.involuntarySwitches = resources.ru_nivcsw;
+    }
+#endif
+    // schedstat: 运行时间 运行队列等待时间 时间片数，单位纳秒
+    if (FILE* file = std::fopen("/proc/thread-self/schedstat", "r")) {
+        long long running = 0, waiting = 0;
+        if (std::fscanf(file, "%lld %lld", &running, &waiting) == 2) {
+            usage.runQueueNs = waiting;
+        }
+        std::fclose(file);
+    }
+#endif
+    return usage;
+}
+
+void GeneratorHealth::reset(const HealthThresholds& healthThresholds) {
+    thresholds = healthThresholds;
+    report = HealthReport();
+}
+
+HealthWindow GeneratorHealth::evaluate(const DDSketch& dispatchLagMs, const std::vector<ThreadUsage>& usageDeltas,
+                                       double windowSeconds) {
+    HealthWindow window;
+    if (windowSeconds <= 0) return window;
+
+    window.dispatchLagP99Ms = dispatchLagMs.getCount() > 0 ? dispatchLagMs.quantile(0.99) : 0.0;
+    for (const auto& delta : usageDeltas) {
+        window.maxThreadCpuPercent = std::max(window.maxThreadCpuPercent, delta.cpuNs / 1e7 / windowSeconds);
+        window.maxRunQueuePercent = std::max(window.maxRunQueuePercent, delta.runQueueNs / 1e7 / windowSeconds);
+        window.maxInvoluntarySwitchesPerSec =
+            std::max(window.maxInvoluntarySwitchesPerSec, delta.involuntarySwitches / windowSeconds);
+    }
+
+    std::ostringstream reason;
+    auto check = [&reason](double value, double limit, const char* name) {
+        if (value <= limit) return;
+        if (reason.tellp() > 0) reason << ", ";
+        reason << name << "=" << value << " (阈值 " << limit << ")";
+    };
+    check(window.dispatchLagP99Ms, thresholds.maxDispatchLagMs, "调度延迟P99(毫秒)");
+    check(window.maxThreadCpuPercent, thresholds.maxThreadCpuPercent, "线程CPU(%)");
+    check(window.maxRunQueuePercent, thresholds.maxRunQueuePercent, "运行队列等待(%)");
+    check(window.maxInvoluntarySwitchesPerSec, thresholds.maxInvoluntarySwitchesPerSec, "非自愿切换(次/秒)");
+    window.reason = reason.str();
+    window.saturated = !window.reason.empty();
+
+    HealthWindow& worst = report.worst;
+    worst.dispatchLagP99Ms = std::max(worst.dispatchLagP99Ms, window.dispatchLagP99Ms);
+    worst.maxThreadCpuPercent = std::max(worst.maxThreadCpuPercent, window.maxThreadCpuPercent);
+    worst.maxRunQueuePercent = std::max(worst.maxRunQueuePercent, window.maxRunQueuePercent);
+    worst.maxInvoluntarySwitchesPerSec =
+        std::max(worst.maxInvoluntarySwitchesPerSec, window.maxInvoluntarySwitchesPerSec);
+
+    report.windows++;
+    if (window.saturated) {
+        report.saturatedWindows++;
+        worst.saturated = true;
+        if (report.firstReason.empty()) report.firstReason = window.reason;
+    }
+    return window;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief 与HdrHistogram编码兼容的响应时间直方图的实现
+ */
+#include "../include/LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+const int32_t V2_ENCODING_COOKIE = 0x1c849303 | 0x10;
+const int32_t V2_COMPRESSED_ENCODING_COOKIE = 0x1c849304 | 0x10;
+const size_t ENCODING_HEADER_SIZE = 40;
+
+int countLeadingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - static_cast<int>(index);
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+void putInt32(std::string& out, int32_t value) {
+    uint32_t bits = static_cast<uint32_t>(value);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+void putInt64(std::string& out, int64_t value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((bits >> shift) & 0xFF));
+    }
+}
+
+void putZigZag(std::string& out, int64_t value) {
+    uint64_t encoded = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (encoded >= 0x80) {
+        out.push_back(static_cast<char>((encoded & 0x7F) | 0x80));
+        encoded >>= 7;
+    }
+    out.push_back(static_cast<char>(encoded));
+}
+
+std::string base64Encode(const std::string& input) {
+    static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve((input.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < input.size(); i += 3) {
+        uint32_t chunk = (static_cast<uint8_t>(input[i]) << 16) |
+                         (static_cast<uint8_t>(input[i + 1]) << 8) |
+                         static_cast<uint8_t>(input[i + 2]);
+        out.push_back(ALPHABET[(chunk >> 18) & 0x3F]);
+        out.push_back(ALPHABET[(chunk >> 12) & 0x3F]);
+        out.push_back(ALPHABET[(chunk >> 6) & 0x3F]);
+        out.push_back(ALPHABET[chunk & 0x3F]);
+    }
+    if (i < input.size()) {
+        uint32_t chunk = static_cast<uint8_t>(input[i]) << 16;
+        if (i + 1 < input.size()) chunk |= static_cast<uint8_t>(input[i + 1]) << 8;
+        out.push_back(ALPHABET[(chunk >> 18) & 0x3F]);
+        out.push_back(ALPHABET[(chunk >> 12) & 0x3F]);
+        out.push_back(i + 1 < input.size() ? ALPHABET[(chunk >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram(int64_t highest)
+    : highestTrackableValue(std::max<int64_t>(highest, 2 * SUB_BUCKET_COUNT)),
+      totalCount(0),
+      minValue(std::numeric_limits<int64_t>::max()),
+      maxValue(0) {
+    // 与HdrHistogram相同的桶数计算方式
+    int64_t smallestUntrackable = SUB_BUCKET_COUNT;
+    int bucketCount = 1;
+    while (smallestUntrackable <= highestTrackableValue) {
+        if (smallestUntrackable > std::numeric_limits<int64_t>::max() / 2) {
+            bucketCount++;
+            break;
+        }
+        smallestUntrackable <<= 1;
+        bucketCount++;
+    }
+    counts.assign(static_cast<size_t>(bucketCount + 1) * SUB_BUCKET_HALF_COUNT, 0);
+}
+
+void LatencyHistogram::record(int64_t value, int64_t count) {
+    if (count <= 0) return;
+    value = std::min(std::max<int64_t>(value, 0), highestTrackableValue);
+
+    counts[static_cast<size_t>(countsIndexFor(value))] += count;
+    totalCount += count;
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    totalCount = 0;
+    minValue = std::numeric_limits<int64_t>::max();
+    maxValue = 0;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    size_t length = std::min(counts.size(), other.counts.size());
+    for (size_t i = 0; i < length; ++i) {
+        counts[i] += other.counts[i];
+    }
+    totalCount += other.totalCount;
+    if (other.totalCount > 0) {
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+}
+
+int64_t LatencyHistogram::valueAtQuantile(double q) const {
+    if (totalCount == 0) return 0;
+
+    q = std::min(1.0, std::max(0.0, q));
+    int64_t target = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(q * totalCount)));
+
+    int64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return std::min(maxValue, highestEquivalentValue(valueFromIndex(static_cast<int>(i))));
+        }
+    }
+    return maxValue;
+}
+
+double LatencyHistogram::getMean() const {
+    if (totalCount == 0) return 0.0;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        if (counts[i] > 0) {
+            int64_t low = valueFromIndex(static_cast<int>(i));
+            sum += counts[i] * (low + highestEquivalentValue(low)) / 2.0;
+        }
+    }
+    return sum / totalCount;
+}
+
+std::string LatencyHistogram::encodeCompressedBase64() const {
+    // V2编码：40字节头 + ZigZag LEB128计数（连续的零用负数表示长度）
+    std::string payload;
+    int countsLimit = totalCount > 0 ? countsIndexFor(maxValue) + 1 : 0;
+    for (int index = 0; index < countsLimit;) {
+        int64_t count = counts[static_cast<size_t>(index++)];
+        int64_t zeros = 0;
+        if (count == 0) {
+            zeros = 1;
+            while (index < countsLimit && counts[static_cast<size_t>(index)] == 0) {
+                zeros++;
+                index++;
+            }
+        }
+        putZigZag(payload, zeros > 1 ? -zeros : count);
+    }
+
+    std::string encoded;
+    encoded.reserve(ENCODING_HEADER_SIZE + payload.size());
+    putInt32(encoded, V2_ENCODING_COOKIE);
+    putInt32(encoded, static_cast<int32_t>(payload.size()));
+    putInt32(encoded, 0);                       // normalizingIndexOffset
+    putInt32(encoded, SIGNIFICANT_DIGITS);
+    putInt64(encoded, 1);                       // lowestDiscernibleValue
+    putInt64(encoded, highestTrackableValue);
+    double conversionRatio = 1.0;
+    int64_t ratioBits;
+    std::memcpy(&ratioBits, &conversionRatio, sizeof(ratioBits));
+    putInt64(encoded, ratioBits);
+    encoded.append(payload);
+
+    uLongf compressedSize = compressBound(static_cast<uLong>(encoded.size()));
+    std::string compressed(compressedSize, '\0');
+    if (compress(reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize,
+                 reinterpret_cast<const Bytef*>(encoded.data()), static_cast<uLong>(encoded.size())) != Z_OK) {
+        return std::string();
+    }
+    compressed.resize(compressedSize);
+
+    std::string wrapped;
+    wrapped.reserve(8 + compressed.size());
+    putInt32(wrapped, V2_COMPRESSED_ENCODING_COOKIE);
+    putInt32(wrapped, static_cast<int32_t>(compressed.size()));
+    wrapped.append(compressed);
+    return base64Encode(wrapped);
+}
+
+int LatencyHistogram::countsIndexFor(int64_t value) const {
+    int bucketIndex = (64 - SUB_BUCKET_COUNT_MAGNITUDE) -
+                      countLeadingZeros(static_cast<uint64_t>(value) | (SUB_BUCKET_COUNT - 1));
+    int subBucketIndex = static_cast<int>(value >> bucketIndex);
+    return ((bucketIndex + 1) << SUB_BUCKET_HALF_COUNT_MAGNITUDE) + (subBucketIndex - SUB_BUCKET_HALF_COUNT);
+}
+
+int64_t LatencyHistogram::valueFromIndex(int index) const {
+    int bucketIndex = (index >> SUB_BUCKET_HALF_COUNT_MAGNITUDE) - 1;
+    int subBucketIndex = (index & (SUB_BUCKET_HALF_COUNT - 1)) + SUB_BUCKET_HALF_COUNT;
+    if (bucketIndex < 0) {
+        subBucketIndex -= SUB_BUCKET_HALF_COUNT;
+        bucketIndex = 0;
+    }
+    return static_cast<int64_t>(subBucketIndex) << bucketIndex;
+}
+
+int64_t LatencyHistogram::highestEquivalentValue(int64_t value) const {
+    int bucketIndex = (64 - SUB_BUCKET_COUNT_MAGNITUDE) -
+                      countLeadingZeros(static_cast<uint64_t>(value) | (SUB_BUCKET_COUNT - 1));
+    int subBucketIndex = static_cast<int>(value >> bucketIndex);
+    int adjustedBucket = subBucketIndex >= SUB_BUCKET_COUNT ? bucketIndex + 1 : bucketIndex;
+    int64_t rangeSize = int64_t(1) << adjustedBucket;
+    int64_t lowest = static_cast<int64_t>(subBucketIndex) << bucketIndex;
+    return lowest + rangeSize - 1;
+}
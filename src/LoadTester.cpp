@@ -3,45 +3,131 @@
  * @brief 负载测试器类的实现
  */
 #include "../include/LoadTester.h"
+#include "../include/Tracer.h"
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <limits>
+#include <random>
 #include <curl/curl.h>
 
 LoadTester::LoadTester()
     : isRunning(false),
+      testActive(false),
       completedRequests(0),
       successfulRequests(0),
       requestIdCounter(0),
-      minResponseTime(0),
-      maxResponseTime(0),
-      avgResponseTime(0) {
+      minResponseTimeNs(std::numeric_limits<int64_t>::max()),
+      maxResponseTimeNs(0),
+      totalResponseTimeNs(0),
+      timedRequests(0),
+      statsPublishIntervalMs(100),
+      urlEndpoint(0),
+      numThreads(0),
+      totalRequests(0),
+      snapshotVersion(0),
+      lastSampledCompleted(0),
+      statsBackend(StatsBackend::RAW_SAMPLES),
+      requestTimeoutMs(10000),
+      autoTuneFinished(false),
+      decodeResponses(false),
+      urlCursor(0),
+      reconnectStorms(0),
+      draining(false),
+      cancelledRequests(0),
+      drainTimeoutMs(0),
+      readyWorkers(0),
+      exitedWorkers(0) {
+    statusNotifier.setCallback([this](const StatusUpdate& update) {
+        dispatchStatusUpdate(update);
+    });
 }
 
 LoadTester::~LoadTester() {
-    if (isRunning) {
+    if (testActive) {
         stop();
     }
 }
 
 bool LoadTester::start(const std::string& testUrl, int threadCount, int requests, const std::string& logFilePath) {
-    if (isRunning) return false;
+    if (testActive) return false;
 
     url = testUrl;
+    urlEndpoint = EndpointTable::getInstance().intern(url);
     numThreads = threadCount;
     totalRequests = requests;
     completedRequests = 0;
     successfulRequests = 0;
     requestIdCounter = 0;
-    isRunning = true;
-    responseTimes.clear();
+    minResponseTimeNs = std::numeric_limits<int64_t>::max();
+    maxResponseTimeNs = 0;
+    totalResponseTimeNs = 0;
+    timedRequests = 0;
+    {
+        std::lock_guard<std::mutex> lock(responseTimesMutex);
+        responseTimes.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(seriesMutex);
+        completedPerSecond.clear();
+        lastSampledCompleted = 0;
+        bandwidthPerSecond.clear();
+        lastSampledBandwidth = BandwidthSecond();
+        secondBuckets.clear();
+        steadyDetector = SteadyStateDetector(measurementOptions.stableSeconds, measurementOptions.maxVariation);
+        measurementWindow = MeasurementWindow();
+    }
+
+    // 分片由各工作线程在绑定核心后自行分配
+    workerShards.clear();
+    workerShards.resize(numThreads);
+    readyWorkers = 0;
+    exitedWorkers = 0;
+    draining = false;
+    cancelledRequests = 0;
+    cancellation.reset();
+    reconnectStorms = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(loopStatsMutex);
+        timerStats = TimerStats();
+        webSocketStats = WebSocketStats();
+        streamStats = StreamStats();
+        replayStats = ReplayStats();
+        scenarioStats = ScenarioStats();
+        scenarioStats.reset(scenario);
+    }
+    replayFeed.reset();
+
+    // 自动调优通过全局速率施加负载，从初始速率开始
+    RateLimitOptions limits = rateLimitOptions;
+    if (autoTuneOptions.enabled) {
+        limits.globalRequestsPerSecond = AutoTuner(autoTuneOptions).currentRate();
+    }
+    autoTuneFinished = false;
+    {
+        std::lock_guard<std::mutex> lock(loopStatsMutex);
+        autoTuneSteps.clear();
+        autoTuneReport.clear();
+    }
 
     {
-        std::lock_guard<std::mutex> lock(historyMutex);
-        requestHistory.clear();
+        std::lock_guard<std::mutex> lock(healthMutex);
+        generatorHealth.reset(healthThresholds);
     }
+    lastHealthCheck = std::chrono::steady_clock::now();
+
+    // 端点在测试开始前全部绑定，运行期间限流器只读映射表
+    rateLimiter.configure(limits);
+    rateLimiter.bindEndpoint(urlEndpoint, url);
+    for (const auto& step : scenario.steps) {
+        rateLimiter.bindEndpoint(EndpointTable::getInstance().intern(step.url), step.url);
+    }
+
+    statusNotifier.reset(static_cast<size_t>(numThreads));
 
     // 初始化curl
     curl_global_init(CURL_GLOBAL_ALL);
@@ -55,22 +141,163 @@ bool LoadTester::start(const std::string& testUrl, int threadCount, int requests
 
     log("测试开始: URL=" + url + ", 线程数=" + std::to_string(numThreads) +
         ", 请求数=" + std::to_string(totalRequests));
+    if (scenario.enabled()) {
+        log("场景: " + scenario.name + ", 步骤数=" + std::to_string(scenario.steps.size()));
+    }
+    if (virtualUserOptions.enabled()) {
+        log("虚拟用户模式: 用户数=" + std::to_string(virtualUserOptions.virtualUsers) +
+            ", 思考时间=" + std::to_string(virtualUserOptions.thinkTime.ms) + " 毫秒, 节奏=" +
+            std::to_string(virtualUserOptions.pacingMs) + " 毫秒, 爬坡=" +
+            std::to_string(virtualUserOptions.rampUpMs) + " 毫秒, 阶段时长=" +
+            std::to_string(virtualUserOptions.durationMs) + " 毫秒");
+    }
+    if (autoTuneOptions.enabled) {
+        log("自动调优: 目标=" + autoTuneOptions.slo.describe() + ", 探测时长=" +
+            std::to_string(autoTuneOptions.probeMs) + " 毫秒, 最多探测=" + std::to_string(autoTuneOptions.maxSteps) + " 次");
+    }
+    if (isWebSocketUrl(url)) {
+        if (url.compare(0, 6, "wss://") == 0) {
+            log("不支持wss://，请使用ws://");
+            logFile.close();
+            return false;
+        }
+        int connections = webSocketOptions.connections > 0 ? webSocketOptions.connections : numThreads;
+        log("WebSocket模式: 连接数=" + std::to_string(connections) + ", 发送间隔=" +
+            std::to_string(webSocketOptions.messageIntervalMs) + " 毫秒, 匹配=" +
+            (webSocketOptions.correlate ? "按id" : "回显") + ", 爬坡=" +
+            std::to_string(webSocketOptions.rampUpMs) + " 毫秒");
+    } else if (isTcpUrl(url)) {
+        log(std::string("原始TCP模式: 分帧=") +
+            (tcpOptions.framing == TcpFraming::LINE ? "行" : "长度前缀(" + std::to_string(tcpOptions.lengthBytes) + "字节)") +
+            ", 流水线深度=" + std::to_string(std::max(1, tcpOptions.pipelineDepth)));
+    } else if (replayOptions.enabled()) {
+        if (!loadReplayLog()) {
+            logFile.close();
+            return false;
+        }
+    } else if (streamingOptions.enabled) {
+        int streams = streamingOptions.streams > 0 ? streamingOptions.streams : numThreads;
+        log("流式模式: 流数=" + std::to_string(streams) + ", 保持时长=" +
+            (streamingOptions.streamDurationMs > 0 ? std::to_string(streamingOptions.streamDurationMs) + " 毫秒"
+                                                   : std::string("直到服务端关闭")) +
+            ", 重连间隔=" + std::to_string(streamingOptions.reconnectDelayMs) + " 毫秒, 爬坡=" +
+            std::to_string(streamingOptions.rampUpMs) + " 毫秒, 时间戳字段=" +
+            (streamingOptions.timestampField.empty() ? std::string("无") : streamingOptions.timestampField));
+    } else if (!connectionOptions.isDefault()) {
+        std::ostringstream line;
+        line << "连接策略: 每连接请求数=";
+        if (connectionOptions.requestsPerConnection > 0) {
+            line << connectionOptions.requestsPerConnection;
+        } else {
+            line << "不限";
+        }
+        line << ", 连接寿命=" << connectionOptions.maxConnectionAgeMs << " 毫秒, 重连风暴间隔="
+             << connectionOptions.reconnectStormIntervalMs << " 毫秒";
+        log(line.str());
+    }
+    if (!loadUrlList()) {
+        logFile.close();
+        return false;
+    }
+    if (throughputOptions.enabled) {
+        log("吞吐量模式: 接收缓冲区=" + std::to_string(throughputOptions.receiveBufferKB) + " KB, 请求之间不插入间隔" +
+            (connectionOptions.requestsPerConnection == 0 ? "" : "（每连接请求数不为0，会反复建连）"));
+    }
+    // 场景、流式、回放、原始TCP与WebSocket模式不经过解码器
+    decodeResponses = compressionOptions.enabled() && !scenario.enabled() && !streamingOptions.enabled && !replayFeed &&
+                      !isTcpUrl(url) && !isWebSocketUrl(url);
+    if (compressionOptions.enabled()) {
+        log("压缩协商: Accept-Encoding=" + compressionOptions.acceptEncoding +
+            (decodeResponses ? "" : "（本模式不统计解码开销）"));
+    }
+    if (measurementOptions.enabled()) {
+        std::ostringstream line;
+        line << "测量窗口配置: 预热=" << measurementOptions.warmUpMs << " 毫秒, 冷却=" << measurementOptions.coolDownMs
+             << " 毫秒";
+        if (measurementOptions.autoDetect) {
+            line << ", 自动检测稳态(连续" << measurementOptions.stableSeconds << "秒变异系数≤" << std::fixed
+                 << std::setprecision(1) << measurementOptions.maxVariation * 100.0 << "%)";
+        }
+        log(line.str());
+    }
+    if (rateLimitOptions.enabled()) {
+        std::ostringstream line;
+        line << "限流: 全局=" << rateLimitOptions.globalRequestsPerSecond << " 请求/秒";
+        for (const auto& limit : rateLimitOptions.endpointLimits) {
+            line << ", " << limit.pattern << "=" << limit.requestsPerSecond << " 请求/秒";
+        }
+        log(line.str());
+    }
+
+    // 追踪在工作线程启动前开启，使每个线程从第一个区间起都被记录
+    if (!traceFile.empty()) {
+        if (Tracer::compiledIn()) {
+            Tracer::getInstance().clear();
+            Tracer::getInstance().setEnabled(true);
+            log("追踪已开启: " + traceFile);
+        } else {
+            log("未以LOADTESTER_TRACING编译，忽略追踪文件: " + traceFile);
+        }
+    }
 
     startTime = std::chrono::system_clock::now();
 
+    // 启动结果导出
+    exporter.setThreadCore(affinityOptions.exporterCore);
+    if (exportOptions.enabled() && !exporter.open(exportOptions, startTime, static_cast<size_t>(numThreads))) {
+        log("无法打开导出文件: " + exporter.getLastError());
+        logFile.close();
+        return false;
+    }
+
+    isRunning = true;
+    testActive = true;
+    publishSnapshot();
+
     // 确保线程向量是空的
     threads.clear();
 
+    // 回放以此刻为起点，解析线程先于工作线程开始读日志
+    if (replayFeed) replayFeed->start();
+
     // 启动工作线程
     for (int i = 0; i < numThreads; i++) {
-        threads.push_back(std::thread(&LoadTester::workerThread, this));
+        threads.push_back(std::thread(&LoadTester::workerThread, this, i));
+    }
+
+    // 所有分片就绪后再启动聚合线程，此后分片数组不再变化
+    {
+        std::unique_lock<std::mutex> lock(shardsMutex);
+        shardsReady.wait(lock, [this] { return readyWorkers == numThreads; });
+    }
+    aggregator = std::thread(&LoadTester::aggregatorThread, this);
+    if (autoTuneOptions.enabled) {
+        autoTuner = std::thread(&LoadTester::autoTuneThread, this);
     }
 
     return true;
 }
 
 void LoadTester::stop() {
-    isRunning = false;
+    if (!testActive) return;
+
+    // 先停止发起新请求，在排空时限内等待进行中的请求自然完成
+    draining = true;
+    int drainMs = drainTimeoutMs;
+    if (drainMs > 0) {
+        std::unique_lock<std::mutex> lock(shardsMutex);
+        workersExited.wait_for(lock, std::chrono::milliseconds(drainMs),
+                               [this] { return exitedWorkers == static_cast<int>(threads.size()); });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(aggregatorMutex);
+        isRunning = false;
+    }
+    aggregatorWakeup.notify_all();
+
+    // 唤醒阻塞在curl_multi_poll上的线程，剩余的传输被中断
+    cancellation.cancel();
 
     // 等待所有线程完成
     for (auto& t : threads) {
@@ -78,6 +305,212 @@ void LoadTester::stop() {
     }
 
     threads.clear();
+    if (replayFeed) replayFeed->stop();
+
+    if (aggregator.joinable()) aggregator.join();
+    if (autoTuner.joinable()) autoTuner.join();
+
+    if (!traceFile.empty() && Tracer::compiledIn()) {
+        Tracer& tracer = Tracer::getInstance();
+        tracer.setEnabled(false);
+        if (tracer.writeChromeTrace(traceFile)) {
+            log("追踪已写出: " + traceFile + ", 区间数=" + std::to_string(tracer.getEventCount()) +
+                ", 丢弃=" + std::to_string(tracer.getDroppedCount()));
+        } else {
+            log("无法写出追踪文件: " + traceFile);
+        }
+    }
+
+    // 最后一个不完整的窗口，工作线程退出前已写入最终的资源使用
+    if (std::chrono::steady_clock::now() - lastHealthCheck >= std::chrono::milliseconds(HEALTH_WINDOW_MS / 10)) {
+        evaluateGeneratorHealth();
+    }
+    HealthReport health = getGeneratorHealth();
+    {
+        std::ostringstream line;
+        line << "发生器健康: 窗口=" << health.windows << ", 饱和窗口=" << health.saturatedWindows << std::fixed
+             << std::setprecision(2) << ", 最大调度延迟P99=" << health.worst.dispatchLagP99Ms
+             << " 毫秒, 最高线程CPU=" << health.worst.maxThreadCpuPercent << "%, 最高运行队列等待="
+             << health.worst.maxRunQueuePercent << "%, 最高非自愿切换=" << health.worst.maxInvoluntarySwitchesPerSec
+             << " 次/秒";
+        log(line.str());
+        if (health.untrustworthy()) {
+            log("警告: 负载发生器自身饱和，本次结果不可信（" + health.firstReason + "）");
+        }
+    }
+
+    // 记录每个工作线程的放置位置与吞吐量
+    for (const auto& worker : getWorkerStats()) {
+        std::ostringstream line;
+        line << "工作线程" << worker.workerIndex << ": 核心=" << worker.core
+             << (worker.pinned ? "(已绑定)" : "") << ", NUMA节点=" << worker.numaNode
+             << ", 完成=" << worker.completedRequests << ", 吞吐量="
+             << std::fixed << std::setprecision(1) << worker.requestsPerSecond << " 请求/秒";
+        if (worker.bytesReceived > 0) {
+            line << ", 接收=" << std::setprecision(2) << worker.receiveMegabytesPerSecond << " MB/s";
+        }
+        log(line.str());
+    }
+
+    BandwidthSecond traffic = totalBandwidth();
+    if (traffic.bytesSent + traffic.bytesReceived > 0) {
+        double seconds = std::chrono::duration<double>(std::chrono::system_clock::now() - startTime).count();
+        double receiveRate = BandwidthStats::megabytesPerSecond(traffic.bytesReceived, seconds);
+        uint64_t peakReceived = 0;
+        for (const auto& second : getBandwidthSeries()) {
+            peakReceived = std::max(peakReceived, second.bytesReceived);
+        }
+        std::ostringstream line;
+        line << "流量: 发送=" << traffic.bytesSent << " 字节, 接收=" << traffic.bytesReceived << " 字节, 平均接收="
+             << std::fixed << std::setprecision(2) << receiveRate << " MB/s (" << std::setprecision(3)
+             << receiveRate * 8 / 1000 << " Gbit/s), 峰值秒=" << std::setprecision(2) << peakReceived / 1e6 << " MB/s";
+        log(line.str());
+    }
+
+    if (throughputOptions.enabled) {
+        BandwidthStats bandwidth = getBandwidthStats();
+        std::ostringstream line;
+        line << "吞吐量模式: 成功传输=" << bandwidth.transfers << ", 响应体=" << bandwidth.bodyBytes << " 字节"
+             << std::fixed << std::setprecision(3) << ", 首字节P50/P99=" << bandwidth.firstByte.quantile(0.50) << "/"
+             << bandwidth.firstByte.quantile(0.99) << " 毫秒, 末字节P50/P99=" << bandwidth.lastByte.quantile(0.50)
+             << "/" << bandwidth.lastByte.quantile(0.99) << " 毫秒" << std::setprecision(2)
+             << ", 单请求速率P1/P50/P99=" << bandwidth.throughput.quantile(0.01) << "/"
+             << bandwidth.throughput.quantile(0.50) << "/" << bandwidth.throughput.quantile(0.99) << " MB/s";
+        log(line.str());
+    }
+
+    if (scenario.enabled()) {
+        ScenarioStats stepStats = getScenarioStats();
+        auto logStep = [this](const char* kind, const StepStats& stats) {
+            std::ostringstream line;
+            line << kind << " " << stats.name << ": 次数=" << stats.count << ", 成功=" << stats.successful
+                 << ", 失败=" << stats.failed << ", 错误=" << stats.errors << std::fixed << std::setprecision(2)
+                 << ", 平均=" << stats.latency.getAverage() << " 毫秒, P50=" << stats.latency.quantile(0.50)
+                 << " 毫秒, P99=" << stats.latency.quantile(0.99) << " 毫秒";
+            log(line.str());
+        };
+        for (const auto& step : stepStats.steps) {
+            logStep("步骤", step);
+        }
+        logStep("事务", stepStats.transactions);
+    }
+
+    if (autoTuneOptions.enabled) {
+        std::lock_guard<std::mutex> lock(loopStatsMutex);
+        log(autoTuneReport);
+    }
+
+    for (const auto& bucket : getRateLimitStats()) {
+        std::ostringstream line;
+        line << "限流 " << bucket.name << ": 上限=" << bucket.requestsPerSecond << " 请求/秒, 放行="
+             << bucket.admitted << ", 推迟=" << bucket.throttled << ", 推迟总时长=" << std::fixed
+             << std::setprecision(1) << bucket.throttledWaitMs << " 毫秒";
+        log(line.str());
+    }
+
+    if (isWebSocketUrl(url)) {
+        WebSocketStats sockets = getWebSocketStats();
+        std::ostringstream line;
+        line << "WebSocket: 打开=" << sockets.opened << ", 失败=" << sockets.failed << ", 断开=" << sockets.dropped
+             << ", 发送消息=" << sockets.messagesSent << ", 未匹配回复=" << sockets.unmatchedReplies << std::fixed
+             << std::setprecision(3) << ", TCP建连P50/P99=" << sockets.connectLatency.quantile(0.50) << "/"
+             << sockets.connectLatency.quantile(0.99) << " 毫秒, 升级完成P50/P99="
+             << sockets.upgradeLatency.quantile(0.50) << "/" << sockets.upgradeLatency.quantile(0.99) << " 毫秒";
+        log(line.str());
+    }
+
+    if (replayFeed) {
+        ReplayStats replay = getReplayStats();
+        std::ostringstream line;
+        line << "回放: 读取行=" << replay.lines << ", 请求=" << replay.requests << ", 无法解析=" << replay.malformed
+             << ", 时间倒退=" << replay.outOfOrder << ", 已发出=" << replay.dispatched << std::fixed
+             << std::setprecision(1) << ", 日志跨度=" << replay.logSpanNs / 1e9 << " 秒, 回放时长="
+             << replay.replaySpanNs / 1e9 << " 秒" << (replay.finished ? "" : "（日志未回放完）");
+        log(line.str());
+    }
+
+    bool streaming = streamingOptions.enabled && !replayFeed && !isWebSocketUrl(url) && !isTcpUrl(url);
+    if (streaming) {
+        StreamStats streams = getStreamStats();
+        std::ostringstream line;
+        line << "流式: 结束的流=" << streams.streams << ", 失败=" << streams.failedStreams << ", 事件="
+             << streams.events << ", 字节=" << streams.bytes << std::fixed << std::setprecision(3)
+             << ", 首事件P50/P99=" << streams.firstEvent.quantile(0.50) << "/" << streams.firstEvent.quantile(0.99)
+             << " 毫秒, 事件间隔P50/P99=" << streams.interEventGap.quantile(0.50) << "/"
+             << streams.interEventGap.quantile(0.99) << " 毫秒";
+        if (streams.eventLag.getCount() > 0) {
+            line << ", 端到端延迟P50/P99=" << streams.eventLag.quantile(0.50) << "/" << streams.eventLag.quantile(0.99)
+                 << " 毫秒";
+        }
+        if (streams.skewedTimestamps > 0) {
+            line << ", 时间戳超前(时钟不同步)=" << streams.skewedTimestamps;
+        }
+        log(line.str());
+    }
+
+    if (virtualUserOptions.enabled() || scenario.enabled() || isWebSocketUrl(url) || streaming) {
+        TimerStats timing = getTimerStats();
+        std::ostringstream line;
+        line << "定时器: 触发=" << timing.firedTimers << ", 迟到(>1毫秒)=" << timing.lateTimers
+             << ", 平均延迟=" << std::fixed << std::setprecision(3) << timing.meanLatenessMs()
+             << " 毫秒, 最大延迟=" << timing.maxLatenessNs / 1e6 << " 毫秒";
+        log(line.str());
+    }
+
+    if (cancelledRequests > 0) {
+        log("停止时中断进行中的请求: " + std::to_string(cancelledRequests));
+    }
+
+    ConnectionStats connections = getConnectionStats();
+    if (connections.opened > 0) {
+        double seconds = std::chrono::duration<double>(std::chrono::system_clock::now() - startTime).count();
+        std::ostringstream line;
+        line << "连接: 新建=" << connections.opened << ", 建连速率=" << std::fixed << std::setprecision(1)
+             << (seconds > 0 ? connections.opened / seconds : 0.0) << " 次/秒, 重连=" << connections.reconnects
+             << ", 重连风暴=" << connections.storms << std::setprecision(3) << ", TCP握手P50/P99="
+             << connections.tcpHandshake.quantile(0.50) << "/" << connections.tcpHandshake.quantile(0.99) << " 毫秒";
+        if (connections.tlsHandshake.getCount() > 0) {
+            line << ", TLS握手P50/P99=" << connections.tlsHandshake.quantile(0.50) << "/"
+                 << connections.tlsHandshake.quantile(0.99) << " 毫秒";
+        }
+        if (connections.reconnects > 0) {
+            line << ", 重连延迟P50/P99=" << connections.reconnectLatency.quantile(0.50) << "/"
+                 << connections.reconnectLatency.quantile(0.99) << " 毫秒";
+        }
+        log(line.str());
+    }
+
+    if (decodeResponses) {
+        CompressionStats compression = getCompressionStats();
+        for (size_t i = 0; i < static_cast<size_t>(ContentEncoding::COUNT); ++i) {
+            auto encoding = static_cast<ContentEncoding>(i);
+            const EncodingStats& bytes = compression.of(encoding);
+            if (bytes.responses == 0) continue;
+            std::ostringstream line;
+            line << "响应编码 " << CompressionStats::name(encoding) << ": 响应=" << bytes.responses << ", 线路字节="
+                 << bytes.wireBytes << ", 解码后字节=" << bytes.decodedBytes << std::fixed << std::setprecision(2)
+                 << ", 压缩比=" << bytes.ratio() << ", 解码耗时=" << std::setprecision(3) << bytes.decodeNs / 1e6
+                 << " 毫秒(" << bytes.decodeMsPerMB() << " 毫秒/MB)";
+            if (bytes.failed > 0) line << ", 解码失败=" << bytes.failed;
+            if (bytes.unsupported > 0) line << ", 未解码=" << bytes.unsupported;
+            log(line.str());
+        }
+    }
+
+    if (measurementOptions.enabled()) {
+        finishMeasurementWindow();
+    }
+
+    // 写出剩余的导出数据
+    bool exported = exporter.isOpen();
+    exporter.close();
+    if (exported && exporter.getDroppedCount() > 0) {
+        log("导出队列已满，丢弃了 " + std::to_string(exporter.getDroppedCount()) +
+            " 条逐请求记录（区间汇总同样不含这些请求），可调大ExportQueueCapacity");
+    }
+
+    // 投递剩余的状态增量
+    statusNotifier.flush(completedRequests, totalRequests, getSuccessRate());
 
     endTime = std::chrono::system_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
@@ -85,18 +518,26 @@ void LoadTester::stop() {
     // 记录摘要
     log("测试完成: " + std::to_string(completedRequests) + "/" + std::to_string(totalRequests) +
         " 请求已完成, " + std::to_string(successfulRequests) + " 成功 (" +
-        std::to_string(successfulRequests * 100.0 / completedRequests) + "%)");
+        std::to_string(getSuccessRate()) + "%)");
     log("测试持续时间: " + std::to_string(duration) + " 毫秒");
 
-    // 计算统计信息
-    calculateStatistics();
+    // 发布最终快照
+    publishSnapshot(true);
+    StatsSnapshot finalStats = statsSnapshot.read();
 
     // 记录响应时间统计
-    log("响应时间: 最小=" + std::to_string(minResponseTime) + " 毫秒, 平均=" +
-        std::to_string(avgResponseTime) + " 毫秒, 最大=" + std::to_string(maxResponseTime) + " 毫秒");
+    log("响应时间: 最小=" + std::to_string(finalStats.minResponseTime) + " 毫秒, 平均=" +
+        std::to_string(finalStats.avgResponseTime) + " 毫秒, 最大=" +
+        std::to_string(finalStats.maxResponseTime) + " 毫秒");
+    log("响应时间分位数: P50=" + std::to_string(finalStats.p50ResponseTime) + " 毫秒, P90=" +
+        std::to_string(finalStats.p90ResponseTime) + " 毫秒, P99=" +
+        std::to_string(finalStats.p99ResponseTime) + " 毫秒");
 
     logFile.close();
     curl_global_cleanup();
+
+    // 最终快照与日志都已写完，此后界面读到的结果不再变化
+    testActive = false;
 }
 
 int LoadTester::getCompletedRequests() const {
@@ -117,44 +558,383 @@ double LoadTester::getSuccessRate() const {
 }
 
 bool LoadTester::isTestRunning() const {
-    return isRunning;
+    return testActive;
 }
 
 void LoadTester::setStatusCallback(std::function<void(int, int, double)> callback) {
     statusCallback = callback;
 }
 
+void LoadTester::setStatusUpdateCallback(std::function<void(const StatusUpdate&)> callback) {
+    statusUpdateCallback = callback;
+}
+
+void LoadTester::setStatusNotifyInterval(int intervalMs) {
+    statusNotifier.setInterval(std::chrono::milliseconds(std::max(1, intervalMs)));
+}
+
 void LoadTester::setRequestCallback(std::function<void(const RequestResult&)> callback) {
     requestCallback = callback;
 }
 
 std::vector<RequestResult> LoadTester::getRecentResults(int count) const {
-    std::lock_guard<std::mutex> lock(historyMutex);
     std::vector<RequestResult> results;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        shard->history.collect(0, results);
+    }
+
+    // 合并各线程的历史，取最近的count个结果，最新的在前
+    std::sort(results.begin(), results.end(), [](const RequestResult& a, const RequestResult& b) {
+        return a.timestampNs > b.timestampNs;
+    });
+    results.resize(std::min(results.size(), static_cast<size_t>(std::max(0, count))));
+    return results;
+}
 
-    // 取最近的count个结果
-    int resultCount = std::min(count, static_cast<int>(requestHistory.size()));
-    results.reserve(resultCount);
+void LoadTester::setStatsPublishInterval(int intervalMs) {
+    statsPublishIntervalMs = std::max(1, intervalMs);
+}
 
-    // 从最新的开始复制
-    auto it = requestHistory.begin();
-    for (int i = 0; i < resultCount; ++i, ++it) {
-        results.push_back(*it);
+void LoadTester::setStatsBackend(StatsBackend backend) {
+    if (testActive) return;
+    statsBackend = backend;
+}
+
+StatsBackend LoadTester::getStatsBackend() const {
+    return statsBackend;
+}
+
+DDSketch LoadTester::getLatencySketch() const {
+    DDSketch merged;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        merged.merge(shard->sketch);
     }
+    return merged;
+}
 
-    return results;
+void LoadTester::setAffinityOptions(const AffinityOptions& options) {
+    if (testActive) return;
+    affinityOptions = options;
+}
+
+std::vector<WorkerStats> LoadTester::getWorkerStats() const {
+    double elapsedSeconds = statsSnapshot.read().elapsedMs / 1000.0;
+
+    std::vector<WorkerStats> stats;
+    for (size_t i = 0; i < workerShards.size(); ++i) {
+        const auto& shard = workerShards[i];
+        if (!shard) continue;
+
+        WorkerStats worker;
+        worker.workerIndex = static_cast<int>(i);
+        worker.core = shard->core;
+        worker.numaNode = shard->numaNode;
+        worker.pinned = shard->pinned;
+        worker.completedRequests = shard->completed.load(std::memory_order_relaxed);
+        worker.requestsPerSecond = elapsedSeconds > 0 ? worker.completedRequests / elapsedSeconds : 0.0;
+        worker.bytesReceived = shard->bytesReceived.load(std::memory_order_relaxed);
+        worker.receiveMegabytesPerSecond = BandwidthStats::megabytesPerSecond(worker.bytesReceived, elapsedSeconds);
+        stats.push_back(worker);
+    }
+    return stats;
+}
+
+void LoadTester::setVirtualUserOptions(const VirtualUserOptions& options) {
+    if (testActive) return;
+    virtualUserOptions = options;
+}
+
+void LoadTester::setRequestTimeout(int timeoutMs) {
+    if (testActive) return;
+    requestTimeoutMs = std::max(1, timeoutMs);
+}
+
+void LoadTester::setScenario(const Scenario& userScenario) {
+    if (testActive) return;
+    scenario = userScenario;
+}
+
+ScenarioStats LoadTester::getScenarioStats() const {
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    return scenarioStats;
+}
+
+void LoadTester::setRateLimitOptions(const RateLimitOptions& options) {
+    if (testActive) return;
+    rateLimitOptions = options;
+}
+
+std::vector<RateLimitStats> LoadTester::getRateLimitStats() const {
+    return rateLimiter.getStats();
+}
+
+void LoadTester::setAutoTuneOptions(const AutoTuneOptions& options) {
+    if (testActive) return;
+    autoTuneOptions = options;
+}
+
+void LoadTester::setTraceFile(const std::string& filePath) {
+    if (testActive) return;
+    traceFile = filePath;
+}
+
+void LoadTester::setDrainTimeout(int timeoutMs) {
+    drainTimeoutMs = std::max(0, timeoutMs);
+}
+
+int LoadTester::getCancelledRequests() const {
+    return cancelledRequests;
+}
+
+void LoadTester::setTcpOptions(const TcpOptions& options) {
+    if (testActive) return;
+    tcpOptions = options;
+}
+
+void LoadTester::setCompressionOptions(const CompressionOptions& options) {
+    if (testActive) return;
+    compressionOptions = options;
+}
+
+CompressionStats LoadTester::getCompressionStats() const {
+    CompressionStats merged;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        merged.merge(shard->compression);
+    }
+    return merged;
+}
+
+void LoadTester::setWebSocketOptions(const WebSocketOptions& options) {
+    if (testActive) return;
+    webSocketOptions = options;
+}
+
+WebSocketStats LoadTester::getWebSocketStats() const {
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    return webSocketStats;
+}
+
+void LoadTester::setStreamingOptions(const StreamingOptions& options) {
+    if (testActive) return;
+    streamingOptions = options;
+}
+
+StreamStats LoadTester::getStreamStats() const {
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    return streamStats;
+}
+
+void LoadTester::setConnectionOptions(const ConnectionOptions& options) {
+    if (testActive) return;
+    connectionOptions = options;
+    connectionOptions.requestsPerConnection = std::max(0, options.requestsPerConnection);
+}
+
+ConnectionStats LoadTester::getConnectionStats() const {
+    ConnectionStats merged;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        merged.merge(shard->connections);
+    }
+    merged.storms = reconnectStorms.load();
+    return merged;
+}
+
+void LoadTester::setMeasurementWindowOptions(const MeasurementWindowOptions& options) {
+    if (testActive) return;
+    measurementOptions = options;
+    measurementOptions.warmUpMs = std::max(0, options.warmUpMs);
+    measurementOptions.coolDownMs = std::max(0, options.coolDownMs);
+}
+
+MeasurementWindow LoadTester::getMeasurementWindow() const {
+    std::lock_guard<std::mutex> lock(seriesMutex);
+    return measurementWindow;
+}
+
+std::vector<ProbeStep> LoadTester::getAutoTuneSteps() const {
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    return autoTuneSteps;
+}
+
+TimerStats LoadTester::getTimerStats() const {
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    return timerStats;
+}
+
+void LoadTester::setExportOptions(const ExportOptions& options) {
+    exportOptions = options;
+}
+
+std::vector<uint32_t> LoadTester::getThroughputSeries() const {
+    std::lock_guard<std::mutex> lock(seriesMutex);
+    return completedPerSecond;
+}
+
+std::vector<BandwidthSecond> LoadTester::getBandwidthSeries() const {
+    std::lock_guard<std::mutex> lock(seriesMutex);
+    return bandwidthPerSecond;
+}
+
+void LoadTester::setThroughputOptions(const ThroughputOptions& options) {
+    if (testActive) return;
+    throughputOptions = options;
+    throughputOptions.receiveBufferKB = std::max(1, options.receiveBufferKB);
+}
+
+void LoadTester::setUrlListOptions(const UrlListOptions& options) {
+    if (testActive) return;
+    urlListOptions = options;
+}
+
+void LoadTester::setReplayOptions(const ReplayOptions& options) {
+    if (testActive) return;
+    replayOptions = options;
+    replayOptions.maxInFlight = std::max(1, options.maxInFlight);
+}
+
+ReplayStats LoadTester::getReplayStats() const {
+    ReplayStats stats;
+    if (replayFeed) stats = replayFeed->getStats();
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    stats.dispatched = replayStats.dispatched;
+    stats.replaySpanNs = replayStats.replaySpanNs;
+    return stats;
+}
+
+bool LoadTester::loadReplayLog() {
+    auto feed = std::make_unique<ReplayFeed>();
+    std::string error;
+    if (!feed->open(replayOptions.path, numThreads, error)) {
+        log("加载访问日志失败: " + error);
+        return false;
+    }
+    replayFeed = std::move(feed);
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "访问日志回放: 文件=" << replayOptions.path << ", 大小="
+         << replayFeed->getFileBytes() / 1e6 << " MB, 倍率=";
+    if (replayOptions.timed()) {
+        line << replayOptions.speed << "x";
+    } else {
+        line << "尽快";
+    }
+    line << ", 每线程并发上限=" << replayOptions.maxInFlight << ", User-Agent="
+         << (replayOptions.sendUserAgent ? "按日志" : "不发送");
+    log(line.str());
+    return true;
+}
+
+bool LoadTester::loadUrlList() {
+    urlList.reset();
+    urlCursor = 0;
+    if (!urlListOptions.enabled()) {
+        EndpointTable::getInstance().attachList(nullptr);
+        return true;
+    }
+    if (isWebSocketUrl(url) || isTcpUrl(url) || replayFeed || streamingOptions.enabled || scenario.enabled()) {
+        log("URL列表只用于HTTP单请求模式，本次忽略: " + urlListOptions.path);
+        EndpointTable::getInstance().attachList(nullptr);
+        return true;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    auto list = std::make_shared<UrlList>();
+    std::string error;
+    if (!list->open(urlListOptions.path, error)) {
+        log("加载URL列表失败: " + error);
+        EndpointTable::getInstance().attachList(nullptr);
+        return false;
+    }
+    double indexMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    // 打乱顺序由所有线程共用，种子在这里定下来
+    activeUrlList = urlListOptions;
+    if (activeUrlList.seed == 0) {
+        activeUrlList.seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    }
+    urlList = std::move(list);
+    EndpointTable::getInstance().attachList(urlList);
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "URL列表: 文件=" << urlListOptions.path
+         << ", URL数=" << urlList->size() << ", 大小=" << urlList->getFileBytes() / 1e6 << " MB, 选择="
+         << UrlListOptions::selectionName(activeUrlList.selection);
+    if (activeUrlList.selection == UrlSelection::ZIPF) line << "(s=" << activeUrlList.zipfSkew << ")";
+    line << ", 索引耗时=" << indexMs << " 毫秒";
+    if (urlList->getSkippedLines() > 0) line << ", 跳过超长行=" << urlList->getSkippedLines();
+    log(line.str());
+    return true;
+}
+
+BandwidthStats LoadTester::getBandwidthStats() const {
+    BandwidthStats merged;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        merged.merge(shard->bandwidth);
+    }
+    return merged;
+}
+
+RunSummary LoadTester::buildRunSummary() const {
+    StatsSnapshot stats = statsSnapshot.read();
+
+    RunSummary summary;
+    summary.url = url;
+    summary.threads = numThreads;
+    summary.totalRequests = stats.totalRequests;
+    summary.completedRequests = stats.completedRequests;
+    summary.successfulRequests = stats.successfulRequests;
+    summary.startTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        startTime.time_since_epoch()).count();
+    summary.durationMs = stats.elapsedMs;
+    summary.completedPerSecond = getThroughputSeries();
+    HealthReport health = getGeneratorHealth();
+    summary.generatorSaturated = health.untrustworthy();
+    summary.saturationReason = health.firstReason;
+
+    if (measurementOptions.enabled() && stats.measuredRequests > 0) {
+        // 只保存测量窗口内的数据，对比时不受预热和冷却影响
+        MeasurementWindow window = getMeasurementWindow();
+        SecondBucket measured = mergeMeasuredBuckets();
+        summary.latency = measured.latency;
+        summary.measureStartSecond = window.startSecond;
+        summary.measureEndSecond = window.endSecond;
+        summary.measuredRequests = static_cast<int>(measured.completed);
+        summary.measuredSuccessful = static_cast<int>(measured.successful);
+        summary.steadyStateDetected = window.steadyStateDetected;
+    } else if (statsBackend == StatsBackend::SKETCH) {
+        summary.latency = getLatencySketch();
+    } else {
+        std::lock_guard<std::mutex> lock(responseTimesMutex);
+        for (double time : responseTimes) {
+            summary.latency.add(time);
+        }
+    }
+    return summary;
+}
+
+StatsSnapshot LoadTester::getStatsSnapshot() const {
+    return statsSnapshot.read();
 }
 
 double LoadTester::getMinResponseTime() const {
-    return minResponseTime;
+    return statsSnapshot.read().minResponseTime;
 }
 
 double LoadTester::getMaxResponseTime() const {
-    return maxResponseTime;
+    return statsSnapshot.read().maxResponseTime;
 }
 
 double LoadTester::getAvgResponseTime() const {
-    return avgResponseTime;
+    return statsSnapshot.read().avgResponseTime;
 }
 
 std::vector<double> LoadTester::getResponseTimes() const {
@@ -173,12 +953,8 @@ std::string LoadTester::readLogFile(const std::string& logFilePath) {
     return buffer.str();
 }
 
-size_t LoadTester::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * nmemb);
-    return size * nmemb;
-}
-
 void LoadTester::log(const std::string& message) {
+    TRACE_SPAN("log");
     std::lock_guard<std::mutex> lock(logMutex);
     auto now = std::chrono::system_clock::now();
     auto now_c = std::chrono::system_clock::to_time_t(now);
@@ -192,111 +968,702 @@ void LoadTester::log(const std::string& message) {
     std::cout << ss.str() << std::endl;
 }
 
-void LoadTester::addResult(const RequestResult& result) {
-    std::lock_guard<std::mutex> lock(historyMutex);
-    // 添加到队列前面（最新的在前）
-    requestHistory.push_front(result);
-
-    // 限制历史记录大小
-    if (requestHistory.size() > MAX_HISTORY_SIZE) {
-        requestHistory.pop_back();
-    }
+void LoadTester::addResult(int workerIndex, const RequestResult& result) {
+    TRACE_SPAN("addResult");
+    // 历史、状态通知与导出都写入本线程自己的分片或队列，热路径上没有跨线程的锁
+    workerShards[workerIndex]->history.push(result);
 
     // 如果有回调，通知UI
     if (requestCallback) {
+        TRACE_SPAN("requestCallback");
         requestCallback(result);
     }
+
+    // 计入下一次合并状态通知
+    statusNotifier.record(static_cast<size_t>(workerIndex), result);
+
+    // 交给后台导出线程
+    if (exporter.isOpen()) {
+        exporter.record(static_cast<size_t>(workerIndex), result);
+    }
 }
 
-RequestResult LoadTester::makeRequest() {
-    CURL* curl;
-    CURLcode res;
-    std::string readBuffer;
-    int requestId = ++requestIdCounter;
+RequestResult LoadTester::completeRequest(int workerIndex, int requestId, uint32_t endpoint,
+                                         const TransferResult& transfer) {
+    TRACE_SPAN("completeRequest");
+    int64_t elapsedNs = transfer.elapsedNs;
+    double elapsed = elapsedNs / 1e6;
 
-    curl = curl_easy_init();
-    if (curl) {
-        auto requestStart = std::chrono::high_resolution_clock::now();
+    recordResponseTime(workerIndex, elapsedNs);
 
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);  // 10秒超时
+    completedRequests++;
+    workerShards[workerIndex]->completed.fetch_add(1, std::memory_order_relaxed);
 
-        res = curl_easy_perform(curl);
+    RequestResult result(requestId, RequestStatus::REQ_ERROR, 0, endpoint, elapsedNs, transfer.code);
+    result.bytesReceived = transfer.bytesReceived;
+    result.bytesSent = static_cast<uint32_t>(std::min<uint64_t>(transfer.bytesSent, UINT32_MAX));
+    workerShards[workerIndex]->bytesSent.fetch_add(transfer.bytesSent, std::memory_order_relaxed);
+    workerShards[workerIndex]->bytesReceived.fetch_add(transfer.bytesReceived, std::memory_order_relaxed);
 
-        auto requestEnd = std::chrono::high_resolution_clock::now();
-        double elapsed = std::chrono::duration<double, std::milli>(requestEnd - requestStart).count();
+    if (transfer.code == CURLE_OK) {
+        int response_code = transfer.statusCode;
+        result.statusCode = static_cast<int16_t>(response_code);
 
-        {
-            std::lock_guard<std::mutex> lock(responseTimesMutex);
-            responseTimes.push_back(elapsed);
+        // 逐请求的结果由导出线程写出，热路径上不再经过带锁、逐行刷新的日志
+        if (response_code >= 200 && response_code < 300) {
+            successfulRequests++;
+            result.status = RequestStatus::SUCCESS;
+        } else {
+            result.status = RequestStatus::FAILED;
+        }
+    }
+
+    if (autoTuneOptions.enabled) {
+        WorkerShard& shard = *workerShards[workerIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.probeSketch.add(elapsed);
+        shard.probeCompleted++;
+        if (result.status != RequestStatus::SUCCESS) shard.probeFailed++;
+    }
+
+    if (transfer.newConnection) {
+        WorkerShard& shard = *workerShards[workerIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.connections.record(transfer.reconnect, transfer.tcpHandshakeNs, transfer.tlsHandshakeNs,
+                                 transfer.connectReadyNs);
+    }
+
+    if (throughputOptions.enabled && transfer.code == CURLE_OK) {
+        WorkerShard& shard = *workerShards[workerIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.bandwidth.record(transfer.bodyBytes, transfer.firstByteNs, elapsedNs);
+    }
+
+    if (decodeResponses && transfer.code == CURLE_OK) {
+        WorkerShard& shard = *workerShards[workerIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.compression.record(transfer.contentEncoding, transfer.wireBytes, transfer.decodedBytes,
+                                 transfer.decodeNs, transfer.decodeStatus);
+    }
+
+    if (measurementOptions.enabled()) {
+        WorkerShard& shard = *workerShards[workerIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.secondSketch.add(elapsed);
+        shard.secondCompleted++;
+        if (result.status == RequestStatus::SUCCESS) shard.secondSuccessful++;
+    }
+
+    // 添加到历史记录
+    addResult(workerIndex, result);
+
+    return result;
+}
+
+template <class Loop, class Complete>
+void LoadTester::runEventLoop(int workerIndex, Loop& loop, Complete complete) {
+    loop.setCancellation(&cancellation);
+    loop.setDrainFlag(&draining);
+    auto nextUsageSample = std::chrono::steady_clock::now();
+    loop.setTickHandler([this, workerIndex, &nextUsageSample](std::chrono::steady_clock::time_point now) {
+        if (now >= nextUsageSample) {
+            sampleWorkerUsage(workerIndex);
+            nextUsageSample = now + std::chrono::milliseconds(USAGE_SAMPLE_INTERVAL_MS);
         }
+    });
+    loop.run(url, isRunning,
+        [this, workerIndex](int64_t lagNs) {
+            // 请求ID同时充当配额计数：每个请求、每条消息、每个流（含重连）或每条日志请求占用一个
+            if (autoTuneFinished || draining) return 0;
+            recordDispatchLag(workerIndex, lagNs);
+            int requestId = ++requestIdCounter;
+            return requestId <= totalRequests ? requestId : 0;
+        },
+        complete);
+
+    sampleWorkerUsage(workerIndex);
+    cancelledRequests += loop.getCancelledCount();
+}
 
-        completedRequests++;
+void LoadTester::runVirtualUsers(int workerIndex) {
+    // 虚拟用户按序号平均分配到各事件循环；只设置了场景时每个线程一个用户
+    int totalUsers = virtualUserOptions.enabled() ? virtualUserOptions.virtualUsers : numThreads;
+    int firstUser = static_cast<int>(static_cast<int64_t>(totalUsers) * workerIndex / numThreads);
+    int lastUser = static_cast<int>(static_cast<int64_t>(totalUsers) * (workerIndex + 1) / numThreads);
+
+    VirtualUserLoop loop(firstUser, lastUser - firstUser, totalUsers, virtualUserOptions, requestTimeoutMs);
+    loop.setScenario(&scenario);
+    if (rateLimiter.enabled()) loop.setRateLimiter(&rateLimiter);
+    loop.setCompression(compressionOptions);
+    std::unique_ptr<UrlPicker> urlPicker;
+    if (urlList) {
+        urlPicker = std::make_unique<UrlPicker>(*urlList, activeUrlList, urlCursor, workerIndex);
+        loop.setUrlPicker(urlPicker.get());
+    }
+    runEventLoop(workerIndex, loop,
+        [this, workerIndex](CURL* easy, CURLcode res, int requestId, uint32_t endpoint, int64_t elapsedNs,
+                            const ContentDecoder* decoder) {
+            TransferResult transfer = readFinishedTransfer(easy, res, elapsedNs);
+            if (decoder) readDecodeResult(*decoder, transfer);
+            completeRequest(workerIndex, requestId, endpoint, transfer);
+        });
+
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    timerStats.merge(loop.getTimerStats());
+    scenarioStats.merge(loop.getScenarioStats());
+}
 
-        RequestResult result(requestId, RequestStatus::REQ_ERROR, 0, url, elapsed);
+void LoadTester::runWebSockets(int workerIndex) {
+    // 连接按序号平均分配到各事件循环
+    int totalConnections = webSocketOptions.connections > 0 ? webSocketOptions.connections : numThreads;
+    int firstConnection = static_cast<int>(static_cast<int64_t>(totalConnections) * workerIndex / numThreads);
+    int lastConnection = static_cast<int>(static_cast<int64_t>(totalConnections) * (workerIndex + 1) / numThreads);
+
+    WebSocketLoop loop(firstConnection, lastConnection - firstConnection, totalConnections, webSocketOptions,
+                       requestTimeoutMs);
+    runEventLoop(workerIndex, loop,
+        [this, workerIndex](int requestId, const TransferResult& transfer) {
+            completeRequest(workerIndex, requestId, urlEndpoint, transfer);
+        });
+
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    timerStats.merge(loop.getTimerStats());
+    webSocketStats.merge(loop.getStats());
+}
 
-        if (res == CURLE_OK) {
-            long response_code;
-            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-            result.statusCode = static_cast<int>(response_code);
+void LoadTester::runStreams(int workerIndex) {
+    // 流按序号平均分配到各事件循环
+    int totalStreams = streamingOptions.streams > 0 ? streamingOptions.streams : numThreads;
+    int firstStream = static_cast<int>(static_cast<int64_t>(totalStreams) * workerIndex / numThreads);
+    int lastStream = static_cast<int>(static_cast<int64_t>(totalStreams) * (workerIndex + 1) / numThreads);
+
+    StreamLoop loop(firstStream, lastStream - firstStream, totalStreams, streamingOptions, requestTimeoutMs);
+    runEventLoop(workerIndex, loop,
+        [this, workerIndex](CURL* easy, CURLcode res, int requestId, int64_t elapsedNs) {
+            completeRequest(workerIndex, requestId, urlEndpoint, readFinishedTransfer(easy, res, elapsedNs));
+        });
+
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    timerStats.merge(loop.getTimerStats());
+    streamStats.merge(loop.getStats());
+}
 
-            if (response_code >= 200 && response_code < 300) {
-                successfulRequests++;
-                result.status = RequestStatus::SUCCESS;
-                log("请求成功: HTTP " + std::to_string(response_code) + " (" + std::to_string(elapsed) + " 毫秒)");
+void LoadTester::runReplay(int workerIndex) {
+    // 调度延迟即实际发出晚于按日志时间应发出的部分
+    ReplayLoop loop(*replayFeed, workerIndex, replayOptions, requestTimeoutMs);
+    runEventLoop(workerIndex, loop,
+        [this, workerIndex](CURL* easy, CURLcode res, int requestId, int64_t elapsedNs) {
+            completeRequest(workerIndex, requestId, urlEndpoint, readFinishedTransfer(easy, res, elapsedNs));
+        });
+
+    std::lock_guard<std::mutex> lock(loopStatsMutex);
+    replayStats.dispatched += loop.getDispatchedCount();
+    replayStats.replaySpanNs = std::max<int64_t>(replayStats.replaySpanNs,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(loop.getLastDispatch() - replayFeed->getStartTime()).count());
+}
+
+void LoadTester::workerThread(int workerIndex) {
+    TRACE_THREAD_NAME("worker " + std::to_string(workerIndex));
+    TRACE_SPAN("workerThread");
+
+    // 先绑定核心，再分配分片，使分片内存落在本地NUMA节点
+    bool pinned = false;
+    if (!affinityOptions.workerCores.empty()) {
+        int core = affinityOptions.workerCores[workerIndex % affinityOptions.workerCores.size()];
+        pinned = pinCurrentThread(core);
+    }
+
+    auto shard = std::make_unique<WorkerShard>();
+    shard->core = currentCpu();
+    shard->numaNode = numaNodeOfCpu(shard->core);
+    shard->pinned = pinned;
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        workerShards[workerIndex] = std::move(shard);
+        readyWorkers++;
+    }
+    shardsReady.notify_all();
+
+    // 运行时配置只决定选用哪个实例化，请求路径本身在编译期特化
+    if (isWebSocketUrl(url)) {
+        runWebSockets(workerIndex);
+    } else if (isTcpUrl(url)) {
+        // 原始TCP用于压测最大吞吐量，不插入固定请求间隔
+        TcpTransport transport(url, tcpOptions, requestTimeoutMs, workerIndex, &cancellation);
+        if (rateLimiter.enabled()) {
+            runSynchronous(workerIndex, std::move(transport),
+                           RateLimitedPacer(std::chrono::nanoseconds(0), rateLimiter, urlEndpoint));
+        } else {
+            runSynchronous(workerIndex, std::move(transport), NoPacer());
+        }
+        sampleWorkerUsage(workerIndex);
+    } else if (replayFeed) {
+        runReplay(workerIndex);
+    } else if (streamingOptions.enabled) {
+        runStreams(workerIndex);
+    } else if (virtualUserOptions.enabled() || scenario.enabled()) {
+        runVirtualUsers(workerIndex);
+    } else {
+        CurlEasyTransport transport(url, requestTimeoutMs, &cancellation);
+        transport.setConnectionPolicy(connectionOptions,
+                                      connectionOptions.reconnectStormIntervalMs > 0 ? &reconnectStorms : nullptr);
+        transport.setCompression(compressionOptions);
+        transport.setThroughput(throughputOptions);
+        // 吞吐量模式只受限流约束，请求之间不插入固定间隔
+        auto interRequestDelay = std::chrono::milliseconds(throughputOptions.enabled ? 0 : 10);
+        auto runHttp = [this, workerIndex, interRequestDelay](auto httpTransport) {
+            if (rateLimiter.enabled()) {
+                runSynchronous(workerIndex, std::move(httpTransport),
+                               RateLimitedPacer(interRequestDelay, rateLimiter, urlEndpoint));
+            } else if (throughputOptions.enabled) {
+                runSynchronous(workerIndex, std::move(httpTransport), NoPacer());
             } else {
-                result.status = RequestStatus::FAILED;
-                log("请求失败: HTTP " + std::to_string(response_code) + " (" + std::to_string(elapsed) + " 毫秒)");
+                runSynchronous(workerIndex, std::move(httpTransport), FixedDelayPacer(interRequestDelay));
             }
+        };
+        if (urlList) {
+            runHttp(UrlListTransport(std::move(transport),
+                                     UrlPicker(*urlList, activeUrlList, urlCursor, workerIndex)));
         } else {
-            result.errorMessage = curl_easy_strerror(res);
-            log("请求错误: " + result.errorMessage + " (" + std::to_string(elapsed) + " 毫秒)");
+            runHttp(std::move(transport));
+        }
+        sampleWorkerUsage(workerIndex);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(shardsMutex);
+        exitedWorkers++;
+    }
+    workersExited.notify_all();
+}
+
+template <class Transport, class Pacer>
+void LoadTester::runSynchronous(int workerIndex, Transport transport, Pacer pacer) {
+    auto nextUsageSample = std::chrono::steady_clock::now();
+    auto sink = makeCallbackSink(
+        [this, workerIndex](int, int64_t lagNs) {
+            recordDispatchLag(workerIndex, lagNs);
+        },
+        [this, workerIndex, &nextUsageSample](int requestId, const TransferResult& transfer) {
+            if (transfer.cancelled) {
+                cancelledRequests++;
+                return;
+            }
+            completeRequest(workerIndex, requestId,
+                            transfer.endpoint != TransferResult::TEST_URL ? transfer.endpoint : urlEndpoint, transfer);
+            auto now = std::chrono::steady_clock::now();
+            if (now >= nextUsageSample) {
+                sampleWorkerUsage(workerIndex);
+                nextUsageSample = now + std::chrono::milliseconds(USAGE_SAMPLE_INTERVAL_MS);
+            }
+        });
+
+    BasicLoadTester<Transport, Pacer, NullStats, decltype(sink)> engine(
+        std::move(transport), std::move(pacer), NullStats(), std::move(sink));
+    engine.run(requestIdCounter, totalRequests, [this] { return isRunning && !draining && !autoTuneFinished; });
+}
+
+void LoadTester::recordDispatchLag(int workerIndex, int64_t lagNs) {
+    WorkerShard& shard = *workerShards[workerIndex];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.lagSketch.add(lagNs / 1e6);
+}
+
+void LoadTester::sampleWorkerUsage(int workerIndex) {
+    // 线程CPU时间等只能在线程自身上读取，由工作线程定期写入分片
+    ThreadUsage usage = sampleCurrentThreadUsage();
+    WorkerShard& shard = *workerShards[workerIndex];
+    shard.cpuNs.store(usage.cpuNs, std::memory_order_relaxed);
+    shard.runQueueNs.store(usage.runQueueNs, std::memory_order_relaxed);
+    shard.involuntarySwitches.store(usage.involuntarySwitches, std::memory_order_relaxed);
+}
+
+void LoadTester::evaluateGeneratorHealth() {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - lastHealthCheck).count();
+    lastHealthCheck = now;
+
+    DDSketch lag;
+    std::vector<ThreadUsage> deltas;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            lag.merge(shard->lagSketch);
+            shard->lagSketch.clear();
+        }
+
+        ThreadUsage current;
+        current.cpuNs = shard->cpuNs.load(std::memory_order_relaxed);
+        current.runQueueNs = shard->runQueueNs.load(std::memory_order_relaxed);
+        current.involuntarySwitches = shard->involuntarySwitches.load(std::memory_order_relaxed);
+
+        ThreadUsage delta;
+        delta.cpuNs = current.cpuNs - shard->lastUsage.cpuNs;
+        delta.runQueueNs = current.runQueueNs - shard->lastUsage.runQueueNs;
+        delta.involuntarySwitches = current.involuntarySwitches - shard->lastUsage.involuntarySwitches;
+        shard->lastUsage = current;
+        deltas.push_back(delta);
+    }
+
+    HealthWindow window;
+    {
+        std::lock_guard<std::mutex> lock(healthMutex);
+        window = generatorHealth.evaluate(lag, deltas, seconds);
+    }
+
+    if (window.saturated) {
+        if (exporter.isOpen()) exporter.markGeneratorSaturated();
+        log("发生器饱和: " + window.reason);
+    }
+}
+
+HealthReport LoadTester::getGeneratorHealth() const {
+    std::lock_guard<std::mutex> lock(healthMutex);
+    return generatorHealth.getReport();
+}
+
+void LoadTester::setHealthThresholds(const HealthThresholds& thresholds) {
+    if (testActive) return;
+    healthThresholds = thresholds;
+}
+
+void LoadTester::recordResponseTime(int workerIndex, int64_t elapsedNs) {
+    TRACE_SPAN("recordResponseTime");
+    if (statsBackend == StatsBackend::SKETCH) {
+        WorkerShard& shard = *workerShards[workerIndex];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.sketch.add(elapsedNs / 1e6);
+    } else {
+        std::lock_guard<std::mutex> lock(responseTimesMutex);
+        responseTimes.push_back(elapsedNs / 1e6);
+    }
+
+    totalResponseTimeNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    timedRequests.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t currentMin = minResponseTimeNs.load(std::memory_order_relaxed);
+    while (elapsedNs < currentMin &&
+           !minResponseTimeNs.compare_exchange_weak(currentMin, elapsedNs, std::memory_order_relaxed)) {
+    }
+
+    int64_t currentMax = maxResponseTimeNs.load(std::memory_order_relaxed);
+    while (elapsedNs > currentMax &&
+           !maxResponseTimeNs.compare_exchange_weak(currentMax, elapsedNs, std::memory_order_relaxed)) {
+    }
+}
+
+void LoadTester::aggregatorThread() {
+    pinCurrentThread(affinityOptions.aggregatorCore);
+    TRACE_THREAD_NAME("aggregator");
+
+    auto nextPublish = std::chrono::steady_clock::now();
+    auto nextHealthCheck = nextPublish + std::chrono::milliseconds(HEALTH_WINDOW_MS);
+    int stormIntervalMs = connectionOptions.reconnectStormIntervalMs;
+    auto nextStorm = nextPublish + std::chrono::milliseconds(stormIntervalMs);
+
+    std::unique_lock<std::mutex> lock(aggregatorMutex);
+    while (isRunning) {
+        // 按快照发布间隔与通知间隔中较短者唤醒
+        auto publishInterval = std::chrono::milliseconds(statsPublishIntervalMs.load());
+        auto tick = std::min(publishInterval, statusNotifier.getInterval());
+        aggregatorWakeup.wait_for(lock, tick);
+        if (!isRunning) break;
+
+        lock.unlock();
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextPublish) {
+            TRACE_SPAN("publishSnapshot");
+            publishSnapshot();
+            nextPublish = now + publishInterval;
+        }
+        sampleThroughput();
+        if (now >= nextHealthCheck) {
+            TRACE_SPAN("evaluateGeneratorHealth");
+            evaluateGeneratorHealth();
+            nextHealthCheck = now + std::chrono::milliseconds(HEALTH_WINDOW_MS);
+        }
+        if (stormIntervalMs > 0 && now >= nextStorm) {
+            // 各工作线程在下一个请求时同时放弃现有连接
+            uint32_t storm = ++reconnectStorms;
+            log("重连风暴" + std::to_string(storm) + ": 所有连接断开重连");
+            nextStorm = now + std::chrono::milliseconds(stormIntervalMs);
+        }
+        statusNotifier.poll(now, completedRequests, totalRequests, getSuccessRate());
+        lock.lock();
+    }
+}
+
+void LoadTester::autoTuneThread() {
+    AutoTuner tuner(autoTuneOptions);
+
+    // 等待指定时长，期间停止测试则返回false
+    auto waitRunning = [this](int ms) {
+        std::unique_lock<std::mutex> lock(aggregatorMutex);
+        return !aggregatorWakeup.wait_for(lock, std::chrono::milliseconds(std::max(0, ms)),
+                                          [this] { return !isRunning; });
+    };
+
+    while (true) {
+        rateLimiter.setGlobalRate(tuner.currentRate());
+
+        // 丢弃速率切换后的过渡期，只测量稳定后的窗口
+        if (!waitRunning(autoTuneOptions.settleMs)) break;
+        takeProbeWindow();
+        auto windowStart = std::chrono::steady_clock::now();
+        if (!waitRunning(autoTuneOptions.probeMs)) break;
+
+        ProbeStep step = takeProbeWindow();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - windowStart).count();
+        step.achievedRps = seconds > 0 ? step.requests / seconds : 0.0;
+
+        bool more = tuner.record(step);
+        const ProbeStep& recorded = tuner.getSteps().back();
+        {
+            std::lock_guard<std::mutex> lock(loopStatsMutex);
+            autoTuneSteps = tuner.getSteps();
         }
 
-        curl_easy_cleanup(curl);
+        std::ostringstream line;
+        line << "自动调优探测" << tuner.getSteps().size() << ": 目标=" << std::fixed << std::setprecision(1)
+             << recorded.targetRps << " 请求/秒, 实际=" << recorded.achievedRps << " 请求/秒, P50="
+             << recorded.p50Ms << " 毫秒, SLO分位数=" << recorded.sloLatencyMs << " 毫秒, 错误率="
+             << std::setprecision(3) << recorded.errorRate * 100.0 << "%, "
+             << (recorded.withinSlo ? "满足" : "违反");
+        log(line.str());
+
+        if (!more) break;
+        if (requestIdCounter >= totalRequests) {
+            log("请求配额已用完，自动调优提前结束");
+            break;
+        }
+    }
 
-        // 添加到历史记录
-        addResult(result);
+    {
+        std::lock_guard<std::mutex> lock(loopStatsMutex);
+        autoTuneReport = formatAutoTuneReport(tuner, autoTuneOptions.slo);
+    }
+    autoTuneFinished = true;
+}
 
-        return result;
+ProbeStep LoadTester::takeProbeWindow() {
+    DDSketch merged;
+    ProbeStep step;
+    uint64_t failed = 0;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        merged.merge(shard->probeSketch);
+        step.requests += shard->probeCompleted;
+        failed += shard->probeFailed;
+        shard->probeSketch.clear();
+        shard->probeCompleted = 0;
+        shard->probeFailed = 0;
     }
 
-    // 如果curl初始化失败
-    RequestResult errorResult(requestId, RequestStatus::REQ_ERROR, 0, url, 0, "CURL初始化失败");
-    addResult(errorResult);
-    return errorResult;
+    if (step.requests > 0) {
+        step.errorRate = static_cast<double>(failed) / step.requests;
+        step.p50Ms = merged.quantile(0.50);
+        step.sloLatencyMs = merged.quantile(autoTuneOptions.slo.latencyQuantile);
+    }
+    return step;
 }
 
-void LoadTester::workerThread() {
-    while (isRunning && completedRequests < totalRequests) {
-        RequestResult result = makeRequest();
+void LoadTester::publishSnapshot(bool finalSnapshot) {
+    // 快照只由启动线程、聚合线程和停止线程依次发布，三者不会并发
+    StatsSnapshot snapshot{};
+    snapshot.version = ++snapshotVersion;
+    snapshot.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now() - startTime).count();
+    snapshot.successfulRequests = successfulRequests.load();
+    snapshot.completedRequests = completedRequests.load();
+    snapshot.totalRequests = totalRequests;
+    snapshot.successRate = snapshot.completedRequests > 0
+        ? snapshot.successfulRequests * 100.0 / snapshot.completedRequests : 0.0;
+
+    int64_t timed = timedRequests.load(std::memory_order_relaxed);
+    if (timed > 0) {
+        snapshot.minResponseTime = minResponseTimeNs.load(std::memory_order_relaxed) / 1e6;
+        snapshot.maxResponseTime = maxResponseTimeNs.load(std::memory_order_relaxed) / 1e6;
+        snapshot.avgResponseTime = totalResponseTimeNs.load(std::memory_order_relaxed) / 1e6 / timed;
+    }
+    if (statsBackend == StatsBackend::SKETCH) {
+        DDSketch merged = getLatencySketch();
+        snapshot.p50ResponseTime = merged.quantile(0.50);
+        snapshot.p90ResponseTime = merged.quantile(0.90);
+        snapshot.p99ResponseTime = merged.quantile(0.99);
+    } else if (finalSnapshot) {
+        // 原始样本的精确分位数需要排序，只在测试结束时计算一次
+        std::vector<double> sorted = getResponseTimes();
+        if (!sorted.empty()) {
+            std::sort(sorted.begin(), sorted.end());
+            auto at = [&sorted](double q) {
+                return sorted[static_cast<size_t>(q * (sorted.size() - 1))];
+            };
+            snapshot.p50ResponseTime = at(0.50);
+            snapshot.p90ResponseTime = at(0.90);
+            snapshot.p99ResponseTime = at(0.99);
+        }
+    }
+    BandwidthSecond traffic = totalBandwidth();
+    snapshot.bytesSent = traffic.bytesSent;
+    snapshot.bytesReceived = traffic.bytesReceived;
+    if (snapshot.elapsedMs > 0) {
+        snapshot.requestsPerSecond = snapshot.completedRequests * 1000.0 / snapshot.elapsedMs;
+        snapshot.receiveMegabytesPerSecond =
+            BandwidthStats::megabytesPerSecond(snapshot.bytesReceived, snapshot.elapsedMs / 1000.0);
+    }
+    snapshot.measuredRequests = snapshot.completedRequests;
+    snapshot.measureEndMs = snapshot.elapsedMs;
+
+    if (finalSnapshot && measurementOptions.enabled()) {
+        // 最终结果只统计测量窗口；窗口内没有请求（如测试短于预热）时保留全部请求的结果
+        MeasurementWindow window = getMeasurementWindow();
+        SecondBucket measured = mergeMeasuredBuckets();
+        if (measured.completed > 0) {
+            int64_t endMs = std::min<int64_t>(window.endSecond * 1000LL, snapshot.elapsedMs);
+            snapshot.measuredRequests = static_cast<int>(measured.completed);
+            snapshot.measureStartMs = window.startSecond * 1000LL;
+            snapshot.measureEndMs = endMs;
+            snapshot.steadyStateDetected = window.steadyStateDetected;
+            snapshot.successRate = measured.successful * 100.0 / measured.completed;
+            snapshot.minResponseTime = measured.latency.getMin();
+            snapshot.maxResponseTime = measured.latency.getMax();
+            snapshot.avgResponseTime = measured.latency.getAverage();
+            snapshot.p50ResponseTime = measured.latency.quantile(0.50);
+            snapshot.p90ResponseTime = measured.latency.quantile(0.90);
+            snapshot.p99ResponseTime = measured.latency.quantile(0.99);
+            snapshot.requestsPerSecond = endMs > snapshot.measureStartMs
+                ? measured.completed * 1000.0 / (endMs - snapshot.measureStartMs) : 0.0;
+        }
+    }
+    snapshot.running = isRunning.load();
+
+    statsSnapshot.publish(snapshot);
+}
+
+void LoadTester::sampleThroughput() {
+    auto elapsedSeconds = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now() - startTime).count();
 
-        // 如果有状态回调，则调用它
-        if (statusCallback) {
-            statusCallback(completedRequests, totalRequests, getSuccessRate());
+    bool steady = false;
+    int steadyStart = -1;
+    {
+        std::lock_guard<std::mutex> lock(seriesMutex);
+        while (static_cast<int64_t>(completedPerSecond.size()) < elapsedSeconds) {
+            // 聚合线程的唤醒间隔远小于1秒，增量都归入刚结束的那一秒
+            int completed = completedRequests.load();
+            completedPerSecond.push_back(static_cast<uint32_t>(std::max(0, completed - lastSampledCompleted)));
+            lastSampledCompleted = completed;
+            BandwidthSecond total = totalBandwidth();
+            bandwidthPerSecond.push_back(BandwidthSecond{total.bytesSent - lastSampledBandwidth.bytesSent,
+                                                         total.bytesReceived - lastSampledBandwidth.bytesReceived});
+            lastSampledBandwidth = total;
+            if (measurementOptions.enabled()) {
+                steady = closeSecondBucket() || steady;
+            }
         }
+        steadyStart = steadyDetector.getSteadyStart();
+    }
 
-        // 小延迟，防止目标服务器过载
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (steady) {
+        log("检测到稳态，测量从第" + std::to_string(steadyStart) + "秒开始");
     }
 }
 
-void LoadTester::calculateStatistics() {
-    if (responseTimes.empty()) {
-        minResponseTime = 0;
-        maxResponseTime = 0;
-        avgResponseTime = 0;
-        return;
+BandwidthSecond LoadTester::totalBandwidth() const {
+    BandwidthSecond total;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        total.bytesSent += shard->bytesSent.load(std::memory_order_relaxed);
+        total.bytesReceived += shard->bytesReceived.load(std::memory_order_relaxed);
     }
+    return total;
+}
 
-    minResponseTime = *std::min_element(responseTimes.begin(), responseTimes.end());
-    maxResponseTime = *std::max_element(responseTimes.begin(), responseTimes.end());
+bool LoadTester::closeSecondBucket() {
+    SecondBucket bucket;
+    for (const auto& shard : workerShards) {
+        if (!shard) continue;
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        bucket.latency.merge(shard->secondSketch);
+        bucket.completed += shard->secondCompleted;
+        bucket.successful += shard->secondSuccessful;
+        shard->secondSketch.clear();
+        shard->secondCompleted = 0;
+        shard->secondSuccessful = 0;
+    }
 
-    double sum = 0.0;
-    for (const auto& time : responseTimes) {
-        sum += time;
+    bool steady = false;
+    if (measurementOptions.autoDetect) {
+        steady = steadyDetector.add(bucket.completed, bucket.completed > 0 ? bucket.latency.quantile(0.50) : 0.0);
     }
-    avgResponseTime = sum / responseTimes.size();
-}
\ No newline at end of file
+    secondBuckets.push_back(std::move(bucket));
+    return steady;
+}
+
+void LoadTester::finishMeasurementWindow() {
+    MeasurementWindow window;
+    uint64_t warmUp = 0, measured = 0, coolDown = 0;
+    {
+        std::lock_guard<std::mutex> lock(seriesMutex);
+        // 最后一个不满一秒的桶不送入稳态检测
+        SecondBucket last;
+        for (const auto& shard : workerShards) {
+            if (!shard) continue;
+            std::lock_guard<std::mutex> shardLock(shard->mutex);
+            last.latency.merge(shard->secondSketch);
+            last.completed += shard->secondCompleted;
+            last.successful += shard->secondSuccessful;
+        }
+        secondBuckets.push_back(std::move(last));
+
+        // 冷却从最后一个有请求完成的秒向前扣除，测试结束后空闲的秒不占用冷却时长
+        int activeSeconds = static_cast<int>(secondBuckets.size());
+        while (activeSeconds > 0 && secondBuckets[activeSeconds - 1].completed == 0) {
+            activeSeconds--;
+        }
+        measurementWindow = resolveMeasurementWindow(measurementOptions, activeSeconds, steadyDetector.getSteadyStart());
+        window = measurementWindow;
+
+        for (int i = 0; i < static_cast<int>(secondBuckets.size()); ++i) {
+            uint64_t completed = secondBuckets[i].completed;
+            if (i < window.startSecond) warmUp += completed;
+            else if (i < window.endSecond) measured += completed;
+            else coolDown += completed;
+        }
+    }
+
+    std::ostringstream line;
+    line << "测量窗口: 第" << window.startSecond << "秒至第" << window.endSecond << "秒, 计入=" << measured
+         << ", 排除预热=" << warmUp << ", 排除冷却=" << coolDown;
+    if (measurementOptions.autoDetect) {
+        line << (window.steadyStateDetected ? ", 开始处由稳态检测确定" : ", 未检测到稳态，按预热时长划分");
+    }
+    log(line.str());
+    if (measured == 0) {
+        log("警告: 测量窗口内没有完成的请求，结果按全部请求统计");
+    }
+}
+
+SecondBucket LoadTester::mergeMeasuredBuckets() const {
+    std::lock_guard<std::mutex> lock(seriesMutex);
+    SecondBucket merged;
+    int end = std::min(measurementWindow.endSecond, static_cast<int>(secondBuckets.size()));
+    for (int i = measurementWindow.startSecond; i < end; ++i) {
+        merged.latency.merge(secondBuckets[i].latency);
+        merged.completed += secondBuckets[i].completed;
+        merged.successful += secondBuckets[i].successful;
+    }
+    return merged;
+}
+
+void LoadTester::dispatchStatusUpdate(const StatusUpdate& update) {
+    TRACE_SPAN("statusCallback");
+    if (statusCallback) {
+        statusCallback(update.completedRequests, update.totalRequests, update.successRate);
+    }
+    if (statusUpdateCallback) {
+        statusUpdateCallback(update);
+    }
+}
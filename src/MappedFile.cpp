@@ -0,0 +1,107 @@
+/**
+ * @file MappedFile.cpp
+ * @brief 只读内存映射文件的实现
+ */
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& filePath, MappedAccess access, std::string& error) {
+    close();
+
+#ifdef _WIN32
+    DWORD flags = FILE_ATTRIBUTE_NORMAL | (access == MappedAccess::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : 0);
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        error = "无法打开文件: " + filePath;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        error = "无法读取文件大小: " + filePath;
+        return false;
+    }
+    uint64_t bytes = static_cast<uint64_t>(fileSize.QuadPart);
+    if (bytes == 0 || bytes > SIZE_MAX) {
+        CloseHandle(file);
+        error = (bytes == 0 ? "文件为空: " : "文件超出地址空间: ") + filePath;
+        return false;
+    }
+
+    // 映射建立后文件与映射对象的句柄即可关闭，视图在解除前一直有效
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    void* mapped = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (mapping) CloseHandle(mapping);
+    if (!mapped) {
+        error = "无法映射文件: " + filePath;
+        return false;
+    }
+#else
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "无法打开文件: " + filePath;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        error = "无法读取文件大小: " + filePath;
+        return false;
+    }
+    uint64_t bytes = static_cast<uint64_t>(info.st_size);
+    if (bytes == 0 || bytes > SIZE_MAX) {
+        ::close(fd);
+        error = (bytes == 0 ? "文件为空: " : "文件超出地址空间: ") + filePath;
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(bytes), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        error = "无法映射文件: " + filePath;
+        return false;
+    }
+    madvise(mapped, static_cast<size_t>(bytes), access == MappedAccess::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_WILLNEED);
+#endif
+
+    view = static_cast<const char*>(mapped);
+    length = static_cast<size_t>(bytes);
+    return true;
+}
+
+void MappedFile::release(size_t offset, size_t bytes) {
+    // 按64KB对齐，覆盖各平台的页大小与Windows的分配粒度；只释放完全落在范围内的页
+    const size_t alignment = 64 * 1024;
+    size_t begin = (offset + alignment - 1) / alignment * alignment;
+    size_t end = std::min(offset + bytes, length) / alignment * alignment;
+    if (!view || begin >= end) return;
+#ifdef _WIN32
+    // 对未锁定的页调用VirtualUnlock会把它们移出工作集
+    VirtualUnlock(const_cast<char*>(view) + begin, end - begin);
+#else
+    madvise(const_cast<char*>(view) + begin, end - begin, MADV_DONTNEED);
+#endif
+}
+
+void MappedFile::close() {
+    if (view) {
+#ifdef _WIN32
+        UnmapViewOfFile(view);
+#else
+        munmap(const_cast<char*>(view), length);
+#endif
+    }
+    view = nullptr;
+    length = 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file RateLimiter.cpp
+ * @brief 无锁的全局与按端点令牌桶限流器的实现
+ */
+#include "../include/RateLimiter.h"
+#include <algorithm>
+#include <sstream>
+
+std::vector<RateLimit> RateLimitOptions::parseEndpointLimits(const std::string& text) {
+    std::vector<RateLimit> limits;
+    std::stringstream ss(text);
+    std::string part;
+
+    while (std::getline(ss, part, ',')) {
+        size_t eq = part.rfind('=');
+        if (eq == std::string::npos || eq == 0) continue;
+        try {
+            RateLimit limit;
+            limit.pattern = part.substr(0, eq);
+            limit.requestsPerSecond = std::stod(part.substr(eq + 1));
+            if (limit.requestsPerSecond > 0) limits.push_back(limit);
+        } catch (...) {
+            // 忽略无法解析的片段
+        }
+    }
+    return limits;
+}
+
+TokenBucket::TokenBucket(double rate, int64_t burstNs)
+    : theoreticalArrival(0),
+      emissionIntervalNs(1),
+      burstToleranceNs(0),
+      burstWindowNs(std::max<int64_t>(0, burstNs)),
+      admitted(0),
+      throttled(0),
+      throttledWaitNs(0) {
+    setRate(rate);
+}
+
+void TokenBucket::setRate(double rate) {
+    int64_t interval = std::max<int64_t>(1, static_cast<int64_t>(1e9 / rate));
+    emissionIntervalNs.store(interval, std::memory_order_relaxed);
+    // 标准GCRA：突发量为burstWindow/interval个令牌，容差为(令牌数-1)个间隔；
+    // 突发时长不超过一个间隔时容差为0，请求严格按间隔放行，同时到达的第二个请求要等一个间隔
+    burstToleranceNs.store(std::max<int64_t>(0, burstWindowNs - interval), std::memory_order_relaxed);
+}
+
+int64_t TokenBucket::tryAcquire(int64_t nowNs) {
+    int64_t interval = emissionIntervalNs.load(std::memory_order_relaxed);
+    int64_t tolerance = burstToleranceNs.load(std::memory_order_relaxed);
+    int64_t arrival = theoreticalArrival.load(std::memory_order_relaxed);
+    while (true) {
+        // 理论到达时间超前当前时间超过容差时拒绝，等待到差值回到容差以内
+        int64_t earliest = arrival - tolerance;
+        if (nowNs < earliest) {
+            return earliest - nowNs;
+        }
+        int64_t next = std::max(arrival, nowNs) + interval;
+        if (theoreticalArrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) {
+            admitted.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+    }
+}
+
+void TokenBucket::refund() {
+    theoreticalArrival.fetch_sub(emissionIntervalNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    admitted.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void TokenBucket::recordThrottle(int64_t waitNs) {
+    throttled.fetch_add(1, std::memory_order_relaxed);
+    throttledWaitNs.fetch_add(waitNs, std::memory_order_relaxed);
+}
+
+RateLimitStats TokenBucket::getStats(const std::string& name) const {
+    RateLimitStats stats;
+    stats.name = name;
+    stats.requestsPerSecond = 1e9 / emissionIntervalNs.load(std::memory_order_relaxed);
+    stats.admitted = admitted.load(std::memory_order_relaxed);
+    stats.throttled = throttled.load(std::memory_order_relaxed);
+    stats.throttledWaitMs = throttledWaitNs.load(std::memory_order_relaxed) / 1e6;
+    return stats;
+}
+
+void RateLimiter::configure(const RateLimitOptions& limitOptions) {
+    options = limitOptions;
+    int64_t burstNs = static_cast<int64_t>(std::max(0, options.burstMs)) * 1000000;
+
+    auto makeBucket = [burstNs](double rate) {
+        return std::make_unique<TokenBucket>(rate, burstNs);
+    };
+
+    globalBucket.reset();
+    if (options.globalRequestsPerSecond > 0) {
+        globalBucket = makeBucket(options.globalRequestsPerSecond);
+    }
+
+    endpointBuckets.clear();
+    bucketNames.clear();
+    for (const auto& limit : options.endpointLimits) {
+        endpointBuckets.push_back(makeBucket(limit.requestsPerSecond));
+        bucketNames.push_back(limit.pattern);
+    }
+    bucketOfEndpoint.clear();
+}
+
+void RateLimiter::bindEndpoint(uint32_t endpoint, const std::string& url) {
+    if (endpoint >= bucketOfEndpoint.size()) {
+        bucketOfEndpoint.resize(endpoint + 1, -1);
+    }
+    bucketOfEndpoint[endpoint] = -1;
+    for (size_t i = 0; i < options.endpointLimits.size(); ++i) {
+        if (url.find(options.endpointLimits[i].pattern) != std::string::npos) {
+            bucketOfEndpoint[endpoint] = static_cast<int>(i);
+            break;
+        }
+    }
+}
+
+int64_t RateLimiter::acquire(uint32_t endpoint, std::chrono::steady_clock::time_point now) {
+    int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+
+    TokenBucket* endpointBucket = nullptr;
+    if (endpoint < bucketOfEndpoint.size() && bucketOfEndpoint[endpoint] >= 0) {
+        endpointBucket = endpointBuckets[bucketOfEndpoint[endpoint]].get();
+    }
+
+    if (endpointBucket) {
+        int64_t waitNs = endpointBucket->tryAcquire(nowNs);
+        if (waitNs > 0) {
+            endpointBucket->recordThrottle(waitNs);
+            return waitNs;
+        }
+    }
+
+    if (globalBucket) {
+        int64_t waitNs = globalBucket->tryAcquire(nowNs);
+        if (waitNs > 0) {
+            if (endpointBucket) endpointBucket->refund();
+            globalBucket->recordThrottle(waitNs);
+            return waitNs;
+        }
+    }
+    return 0;
+}
+
+void RateLimiter::setGlobalRate(double requestsPerSecond) {
+    if (globalBucket && requestsPerSecond > 0) {
+        globalBucket->setRate(requestsPerSecond);
+    }
+}
+
+std::vector<RateLimitStats> RateLimiter::getStats() const {
+    std::vector<RateLimitStats> stats;
+    if (globalBucket) {
+        stats.push_back(globalBucket->getStats("全局"));
+    }
+    for (size_t i = 0; i < endpointBuckets.size(); ++i) {
+        stats.push_back(endpointBuckets[i]->getStats(bucketNames[i]));
+    }
+    return stats;
+}
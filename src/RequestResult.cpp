@@ -0,0 +1,59 @@
+/**
+ * @file RequestResult.cpp
+ * @brief 请求结果与URL驻留表的实现
+ */
+#include "../include/RequestResult.h"
+#include "../include/UrlList.h"
+#include <mutex>
+#include <curl/curl.h>
+
+EndpointTable& EndpointTable::getInstance() {
+    static EndpointTable instance;
+    return instance;
+}
+
+uint32_t EndpointTable::intern(std::string_view url) {
+    std::string key(url);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = indices.find(key);
+        if (it != indices.end()) return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = indices.find(key);
+    if (it != indices.end()) return it->second;
+
+    uint32_t index = static_cast<uint32_t>(urls.size());
+    urls.push_back(key);
+    indices.emplace(std::move(key), index);
+    return index;
+}
+
+std::string EndpointTable::lookup(uint32_t index) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (isListEndpoint(index)) {
+        size_t line = index - LIST_ENDPOINT_BASE;
+        return urlList && line < urlList->size() ? std::string(urlList->line(line)) : std::string();
+    }
+    return index < urls.size() ? urls[index] : std::string();
+}
+
+void EndpointTable::attachList(std::shared_ptr<const UrlList> list) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    urlList = std::move(list);
+}
+
+const char* RequestResult::errorMessage() const {
+    return errorCode != 0 ? curl_easy_strerror(static_cast<CURLcode>(errorCode)) : "";
+}
+
+std::chrono::system_clock::time_point RequestResult::wallClock() const {
+    // 两个时钟之间的偏移在进程内取一次，测试期间的漂移可以忽略
+    static const auto offset = std::chrono::system_clock::now().time_since_epoch() -
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::steady_clock::now().time_since_epoch());
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestampNs)) +
+        offset);
+}
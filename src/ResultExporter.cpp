@@ -0,0 +1,440 @@
+/**
+ * @file ResultExporter.cpp
+ * @brief 结构化结果导出器的实现
+ */
+#include "../include/ResultExporter.h"
+#include "../include/ThreadAffinity.h"
+#include "../include/Tracer.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+const size_t WRITE_CHUNK_SIZE = 1 << 20;    // 缓冲区超过1MB时写盘
+const size_t WAKEUP_BATCH_SIZE = 8192;      // 单个队列积压超过该数量时立即唤醒导出线程
+const int SINK_POLL_MS = 50;                // 导出线程无唤醒时的取出周期
+const int IDLE_CLOSE_GRACE_MS = 100;        // 没有结果时，区间结束后再等这么久才按时钟关闭
+
+void appendInt(std::string& out, int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+/**
+ * @brief 以三位小数输出千分之一单位的整数（例如微秒输出为毫秒）
+ */
+void appendFixed3(std::string& out, int64_t thousandths) {
+    if (thousandths < 0) {
+        out.push_back('-');
+        thousandths = -thousandths;
+    }
+    appendInt(out, thousandths / 1000);
+    out.push_back('.');
+    int64_t fraction = thousandths % 1000;
+    out.push_back(static_cast<char>('0' + fraction / 100));
+    out.push_back(static_cast<char>('0' + fraction / 10 % 10));
+    out.push_back(static_cast<char>('0' + fraction % 10));
+}
+
+void appendCsvField(std::string& out, std::string_view value) {
+    if (value.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.append(value);
+        return;
+    }
+    out.push_back('"');
+    for (char c : value) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+void appendJsonString(std::string& out, std::string_view value) {
+    static const char HEX[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : value) {
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out.append("\\u00");
+                    out.push_back(HEX[(c >> 4) & 0xF]);
+                    out.push_back(HEX[c & 0xF]);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+const char* statusName(RequestStatus status) {
+    switch (status) {
+        case RequestStatus::SUCCESS: return "SUCCESS";
+        case RequestStatus::FAILED: return "FAILED";
+        case RequestStatus::REQ_ERROR: return "ERROR";
+    }
+    return "UNKNOWN";
+}
+
+int64_t toMicros(int64_t nanoseconds) {
+    return (nanoseconds + 500) / 1000;
+}
+
+int64_t toEpochMs(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+void ResultExporter::BufferedFile::flushIfLarge() {
+    if (buffer.size() >= WRITE_CHUNK_SIZE) {
+        flush();
+    }
+}
+
+void ResultExporter::BufferedFile::flush() {
+    if (isOpen() && !buffer.empty()) {
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+    buffer.clear();
+}
+
+ResultExporter::ResultExporter()
+    : intervalSuccessful(0),
+      intervalFailed(0),
+      intervalErrors(0),
+      intervalBytesSent(0),
+      intervalBytesReceived(0),
+      intervalSaturated(false),
+      runSaturated(false),
+      wakeThreshold(WAKEUP_BATCH_SIZE),
+      wakeRequested(false),
+      droppedCount(0),
+      running(false),
+      exportedCount(0),
+      threadCore(-1) {
+}
+
+ResultExporter::~ResultExporter() {
+    close();
+}
+
+bool ResultExporter::open(const ExportOptions& exportOptions, std::chrono::system_clock::time_point start,
+                          size_t producers) {
+    close();
+
+    options = exportOptions;
+    options.intervalMs = std::max(1, options.intervalMs);
+    options.queueCapacity = std::max(1024, options.queueCapacity);
+    startTime = start;
+    intervalStart = start;
+    intervalHistogram.reset();
+    intervalSuccessful = intervalFailed = intervalErrors = 0;
+    intervalBytesSent = intervalBytesReceived = 0;
+    intervalSaturated = false;
+    runSaturated = false;
+    exportedCount = 0;
+    droppedCount = 0;
+    wakeRequested = false;
+    lastError.clear();
+
+    struct Target {
+        const std::string& path;
+        BufferedFile& file;
+    };
+    Target targets[] = {
+        {options.csvPath, csvFile},
+        {options.jsonlPath, jsonlFile},
+        {options.intervalPath, intervalFile},
+        {options.hdrLogPath, hdrLogFile},
+    };
+
+    for (auto& target : targets) {
+        if (target.path.empty()) continue;
+        target.file.stream.open(target.path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!target.file.isOpen()) {
+            lastError = target.path;
+            for (auto& opened : targets) {
+                if (opened.file.isOpen()) opened.file.stream.close();
+            }
+            return false;
+        }
+        target.file.buffer.reserve(WRITE_CHUNK_SIZE + 4096);
+    }
+
+    writeHeaders();
+
+    queues.clear();
+    for (size_t i = 0; i < std::max<size_t>(1, producers); ++i) {
+        queues.push_back(std::make_unique<ProducerQueue>(static_cast<size_t>(options.queueCapacity)));
+    }
+    wakeThreshold = std::min(WAKEUP_BATCH_SIZE, queues.front()->ring.getCapacity() / 2);
+
+    running = true;
+    sink = std::thread(&ResultExporter::sinkThread, this);
+    return true;
+}
+
+void ResultExporter::close() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        if (!running) return;
+        running = false;
+    }
+    wakeup.notify_all();
+
+    if (sink.joinable()) sink.join();
+
+    if (runSaturated && hdrLogFile.isOpen()) {
+        hdrLogFile.buffer.append("#[GeneratorSaturated: true]\n");
+    }
+
+    for (BufferedFile* file : {&csvFile, &jsonlFile, &intervalFile, &hdrLogFile}) {
+        file->flush();
+        if (file->isOpen()) file->stream.close();
+    }
+}
+
+void ResultExporter::markGeneratorSaturated() {
+    intervalSaturated = true;
+    runSaturated = true;
+}
+
+void ResultExporter::record(size_t producer, const RequestResult& result) {
+    if (!running) return;
+    ProducerQueue& queue = *queues[producer];
+    if (!queue.ring.push(result)) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 不持锁通知：错过的唤醒最多推迟一个取出周期
+    if (++queue.sinceWake >= wakeThreshold) {
+        queue.sinceWake = 0;
+        wakeRequested.store(true, std::memory_order_release);
+        wakeup.notify_one();
+    }
+}
+
+void ResultExporter::sinkThread() {
+    pinCurrentThread(threadCore);
+    TRACE_THREAD_NAME("exporter");
+
+    std::vector<RequestResult> batch;
+    auto interval = std::chrono::milliseconds(options.intervalMs);
+    bool stopping = false;
+
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeup.wait_for(lock, std::chrono::milliseconds(SINK_POLL_MS), [this] {
+                return !running || wakeRequested.load(std::memory_order_acquire);
+            });
+            wakeRequested = false;
+            stopping = !running;
+        }
+
+        // 水位在取出之前读取：早于它完成的结果已经进入了各个队列
+        auto watermark = std::chrono::system_clock::now();
+        for (auto& queue : queues) {
+            queue->ring.drain([&batch](const RequestResult& result) { batch.push_back(result); });
+        }
+
+        {
+            TRACE_SPAN("writeRecords");
+            writeRecords(batch);
+        }
+        batch.clear();
+
+        // 没有结果推动时，按水位关闭早已结束的区间，空闲区间照样输出一行
+        while (watermark >= intervalStart + interval + std::chrono::milliseconds(IDLE_CLOSE_GRACE_MS)) {
+            closeInterval(intervalStart + interval);
+        }
+    }
+
+    // 最后一个不完整的区间
+    if (intervalHistogram.getTotalCount() > 0) {
+        closeInterval(std::chrono::system_clock::now());
+    }
+}
+
+void ResultExporter::writeHeaders() {
+    if (csvFile.isOpen()) {
+        csvFile.buffer.append("id,timestamp_ms,status,status_code,response_time_ms,url,error,bytes_sent,bytes_received\n");
+    }
+    if (intervalFile.isOpen()) {
+        intervalFile.buffer.append("interval_start_s,interval_length_s,count,successful,failed,errors,"
+                                   "min_ms,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,generator_saturated,"
+                                   "bytes_sent,bytes_received,receive_mb_per_s\n");
+    }
+    if (hdrLogFile.isOpen()) {
+        std::string& out = hdrLogFile.buffer;
+        out.append("#[Histogram log format version 1.3]\n");
+        out.append("#[StartTime: ");
+        appendFixed3(out, toEpochMs(startTime));
+        out.append(" (seconds since epoch)]\n");
+        out.append("\"StartTimestamp\",\"Interval_Length\",\"Interval_Max\",\"Interval_Compressed_Histogram\"\n");
+    }
+}
+
+void ResultExporter::writeRecords(std::vector<RequestResult>& records) {
+    // 各队列内部按完成顺序排列，合并后按完成时刻排序，区间随记录的时间戳推进
+    std::sort(records.begin(), records.end(), [](const RequestResult& a, const RequestResult& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+    auto interval = std::chrono::milliseconds(options.intervalMs);
+
+    for (const auto& result : records) {
+        int64_t micros = toMicros(result.responseTimeNs);
+        auto completedAt = result.wallClock();
+        int64_t timestamp = toEpochMs(completedAt);
+
+        // 完成时刻早于当前区间的迟到记录计入当前区间
+        while (completedAt >= intervalStart + interval) {
+            closeInterval(intervalStart + interval);
+        }
+        const std::string& url = endpointUrl(result.endpoint);
+        std::string_view error = result.errorMessage();
+
+        if (csvFile.isOpen()) {
+            std::string& out = csvFile.buffer;
+            appendInt(out, result.id);
+            out.push_back(',');
+            appendInt(out, timestamp);
+            out.push_back(',');
+            out.append(statusName(result.status));
+            out.push_back(',');
+            appendInt(out, result.statusCode);
+            out.push_back(',');
+            appendFixed3(out, micros);
+            out.push_back(',');
+            appendCsvField(out, url);
+            out.push_back(',');
+            appendCsvField(out, error);
+            out.push_back(',');
+            appendInt(out, result.bytesSent);
+            out.push_back(',');
+            appendInt(out, static_cast<int64_t>(result.bytesReceived));
+            out.push_back('\n');
+            csvFile.flushIfLarge();
+        }
+
+        if (jsonlFile.isOpen()) {
+            std::string& out = jsonlFile.buffer;
+            out.append("{\"id\":");
+            appendInt(out, result.id);
+            out.append(",\"timestamp_ms\":");
+            appendInt(out, timestamp);
+            out.append(",\"status\":\"");
+            out.append(statusName(result.status));
+            out.append("\",\"status_code\":");
+            appendInt(out, result.statusCode);
+            out.append(",\"response_time_ms\":");
+            appendFixed3(out, micros);
+            out.append(",\"bytes_sent\":");
+            appendInt(out, result.bytesSent);
+            out.append(",\"bytes_received\":");
+            appendInt(out, static_cast<int64_t>(result.bytesReceived));
+            out.append(",\"url\":");
+            appendJsonString(out, url);
+            if (!error.empty()) {
+                out.append(",\"error\":");
+                appendJsonString(out, error);
+            }
+            out.append("}\n");
+            jsonlFile.flushIfLarge();
+        }
+
+        intervalHistogram.record(micros);
+        intervalBytesSent += result.bytesSent;
+        intervalBytesReceived += result.bytesReceived;
+        switch (result.status) {
+            case RequestStatus::SUCCESS: intervalSuccessful++; break;
+            case RequestStatus::FAILED: intervalFailed++; break;
+            case RequestStatus::REQ_ERROR: intervalErrors++; break;
+        }
+    }
+    exportedCount += records.size();
+}
+
+const std::string& ResultExporter::endpointUrl(uint32_t endpoint) {
+    // URL列表的行可能有上千万，不缓存，每次从映射中读取
+    if (EndpointTable::isListEndpoint(endpoint)) {
+        listUrl = EndpointTable::getInstance().lookup(endpoint);
+        return listUrl;
+    }
+    // 驻留表只增不减，已查到的URL可以一直缓存
+    if (endpoint >= endpointUrls.size()) {
+        endpointUrls.resize(endpoint + 1);
+        endpointKnown.resize(endpoint + 1, false);
+    }
+    if (!endpointKnown[endpoint]) {
+        endpointUrls[endpoint] = EndpointTable::getInstance().lookup(endpoint);
+        endpointKnown[endpoint] = true;
+    }
+    return endpointUrls[endpoint];
+}
+
+void ResultExporter::closeInterval(std::chrono::system_clock::time_point intervalEnd) {
+    int64_t startOffsetMs = std::chrono::duration_cast<std::chrono::milliseconds>(intervalStart - startTime).count();
+    int64_t lengthMs = std::chrono::duration_cast<std::chrono::milliseconds>(intervalEnd - intervalStart).count();
+    bool saturated = intervalSaturated.exchange(false);
+
+    if (intervalFile.isOpen()) {
+        std::string& out = intervalFile.buffer;
+        appendFixed3(out, startOffsetMs);
+        out.push_back(',');
+        appendFixed3(out, lengthMs);
+        out.push_back(',');
+        appendInt(out, intervalHistogram.getTotalCount());
+        out.push_back(',');
+        appendInt(out, intervalSuccessful);
+        out.push_back(',');
+        appendInt(out, intervalFailed);
+        out.push_back(',');
+        appendInt(out, intervalErrors);
+        for (int64_t value : {intervalHistogram.getMinValue(),
+                              static_cast<int64_t>(std::llround(intervalHistogram.getMean())),
+                              intervalHistogram.valueAtQuantile(0.50),
+                              intervalHistogram.valueAtQuantile(0.90),
+                              intervalHistogram.valueAtQuantile(0.99),
+                              intervalHistogram.getMaxValue()}) {
+            out.push_back(',');
+            appendFixed3(out, value);
+        }
+        out.append(saturated ? ",1," : ",0,");
+        appendInt(out, static_cast<int64_t>(intervalBytesSent));
+        out.push_back(',');
+        appendInt(out, static_cast<int64_t>(intervalBytesReceived));
+        out.push_back(',');
+        // 字节/毫秒即千分之一MB/s
+        appendFixed3(out, lengthMs > 0 ? static_cast<int64_t>(intervalBytesReceived) / lengthMs : 0);
+        out.push_back('\n');
+        intervalFile.flushIfLarge();
+    }
+
+    // 区间日志中的值以微秒记录，Interval_Max按毫秒输出
+    if (hdrLogFile.isOpen()) {
+        std::string& out = hdrLogFile.buffer;
+        appendFixed3(out, startOffsetMs);
+        out.push_back(',');
+        appendFixed3(out, lengthMs);
+        out.push_back(',');
+        appendFixed3(out, intervalHistogram.getMaxValue());
+        out.push_back(',');
+        out.append(intervalHistogram.encodeCompressedBase64());
+        out.push_back('\n');
+        hdrLogFile.flushIfLarge();
+    }
+
+    intervalStart = intervalEnd;
+    intervalHistogram.reset();
+    intervalSuccessful = intervalFailed = intervalErrors = 0;
+    intervalBytesSent = intervalBytesReceived = 0;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file RunComparator.cpp
+ * @brief 运行间回归检测的实现
+ */
+#include "../include/RunComparator.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief 两个草图对齐后的一个桶
+ */
+struct AlignedBin {
+    double lowerBound;
+    double baselineCount;
+    double currentCount;
+};
+
+std::vector<AlignedBin> alignBins(const DDSketch& baseline, const DDSketch& current) {
+    std::vector<std::pair<double, uint64_t>> a, b;
+    baseline.forEachBin([&a](double lower, double, uint64_t n) { a.emplace_back(lower, n); });
+    current.forEachBin([&b](double lower, double, uint64_t n) { b.emplace_back(lower, n); });
+
+    // 精度相同的草图桶边界完全一致，按下界归并即可
+    std::vector<AlignedBin> bins;
+    bins.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        bool takeA = j >= b.size() || (i < a.size() && a[i].first <= b[j].first * (1 + 1e-9));
+        bool takeB = i >= a.size() || (j < b.size() && b[j].first <= a[i].first * (1 + 1e-9));
+        AlignedBin bin{takeA ? a[i].first : b[j].first, 0.0, 0.0};
+        if (takeA) bin.baselineCount = static_cast<double>(a[i++].second);
+        if (takeB) bin.currentCount = static_cast<double>(b[j++].second);
+        bins.push_back(bin);
+    }
+    return bins;
+}
+
+/**
+ * @brief Kolmogorov分布的上尾概率Q(lambda)
+ */
+double kolmogorovQ(double lambda) {
+    if (lambda < 0.2) return 1.0;
+
+    double sum = 0.0;
+    for (int j = 1; j <= 100; ++j) {
+        double term = std::exp(-2.0 * j * j * lambda * lambda);
+        sum += (j % 2 == 1 ? term : -term);
+        if (term < 1e-12) break;
+    }
+    return std::min(1.0, std::max(0.0, 2.0 * sum));
+}
+
+double twoSidedNormalP(double z) {
+    return std::erfc(std::fabs(z) / std::sqrt(2.0));
+}
+
+void meanAndVariance(const std::vector<uint32_t>& series, double& mean, double& variance) {
+    mean = 0.0;
+    variance = 0.0;
+    if (series.empty()) return;
+
+    for (uint32_t v : series) mean += v;
+    mean /= series.size();
+    if (series.size() < 2) return;
+
+    for (uint32_t v : series) variance += (v - mean) * (v - mean);
+    variance /= (series.size() - 1);
+}
+
+QuantileShift makeShift(double baseline, double current) {
+    QuantileShift shift;
+    shift.baseline = baseline;
+    shift.current = current;
+    shift.changePercent = baseline > 0.0 ? (current - baseline) * 100.0 / baseline : 0.0;
+    return shift;
+}
+
+} // namespace
+
+RunComparison compareRuns(const RunSummary& baseline, const RunSummary& current,
+                          const ComparisonOptions& options) {
+    RunComparison result;
+    result.p50 = makeShift(baseline.latency.quantile(0.50), current.latency.quantile(0.50));
+    result.p99 = makeShift(baseline.latency.quantile(0.99), current.latency.quantile(0.99));
+
+    // 分布检验：KS与Mann-Whitney U，均基于对齐后的桶
+    double nA = static_cast<double>(baseline.latency.getCount());
+    double nB = static_cast<double>(current.latency.getCount());
+    bool comparable = nA > 0 && nB > 0 &&
+        std::fabs(baseline.latency.getRelativeAccuracy() - current.latency.getRelativeAccuracy()) < 1e-12;
+
+    if (comparable) {
+        double cumA = 0.0, cumB = 0.0, maxDiff = 0.0;
+        double u = 0.0, tieTerm = 0.0;
+        for (const auto& bin : alignBins(baseline.latency, current.latency)) {
+            // 当前样本大于基线样本的对数，同桶视为平局各计一半
+            u += bin.currentCount * (cumA + 0.5 * bin.baselineCount);
+            double ties = bin.baselineCount + bin.currentCount;
+            tieTerm += ties * ties * ties - ties;
+
+            cumA += bin.baselineCount;
+            cumB += bin.currentCount;
+            maxDiff = std::max(maxDiff, std::fabs(cumA / nA - cumB / nB));
+        }
+
+        result.ksStatistic = maxDiff;
+        double ne = std::sqrt(nA * nB / (nA + nB));
+        result.ksPValue = kolmogorovQ((ne + 0.12 + 0.11 / ne) * maxDiff);
+
+        double n = nA + nB;
+        double variance = nA * nB / 12.0 * ((n + 1.0) - tieTerm / (n * (n - 1.0)));
+        if (variance > 0.0) {
+            result.mannWhitneyZ = (u - nA * nB / 2.0) / std::sqrt(variance);
+            result.mannWhitneyPValue = twoSidedNormalP(result.mannWhitneyZ);
+        }
+    }
+
+    // 吞吐量：基于测量窗口内每秒完成数序列的Welch区间
+    std::vector<uint32_t> seriesA = baseline.measuredPerSecond();
+    std::vector<uint32_t> seriesB = current.measuredPerSecond();
+    double meanA, varA, meanB, varB;
+    meanAndVariance(seriesA, meanA, varA);
+    meanAndVariance(seriesB, meanB, varB);
+    result.baselineThroughput = seriesA.empty() ? baseline.throughput() : meanA;
+    result.currentThroughput = seriesB.empty() ? current.throughput() : meanB;
+    result.throughputDelta = result.currentThroughput - result.baselineThroughput;
+
+    double standardError = 0.0;
+    if (seriesA.size() > 1 && seriesB.size() > 1) {
+        standardError = std::sqrt(varA / seriesA.size() + varB / seriesB.size());
+    }
+    result.throughputCiLow = result.throughputDelta - 1.96 * standardError;
+    result.throughputCiHigh = result.throughputDelta + 1.96 * standardError;
+
+    // 错误率：双比例z检验
+    result.errorRateDelta = current.errorRate() - baseline.errorRate();
+    double errorP = 1.0;
+    double countA = baseline.hasMeasurementWindow() ? baseline.measuredRequests : baseline.completedRequests;
+    double countB = current.hasMeasurementWindow() ? current.measuredRequests : current.completedRequests;
+    if (countA > 0 && countB > 0) {
+        double pA = baseline.errorRate() / 100.0;
+        double pB = current.errorRate() / 100.0;
+        double pooled = (pA * countA + pB * countB) / (countA + countB);
+        double se = std::sqrt(pooled * (1.0 - pooled) * (1.0 / countA + 1.0 / countB));
+        if (se > 0.0) {
+            errorP = twoSidedNormalP((pB - pA) / se);
+        }
+    }
+
+    // 回归判定同时要求效应量超过阈值且统计显著，避免大样本下的微小差异误报
+    bool distributionShifted = result.ksPValue < options.significanceLevel ||
+                               result.mannWhitneyPValue < options.significanceLevel;
+    result.latencyRegression = distributionShifted && result.mannWhitneyZ > 0.0 &&
+        (result.p50.changePercent > options.latencyThresholdPercent ||
+         result.p99.changePercent > options.latencyThresholdPercent);
+
+    result.throughputRegression = result.baselineThroughput > 0.0 && result.throughputCiHigh < 0.0 &&
+        -result.throughputDelta * 100.0 / result.baselineThroughput > options.throughputThresholdPercent;
+
+    result.errorRegression = errorP < options.significanceLevel &&
+        result.errorRateDelta > options.errorRateThresholdPoints;
+
+    return result;
+}
+
+std::string formatComparisonReport(const RunComparison& comparison) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "与上次运行对比:\n";
+    ss << "  P50: " << comparison.p50.baseline << " -> " << comparison.p50.current
+       << " 毫秒 (" << std::showpos << comparison.p50.changePercent << std::noshowpos << "%)\n";
+    ss << "  P99: " << comparison.p99.baseline << " -> " << comparison.p99.current
+       << " 毫秒 (" << std::showpos << comparison.p99.changePercent << std::noshowpos << "%)\n";
+    ss << "  吞吐量: " << comparison.baselineThroughput << " -> " << comparison.currentThroughput
+       << " 请求/秒, 差值95%置信区间 [" << comparison.throughputCiLow << ", "
+       << comparison.throughputCiHigh << "]\n";
+    ss << "  错误率变化: " << std::showpos << comparison.errorRateDelta << std::noshowpos << " 个百分点\n";
+    ss << std::setprecision(4);
+    ss << "  KS检验: D=" << comparison.ksStatistic << ", p=" << comparison.ksPValue
+       << "; Mann-Whitney: z=" << comparison.mannWhitneyZ << ", p=" << comparison.mannWhitneyPValue << "\n";
+
+    if (comparison.hasRegression()) {
+        ss << "  结论: 检测到回归 -";
+        if (comparison.latencyRegression) ss << " 延迟";
+        if (comparison.throughputRegression) ss << " 吞吐量";
+        if (comparison.errorRegression) ss << " 错误率";
+        ss << "\n";
+    } else {
+        ss << "  结论: 未检测到显著回归\n";
+    }
+    return ss.str();
+}
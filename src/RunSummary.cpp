@@ -0,0 +1,181 @@
+/**
+ * @file RunSummary.cpp
+ * @brief 单次测试运行摘要的实现
+ */
+#include "../include/RunSummary.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+const char SUMMARY_MAGIC[4] = {'L', 'T', 'R', 'S'};
+const uint8_t SUMMARY_VERSION = 3;      // 版本2增加发生器饱和标记，版本3增加测量窗口，仍可读取旧版本
+
+void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool readVarint(const std::string& data, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+double RunSummary::errorRate() const {
+    if (hasMeasurementWindow()) {
+        if (measuredRequests <= 0) return 0.0;
+        return (measuredRequests - measuredSuccessful) * 100.0 / measuredRequests;
+    }
+    if (completedRequests <= 0) return 0.0;
+    return (completedRequests - successfulRequests) * 100.0 / completedRequests;
+}
+
+double RunSummary::throughput() const {
+    if (hasMeasurementWindow()) {
+        int seconds = measureEndSecond - measureStartSecond;
+        return seconds > 0 ? static_cast<double>(measuredRequests) / seconds : 0.0;
+    }
+    if (durationMs <= 0) return 0.0;
+    return completedRequests * 1000.0 / durationMs;
+}
+
+std::vector<uint32_t> RunSummary::measuredPerSecond() const {
+    if (!hasMeasurementWindow()) return completedPerSecond;
+    // 序列只含完整的秒，窗口可能延伸到最后一个不满一秒的桶
+    size_t begin = std::min(completedPerSecond.size(), static_cast<size_t>(measureStartSecond));
+    size_t end = std::min(completedPerSecond.size(), static_cast<size_t>(measureEndSecond));
+    return std::vector<uint32_t>(completedPerSecond.begin() + begin, completedPerSecond.begin() + std::max(begin, end));
+}
+
+std::string RunSummary::serialize() const {
+    std::string out;
+    out.append(SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC));
+    out.push_back(static_cast<char>(SUMMARY_VERSION));
+
+    writeVarint(out, url.size());
+    out.append(url);
+    writeVarint(out, static_cast<uint64_t>(threads));
+    writeVarint(out, static_cast<uint64_t>(totalRequests));
+    writeVarint(out, static_cast<uint64_t>(completedRequests));
+    writeVarint(out, static_cast<uint64_t>(successfulRequests));
+    writeVarint(out, static_cast<uint64_t>(startTimeMs));
+    writeVarint(out, static_cast<uint64_t>(durationMs));
+
+    writeVarint(out, completedPerSecond.size());
+    for (uint32_t value : completedPerSecond) {
+        writeVarint(out, value);
+    }
+
+    writeVarint(out, generatorSaturated ? 1 : 0);
+    writeVarint(out, saturationReason.size());
+    out.append(saturationReason);
+
+    writeVarint(out, static_cast<uint64_t>(measureStartSecond));
+    writeVarint(out, static_cast<uint64_t>(measureEndSecond));
+    writeVarint(out, static_cast<uint64_t>(measuredRequests));
+    writeVarint(out, static_cast<uint64_t>(measuredSuccessful));
+    writeVarint(out, steadyStateDetected ? 1 : 0);
+
+    std::string sketchData = latency.serialize();
+    writeVarint(out, sketchData.size());
+    out.append(sketchData);
+    return out;
+}
+
+bool RunSummary::deserialize(const std::string& data, RunSummary& summary) {
+    if (data.size() < sizeof(SUMMARY_MAGIC) + 1 ||
+        std::memcmp(data.data(), SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC)) != 0) {
+        return false;
+    }
+    uint8_t version = static_cast<uint8_t>(data[sizeof(SUMMARY_MAGIC)]);
+    if (version < 1 || version > SUMMARY_VERSION) {
+        return false;
+    }
+
+    size_t pos = sizeof(SUMMARY_MAGIC) + 1;
+    RunSummary result;
+    uint64_t length, value;
+
+    if (!readVarint(data, pos, length) || length > data.size() - pos) return false;
+    result.url = data.substr(pos, static_cast<size_t>(length));
+    pos += static_cast<size_t>(length);
+
+    uint64_t fields[6];
+    for (auto& field : fields) {
+        if (!readVarint(data, pos, field)) return false;
+    }
+    result.threads = static_cast<int>(fields[0]);
+    result.totalRequests = static_cast<int>(fields[1]);
+    result.completedRequests = static_cast<int>(fields[2]);
+    result.successfulRequests = static_cast<int>(fields[3]);
+    result.startTimeMs = static_cast<int64_t>(fields[4]);
+    result.durationMs = static_cast<int64_t>(fields[5]);
+
+    if (!readVarint(data, pos, length) || length > data.size() - pos) return false;
+    result.completedPerSecond.reserve(static_cast<size_t>(length));
+    for (uint64_t i = 0; i < length; ++i) {
+        if (!readVarint(data, pos, value)) return false;
+        result.completedPerSecond.push_back(static_cast<uint32_t>(value));
+    }
+
+    if (version >= 2) {
+        if (!readVarint(data, pos, value)) return false;
+        result.generatorSaturated = value != 0;
+        if (!readVarint(data, pos, length) || length > data.size() - pos) return false;
+        result.saturationReason = data.substr(pos, static_cast<size_t>(length));
+        pos += static_cast<size_t>(length);
+    }
+
+    if (version >= 3) {
+        uint64_t window[5];
+        for (auto& field : window) {
+            if (!readVarint(data, pos, field)) return false;
+        }
+        result.measureStartSecond = static_cast<int>(window[0]);
+        result.measureEndSecond = static_cast<int>(window[1]);
+        result.measuredRequests = static_cast<int>(window[2]);
+        result.measuredSuccessful = static_cast<int>(window[3]);
+        result.steadyStateDetected = window[4] != 0;
+    }
+
+    if (!readVarint(data, pos, length) || length != data.size() - pos) return false;
+    if (!DDSketch::deserialize(data.substr(pos), result.latency)) return false;
+
+    summary = result;
+    return true;
+}
+
+bool RunSummary::saveToFile(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string data = serialize();
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+bool RunSummary::loadFromFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return deserialize(data, *this);
+}
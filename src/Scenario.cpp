@@ -0,0 +1,537 @@
+/**
+ * @file Scenario.cpp
+ * @brief 多步骤会话场景、会话状态与分步统计的实现
+ */
+#include "../include/Scenario.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 只做定位的JSON扫描器：跳过不需要的值，不构建文档树
+ */
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view text) : text(text), pos(0) {}
+
+    void skipSpace() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) pos++;
+    }
+
+    char peek() {
+        skipSpace();
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        pos++;
+        return true;
+    }
+
+    /**
+     * @brief 读取字符串的原始内容（不含引号，不反转义）
+     */
+    bool readStringRaw(std::string_view& raw) {
+        if (!consume('"')) return false;
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\') pos++;
+            pos++;
+        }
+        if (pos >= text.size()) return false;
+        raw = text.substr(start, pos - start);
+        pos++;
+        return true;
+    }
+
+    /**
+     * @brief 跳过一个完整的值，返回其原文
+     */
+    bool skipValue(std::string_view& raw) {
+        char c = peek();
+        size_t start = pos;
+        if (c == '"') {
+            std::string_view unused;
+            if (!readStringRaw(unused)) return false;
+        } else if (c == '{' || c == '[') {
+            int depth = 0;
+            while (pos < text.size()) {
+                char ch = text[pos];
+                if (ch == '"') {
+                    std::string_view unused;
+                    if (!readStringRaw(unused)) return false;
+                    continue;
+                }
+                if (ch == '{' || ch == '[') depth++;
+                if (ch == '}' || ch == ']') depth--;
+                pos++;
+                if (depth == 0) break;
+            }
+            if (depth != 0) return false;
+        } else {
+            while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' &&
+                   !std::isspace(static_cast<unsigned char>(text[pos]))) {
+                pos++;
+            }
+            if (pos == start) return false;
+        }
+        raw = text.substr(start, pos - start);
+        return true;
+    }
+
+    /**
+     * @brief 进入当前对象中键为key的值
+     */
+    bool enterKey(std::string_view key) {
+        if (!consume('{')) return false;
+        if (consume('}')) return false;
+        while (true) {
+            std::string_view name;
+            if (!readStringRaw(name) || !consume(':')) return false;
+            if (name == key) return true;
+            std::string_view unused;
+            if (!skipValue(unused)) return false;
+            if (!consume(',')) return false;
+        }
+    }
+
+    /**
+     * @brief 进入当前数组中下标为index的值
+     */
+    bool enterIndex(size_t index) {
+        if (!consume('[')) return false;
+        if (consume(']')) return false;
+        for (size_t i = 0; i < index; ++i) {
+            std::string_view unused;
+            if (!skipValue(unused) || !consume(',')) return false;
+        }
+        return true;
+    }
+
+private:
+    std::string_view text;
+    size_t pos;
+};
+
+void appendUtf8(std::pmr::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+uint32_t parseHex4(std::string_view text) {
+    uint32_t code = 0;
+    for (char c : text) {
+        code <<= 4;
+        if (c >= '0' && c <= '9') code |= c - '0';
+        else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+    }
+    return code;
+}
+
+void unescapeJsonString(std::string_view raw, std::pmr::string& out) {
+    out.clear();
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c != '\\' || i + 1 >= raw.size()) {
+            out.push_back(c);
+            continue;
+        }
+        char escape = raw[++i];
+        switch (escape) {
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'u':
+                if (i + 4 < raw.size()) {
+                    uint32_t code = parseHex4(raw.substr(i + 1, 4));
+                    i += 4;
+                    // 代理对
+                    if (code >= 0xD800 && code < 0xDC00 && i + 6 < raw.size() &&
+                        raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                        uint32_t low = parseHex4(raw.substr(i + 3, 4));
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                    appendUtf8(out, code);
+                }
+                break;
+            default: out.push_back(escape); break;
+        }
+    }
+}
+
+} // namespace
+
+bool findJsonValue(std::string_view json, std::string_view path, std::pmr::string& out) {
+    JsonCursor cursor(json);
+
+    while (!path.empty()) {
+        size_t dot = path.find('.');
+        std::string_view segment = path.substr(0, dot);
+        path = (dot == std::string_view::npos) ? std::string_view() : path.substr(dot + 1);
+
+        bool entered;
+        if (cursor.peek() == '[') {
+            size_t index = 0;
+            for (char c : segment) {
+                if (c < '0' || c > '9') return false;
+                index = index * 10 + (c - '0');
+            }
+            entered = !segment.empty() && cursor.enterIndex(index);
+        } else {
+            entered = cursor.enterKey(segment);
+        }
+        if (!entered) return false;
+    }
+
+    if (cursor.peek() == '"') {
+        std::string_view raw;
+        if (!cursor.readStringRaw(raw)) return false;
+        unescapeJsonString(raw, out);
+        return true;
+    }
+
+    std::string_view raw;
+    if (!cursor.skipValue(raw)) return false;
+    out.assign(raw.data(), raw.size());
+    return true;
+}
+
+bool Scenario::loadFromFile(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    name.clear();
+    steps.clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        // 跳过注释和空行
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        if (line == "[Step]") {
+            steps.emplace_back();
+            steps.back().name = "step" + std::to_string(steps.size());
+            continue;
+        }
+
+        size_t pos = line.find('=');
+        if (pos == std::string::npos) continue;
+        std::string key = trim(line.substr(0, pos));
+        std::string value = line.substr(pos + 1);
+
+        if (steps.empty()) {
+            if (key == "name") name = value;
+            continue;
+        }
+
+        ScenarioStep& step = steps.back();
+        if (key == "name") {
+            step.name = value;
+        } else if (key == "method") {
+            step.method = value;
+            std::transform(step.method.begin(), step.method.end(), step.method.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        } else if (key == "url") {
+            step.url = value;
+        } else if (key == "header") {
+            step.headers.push_back(value);
+        } else if (key == "body") {
+            step.body = value;
+        } else if (key == "extract") {
+            // 变量名:来源:路径
+            size_t first = value.find(':');
+            size_t second = first == std::string::npos ? first : value.find(':', first + 1);
+            if (second == std::string::npos) continue;
+
+            Extraction extraction;
+            extraction.variable = value.substr(0, first);
+            std::string source = value.substr(first + 1, second - first - 1);
+            extraction.source = (source == "header") ? Extraction::Source::HEADER : Extraction::Source::JSON;
+            extraction.path = value.substr(second + 1);
+            step.extractions.push_back(extraction);
+        }
+    }
+
+    steps.erase(std::remove_if(steps.begin(), steps.end(),
+                               [](const ScenarioStep& step) { return step.url.empty(); }),
+                steps.end());
+    if (name.empty()) name = "transaction";
+    return !steps.empty();
+}
+
+void StepStats::merge(const StepStats& other) {
+    count += other.count;
+    successful += other.successful;
+    failed += other.failed;
+    errors += other.errors;
+    latency.merge(other.latency);
+}
+
+void ScenarioStats::reset(const Scenario& scenario) {
+    steps.assign(scenario.steps.size(), StepStats());
+    for (size_t i = 0; i < steps.size(); ++i) {
+        steps[i].name = scenario.steps[i].name;
+    }
+    transactions = StepStats();
+    transactions.name = scenario.name;
+}
+
+void ScenarioStats::merge(const ScenarioStats& other) {
+    if (steps.empty()) {
+        *this = other;
+        return;
+    }
+    for (size_t i = 0; i < std::min(steps.size(), other.steps.size()); ++i) {
+        steps[i].merge(other.steps[i]);
+    }
+    transactions.merge(other.transactions);
+}
+
+ScenarioSession::ScenarioSession(const Scenario& sessionScenario, int sessionUserId)
+    : scenario(sessionScenario),
+      userId(sessionUserId),
+      iteration(0),
+      stepIndex(0),
+      headerList(nullptr),
+      captureBody(false),
+      initialBuffer(),
+      arena(initialBuffer.data(), initialBuffer.size()) {
+}
+
+ScenarioSession::~ScenarioSession() {
+    freeHeaderList();
+    // 先销毁池中的对象，再由成员析构释放内存池
+    state.reset();
+}
+
+void ScenarioSession::beginTransaction(CURL* easy) {
+    // 上一个事务的全部状态整体丢弃，内存池回到内嵌初始块
+    state.reset();
+    arena.release();
+    state.emplace(&arena);
+
+    curl_easy_setopt(easy, CURLOPT_COOKIELIST, "ALL");
+    iteration++;
+    stepIndex = 0;
+    transactionStart = std::chrono::steady_clock::now();
+}
+
+void ScenarioSession::abandonTransaction() {
+    freeHeaderList();
+    stepIndex = 0;
+}
+
+void ScenarioSession::freeHeaderList() {
+    if (headerList) {
+        curl_slist_free_all(headerList);
+        headerList = nullptr;
+    }
+}
+
+size_t ScenarioSession::headerCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    auto* session = static_cast<ScenarioSession*>(userdata);
+    session->state->headers.append(buffer, size * nitems);
+    return size * nitems;
+}
+
+size_t ScenarioSession::bodyCallback(char* buffer, size_t size, size_t nmemb, void* userdata) {
+    auto* session = static_cast<ScenarioSession*>(userdata);
+    if (session->captureBody) {
+        session->state->body.append(buffer, size * nmemb);
+    }
+    return size * nmemb;
+}
+
+const std::pmr::string& ScenarioSession::expand(const std::string& text) {
+    std::pmr::string& out = state->scratch;
+    out.clear();
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t open = text.find("${", pos);
+        size_t close = open == std::string::npos ? open : text.find('}', open + 2);
+        if (close == std::string::npos) {
+            out.append(text, pos, std::string::npos);
+            break;
+        }
+        out.append(text, pos, open - pos);
+
+        std::string_view name(text.data() + open + 2, close - open - 2);
+        if (name == "vu") {
+            out.append(std::to_string(userId));
+        } else if (name == "iteration") {
+            out.append(std::to_string(iteration));
+        } else {
+            auto it = state->variables.find(std::pmr::string(name, &arena));
+            if (it != state->variables.end()) out.append(it->second);
+        }
+        pos = close + 1;
+    }
+    return out;
+}
+
+void ScenarioSession::prepareStep(CURL* easy) {
+    const ScenarioStep& step = scenario.steps[stepIndex];
+
+    state->headers.clear();
+    state->body.clear();
+    captureBody = std::any_of(step.extractions.begin(), step.extractions.end(),
+                              [](const Extraction& e) { return e.source == Extraction::Source::JSON; });
+
+    curl_easy_setopt(easy, CURLOPT_URL, expand(step.url).c_str());
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, headerCallback);
+    curl_easy_setopt(easy, CURLOPT_HEADERDATA, this);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, bodyCallback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, this);
+
+    freeHeaderList();
+    for (const auto& header : step.headers) {
+        headerList = curl_slist_append(headerList, expand(header).c_str());
+    }
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, headerList);
+
+    // 先恢复为GET（同时清除上一步的NOBODY），再按方法设置请求体（curl会复制请求体）
+    curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, nullptr);
+    curl_easy_setopt(easy, CURLOPT_HTTPGET, 1L);
+    if (step.method == "GET") return;
+
+    if (step.method == "HEAD") {
+        curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+        return;
+    }
+    const std::pmr::string& body = expand(step.body);
+    if (step.method == "POST" || !body.empty()) {
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+        curl_easy_setopt(easy, CURLOPT_COPYPOSTFIELDS, body.c_str());
+    }
+    if (step.method != "POST") {
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, step.method.c_str());
+    }
+}
+
+bool ScenarioSession::applyExtractions(const ScenarioStep& step) {
+    bool allFound = true;
+    std::pmr::string value(&arena);
+
+    for (const auto& extraction : step.extractions) {
+        bool found = false;
+        if (extraction.source == Extraction::Source::JSON) {
+            found = findJsonValue(state->body, extraction.path, value);
+        } else {
+            // 重定向时会收到多组响应头，取最后一个匹配的值
+            std::string_view headers(state->headers);
+            size_t lineStart = 0;
+            while (lineStart < headers.size()) {
+                size_t lineEnd = headers.find('\n', lineStart);
+                if (lineEnd == std::string_view::npos) lineEnd = headers.size();
+                std::string_view line = headers.substr(lineStart, lineEnd - lineStart);
+                size_t colon = line.find(':');
+                if (colon != std::string_view::npos && equalsIgnoreCase(line.substr(0, colon), extraction.path)) {
+                    std::string_view headerValue = line.substr(colon + 1);
+                    while (!headerValue.empty() && (headerValue.front() == ' ' || headerValue.front() == '\t')) {
+                        headerValue.remove_prefix(1);
+                    }
+                    while (!headerValue.empty() && (headerValue.back() == '\r' || headerValue.back() == ' ')) {
+                        headerValue.remove_suffix(1);
+                    }
+                    value.assign(headerValue.data(), headerValue.size());
+                    found = true;
+                }
+                lineStart = lineEnd + 1;
+            }
+        }
+
+        if (found) {
+            state->variables[std::pmr::string(extraction.variable, &arena)] = value;
+        } else {
+            allFound = false;
+        }
+    }
+    return allFound;
+}
+
+StepOutcome ScenarioSession::finishStep(CURL* easy, CURLcode result, int64_t elapsedNs, ScenarioStats& stats) {
+    const ScenarioStep& step = scenario.steps[stepIndex];
+    StepStats& stepStats = stats.steps[stepIndex];
+    freeHeaderList();
+
+    stepStats.count++;
+    stepStats.latency.add(elapsedNs / 1e6);
+
+    bool succeeded = false;
+    if (result != CURLE_OK) {
+        stepStats.errors++;
+    } else {
+        long responseCode = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &responseCode);
+        if (responseCode >= 200 && responseCode < 300 && applyExtractions(step)) {
+            stepStats.successful++;
+            succeeded = true;
+        } else {
+            stepStats.failed++;
+        }
+    }
+
+    bool lastStep = stepIndex + 1 >= scenario.steps.size();
+    if (succeeded && !lastStep) {
+        stepIndex++;
+        return StepOutcome::NEXT_STEP;
+    }
+
+    // 事务结束（成功完成最后一步或中途失败）
+    StepStats& transactionStats = stats.transactions;
+    transactionStats.count++;
+    transactionStats.latency.add(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - transactionStart).count());
+    if (succeeded) {
+        transactionStats.successful++;
+    } else if (result != CURLE_OK) {
+        transactionStats.errors++;
+    } else {
+        transactionStats.failed++;
+    }
+    stepIndex = 0;
+    return succeeded ? StepOutcome::TRANSACTION_SUCCEEDED : StepOutcome::TRANSACTION_FAILED;
+}
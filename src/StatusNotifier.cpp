@@ -0,0 +1,185 @@
+/**
+ * @file StatusNotifier.cpp
+ * @brief 合并式状态通知器的实现
+ */
+#include "../include/StatusNotifier.h"
+#include <algorithm>
+
+RecentResultRing::RecentResultRing(size_t ringCapacity)
+    : capacity(std::max<size_t>(1, ringCapacity)),
+      slots(new SeqLock<RequestResult>[capacity + 1]),
+      written(0) {
+}
+
+void RecentResultRing::push(const RequestResult& result) {
+    uint64_t index = written.load(std::memory_order_relaxed);
+    slots[index % (capacity + 1)].publish(result);
+    written.store(index + 1, std::memory_order_release);
+}
+
+uint64_t RecentResultRing::collect(uint64_t from, std::vector<RequestResult>& out) const {
+    uint64_t end = written.load(std::memory_order_acquire);
+    uint64_t begin = std::max(from, end > capacity ? end - capacity : 0);
+    size_t first = out.size();
+    for (uint64_t i = begin; i < end; ++i) {
+        out.push_back(slots[i % (capacity + 1)].read());
+    }
+
+    // 读取期间写者可能已经绕回覆盖了开头的槽位：写入计数达到i + capacity + 1后，
+    // 第i个槽位可能已是新值（或正在写入），这些序号一律丢弃
+    uint64_t after = written.load(std::memory_order_acquire);
+    if (after > begin + capacity) {
+        size_t overwritten = static_cast<size_t>(std::min(end, after - capacity) - begin);
+        out.erase(out.begin() + first, out.begin() + first + overwritten);
+    }
+    return end;
+}
+
+StatusNotifier::StatusNotifier(size_t maxBatchedResults)
+    : maxBatchedResults(std::max<size_t>(1, maxBatchedResults)),
+      interval(100),
+      deliveredCount(0) {
+    shards.push_back(std::make_unique<Shard>(this->maxBatchedResults));
+}
+
+void StatusNotifier::setCallback(Callback newCallback) {
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    callback = std::move(newCallback);
+}
+
+void StatusNotifier::setInterval(std::chrono::milliseconds newInterval) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    interval = std::max(std::chrono::milliseconds(1), newInterval);
+}
+
+std::chrono::milliseconds StatusNotifier::getInterval() const {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return interval;
+}
+
+void StatusNotifier::reset(size_t shardCount) {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    shards.clear();
+    for (size_t i = 0; i < std::max<size_t>(1, shardCount); ++i) {
+        shards.push_back(std::make_unique<Shard>(maxBatchedResults));
+    }
+    pendingResults.clear();
+    pendingDelta = StatusUpdate();
+    lastDelivery = std::chrono::steady_clock::time_point();
+    deliveredCount = 0;
+}
+
+void StatusNotifier::record(size_t shardIndex, const RequestResult& result) {
+    Shard& shard = *shards[shardIndex];
+
+    // 单写者：读出再写回即可，收集方只读
+    auto bump = [](std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    };
+    switch (result.status) {
+        case RequestStatus::SUCCESS:
+            bump(shard.successful);
+            break;
+        case RequestStatus::FAILED:
+            bump(shard.failed);
+            break;
+        case RequestStatus::REQ_ERROR:
+            bump(shard.errors);
+            break;
+    }
+    // 完成数最后更新并以release发布，收集方读到它时分类计数已经可见
+    shard.completed.store(shard.completed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    shard.recent.push(result);
+}
+
+void StatusNotifier::collect() {
+    for (auto& shardPtr : shards) {
+        Shard& shard = *shardPtr;
+        Shard::Seen& seen = shard.seen;
+
+        uint64_t completed = shard.completed.load(std::memory_order_acquire);
+        uint64_t successful = shard.successful.load(std::memory_order_relaxed);
+        uint64_t failed = shard.failed.load(std::memory_order_relaxed);
+        uint64_t errors = shard.errors.load(std::memory_order_relaxed);
+
+        pendingDelta.deltaCompleted += static_cast<int>(completed - seen.completed);
+        pendingDelta.deltaSuccessful += static_cast<int>(successful - seen.successful);
+        pendingDelta.deltaFailed += static_cast<int>(failed - seen.failed);
+        pendingDelta.deltaErrors += static_cast<int>(errors - seen.errors);
+        seen.completed = completed;
+        seen.successful = successful;
+        seen.failed = failed;
+        seen.errors = errors;
+
+        // 两次收集之间被覆盖、没能读到的结果计为未携带
+        size_t before = pendingResults.size();
+        uint64_t end = shard.recent.collect(seen.recent, pendingResults);
+        pendingDelta.droppedResults += static_cast<int>(end - seen.recent - (pendingResults.size() - before));
+        seen.recent = end;
+    }
+
+    // 只保留所有分片中最新的若干条结果，其余只计数
+    if (pendingResults.size() > maxBatchedResults) {
+        pendingDelta.droppedResults += static_cast<int>(pendingResults.size() - maxBatchedResults);
+        std::nth_element(pendingResults.begin(), pendingResults.begin() + maxBatchedResults, pendingResults.end(),
+                         [](const RequestResult& a, const RequestResult& b) { return a.timestampNs > b.timestampNs; });
+        pendingResults.resize(maxBatchedResults);
+    }
+}
+
+bool StatusNotifier::poll(std::chrono::steady_clock::time_point now, int completed, int total, double successRate) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (now - lastDelivery < interval) {
+            return false;
+        }
+        collect();
+        if (pendingDelta.deltaCompleted == 0) {
+            return false;
+        }
+        lastDelivery = now;
+    }
+
+    deliver(completed, total, successRate);
+    return true;
+}
+
+void StatusNotifier::flush(int completed, int total, double successRate) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        collect();
+        lastDelivery = std::chrono::steady_clock::now();
+    }
+
+    deliver(completed, total, successRate);
+}
+
+size_t StatusNotifier::getDeliveredCount() const {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    return deliveredCount;
+}
+
+void StatusNotifier::deliver(int completed, int total, double successRate) {
+    StatusUpdate update;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        update = std::move(pendingDelta);
+        pendingDelta = StatusUpdate();
+        std::sort(pendingResults.begin(), pendingResults.end(),
+                  [](const RequestResult& a, const RequestResult& b) { return a.timestampNs > b.timestampNs; });
+        update.recentResults.assign(pendingResults.begin(), pendingResults.end());
+        pendingResults.clear();
+        deliveredCount++;
+    }
+
+    update.completedRequests = completed;
+    update.totalRequests = total;
+    update.successRate = successRate;
+
+    // 回调在锁外执行，收集状态不会被前端阻塞
+    std::lock_guard<std::mutex> lock(callbackMutex);
+    if (callback) {
+        callback(update);
+    }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file SteadyState.cpp
+ * @brief 预热/冷却测量窗口与稳态检测的实现
+ */
+#include "../include/SteadyState.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief 序列最后count个值的变异系数，均值为0时返回无穷大
+ */
+double coefficientOfVariation(const std::vector<double>& values, size_t count) {
+    double mean = 0.0;
+    for (size_t i = values.size() - count; i < values.size(); ++i) mean += values[i];
+    mean /= count;
+    if (mean <= 0.0) return INFINITY;
+
+    double variance = 0.0;
+    for (size_t i = values.size() - count; i < values.size(); ++i) {
+        variance += (values[i] - mean) * (values[i] - mean);
+    }
+    return std::sqrt(variance / count) / mean;
+}
+
+} // namespace
+
+SteadyStateDetector::SteadyStateDetector(int windowSeconds, double variation)
+    : stableSeconds(std::max(2, windowSeconds)), maxVariation(variation), steadyStart(-1) {
+}
+
+bool SteadyStateDetector::add(uint64_t completed, double p50Ms) {
+    throughput.push_back(static_cast<double>(completed));
+    medians.push_back(p50Ms);
+    if (isSteady()) return false;
+
+    size_t window = static_cast<size_t>(stableSeconds);
+    if (throughput.size() < window) return false;
+    for (size_t i = throughput.size() - window; i < throughput.size(); ++i) {
+        if (throughput[i] <= 0.0) return false;
+    }
+    if (coefficientOfVariation(throughput, window) > maxVariation ||
+        coefficientOfVariation(medians, window) > maxVariation) {
+        return false;
+    }
+
+    steadyStart = static_cast<int>(throughput.size() - window);
+    return true;
+}
+
+MeasurementWindow resolveMeasurementWindow(const MeasurementWindowOptions& options, int bucketCount,
+                                           int steadyStart) {
+    MeasurementWindow window;
+    window.endSecond = bucketCount;
+    if (!options.enabled()) return window;
+
+    // 部分覆盖的秒整体排除，宁可少算也不混入预热或冷却
+    int warmUpSeconds = (options.warmUpMs + 999) / 1000;
+    int coolDownSeconds = (options.coolDownMs + 999) / 1000;
+
+    window.startSecond = warmUpSeconds;
+    if (options.autoDetect && steadyStart > window.startSecond) {
+        window.startSecond = steadyStart;
+        window.steadyStateDetected = true;
+    } else if (options.autoDetect && steadyStart >= 0) {
+        window.steadyStateDetected = true;
+    }
+    window.endSecond = std::max(window.startSecond, bucketCount - coolDownSeconds);
+    return window;
+}
@@ -0,0 +1,419 @@
+/**
+ * @file TcpTransport.cpp
+ * @brief 按行或长度前缀分帧的原始TCP请求/响应传输的实现
+ */
+#include "../include/TcpTransport.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+const size_t RECV_CHUNK = 16384;            // 单次curl_easy_recv读取的最大字节数
+const size_t RECV_COMPACT_BYTES = 65536;    // 已解析部分超过该长度时压缩接收缓冲区
+
+/**
+ * @brief 十六进制字符的值，非十六进制字符返回-1
+ */
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+bool TcpOptions::parseFraming(const std::string& text, TcpFraming& framing) {
+    std::string name;
+    for (char c : text) name.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    if (name == "line") {
+        framing = TcpFraming::LINE;
+        return true;
+    }
+    if (name == "length") {
+        framing = TcpFraming::LENGTH_PREFIX;
+        return true;
+    }
+    return false;
+}
+
+std::string TcpOptions::unescape(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            out.push_back(text[i]);
+            continue;
+        }
+        char c = text[++i];
+        switch (c) {
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case '0': out.push_back('\0'); break;
+            case 'x':
+                if (i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+                    out.push_back(static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2])));
+                    i += 2;
+                } else {
+                    out.append("\\x");
+                }
+                break;
+            default: out.push_back(c); break;
+        }
+    }
+    return out;
+}
+
+bool isTcpUrl(const std::string& url) {
+    return url.compare(0, 6, "tcp://") == 0 || url.compare(0, 7, "tcps://") == 0;
+}
+
+TcpTransport::TcpTransport(const std::string& url, const TcpOptions& tcpOptions, int timeout, int connection,
+                           CancellationSource* cancellation)
+    : options(tcpOptions),
+      timeoutMs(std::max(1, timeout)),
+      connectionIndex(connection),
+      cancel(cancellation),
+      multi(curl_multi_init()),
+      curl(nullptr),
+      socket(CURL_SOCKET_BAD),
+      sequence(0),
+      connectionsOpened(0),
+      sendOffset(0),
+      recvOffset(0),
+      failedCode(CURLE_OK),
+      failedCancelled(false) {
+    // CONNECT_ONLY只建连不发请求，借用http/https方案让libcurl完成TCP与TLS握手
+    if (url.compare(0, 7, "tcps://") == 0) {
+        curlUrl = "https://" + url.substr(7);
+    } else {
+        curlUrl = "http://" + url.substr(url.compare(0, 6, "tcp://") == 0 ? 6 : 0);
+    }
+
+    options.pipelineDepth = std::max(1, options.pipelineDepth);
+    if (options.lengthBytes != 1 && options.lengthBytes != 2) options.lengthBytes = 4;
+    if (options.delimiter.empty()) options.delimiter = "\n";
+
+    std::string payload = options.payload;
+    if (options.framing == TcpFraming::LINE &&
+        (payload.size() < options.delimiter.size() ||
+         payload.compare(payload.size() - options.delimiter.size(), options.delimiter.size(), options.delimiter) != 0)) {
+        payload += options.delimiter;
+    }
+
+    // 模板预先拆成字面量与占位符，发送时只做拼接
+    size_t pos = 0;
+    while (pos < payload.size()) {
+        size_t seq = payload.find("{seq}", pos);
+        size_t conn = payload.find("{conn}", pos);
+        size_t next = std::min(seq, conn);
+        if (next == std::string::npos) {
+            parts.push_back({TemplatePart::LITERAL, payload.substr(pos)});
+            break;
+        }
+        if (next > pos) parts.push_back({TemplatePart::LITERAL, payload.substr(pos, next - pos)});
+        if (next == seq) {
+            parts.push_back({TemplatePart::SEQUENCE, std::string()});
+            pos = next + 5;
+        } else {
+            parts.push_back({TemplatePart::CONNECTION, std::string()});
+            pos = next + 6;
+        }
+    }
+
+    if (multi && cancel) cancel->registerMulti(multi);
+}
+
+TcpTransport::~TcpTransport() {
+    disconnect();
+    if (multi) {
+        if (cancel) cancel->unregisterMulti(multi);
+        curl_multi_cleanup(multi);
+    }
+}
+
+TcpTransport::TcpTransport(TcpTransport&& other) noexcept
+    : curlUrl(std::move(other.curlUrl)),
+      options(std::move(other.options)),
+      parts(std::move(other.parts)),
+      timeoutMs(other.timeoutMs),
+      connectionIndex(other.connectionIndex),
+      cancel(other.cancel),
+      multi(other.multi),
+      curl(other.curl),
+      socket(other.socket),
+      sequence(other.sequence),
+      connectionsOpened(other.connectionsOpened),
+      sendBuffer(std::move(other.sendBuffer)),
+      sendOffset(other.sendOffset),
+      recvBuffer(std::move(other.recvBuffer)),
+      recvOffset(other.recvOffset),
+      outstanding(std::move(other.outstanding)),
+      failed(std::move(other.failed)),
+      failedCode(other.failedCode),
+      failedCancelled(other.failedCancelled),
+      failedAt(other.failedAt),
+      pendingConnect(other.pendingConnect) {
+    other.multi = nullptr;
+    other.curl = nullptr;
+    other.socket = CURL_SOCKET_BAD;
+}
+
+TransferResult TcpTransport::perform() {
+    if (!failed.empty()) return takeFailed();
+
+    TransferResult result;
+    if (!curl && !connect(result)) return result;
+
+    while (static_cast<int>(outstanding.size()) < options.pipelineDepth) {
+        appendRequest();
+    }
+
+    auto deadline = outstanding.front().sentAt + std::chrono::milliseconds(timeoutMs);
+    CURLcode code = CURLE_OK;
+    size_t responseBytes = 0;
+    while (true) {
+        if (extractResponse(responseBytes)) break;
+
+        code = flushSend();
+        if (code != CURLE_OK) break;
+        code = receiveSome();
+        if (code == CURLE_OK) continue;
+        if (code != CURLE_AGAIN) break;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            code = CURLE_OPERATION_TIMEDOUT;
+            break;
+        }
+        int waitMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+        int events = CURL_WAIT_POLLIN | (sendOffset < sendBuffer.size() ? CURL_WAIT_POLLOUT : 0);
+        TRACE_SPAN("tcpWait");
+        if (!waitSocket(events, waitMs, result.cancelled)) {
+            code = CURLE_ABORTED_BY_CALLBACK;
+            break;
+        }
+        code = CURLE_OK;
+    }
+
+    OutstandingRequest request = outstanding.front();
+    outstanding.pop_front();
+    result.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - request.sentAt).count();
+    result.code = code;
+    result.bytesSent = request.bytes;
+    result.bytesReceived = responseBytes;
+    result.bodyBytes = responseBytes;
+    if (code == CURLE_OK) {
+        result.statusCode = 200;
+    } else {
+        failPipeline(code, result.cancelled);
+    }
+
+    if (pendingConnect.newConnection) {
+        result.newConnection = true;
+        result.reconnect = pendingConnect.reconnect;
+        result.tcpHandshakeNs = pendingConnect.tcpHandshakeNs;
+        result.tlsHandshakeNs = pendingConnect.tlsHandshakeNs;
+        result.connectReadyNs = pendingConnect.connectReadyNs;
+        pendingConnect = TransferResult();
+    }
+    return result;
+}
+
+bool TcpTransport::connect(TransferResult& result) {
+    auto start = std::chrono::steady_clock::now();
+    curl = curl_easy_init();
+    if (!curl) {
+        result.code = CURLE_FAILED_INIT;
+        return false;
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, curlUrl.c_str());
+    curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(timeoutMs));
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    CURLcode code;
+    {
+        TRACE_SPAN("tcpConnect");
+        code = multi ? connectCancellable(result.cancelled) : curl_easy_perform(curl);
+    }
+    if (code == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_ACTIVESOCKET, &socket);
+        if (socket == CURL_SOCKET_BAD) code = CURLE_COULDNT_CONNECT;
+    }
+    if (code != CURLE_OK) {
+        result.code = code;
+        result.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        disconnect();
+        return false;
+    }
+
+    pendingConnect = TransferResult();
+    readConnectionTiming(curl, pendingConnect);
+    pendingConnect.newConnection = true;
+    pendingConnect.reconnect = connectionsOpened > 0;
+    connectionsOpened++;
+    sequence = 0;
+    return true;
+}
+
+CURLcode TcpTransport::connectCancellable(bool& cancelled) {
+    // 建连完成后句柄留在multi上，CONNECT_ONLY连接随移除一起关闭，由disconnect()移除
+    curl_multi_add_handle(multi, curl);
+
+    CURLcode code = CURLE_FAILED_INIT;
+    while (true) {
+        int stillRunning = 0;
+        if (curl_multi_perform(multi, &stillRunning) != CURLM_OK) break;
+        if (stillRunning == 0) {
+            int remaining = 0;
+            while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+                if (message->msg == CURLMSG_DONE) code = message->data.result;
+            }
+            break;
+        }
+        if (cancel && cancel->isCancelled()) {
+            cancelled = true;
+            code = CURLE_ABORTED_BY_CALLBACK;
+            break;
+        }
+        curl_multi_poll(multi, nullptr, 0, timeoutMs, nullptr);
+    }
+    return code;
+}
+
+void TcpTransport::disconnect() {
+    if (curl) {
+        if (multi) curl_multi_remove_handle(multi, curl);
+        curl_easy_cleanup(curl);
+    }
+    curl = nullptr;
+    socket = CURL_SOCKET_BAD;
+    sendBuffer.clear();
+    sendOffset = 0;
+    recvBuffer.clear();
+    recvOffset = 0;
+    outstanding.clear();
+}
+
+void TcpTransport::failPipeline(CURLcode code, bool cancelled) {
+    // 同一连接上已发出的请求不会再有响应，留待后续perform()逐个返回失败结果
+    for (const auto& request : outstanding) failed.push_back(request);
+    failedCode = code;
+    failedCancelled = cancelled;
+    failedAt = std::chrono::steady_clock::now();
+    disconnect();
+}
+
+TransferResult TcpTransport::takeFailed() {
+    OutstandingRequest request = failed.front();
+    failed.pop_front();
+    TransferResult result;
+    result.code = failedCode;
+    result.cancelled = failedCancelled;
+    result.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(failedAt - request.sentAt).count();
+    result.bytesSent = request.bytes;
+    return result;
+}
+
+void TcpTransport::appendRequest() {
+    size_t frameStart = sendBuffer.size();
+    if (options.framing == TcpFraming::LENGTH_PREFIX) {
+        sendBuffer.append(static_cast<size_t>(options.lengthBytes), '\0');
+    }
+    for (const auto& part : parts) {
+        switch (part.kind) {
+            case TemplatePart::LITERAL: sendBuffer.append(part.text); break;
+            case TemplatePart::SEQUENCE: sendBuffer.append(std::to_string(sequence)); break;
+            case TemplatePart::CONNECTION: sendBuffer.append(std::to_string(connectionIndex)); break;
+        }
+    }
+    if (options.framing == TcpFraming::LENGTH_PREFIX) {
+        // 大端长度头，长度不含头部
+        uint64_t length = sendBuffer.size() - frameStart - options.lengthBytes;
+        for (int i = options.lengthBytes - 1; i >= 0; --i) {
+            sendBuffer[frameStart + i] = static_cast<char>(length & 0xFF);
+            length >>= 8;
+        }
+    }
+    sequence++;
+    outstanding.push_back(OutstandingRequest{std::chrono::steady_clock::now(), sendBuffer.size() - frameStart});
+}
+
+CURLcode TcpTransport::flushSend() {
+    while (sendOffset < sendBuffer.size()) {
+        size_t sent = 0;
+        CURLcode code = curl_easy_send(curl, sendBuffer.data() + sendOffset, sendBuffer.size() - sendOffset, &sent);
+        if (code == CURLE_AGAIN) return CURLE_OK;
+        if (code != CURLE_OK) return code;
+        sendOffset += sent;
+    }
+    sendBuffer.clear();
+    sendOffset = 0;
+    return CURLE_OK;
+}
+
+bool TcpTransport::extractResponse(size_t& frameBytes) {
+    size_t available = recvBuffer.size() - recvOffset;
+    size_t frameEnd;
+    if (options.framing == TcpFraming::LINE) {
+        size_t pos = recvBuffer.find(options.delimiter, recvOffset);
+        if (pos == std::string::npos) return false;
+        frameEnd = pos + options.delimiter.size();
+    } else {
+        size_t header = static_cast<size_t>(options.lengthBytes);
+        if (available < header) return false;
+        uint64_t length = 0;
+        for (size_t i = 0; i < header; ++i) {
+            length = (length << 8) | static_cast<uint8_t>(recvBuffer[recvOffset + i]);
+        }
+        if (available - header < length) return false;
+        frameEnd = recvOffset + header + static_cast<size_t>(length);
+    }
+
+    frameBytes = frameEnd - recvOffset;
+    recvOffset = frameEnd;
+    if (recvOffset == recvBuffer.size()) {
+        recvBuffer.clear();
+        recvOffset = 0;
+    } else if (recvOffset > RECV_COMPACT_BYTES) {
+        recvBuffer.erase(0, recvOffset);
+        recvOffset = 0;
+    }
+    return true;
+}
+
+CURLcode TcpTransport::receiveSome() {
+    char chunk[RECV_CHUNK];
+    size_t received = 0;
+    CURLcode code = curl_easy_recv(curl, chunk, sizeof(chunk), &received);
+    if (code != CURLE_OK) return code;
+    // 对端关闭连接
+    if (received == 0) return CURLE_RECV_ERROR;
+    recvBuffer.append(chunk, received);
+    return CURLE_OK;
+}
+
+bool TcpTransport::waitSocket(int events, int waitMs, bool& cancelled) {
+    if (cancel && cancel->isCancelled()) {
+        cancelled = true;
+        return false;
+    }
+    if (!multi) return true;
+
+    // multi句柄上没有传输，只借用curl_multi_poll等待套接字并接收取消唤醒
+    curl_waitfd fd;
+    fd.fd = socket;
+    fd.events = static_cast<short>(events);
+    fd.revents = 0;
+    int ready = 0;
+    curl_multi_poll(multi, &fd, 1, waitMs, &ready);
+
+    if (cancel && cancel->isCancelled()) {
+        cancelled = true;
+        return false;
+    }
+    return true;
+}
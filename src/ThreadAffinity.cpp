@@ -0,0 +1,118 @@
+/**
+ * @file ThreadAffinity.cpp
+ * @brief 线程CPU亲和性与NUMA拓扑工具函数的实现
+ */
+#include "../include/ThreadAffinity.h"
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 可绑定核心编号的上界（不含），取本机逻辑核心数，未知时取亲和性掩码的容量
+ */
+int coreLimit() {
+#ifdef _WIN32
+    const int maskBits = 64;
+#else
+    const int maskBits = CPU_SETSIZE;
+#endif
+    int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return hardware > 0 ? std::min(hardware, maskBits) : maskBits;
+}
+
+} // namespace
+
+std::vector<int> parseCoreList(const std::string& text, std::string* badToken) {
+    std::vector<int> cores;
+    std::stringstream ss(text);
+    std::string part;
+    const int limit = coreLimit();
+
+    auto reject = [badToken](const std::string& token) {
+        if (badToken && badToken->empty()) *badToken = token;
+    };
+
+    while (std::getline(ss, part, ',')) {
+        if (part.find_first_not_of(" \t") == std::string::npos) continue;
+        try {
+            size_t dash = part.find('-');
+            int first, last;
+            if (dash == std::string::npos) {
+                first = last = std::stoi(part);
+            } else {
+                first = std::stoi(part.substr(0, dash));
+                last = std::stoi(part.substr(dash + 1));
+            }
+            // 超出本机核心数的范围整体拒绝，避免"0-2147483647"之类的输入展开成海量条目
+            if (first < 0 || last < first || last >= limit) {
+                reject(part);
+                continue;
+            }
+            for (int core = first; core <= last; ++core) {
+                cores.push_back(core);
+            }
+        } catch (...) {
+            reject(part);
+        }
+    }
+    return cores;
+}
+
+bool pinCurrentThread(int core) {
+    if (core < 0) return true;
+
+#ifdef _WIN32
+    if (core >= 64) return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+#else
+    if (core >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+int currentCpu() {
+#ifdef _WIN32
+    return static_cast<int>(GetCurrentProcessorNumber());
+#else
+    return sched_getcpu();
+#endif
+}
+
+int numaNodeOfCpu(int core) {
+    if (core < 0) return 0;
+
+#ifdef _WIN32
+    UCHAR node = 0;
+    if (core < 256 && GetNumaProcessorNode(static_cast<UCHAR>(core), &node)) {
+        return node;
+    }
+    return 0;
+#else
+    // sysfs中每个节点目录下有指向所属核心的cpuN链接
+    for (int node = 0; node < 64; ++node) {
+        std::string nodeDir = "/sys/devices/system/node/node" + std::to_string(node);
+        if (access(nodeDir.c_str(), F_OK) != 0) {
+            if (node > 0) break;
+            continue;
+        }
+        std::string cpuLink = nodeDir + "/cpu" + std::to_string(core);
+        if (access(cpuLink.c_str(), F_OK) == 0) {
+            return node;
+        }
+    }
+    return 0;
+#endif
+}
@@ -0,0 +1,123 @@
+/**
+ * @file TimerWheel.cpp
+ * @brief 分层时间轮定时器的实现
+ */
+#include "../include/TimerWheel.h"
+#include <algorithm>
+
+namespace {
+
+const int64_t TICK_NS = 1000000;    // 每个刻度1毫秒
+
+} // namespace
+
+void TimerStats::merge(const TimerStats& other) {
+    firedTimers += other.firedTimers;
+    lateTimers += other.lateTimers;
+    totalLatenessNs += other.totalLatenessNs;
+    maxLatenessNs = std::max(maxLatenessNs, other.maxLatenessNs);
+}
+
+TimerWheel::TimerWheel(Clock::time_point wheelOrigin)
+    : origin(wheelOrigin),
+      currentTick(0),
+      pendingCount(0) {
+}
+
+uint64_t TimerWheel::toTick(Clock::time_point time) const {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count();
+    if (ns <= 0) return 0;
+    return static_cast<uint64_t>((ns + TICK_NS - 1) / TICK_NS);
+}
+
+uint64_t TimerWheel::elapsedTicks(Clock::time_point time) const {
+    int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count();
+    return ns > 0 ? static_cast<uint64_t>(ns / TICK_NS) : 0;
+}
+
+void TimerWheel::schedule(Clock::time_point expiry, uint64_t token) {
+    insert({std::max(toTick(expiry), currentTick + 1), token});
+    pendingCount++;
+}
+
+void TimerWheel::insert(const Timer& timer) {
+    for (int level = 0; level < LEVELS; ++level) {
+        int shift = SLOT_BITS * level;
+        // 与当前刻度在本层的距离不足一圈时放入本层
+        if ((timer.expiryTick >> shift) - (currentTick >> shift) < SLOTS) {
+            wheels[level][(timer.expiryTick >> shift) & SLOT_MASK].push_back(timer);
+            return;
+        }
+    }
+    // 超出最高层范围的定时器放在最高层最后处理的槽，下放时会重新计算位置
+    int shift = SLOT_BITS * (LEVELS - 1);
+    wheels[LEVELS - 1][((currentTick >> shift) - 1) & SLOT_MASK].push_back(timer);
+}
+
+void TimerWheel::cascade(int level) {
+    Slot& slot = wheels[level][(currentTick >> (SLOT_BITS * level)) & SLOT_MASK];
+    Slot moved;
+    moved.swap(slot);
+    for (const Timer& timer : moved) {
+        insert(timer);
+    }
+}
+
+size_t TimerWheel::advance(Clock::time_point now, const Handler& handler) {
+    uint64_t targetTick = elapsedTicks(now);
+
+    size_t fired = 0;
+    while (currentTick < targetTick && pendingCount > 0) {
+        currentTick++;
+
+        // 到达低层边界时由高到低逐级下放
+        int topLevel = 0;
+        while (topLevel + 1 < LEVELS &&
+               (currentTick & ((uint64_t(1) << (SLOT_BITS * (topLevel + 1))) - 1)) == 0) {
+            topLevel++;
+        }
+        for (int level = topLevel; level >= 1; --level) {
+            cascade(level);
+        }
+
+        Slot& slot = wheels[0][currentTick & SLOT_MASK];
+        if (slot.empty()) continue;
+
+        firing.clear();
+        firing.swap(slot);
+        pendingCount -= firing.size();
+
+        for (const Timer& timer : firing) {
+            int64_t latenessNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                now - origin).count() - static_cast<int64_t>(timer.expiryTick) * TICK_NS;
+            latenessNs = std::max<int64_t>(0, latenessNs);
+            stats.firedTimers++;
+            stats.totalLatenessNs += latenessNs;
+            stats.maxLatenessNs = std::max(stats.maxLatenessNs, latenessNs);
+            if (latenessNs > TICK_NS) stats.lateTimers++;
+
+            handler(timer.token);
+        }
+        fired += firing.size();
+    }
+
+    // 空闲时直接跳到目标刻度，避免下次推进时逐刻度空转
+    if (pendingCount == 0 && currentTick < targetTick) {
+        currentTick = targetTick;
+    }
+    return fired;
+}
+
+int TimerWheel::nextTimeoutMs(Clock::time_point now) const {
+    if (pendingCount == 0) return -1;
+
+    uint64_t nowTick = elapsedTicks(now);
+    for (uint64_t tick = currentTick + 1; tick <= currentTick + SLOTS; ++tick) {
+        bool boundary = (tick & SLOT_MASK) == 0;
+        if (!wheels[0][tick & SLOT_MASK].empty() || boundary) {
+            // 高层边界处需要下放，按该刻度返回以便及时推进
+            return tick > nowTick ? static_cast<int>(tick - nowTick) : 0;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file Tracer.cpp
+ * @brief 热路径区间追踪与Chrome trace格式导出的实现
+ */
+#include "../include/Tracer.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <limits>
+
+namespace {
+
+const size_t EVENTS_PER_THREAD = 1 << 18;   // 每个线程最多保留的区间数（约6MB）
+
+void appendInt(std::string& out, int64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+/**
+ * @brief 以微秒写出纳秒值，保留三位小数（Chrome trace的时间单位是微秒）
+ */
+void appendMicros(std::string& out, int64_t ns) {
+    appendInt(out, ns / 1000);
+    int64_t fraction = ns % 1000;
+    out.push_back('.');
+    out.push_back(static_cast<char>('0' + fraction / 100));
+    out.push_back(static_cast<char>('0' + fraction / 10 % 10));
+    out.push_back(static_cast<char>('0' + fraction % 10));
+}
+
+void appendJsonString(std::string& out, const std::string& text) {
+    out.push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') out.push_back('\\');
+        if (static_cast<unsigned char>(c) >= 0x20) out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+} // namespace
+
+/**
+ * @struct Tracer::BufferLease
+ * @brief 线程局部的缓冲区持有者，线程退出时归还缓冲区
+ */
+struct Tracer::BufferLease {
+    ThreadBuffer* buffer = nullptr;
+
+    ~BufferLease() {
+        if (buffer) Tracer::getInstance().releaseBuffer(buffer);
+    }
+};
+
+std::atomic<bool> Tracer::active{false};
+
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::ThreadBuffer* Tracer::threadBuffer() {
+    thread_local BufferLease lease;
+    if (lease.buffer) return lease.buffer;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    ThreadBuffer* buffer;
+    if (!freeBuffers.empty()) {
+        buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+    } else {
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer->events.resize(EVENTS_PER_THREAD);
+    }
+    buffer->threadId = nextThreadId++;
+    buffer->owned = true;
+    lease.buffer = buffer;
+    return buffer;
+}
+
+void Tracer::releaseBuffer(ThreadBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->owned = false;
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    freeBuffers.clear();
+    for (auto& buffer : buffers) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        if (buffer->owned) {
+            // 仍被存活线程持有：保留归属，只换一个新编号
+            buffer->threadId = nextThreadId++;
+        } else {
+            buffer->threadName.clear();
+            freeBuffers.push_back(buffer.get());
+        }
+    }
+}
+
+void Tracer::record(const char* name, int64_t startNs, int64_t endNs) {
+    ThreadBuffer* buffer = threadBuffer();
+    size_t index = buffer->count.load(std::memory_order_relaxed);
+    if (index >= buffer->events.size()) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[index] = TraceEvent{name, startNs, endNs - startNs};
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    if (!isActive()) return;
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->threadName = name;
+}
+
+bool Tracer::writeChromeTrace(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // 以最早的区间为零点，时间线从0开始
+    int64_t origin = std::numeric_limits<int64_t>::max();
+    for (const auto& buffer : buffers) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            origin = std::min(origin, buffer->events[i].startNs);
+        }
+    }
+
+    std::string out;
+    out.reserve(1 << 20);
+    out.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first) out.append(",\n");
+        first = false;
+    };
+
+    for (const auto& buffer : buffers) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0) continue;
+
+        separator();
+        out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        appendInt(out, buffer->threadId);
+        out.append(",\"args\":{\"name\":");
+        appendJsonString(out, buffer->threadName.empty()
+            ? "thread " + std::to_string(buffer->threadId) : buffer->threadName);
+        out.append("}}");
+
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            separator();
+            out.append("{\"name\":\"");
+            out.append(event.name);
+            out.append("\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+            appendInt(out, buffer->threadId);
+            out.append(",\"ts\":");
+            appendMicros(out, event.startNs - origin);
+            out.append(",\"dur\":");
+            appendMicros(out, event.durationNs);
+            out.push_back('}');
+
+            if (out.size() >= (1 << 20)) {
+                file.write(out.data(), static_cast<std::streamsize>(out.size()));
+                out.clear();
+            }
+        }
+    }
+    out.append("\n]}\n");
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+uint64_t Tracer::getEventCount() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t total = 0;
+    for (const auto& buffer : buffers) {
+        total += buffer->count.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+uint64_t Tracer::getDroppedCount() const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t total = 0;
+    for (const auto& buffer : buffers) {
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
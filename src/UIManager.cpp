@@ -4,6 +4,7 @@
  */
 #include "../include/UIManager.h"
 #include "../include/AppConfig.h"
+#include "../include/RunComparator.h"
 #include <windowsx.h>
 #include <sstream>
 #include <iomanip>
@@ -70,7 +71,10 @@ UIManager::~UIManager() {
         updateTimerActive = false;
     }
 
-    // 停止正在运行的测试
+    // 等待后台停止完成，再停止仍在运行的测试
+    if (stopThread.joinable()) {
+        stopThread.join();
+    }
     if (tester.isTestRunning()) {
         tester.stop();
     }
@@ -101,16 +105,11 @@ bool UIManager::initialize() {
         return false;
     }
 
-    // 设置状态回调
-    tester.setStatusCallback([this](int completed, int total, double successRate) {
-        // 这个回调会在工作线程中调用，所以需要使用PostMessage来更新UI
-        PostMessage(hwndMain, WM_USER, 0, 0);
-    });
-
-    // 设置请求结果回调
-    tester.setRequestCallback([this](const RequestResult& result) {
-        // 发送请求结果到UI线程
-        PostMessage(hwndMain, WM_USER + 1, reinterpret_cast<WPARAM>(new RequestResult(result)), 0);
+    // 设置合并状态通知回调
+    tester.setStatusNotifyInterval(NOTIFY_INTERVAL);
+    tester.setStatusUpdateCallback([this](const StatusUpdate& update) {
+        // 这个回调会在聚合线程中调用，每个间隔最多一次，使用PostMessage转交UI线程
+        PostMessage(hwndMain, WM_USER + 1, reinterpret_cast<WPARAM>(new StatusUpdate(update)), 0);
     });
 
     // 加载配置
@@ -143,6 +142,10 @@ void UIManager::updateStatus(int completed, int total, double successRate) {
     // 更新状态标签
     std::wstringstream wss;
     wss << L"运行中... " << completed << L"/" << total << L" 请求已完成";
+    StatsSnapshot stats = tester.getStatsSnapshot();
+    if (stats.bytesReceived > 0) {
+        wss << L", 接收 " << std::fixed << std::setprecision(2) << stats.receiveMegabytesPerSecond << L" MB/s";
+    }
     SetWindowTextW(hwndStatusLabel, wss.str().c_str());
 
     // 更新成功率标签
@@ -150,11 +153,11 @@ void UIManager::updateStatus(int completed, int total, double successRate) {
     wss << L"成功率: " << std::fixed << std::setprecision(2) << successRate << L"%";
     SetWindowTextW(hwndSuccessRateLabel, wss.str().c_str());
 
-    // 更新响应时间标签
+    // 更新响应时间标签（同一快照中的数据保证一致）
     wss.str(L"");
-    wss << L"响应时间: 最小=" << std::fixed << std::setprecision(2) << tester.getMinResponseTime()
-        << L"ms, 平均=" << tester.getAvgResponseTime()
-        << L"ms, 最大=" << tester.getMaxResponseTime() << L"ms";
+    wss << L"响应时间: 最小=" << std::fixed << std::setprecision(2) << stats.minResponseTime
+        << L"ms, 平均=" << stats.avgResponseTime
+        << L"ms, 最大=" << stats.maxResponseTime << L"ms";
     SetWindowTextW(hwndResponseTimeLabel, wss.str().c_str());
 
     // 重绘图表区域
@@ -414,14 +417,16 @@ void UIManager::initializeListView() {
     ListView_InsertColumn(hwndRequestListView, COL_URL, &lvc);
 }
 
-void UIManager::updateListView(const RequestResult& result) {
-    // 将结果添加到最近请求列表
+void UIManager::updateListView(const std::vector<RequestResult>& results) {
+    // 将结果添加到最近请求列表（批次中最新的在前，按从旧到新的顺序插入）
     {
         std::lock_guard<std::mutex> lock(requestsMutex);
-        recentRequests.push_front(result);
+        for (auto it = results.rbegin(); it != results.rend(); ++it) {
+            recentRequests.push_front(*it);
+        }
 
         // 限制列表大小
-        if (recentRequests.size() > MAX_VISIBLE_REQUESTS) {
+        while (recentRequests.size() > MAX_VISIBLE_REQUESTS) {
             recentRequests.pop_back();
         }
     }
@@ -505,11 +510,11 @@ void UIManager::updateListView() {
 
         // 响应时间列
         wchar_t timeStr[32];
-        swprintf_s(timeStr, L"%.2f", req.responseTime);
+        swprintf_s(timeStr, L"%.2f", req.responseTimeMs());
         ListView_SetItemText(hwndRequestListView, itemIndex, COL_TIME, timeStr);
 
         // URL列 - 使用安全转换
-        std::wstring wUrl = stringToWstring(req.url);
+        std::wstring wUrl = stringToWstring(req.url());
         ListView_SetItemText(hwndRequestListView, itemIndex, COL_URL, const_cast<LPWSTR>(wUrl.c_str()));
     }
 }
@@ -678,37 +683,26 @@ LRESULT CALLBACK UIManager::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPAR
     if (instance) {
         if (uMsg == WM_COMMAND) {
             return instance->handleCommand(wParam, lParam);
-        } else if (uMsg == WM_USER) {
-            // 更新UI状态的消息
-            if (instance->tester.isTestRunning()) {
-                instance->updateStatus(
-                    instance->tester.getCompletedRequests(),
-                    instance->tester.getTotalRequests(),
-                    instance->tester.getSuccessRate()
-                );
-            }
-            return 0;
         } else if (uMsg == WM_USER + 1) {
-            // 请求结果消息
-            RequestResult* result = reinterpret_cast<RequestResult*>(wParam);
-            if (result) {
-                instance->handleRequestResult(*result);
-                delete result;  // 删除创建的请求结果对象
+            // 合并状态通知消息
+            StatusUpdate* update = reinterpret_cast<StatusUpdate*>(wParam);
+            if (update) {
+                instance->handleStatusUpdate(*update);
+                delete update;  // 删除创建的状态通知对象
             }
             return 0;
+        } else if (uMsg == WM_USER + 2) {
+            // 停止线程已完成stop()
+            instance->handleTestStopped();
+            return 0;
         } else if (uMsg == WM_TIMER && wParam == UPDATE_TIMER_ID) {
+            // 测试结束由停止线程投递的消息处理，定时器只刷新运行中的状态
             if (instance->tester.isTestRunning()) {
                 instance->updateStatus(
                     instance->tester.getCompletedRequests(),
                     instance->tester.getTotalRequests(),
                     instance->tester.getSuccessRate()
                 );
-            } else {
-                // 测试完成
-                KillTimer(hwnd, UPDATE_TIMER_ID);
-                instance->updateTimerActive = false;
-                instance->updateControlsState(false);
-                instance->showTestResults();
             }
             return 0;
         } else if (uMsg == WM_DRAWITEM) {
@@ -750,17 +744,15 @@ LRESULT CALLBACK UIManager::LogDialogProc(HWND hwnd, UINT uMsg, WPARAM wParam, L
     return FALSE;
 }
 
-void UIManager::handleRequestResult(const RequestResult& result) {
+void UIManager::handleStatusUpdate(const StatusUpdate& update) {
     // 更新请求列表视图
-    updateListView(result);
-
-    // 如果这是第一个请求，立即更新状态
-    if (result.id == 1) {
-        updateStatus(
-            tester.getCompletedRequests(),
-            tester.getTotalRequests(),
-            tester.getSuccessRate()
-        );
+    if (!update.recentResults.empty()) {
+        updateListView(update.recentResults);
+    }
+
+    // 测试仍在运行时同步刷新状态
+    if (tester.isTestRunning()) {
+        updateStatus(update.completedRequests, update.totalRequests, update.successRate);
     }
 }
 
@@ -883,6 +875,163 @@ void UIManager::handleStartTest() {
     // 添加URL到下拉框
     addUrlToComboBox(url);
 
+    // 结构化导出（在配置文件中设置路径后启用）
+    ExportOptions exportOptions;
+    exportOptions.csvPath = config.getString("ExportCsvFile");
+    exportOptions.jsonlPath = config.getString("ExportJsonlFile");
+    exportOptions.intervalPath = config.getString("ExportIntervalFile");
+    exportOptions.hdrLogPath = config.getString("ExportHdrLogFile");
+    exportOptions.intervalMs = config.getInt("ExportIntervalMs", 1000);
+    exportOptions.queueCapacity = config.getInt("ExportQueueCapacity", 16384);
+    tester.setExportOptions(exportOptions);
+
+    // 线程CPU放置（在配置文件中设置核心列表后启用）
+    AffinityOptions affinityOptions;
+    std::string badCoreToken;
+    affinityOptions.workerCores = parseCoreList(config.getString("WorkerCores"), &badCoreToken);
+    if (!badCoreToken.empty()) {
+        std::wstring message = L"WorkerCores中的片段\"" + stringToWstring(badCoreToken) +
+                               L"\"无效或超出本机核心数，已忽略。";
+        MessageBoxW(hwndMain, message.c_str(), L"警告", MB_ICONWARNING);
+    }
+    affinityOptions.aggregatorCore = config.getInt("AggregatorCore", -1);
+    affinityOptions.exporterCore = config.getInt("ExporterCore", -1);
+    tester.setAffinityOptions(affinityOptions);
+
+    // 虚拟用户模式（在配置文件中设置用户数后启用，线程数即事件循环数）
+    VirtualUserOptions virtualUserOptions;
+    virtualUserOptions.virtualUsers = config.getInt("VirtualUsers", 0);
+    virtualUserOptions.thinkTime.distribution =
+        ThinkTime::parseDistribution(config.getString("ThinkTimeDistribution", "fixed"));
+    virtualUserOptions.thinkTime.ms = config.getInt("ThinkTimeMs", 0);
+    virtualUserOptions.thinkTime.maxMs = config.getInt("ThinkTimeMaxMs", 0);
+    virtualUserOptions.pacingMs = config.getInt("PacingMs", 0);
+    virtualUserOptions.rampUpMs = config.getInt("RampUpMs", 0);
+    virtualUserOptions.durationMs = config.getInt("DurationMs", 0);
+    tester.setVirtualUserOptions(virtualUserOptions);
+    tester.setRequestTimeout(config.getInt("RequestTimeoutMs", 10000));
+
+    // 多步骤场景（在配置文件中设置场景文件后启用）
+    Scenario scenario;
+    std::string scenarioFile = config.getString("ScenarioFile");
+    if (!scenarioFile.empty() && !scenario.loadFromFile(scenarioFile)) {
+        MessageBoxW(hwndMain, L"无法加载场景文件，将只请求测试URL。", L"警告", MB_ICONWARNING);
+    }
+    tester.setScenario(scenario);
+
+    // 全局与按端点限流（如"/search=2000,/checkout=500"）
+    RateLimitOptions rateLimitOptions;
+    rateLimitOptions.globalRequestsPerSecond = config.getInt("GlobalRateLimit", 0);
+    rateLimitOptions.endpointLimits = RateLimitOptions::parseEndpointLimits(config.getString("EndpointRateLimits"));
+    rateLimitOptions.burstMs = config.getInt("RateLimitBurstMs", 10);
+    tester.setRateLimitOptions(rateLimitOptions);
+
+    // 自动调优（如"p99 < 200ms and errors < 0.1%"）
+    AutoTuneOptions autoTuneOptions;
+    std::string slo = config.getString("AutoTuneSlo");
+    if (!slo.empty()) {
+        autoTuneOptions.enabled = SloTarget::parse(slo, autoTuneOptions.slo);
+        if (!autoTuneOptions.enabled) {
+            MessageBoxW(hwndMain, L"无法解析AutoTuneSlo，将不进行自动调优。", L"警告", MB_ICONWARNING);
+        }
+    }
+    autoTuneOptions.initialRps = config.getInt("AutoTuneInitialRps", 100);
+    autoTuneOptions.maxRps = config.getInt("AutoTuneMaxRps", 100000);
+    autoTuneOptions.probeMs = config.getInt("AutoTuneProbeMs", 5000);
+    autoTuneOptions.settleMs = config.getInt("AutoTuneSettleMs", 1000);
+    autoTuneOptions.maxSteps = config.getInt("AutoTuneMaxSteps", 20);
+    tester.setAutoTuneOptions(autoTuneOptions);
+
+    // 负载发生器自身饱和的判定阈值
+    HealthThresholds healthThresholds;
+    healthThresholds.maxDispatchLagMs = config.getInt("HealthMaxDispatchLagMs", 10);
+    healthThresholds.maxThreadCpuPercent = config.getInt("HealthMaxThreadCpuPercent", 90);
+    healthThresholds.maxRunQueuePercent = config.getInt("HealthMaxRunQueuePercent", 10);
+    healthThresholds.maxInvoluntarySwitchesPerSec = config.getInt("HealthMaxInvoluntarySwitchesPerSec", 1000);
+    tester.setHealthThresholds(healthThresholds);
+
+    // 热路径追踪（需以LOADTESTER_TRACING编译）
+    tester.setTraceFile(config.getString("TraceFile"));
+
+    // 原始TCP模式（URL为tcp://主机:端口）：分帧、请求模板与流水线深度
+    TcpOptions tcpOptions;
+    std::string framing = config.getString("TcpFraming", "line");
+    if (!TcpOptions::parseFraming(framing, tcpOptions.framing)) {
+        MessageBoxW(hwndMain, L"无法解析TcpFraming，将按行分帧。", L"警告", MB_ICONWARNING);
+    }
+    tcpOptions.delimiter = TcpOptions::unescape(config.getString("TcpDelimiter", "\\n"));
+    tcpOptions.lengthBytes = config.getInt("TcpLengthBytes", 4);
+    tcpOptions.payload = TcpOptions::unescape(config.getString("TcpPayload", "PING {seq}"));
+    tcpOptions.pipelineDepth = config.getInt("TcpPipelineDepth", 1);
+    tester.setTcpOptions(tcpOptions);
+
+    // 响应压缩协商：Accept-Encoding的值，如"gzip, deflate, br"；留空不协商
+    CompressionOptions compressionOptions;
+    compressionOptions.acceptEncoding = config.getString("AcceptEncoding", "");
+    tester.setCompressionOptions(compressionOptions);
+
+    // 下载吞吐量模式：同步请求之间不插入间隔，加大接收缓冲区并统计首/末字节时间与下载速率
+    ThroughputOptions throughputOptions;
+    throughputOptions.enabled = config.getInt("ThroughputMode", 0) != 0;
+    throughputOptions.receiveBufferKB = config.getInt("ThroughputReceiveBufferKB", 512);
+    tester.setThroughputOptions(throughputOptions);
+
+    // URL列表：每个请求从文件中取一个URL；选择方式为sequential/random/zipf/shuffled，Zipf指数按百分比给出
+    UrlListOptions urlListOptions;
+    urlListOptions.path = config.getString("UrlListFile", "");
+    if (!UrlListOptions::parseSelection(config.getString("UrlListSelection", "sequential"), urlListOptions.selection)) {
+        MessageBoxW(hwndMain, L"无法解析UrlListSelection，将按顺序选择。", L"警告", MB_ICONWARNING);
+    }
+    urlListOptions.zipfSkew = config.getInt("UrlListZipfSkewPercent", 100) / 100.0;
+    urlListOptions.seed = static_cast<uint64_t>(static_cast<uint32_t>(config.getInt("UrlListSeed", 0)));
+    tester.setUrlListOptions(urlListOptions);
+
+    // 访问日志回放：combined/common格式日志，倍率以百分比表示（100为原始间隔，1000为十倍速，0为尽快）
+    ReplayOptions replayOptions;
+    replayOptions.path = config.getString("ReplayLogFile", "");
+    replayOptions.speed = config.getInt("ReplaySpeedPercent", 100) / 100.0;
+    replayOptions.maxInFlight = config.getInt("ReplayMaxInFlight", 256);
+    replayOptions.sendUserAgent = config.getInt("ReplayUserAgent", 1) != 0;
+    tester.setReplayOptions(replayOptions);
+
+    // WebSocket模式（URL为ws://）：连接数（0为每线程一个）、每连接发送间隔、消息模板与回复匹配方式
+    WebSocketOptions webSocketOptions;
+    webSocketOptions.connections = config.getInt("WebSocketConnections", 0);
+    webSocketOptions.messageIntervalMs = config.getInt("WebSocketMessageIntervalMs", 1000);
+    webSocketOptions.payload = TcpOptions::unescape(config.getString("WebSocketPayload", "ping {id}"));
+    webSocketOptions.correlate = config.getInt("WebSocketCorrelate", 0) != 0;
+    webSocketOptions.rampUpMs = config.getInt("WebSocketRampUpMs", 0);
+    tester.setWebSocketOptions(webSocketOptions);
+
+    // SSE/长轮询流式模式：流数（0为每线程一个）、保持时长（0为直到服务端关闭）、重连间隔与时间戳字段
+    StreamingOptions streamingOptions;
+    streamingOptions.enabled = config.getInt("StreamMode", 0) != 0;
+    streamingOptions.streams = config.getInt("StreamCount", 0);
+    streamingOptions.streamDurationMs = config.getInt("StreamDurationMs", 0);
+    streamingOptions.reconnectDelayMs = config.getInt("StreamReconnectDelayMs", 0);
+    streamingOptions.rampUpMs = config.getInt("StreamRampUpMs", 0);
+    streamingOptions.timestampField = config.getString("StreamTimestampField", "");
+    tester.setStreamingOptions(streamingOptions);
+
+    // 同步请求的连接复用：每连接请求数（0为不限）、连接寿命与重连风暴
+    ConnectionOptions connectionOptions;
+    connectionOptions.requestsPerConnection = config.getInt("RequestsPerConnection", 1);
+    connectionOptions.maxConnectionAgeMs = config.getInt("MaxConnectionAgeMs", 0);
+    connectionOptions.reconnectStormIntervalMs = config.getInt("ReconnectStormIntervalMs", 0);
+    tester.setConnectionOptions(connectionOptions);
+
+    // 预热/冷却测量窗口与稳态检测
+    MeasurementWindowOptions windowOptions;
+    windowOptions.warmUpMs = config.getInt("WarmUpMs", 0);
+    windowOptions.coolDownMs = config.getInt("CoolDownMs", 0);
+    windowOptions.autoDetect = config.getInt("AutoSteadyState", 0) != 0;
+    windowOptions.stableSeconds = config.getInt("SteadyStateSeconds", 5);
+    windowOptions.maxVariation = config.getInt("SteadyStateMaxVariationPercent", 10) / 100.0;
+    tester.setMeasurementWindowOptions(windowOptions);
+
+    // 停止时等待进行中请求完成的时限，0表示立即中断
+    tester.setDrainTimeout(config.getInt("StopDrainMs", 0));
+
     // 开始测试
     if (tester.start(url, threads, requests, logFile)) {
         // 更新UI状态
@@ -898,16 +1047,30 @@ void UIManager::handleStartTest() {
 
 
 void UIManager::handleStopTest() {
-    // 创建一个线程来停止测试，以避免UI冻结
-    std::thread([this]() {
+    // 立即禁用停止按钮
+    EnableWindow(hwndStopButton, FALSE);
+
+    if (stopThread.joinable()) return;
+
+    // stop()要排空、回收所有线程、写出追踪与导出文件，大型测试可能耗时数秒，始终在后台线程执行
+    stopThread = std::thread([this]() {
         tester.stop();
 
         // 发送消息通知主线程更新UI
         PostMessage(hwndMain, WM_USER + 2, 0, 0);
-    }).detach();
+    });
+}
 
-    // 立即禁用停止按钮
-    EnableWindow(hwndStopButton, FALSE);
+void UIManager::handleTestStopped() {
+    if (stopThread.joinable()) {
+        stopThread.join();
+    }
+    if (updateTimerActive) {
+        KillTimer(hwndMain, UPDATE_TIMER_ID);
+        updateTimerActive = false;
+    }
+    updateControlsState(false);
+    showTestResults();
 }
 
 void UIManager::handleViewLog() {
@@ -1006,7 +1169,10 @@ void UIManager::showLogDialog() {
 }
 
 void UIManager::handleExit() {
-    // 如果有正在运行的测试，先停止
+    // 如果有正在运行的测试，先停止；已在后台停止时等它完成
+    if (stopThread.joinable()) {
+        stopThread.join();
+    }
     if (tester.isTestRunning()) {
         if (MessageBoxW(hwndMain, L"测试正在运行，确定要退出吗？", L"确认", MB_YESNO | MB_ICONQUESTION) != IDYES) {
             return;
@@ -1024,16 +1190,18 @@ void UIManager::showTestResults() {
     // 更新状态标签
     SetWindowTextW(hwndStatusLabel, L"测试完成");
 
+    StatsSnapshot stats = tester.getStatsSnapshot();
+
     // 更新成功率标签
     std::wstringstream wss;
-    wss << L"成功率: " << std::fixed << std::setprecision(2) << tester.getSuccessRate() << L"%";
+    wss << L"成功率: " << std::fixed << std::setprecision(2) << stats.successRate << L"%";
     SetWindowTextW(hwndSuccessRateLabel, wss.str().c_str());
 
     // 更新响应时间标签
     wss.str(L"");
-    wss << L"响应时间: 最小=" << std::fixed << std::setprecision(2) << tester.getMinResponseTime()
-        << L"ms, 平均=" << tester.getAvgResponseTime()
-        << L"ms, 最大=" << tester.getMaxResponseTime() << L"ms";
+    wss << L"响应时间: 最小=" << std::fixed << std::setprecision(2) << stats.minResponseTime
+        << L"ms, 平均=" << stats.avgResponseTime
+        << L"ms, 最大=" << stats.maxResponseTime << L"ms";
     SetWindowTextW(hwndResponseTimeLabel, wss.str().c_str());
 
     // 进度条设置为100%
@@ -1045,14 +1213,81 @@ void UIManager::showTestResults() {
     // 完成测试后展示总体结果对话框
     std::wstringstream resultMsg;
     resultMsg << L"测试完成!\n\n";
-    resultMsg << L"总请求数: " << tester.getTotalRequests() << L"\n";
-    resultMsg << L"完成请求数: " << tester.getCompletedRequests() << L"\n";
-    resultMsg << L"成功请求数: " << tester.getSuccessfulRequests() << L"\n";
-    resultMsg << L"成功率: " << std::fixed << std::setprecision(2) << tester.getSuccessRate() << L"%\n\n";
+    resultMsg << L"总请求数: " << stats.totalRequests << L"\n";
+    resultMsg << L"完成请求数: " << stats.completedRequests << L"\n";
+    if (tester.getCancelledRequests() > 0) {
+        resultMsg << L"停止时中断的请求数: " << tester.getCancelledRequests() << L"\n";
+    }
+    resultMsg << L"成功请求数: " << stats.successfulRequests << L"\n";
+    ConnectionStats connections = tester.getConnectionStats();
+    if (connections.opened > 0 && stats.elapsedMs > 0) {
+        resultMsg << L"新建连接数: " << connections.opened << L" (" << std::fixed << std::setprecision(1)
+                  << connections.opened * 1000.0 / stats.elapsedMs << L" 次/秒), 重连: " << connections.reconnects
+                  << L", TCP握手P99: " << std::setprecision(3) << connections.tcpHandshake.quantile(0.99) << L" ms\n";
+    }
+    if (stats.bytesSent + stats.bytesReceived > 0) {
+        resultMsg << L"流量: 发送 " << std::fixed << std::setprecision(2) << stats.bytesSent / 1e6 << L" MB, 接收 "
+                  << stats.bytesReceived / 1e6 << L" MB, 平均接收 " << stats.receiveMegabytesPerSecond << L" MB/s\n";
+    }
+    BandwidthStats bandwidth = tester.getBandwidthStats();
+    if (bandwidth.transfers > 0) {
+        resultMsg << L"末字节P50/P99: " << std::fixed << std::setprecision(3) << bandwidth.lastByte.quantile(0.50)
+                  << L" / " << bandwidth.lastByte.quantile(0.99) << L" ms, 单请求速率P50/P1: " << std::setprecision(2)
+                  << bandwidth.throughput.quantile(0.50) << L" / " << bandwidth.throughput.quantile(0.01) << L" MB/s\n";
+    }
+    EncodingStats encoded = tester.getCompressionStats().total();
+    if (encoded.responses > 0) {
+        resultMsg << L"响应体字节: 线路 " << encoded.wireBytes << L", 解码后 " << encoded.decodedBytes << L" (压缩比 "
+                  << std::fixed << std::setprecision(2) << encoded.ratio() << L"), 解码耗时 " << std::setprecision(3)
+                  << encoded.decodeNs / 1e6 << L" ms\n";
+    }
+    WebSocketStats sockets = tester.getWebSocketStats();
+    if (sockets.opened + sockets.failed > 0) {
+        resultMsg << L"WebSocket连接: 打开 " << sockets.opened << L", 失败 " << sockets.failed << L", 断开 "
+                  << sockets.dropped << L", 升级完成P99: " << std::fixed << std::setprecision(3)
+                  << sockets.upgradeLatency.quantile(0.99) << L" ms\n";
+    }
+    StreamStats streams = tester.getStreamStats();
+    if (streams.streams > 0) {
+        resultMsg << L"流式: 流 " << streams.streams << L", 失败 " << streams.failedStreams << L", 事件 "
+                  << streams.events << L", 首事件P99: " << std::fixed << std::setprecision(3)
+                  << streams.firstEvent.quantile(0.99) << L" ms";
+        if (streams.eventLag.getCount() > 0) {
+            resultMsg << L", 端到端延迟P99: " << streams.eventLag.quantile(0.99) << L" ms";
+        }
+        resultMsg << L"\n";
+    }
+    if (stats.measuredRequests != stats.completedRequests) {
+        resultMsg << L"测量窗口: " << std::fixed << std::setprecision(1) << stats.measureStartMs / 1000.0 << L" - "
+                  << stats.measureEndMs / 1000.0 << L" 秒" << (stats.steadyStateDetected ? L"（自动检测稳态）" : L"")
+                  << L", 计入请求数: " << stats.measuredRequests << L"\n";
+        resultMsg << L"以下成功率与响应时间只统计测量窗口\n";
+    }
+    resultMsg << L"成功率: " << std::fixed << std::setprecision(2) << stats.successRate << L"%\n\n";
     resultMsg << L"响应时间统计:\n";
-    resultMsg << L"  最小: " << std::fixed << std::setprecision(2) << tester.getMinResponseTime() << L" ms\n";
-    resultMsg << L"  最大: " << std::fixed << std::setprecision(2) << tester.getMaxResponseTime() << L" ms\n";
-    resultMsg << L"  平均: " << std::fixed << std::setprecision(2) << tester.getAvgResponseTime() << L" ms\n\n";
+    resultMsg << L"  最小: " << std::fixed << std::setprecision(2) << stats.minResponseTime << L" ms\n";
+    resultMsg << L"  最大: " << std::fixed << std::setprecision(2) << stats.maxResponseTime << L" ms\n";
+    resultMsg << L"  平均: " << std::fixed << std::setprecision(2) << stats.avgResponseTime << L" ms\n";
+    resultMsg << L"  P50/P90/P99: " << stats.p50ResponseTime << L" / " << stats.p90ResponseTime
+              << L" / " << stats.p99ResponseTime << L" ms\n\n";
+    // 与同一日志文件上次运行的摘要对比，然后保存本次摘要
+    std::string summaryFile = currentLogFile + ".summary";
+    RunSummary current = tester.buildRunSummary();
+    if (current.generatorSaturated) {
+        resultMsg << L"警告: 负载发生器自身饱和，本次结果不可信\n  " << stringToWstring(current.saturationReason)
+                  << L"\n\n";
+    }
+    RunSummary previous;
+    if (previous.loadFromFile(summaryFile) && previous.url == current.url) {
+        RunComparison comparison = compareRuns(previous, current);
+        resultMsg << stringToWstring(formatComparisonReport(comparison));
+        if (previous.generatorSaturated) {
+            resultMsg << L"  注意: 上次运行的负载发生器饱和，对比结论仅供参考\n";
+        }
+        resultMsg << L"\n";
+    }
+    current.saveToFile(summaryFile);
+
     // 修复引号问题
     resultMsg << L"您可以通过点击\"查看日志\"按钮查看详细日志。";
 
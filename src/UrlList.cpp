@@ -0,0 +1,287 @@
+/**
+ * @file UrlList.cpp
+ * @brief 内存映射的URL列表与URL选择的实现
+ */
+#include "../include/UrlList.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+constexpr size_t MIN_SCAN_CHUNK = 16u << 20;    ///< 每个扫描线程至少负责的字节数
+constexpr unsigned MAX_SCAN_THREADS = 16;       ///< 扫描线程上限
+
+/**
+ * @brief SplitMix64，用于由种子派生密钥和Feistel轮函数
+ */
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @class LineCollector
+ * @brief 收集一个扫描段内的行：去掉首尾空白，跳过空行、注释行和超长行
+ */
+class LineCollector {
+public:
+    LineCollector(const char* fileData, std::vector<uint64_t>& output)
+        : data(fileData), entries(output) {}
+
+    void add(size_t begin, size_t end) {
+        while (begin < end && isBlank(data[begin])) begin++;
+        while (end > begin && (isBlank(data[end - 1]) || data[end - 1] == '\r')) end--;
+        if (begin == end || data[begin] == '#') return;
+        if (end - begin > UrlList::MAX_LINE_LENGTH) {
+            skipped++;
+            return;
+        }
+        entries.push_back((static_cast<uint64_t>(begin) << 24) | (end - begin));
+    }
+
+    size_t getSkipped() const { return skipped; }
+
+private:
+    static bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+    const char* data;
+    std::vector<uint64_t>& entries;
+    size_t skipped = 0;
+};
+
+/**
+ * @brief 扫描[begin, end)内的换行符，把每一行交给collector；end处未以换行结尾的部分也算一行
+ */
+void scanLines(const char* data, size_t begin, size_t end, LineCollector& collector) {
+    size_t lineStart = begin;
+    size_t pos = begin;
+    while (pos + 16 <= end) {
+        uint32_t mask = matchBytes16(data + pos, '\n');
+        while (mask != 0) {
+            size_t newlineAt = pos + lowestSetBit(mask);
+            collector.add(lineStart, newlineAt);
+            lineStart = newlineAt + 1;
+            mask &= mask - 1;
+        }
+        pos += 16;
+    }
+    while (pos < end) {
+        size_t newlineAt = static_cast<size_t>(findByte(data + pos, data + end, '\n') - data);
+        if (newlineAt == end) break;
+        collector.add(lineStart, newlineAt);
+        lineStart = pos = newlineAt + 1;
+    }
+    if (lineStart < end) collector.add(lineStart, end);
+}
+
+}  // namespace
+
+bool UrlListOptions::parseSelection(const std::string& text, UrlSelection& selection) {
+    std::string name;
+    for (char c : text) name.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    if (name == "sequential") {
+        selection = UrlSelection::SEQUENTIAL;
+    } else if (name == "random") {
+        selection = UrlSelection::RANDOM;
+    } else if (name == "zipf") {
+        selection = UrlSelection::ZIPF;
+    } else if (name == "shuffled") {
+        selection = UrlSelection::SHUFFLED;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* UrlListOptions::selectionName(UrlSelection selection) {
+    switch (selection) {
+        case UrlSelection::SEQUENTIAL: return "顺序";
+        case UrlSelection::RANDOM: return "均匀随机";
+        case UrlSelection::ZIPF: return "Zipf";
+        case UrlSelection::SHUFFLED: return "打乱无放回";
+    }
+    return "";
+}
+
+void UrlList::close() {
+    file.close();
+    entries.clear();
+    entries.shrink_to_fit();
+    skippedLines = 0;
+}
+
+bool UrlList::open(const std::string& filePath, std::string& error) {
+    close();
+    if (!file.open(filePath, MappedAccess::WHOLE, error)) return false;
+    if (file.size() > MAX_FILE_BYTES) {
+        error = "URL列表超过1TB: " + filePath;
+        close();
+        return false;
+    }
+    const char* data = file.data();
+    size_t length = file.size();
+
+    // 按字节数分段，段边界推到下一个换行之后，各段的行互不重叠
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunks = std::min<size_t>({hardware, MAX_SCAN_THREADS, std::max<size_t>(1, length / MIN_SCAN_CHUNK)});
+    std::vector<size_t> bounds(chunks + 1, length);
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunks; ++i) {
+        size_t at = std::max(bounds[i - 1], length / chunks * i);
+        const char* found = findByte(data + at, data + length, '\n');
+        bounds[i] = found < data + length ? static_cast<size_t>(found - data) + 1 : length;
+    }
+
+    std::vector<std::vector<uint64_t>> parts(chunks);
+    std::vector<size_t> skipped(chunks, 0);
+    auto scanChunk = [data, &bounds, &parts, &skipped](size_t i) {
+        // 按平均URL长度预留，减少扩容拷贝
+        parts[i].reserve((bounds[i + 1] - bounds[i]) / 64);
+        LineCollector collector(data, parts[i]);
+        scanLines(data, bounds[i], bounds[i + 1], collector);
+        skipped[i] = collector.getSkipped();
+    };
+    std::vector<std::thread> scanners;
+    for (size_t i = 1; i < chunks; ++i) scanners.emplace_back(scanChunk, i);
+    scanChunk(0);
+    for (auto& scanner : scanners) scanner.join();
+
+    size_t total = 0;
+    for (size_t i = 0; i < chunks; ++i) {
+        total += parts[i].size();
+        skippedLines += skipped[i];
+    }
+    if (total == 0 || total > MAX_LINES) {
+        error = total == 0 ? "URL列表中没有URL: " + filePath : "URL列表超过" + std::to_string(MAX_LINES) + "行: " + filePath;
+        close();
+        return false;
+    }
+    if (chunks == 1) {
+        entries = std::move(parts[0]);
+    } else {
+        entries.reserve(total);
+        for (auto& part : parts) {
+            entries.insert(entries.end(), part.begin(), part.end());
+            std::vector<uint64_t>().swap(part);
+        }
+    }
+    return true;
+}
+
+UrlPicker::UrlPicker(const UrlList& urlList, const UrlListOptions& options, std::atomic<uint64_t>& sharedCursor,
+                     int workerIndex)
+    : list(urlList),
+      selection(options.selection),
+      cursor(sharedCursor),
+      seed(options.seed),
+      rng(options.seed != 0 ? mix64(options.seed ^ mix64(static_cast<uint64_t>(workerIndex)))
+                            : std::random_device{}() ^ static_cast<uint64_t>(workerIndex)),
+      skew(options.zipfSkew) {
+    double n = static_cast<double>(list.size());
+    if (selection == UrlSelection::ZIPF) {
+        if (skew <= 0) {
+            selection = UrlSelection::RANDOM;
+        } else {
+            hIntegralX1 = zipfHIntegral(1.5) - 1.0;
+            hIntegralN = zipfHIntegral(n + 0.5);
+            acceptThreshold = 2.0 - zipfHIntegralInverse(zipfHIntegral(2.5) - zipfH(2.0));
+        }
+    }
+
+    // Feistel置换的定义域取不小于行数的偶数位宽，超出行数的结果循环置换直到落回范围内
+    unsigned bits = 1;
+    while (bits < 62 && (uint64_t(1) << bits) < list.size()) bits++;
+    halfBits = (bits + 1) / 2;
+}
+
+size_t UrlPicker::next() {
+    switch (selection) {
+        case UrlSelection::SEQUENTIAL:
+            return static_cast<size_t>(cursor.fetch_add(1, std::memory_order_relaxed) % list.size());
+        case UrlSelection::RANDOM:
+            return uniform();
+        case UrlSelection::ZIPF:
+            return zipfRank() - 1;
+        case UrlSelection::SHUFFLED: {
+            uint64_t position = cursor.fetch_add(1, std::memory_order_relaxed);
+            return shuffled(position % list.size(), position / list.size());
+        }
+    }
+    return 0;
+}
+
+size_t UrlPicker::uniform() {
+    // 行数小于2^31，高32位乘行数再右移32位即为均匀分布，偏差不超过行数/2^32
+    return static_cast<size_t>(((rng() >> 32) * list.size()) >> 32);
+}
+
+size_t UrlPicker::zipfRank() {
+    size_t n = list.size();
+    while (true) {
+        double u = hIntegralN + static_cast<double>(rng() >> 11) * 0x1.0p-53 * (hIntegralX1 - hIntegralN);
+        double x = zipfHIntegralInverse(u);
+        size_t k = static_cast<size_t>(std::clamp(x + 0.5, 1.0, static_cast<double>(n)));
+        if (k - x <= acceptThreshold || u >= zipfHIntegral(k + 0.5) - zipfH(static_cast<double>(k))) {
+            return k;
+        }
+    }
+}
+
+size_t UrlPicker::shuffled(uint64_t position, uint64_t pass) const {
+    if (list.size() == 1) return 0;
+    uint64_t mask = (uint64_t(1) << halfBits) - 1;
+    uint64_t keys[4];
+    for (int round = 0; round < 4; ++round) keys[round] = mix64(seed + pass * 4 + round);
+
+    // 4轮Feistel网络在2^(2*halfBits)上是双射，循环置换保证结果落在[0, size)内且仍是双射
+    uint64_t x = position;
+    do {
+        uint64_t left = x >> halfBits;
+        uint64_t right = x & mask;
+        for (uint64_t key : keys) {
+            uint64_t next = left ^ (mix64(right ^ key) & mask);
+            left = right;
+            right = next;
+        }
+        x = (left << halfBits) | right;
+    } while (x >= list.size());
+    return static_cast<size_t>(x);
+}
+
+namespace {
+
+/**
+ * @brief log1p(x)/x，x接近0时用泰勒展开
+ */
+double helper1(double x) {
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+/**
+ * @brief expm1(x)/x，x接近0时用泰勒展开
+ */
+double helper2(double x) {
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+}
+
+}  // namespace
+
+double UrlPicker::zipfH(double x) const {
+    return std::exp(-skew * std::log(x));
+}
+
+double UrlPicker::zipfHIntegral(double x) const {
+    double logX = std::log(x);
+    return helper2((1.0 - skew) * logX) * logX;
+}
+
+double UrlPicker::zipfHIntegralInverse(double x) const {
+    double t = x * (1.0 - skew);
+    if (t < -1.0) t = -1.0;
+    return std::exp(helper1(t) * x);
+}
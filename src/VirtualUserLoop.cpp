@@ -0,0 +1,308 @@
+/**
+ * @file VirtualUserLoop.cpp
+ * @brief 基于curl multi事件循环的虚拟用户运行时的实现
+ */
+#include "../include/VirtualUserLoop.h"
+#include "../include/Tracer.h"
+#include <algorithm>
+
+namespace {
+
+const int64_t MAX_THINK_TIME_MS = 3600000; // 指数分布的长尾截断为1小时
+
+} // namespace
+
+int64_t ThinkTime::sample(std::mt19937_64& rng) const {
+    switch (distribution) {
+        case Distribution::UNIFORM: {
+            if (maxMs <= ms) return std::max(0, ms);
+            std::uniform_int_distribution<int64_t> uniform(std::max(0, ms), maxMs);
+            return uniform(rng);
+        }
+        case Distribution::EXPONENTIAL: {
+            if (ms <= 0) return 0;
+            std::exponential_distribution<double> exponential(1.0 / ms);
+            return std::min<int64_t>(static_cast<int64_t>(exponential(rng)), MAX_THINK_TIME_MS);
+        }
+        case Distribution::FIXED:
+            break;
+    }
+    return std::max(0, ms);
+}
+
+ThinkTime::Distribution ThinkTime::parseDistribution(const std::string& name) {
+    if (name == "uniform") return Distribution::UNIFORM;
+    if (name == "exponential" || name == "exp") return Distribution::EXPONENTIAL;
+    return Distribution::FIXED;
+}
+
+VirtualUserLoop::VirtualUserLoop(int firstUser, int userCount, int totalUsers,
+                                 const VirtualUserOptions& userOptions, int requestTimeoutMs)
+    : multi(curl_multi_init()),
+      firstUserId(firstUser),
+      scenario(nullptr),
+      rateLimiter(nullptr),
+      encodingHeader(nullptr),
+      cancelledCount(0),
+      urlEndpoint(0),
+      urlPicker(nullptr),
+      options(userOptions),
+      requestTimeout(std::max(1, requestTimeoutMs)),
+      rng(std::random_device{}() ^ static_cast<uint64_t>(firstUser)),
+      inFlight(0),
+      accepting(true) {
+    users.resize(std::max(0, userCount));
+
+    // 按全局编号在爬坡时长内均匀错开启动时间
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < users.size(); ++i) {
+        users[i].easy = curl_easy_init();
+        int64_t offsetMs = totalUsers > 0
+            ? static_cast<int64_t>(options.rampUpMs) * (firstUser + static_cast<int>(i)) / totalUsers : 0;
+        scheduleWake(i, now + std::chrono::milliseconds(offsetMs));
+    }
+    if (options.durationMs > 0) {
+        timers.schedule(now + std::chrono::milliseconds(options.durationMs), makeToken(TimerKind::PHASE, 0, 0));
+    }
+}
+
+VirtualUserLoop::~VirtualUserLoop() {
+    for (auto& user : users) {
+        if (!user.easy) continue;
+        if (user.state == UserState::IN_FLIGHT) {
+            curl_multi_remove_handle(multi, user.easy);
+        }
+        curl_easy_cleanup(user.easy);
+    }
+    if (multi) curl_multi_cleanup(multi);
+    if (encodingHeader) curl_slist_free_all(encodingHeader);
+}
+
+void VirtualUserLoop::setScenario(const Scenario* userScenario) {
+    scenario = (userScenario && userScenario->enabled()) ? userScenario : nullptr;
+    scenarioStats = ScenarioStats();
+    if (!scenario) return;
+
+    scenarioStats.reset(*scenario);
+    stepEndpoints.clear();
+    for (const auto& step : scenario->steps) {
+        stepEndpoints.push_back(EndpointTable::getInstance().intern(step.url));
+    }
+    for (size_t i = 0; i < users.size(); ++i) {
+        users[i].session = std::make_unique<ScenarioSession>(*scenario, firstUserId + static_cast<int>(i));
+    }
+}
+
+uint64_t VirtualUserLoop::makeToken(TimerKind kind, size_t userIndex, uint32_t generation) {
+    // 高32位为版本号，其后4位为用途，低28位为用户序号
+    return (static_cast<uint64_t>(generation) << 32) |
+           (static_cast<uint64_t>(kind) << 28) |
+           (static_cast<uint64_t>(userIndex) & 0x0FFFFFFF);
+}
+
+void VirtualUserLoop::run(const std::string& url, const std::atomic<bool>& running,
+                          const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    if (!multi) return;
+    urlEndpoint = EndpointTable::getInstance().intern(url);
+
+    if (compression.enabled() && !scenario) {
+        encodingHeader = curl_slist_append(nullptr, ("Accept-Encoding: " + compression.acceptEncoding).c_str());
+    }
+
+    for (auto& user : users) {
+        if (!user.easy) {
+            user.state = UserState::FINISHED;
+            continue;
+        }
+        curl_easy_setopt(user.easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(user.easy, CURLOPT_PRIVATE, &user);
+        if (user.session) {
+            // 空文件名只启用内存中的Cookie引擎，每个句柄即一个Cookie罐
+            curl_easy_setopt(user.easy, CURLOPT_COOKIEFILE, "");
+            if (compression.enabled()) {
+                curl_easy_setopt(user.easy, CURLOPT_ACCEPT_ENCODING, compression.acceptEncoding.c_str());
+            }
+        } else if (encodingHeader) {
+            // 关闭curl的自动解码，由用户自己的解码器解码并计数
+            user.decoder = std::make_unique<ContentDecoder>();
+            curl_easy_setopt(user.easy, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(user.easy, CURLOPT_HTTPHEADER, encodingHeader);
+            curl_easy_setopt(user.easy, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+            curl_easy_setopt(user.easy, CURLOPT_HEADERFUNCTION, ContentDecoder::headerCallback);
+            curl_easy_setopt(user.easy, CURLOPT_HEADERDATA, user.decoder.get());
+            curl_easy_setopt(user.easy, CURLOPT_WRITEFUNCTION, ContentDecoder::writeCallback);
+            curl_easy_setopt(user.easy, CURLOPT_WRITEDATA, user.decoder.get());
+        } else {
+            curl_easy_setopt(user.easy, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(user.easy, CURLOPT_WRITEFUNCTION, discardBody);
+        }
+    }
+
+    auto handler = [&](uint64_t token) { onTimer(token, dispatch, complete); };
+    if (cancellation) cancellation->registerMulti(multi);
+
+    while (running && (accepting || inFlight > 0)) {
+        if (isDraining()) accepting = false;
+        auto now = std::chrono::steady_clock::now();
+        if (tick) tick(now);
+        {
+            TRACE_SPAN("timers");
+            timers.advance(now, handler);
+        }
+        if (!accepting && inFlight == 0) break;
+
+        {
+            TRACE_SPAN("curl_multi_perform");
+            int stillRunning = 0;
+            curl_multi_perform(multi, &stillRunning);
+        }
+        collectCompleted(complete, dispatch);
+
+        int waitMs = timers.nextTimeoutMs(std::chrono::steady_clock::now());
+        int timeoutMs = pollTimeoutMs(waitMs);
+        TRACE_SPAN("curl_multi_poll");
+        curl_multi_poll(multi, nullptr, 0, timeoutMs, nullptr);
+    }
+
+    if (cancellation) cancellation->unregisterMulti(multi);
+
+    // 因停止而退出时仍在进行中的请求由析构函数移除，这里只计数
+    for (const auto& user : users) {
+        if (user.state == UserState::IN_FLIGHT) cancelledCount++;
+    }
+}
+
+void VirtualUserLoop::onTimer(uint64_t token, const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    auto kind = static_cast<TimerKind>((token >> 28) & 0xF);
+    size_t userIndex = static_cast<size_t>(token & 0x0FFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(token >> 32);
+
+    if (kind == TimerKind::PHASE) {
+        // 阶段结束：不再发起新请求，进行中的请求继续完成
+        accepting = false;
+        return;
+    }
+
+    VirtualUser& user = users[userIndex];
+    if (user.generation != generation) return;
+
+    if (kind == TimerKind::WAKE && user.state == UserState::WAITING) {
+        startRequest(userIndex, dispatch);
+    } else if (kind == TimerKind::DEADLINE && user.state == UserState::IN_FLIGHT) {
+        curl_multi_remove_handle(multi, user.easy);
+        finishRequest(userIndex, CURLE_OPERATION_TIMEDOUT, complete, dispatch);
+    }
+}
+
+void VirtualUserLoop::startRequest(size_t userIndex, const DispatchHandler& dispatch) {
+    TRACE_SPAN("startRequest");
+    VirtualUser& user = users[userIndex];
+
+    if (accepting && rateLimiter) {
+        auto now = std::chrono::steady_clock::now();
+        uint32_t endpoint = user.session ? stepEndpoints[user.session->currentStep()] : urlEndpoint;
+        int64_t waitNs = rateLimiter->acquire(endpoint, now);
+        if (waitNs > 0) {
+            // 被限流：保持等待状态，到下一个令牌可用时再尝试
+            scheduleWake(userIndex, now + std::chrono::nanoseconds(waitNs));
+            return;
+        }
+    }
+
+    int requestId = 0;
+    if (accepting) {
+        auto lag = std::chrono::steady_clock::now() - user.intendedStart;
+        requestId = dispatch(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(lag).count()));
+    }
+    if (requestId <= 0) {
+        // 请求配额已用完或阶段已结束
+        accepting = false;
+        user.state = UserState::FINISHED;
+        if (user.session) user.session->abandonTransaction();
+        return;
+    }
+
+    if (!user.session || user.session->atTransactionStart()) {
+        user.iterationStart = user.intendedStart;
+    }
+    if (user.session) {
+        if (user.session->atTransactionStart()) {
+            user.session->beginTransaction(user.easy);
+        }
+        user.session->prepareStep(user.easy);
+    } else if (urlPicker) {
+        size_t line = urlPicker->next();
+        urlBuffer.assign(urlPicker->getList().line(line));
+        curl_easy_setopt(user.easy, CURLOPT_URL, urlBuffer.c_str());
+        user.endpoint = EndpointTable::listEndpoint(line);
+    }
+
+    if (user.decoder) user.decoder->reset();
+    user.requestId = requestId;
+    user.requestStart = std::chrono::steady_clock::now();
+    user.state = UserState::IN_FLIGHT;
+    user.generation++;
+    curl_multi_add_handle(multi, user.easy);
+    inFlight++;
+
+    timers.schedule(user.requestStart + requestTimeout, makeToken(TimerKind::DEADLINE, userIndex, user.generation));
+}
+
+void VirtualUserLoop::finishRequest(size_t userIndex, CURLcode result, const CompletionHandler& complete,
+                                    const DispatchHandler& dispatch) {
+    TRACE_SPAN("finishRequest");
+    VirtualUser& user = users[userIndex];
+    auto now = std::chrono::steady_clock::now();
+    int64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - user.requestStart).count();
+
+    uint32_t endpoint = user.session ? stepEndpoints[user.session->currentStep()]
+                                     : (urlPicker ? user.endpoint : urlEndpoint);
+    complete(user.easy, result, user.requestId, endpoint, elapsedNs, user.decoder.get());
+
+    inFlight--;
+    user.state = UserState::WAITING;
+    user.generation++;
+
+    // 事务中的下一步紧接着发起，思考时间只在事务之间
+    if (user.session &&
+        user.session->finishStep(user.easy, result, elapsedNs, scenarioStats) == StepOutcome::NEXT_STEP) {
+        user.intendedStart = now;
+        startRequest(userIndex, dispatch);
+        return;
+    }
+
+    // 固定节奏从本次迭代的计划开始时间计时，不随各步耗时与调度延迟漂移；否则从完成时刻加上思考时间
+    auto wakeAt = options.pacingMs > 0
+        ? std::max(now, user.iterationStart + std::chrono::milliseconds(options.pacingMs))
+        : now + std::chrono::milliseconds(options.thinkTime.sample(rng));
+
+    if (wakeAt <= now) {
+        user.intendedStart = now;
+        startRequest(userIndex, dispatch);
+    } else {
+        scheduleWake(userIndex, wakeAt);
+    }
+}
+
+void VirtualUserLoop::scheduleWake(size_t userIndex, std::chrono::steady_clock::time_point wakeAt) {
+    VirtualUser& user = users[userIndex];
+    user.intendedStart = wakeAt;
+    timers.schedule(wakeAt, makeToken(TimerKind::WAKE, userIndex, user.generation));
+}
+
+void VirtualUserLoop::collectCompleted(const CompletionHandler& complete, const DispatchHandler& dispatch) {
+    int remaining = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &remaining)) {
+        if (message->msg != CURLMSG_DONE) continue;
+
+        CURL* easy = message->easy_handle;
+        CURLcode result = message->data.result;
+        VirtualUser* user = nullptr;
+        curl_easy_getinfo(easy, CURLINFO_PRIVATE, reinterpret_cast<char**>(&user));
+        if (!user) continue;
+
+        // 移除后句柄保留连接缓存，下次添加时复用同一连接
+        curl_multi_remove_handle(multi, easy);
+        finishRequest(static_cast<size_t>(user - users.data()), result, complete, dispatch);
+    }
+}
@@ -0,0 +1,754 @@
+/**
+ * @file WebSocketLoop.cpp
+ * @brief WebSocket连接事件循环的实现
+ */
+#include "../include/WebSocketLoop.h"
+#include "../include/Tracer.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+namespace {
+
+const int MAX_READY_EVENTS = 256;               // 每轮最多取回的就绪连接数，其余留到下一轮（水平触发）
+const size_t READ_BUFFER_BYTES = 64 * 1024;     // 共用接收缓冲区大小
+const size_t MAX_HANDSHAKE_BYTES = 16 * 1024;   // 升级响应头的上限
+const uint64_t MAX_FRAME_BYTES = 16 * 1024 * 1024; // 单帧负载的上限
+
+const uint8_t OPCODE_CONTINUATION = 0x0;
+const uint8_t OPCODE_TEXT = 0x1;
+const uint8_t OPCODE_BINARY = 0x2;
+const uint8_t OPCODE_CLOSE = 0x8;
+const uint8_t OPCODE_PING = 0x9;
+const uint8_t OPCODE_PONG = 0xA;
+
+#ifdef _WIN32
+void closeSocket(curl_socket_t socket) { closesocket(socket); }
+bool setNonBlocking(curl_socket_t socket) {
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+}
+int lastSocketError() { return WSAGetLastError(); }
+bool wouldBlock(int error) { return error == WSAEWOULDBLOCK; }
+bool connectPending(int error) { return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS; }
+const int SEND_FLAGS = 0;
+#else
+void closeSocket(curl_socket_t socket) { close(socket); }
+bool setNonBlocking(curl_socket_t socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+int lastSocketError() { return errno; }
+bool wouldBlock(int error) { return error == EAGAIN || error == EWOULDBLOCK; }
+bool connectPending(int error) { return error == EINPROGRESS; }
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;    // 对端关闭后写入不触发SIGPIPE
+#else
+const int SEND_FLAGS = 0;
+#endif
+#endif
+
+std::string base64(const unsigned char* data, size_t length) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    text.reserve((length + 2) / 3 * 4);
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t chunk = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < length) chunk |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < length) chunk |= data[i + 2];
+        text += alphabet[(chunk >> 18) & 0x3F];
+        text += alphabet[(chunk >> 12) & 0x3F];
+        text += (i + 1 < length) ? alphabet[(chunk >> 6) & 0x3F] : '=';
+        text += (i + 2 < length) ? alphabet[chunk & 0x3F] : '=';
+    }
+    return text;
+}
+
+bool isIdChar(char c) {
+    return (c >= '0' && c <= '9') || c == '.';
+}
+
+// id在文本中作为完整的"连接序号.消息序号"出现，而不是更长数字的一部分
+bool containsId(const char* data, size_t length, const std::string& id) {
+    const char* end = data + length;
+    for (const char* at = std::search(data, end, id.begin(), id.end()); at != end;
+         at = std::search(at + 1, end, id.begin(), id.end())) {
+        bool startsClean = at == data || !isIdChar(at[-1]);
+        bool endsClean = at + id.size() == end || !isIdChar(at[id.size()]);
+        if (startsClean && endsClean) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+void WebSocketStats::merge(const WebSocketStats& other) {
+    opened += other.opened;
+    failed += other.failed;
+    dropped += other.dropped;
+    messagesSent += other.messagesSent;
+    unmatchedReplies += other.unmatchedReplies;
+    connectLatency.merge(other.connectLatency);
+    upgradeLatency.merge(other.upgradeLatency);
+}
+
+bool isWebSocketUrl(const std::string& url) {
+    return url.compare(0, 5, "ws://") == 0 || url.compare(0, 6, "wss://") == 0;
+}
+
+WebSocketLoop::WebSocketLoop(int firstIndex, int connectionCount, int totalConnections,
+                             const WebSocketOptions& webSocketOptions, int requestTimeoutMs)
+    : multi(curl_multi_init()),
+      firstConnection(firstIndex),
+      options(webSocketOptions),
+      timeout(std::max(1, requestTimeoutMs)),
+      interval(std::max(1, webSocketOptions.messageIntervalMs)),
+      addressFamily(AF_INET),
+#ifdef __linux__
+      readiness(epoll_create1(EPOLL_CLOEXEC)),
+#endif
+      rng(std::random_device{}() ^ static_cast<uint64_t>(firstIndex)),
+      cancelledCount(0),
+      inFlight(0),
+      activeConnections(0),
+      accepting(true) {
+    if (options.correlate && options.payload.find("{id}") == std::string::npos) {
+        options.correlate = false;
+    }
+    connections.resize(std::max(0, connectionCount));
+    activeConnections = connections.size();
+
+    // 按全局编号在爬坡时长内均匀错开建连时间
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < connections.size(); ++i) {
+        int64_t offsetMs = totalConnections > 0
+            ? static_cast<int64_t>(options.rampUpMs) * (firstConnection + static_cast<int>(i)) / totalConnections
+            : 0;
+        timers.schedule(now + std::chrono::milliseconds(offsetMs), makeToken(TimerKind::CONNECT, i));
+    }
+}
+
+WebSocketLoop::~WebSocketLoop() {
+    for (auto& connection : connections) {
+        if (connection.socket != CURL_SOCKET_BAD) closeSocket(connection.socket);
+    }
+#ifdef __linux__
+    if (readiness >= 0) close(readiness);
+#endif
+    if (multi) curl_multi_cleanup(multi);
+}
+
+uint64_t WebSocketLoop::makeToken(TimerKind kind, size_t index) {
+    // 高32位为用途，低32位为连接下标
+    return (static_cast<uint64_t>(kind) << 32) | (static_cast<uint64_t>(index) & 0xFFFFFFFF);
+}
+
+bool WebSocketLoop::resolve(const std::string& url) {
+    if (url.compare(0, 5, "ws://") != 0) return false;
+
+    std::string rest = url.substr(5);
+    rest = rest.substr(0, rest.find('#'));
+    size_t slash = rest.find_first_of("/?");
+    std::string authority = rest.substr(0, slash);
+    std::string path = slash == std::string::npos ? "/" : rest.substr(slash);
+    if (path[0] == '?') path = "/" + path;
+
+    std::string host = authority;
+    std::string port = "80";
+    if (!authority.empty() && authority[0] == '[') {
+        size_t close = authority.find(']');
+        if (close == std::string::npos) return false;
+        host = authority.substr(1, close - 1);
+        if (close + 1 < authority.size() && authority[close + 1] == ':') port = authority.substr(close + 2);
+    } else {
+        size_t colon = authority.rfind(':');
+        if (colon != std::string::npos) {
+            host = authority.substr(0, colon);
+            port = authority.substr(colon + 1);
+        }
+    }
+    if (host.empty() || port.empty()) return false;
+
+    // 每个循环只解析一次，所有连接共用同一地址
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) return false;
+    address.assign(reinterpret_cast<const char*>(found->ai_addr),
+                   reinterpret_cast<const char*>(found->ai_addr) + found->ai_addrlen);
+    addressFamily = found->ai_family;
+    freeaddrinfo(found);
+
+    upgradeRequest = "GET " + path + " HTTP/1.1\r\nHost: " + authority +
+                     "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Version: 13\r\n";
+    return true;
+}
+
+void WebSocketLoop::run(const std::string& url, const std::atomic<bool>& running,
+                        const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    if (!multi) return;
+#ifdef __linux__
+    if (readiness < 0) return;
+#endif
+    if (!resolve(url)) {
+        // 地址无效或无法解析：所有连接记为建连失败
+        stats.failed += connections.size();
+        return;
+    }
+    readBuffer.resize(READ_BUFFER_BYTES);
+
+    auto handler = [&](uint64_t token) { onTimer(token, dispatch, complete); };
+    if (cancellation) cancellation->registerMulti(multi);
+
+    while (running && activeConnections > 0 && (accepting || inFlight > 0)) {
+        if (isDraining()) accepting = false;
+        auto now = std::chrono::steady_clock::now();
+        if (tick) tick(now);
+        {
+            TRACE_SPAN("timers");
+            timers.advance(now, handler);
+        }
+        if (activeConnections == 0 || (!accepting && inFlight == 0)) break;
+
+        int waitMs = timers.nextTimeoutMs(std::chrono::steady_clock::now());
+        int timeoutMs = pollTimeoutMs(waitMs);
+        {
+            TRACE_SPAN("curl_multi_poll");
+            waitForSockets(timeoutMs);
+        }
+
+        // 只处理就绪的连接，空闲连接不参与每轮的工作
+        TRACE_SPAN("sockets");
+        for (const ReadySocket& socket : ready) {
+            Connection& connection = connections[socket.index];
+            if (connection.state == ConnectionState::CLOSED) continue;
+            if (connection.state == ConnectionState::CONNECTING) {
+                onConnected(socket.index, complete);
+                continue;
+            }
+            if ((socket.events & CURL_WAIT_POLLOUT) && !flush(connection)) {
+                closeConnection(socket.index, CURLE_SEND_ERROR, complete);
+                continue;
+            }
+            if (socket.events & CURL_WAIT_POLLIN) onReadable(socket.index, complete);
+            if (connection.state != ConnectionState::CLOSED) watch(socket.index);
+        }
+    }
+
+    if (cancellation) cancellation->unregisterMulti(multi);
+
+    // 因停止而退出时仍未得到回复的消息只计数，套接字由析构函数关闭
+    for (const auto& connection : connections) {
+        cancelledCount += static_cast<int>(connection.pending.size());
+    }
+}
+
+void WebSocketLoop::onTimer(uint64_t token, const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    auto kind = static_cast<TimerKind>(token >> 32);
+    size_t index = static_cast<size_t>(token & 0xFFFFFFFF);
+
+    switch (kind) {
+        case TimerKind::CONNECT:
+            if (connections[index].state == ConnectionState::WAITING) startConnect(index, complete);
+            break;
+        case TimerKind::SEND:
+            if (connections[index].state == ConnectionState::OPEN) sendMessage(index, dispatch, complete);
+            break;
+        case TimerKind::HANDSHAKE:
+            // 连接不重连，建连开始时刻不会改变，只需看状态
+            if (connections[index].state == ConnectionState::CONNECTING ||
+                connections[index].state == ConnectionState::UPGRADING) {
+                closeConnection(index, CURLE_OPERATION_TIMEDOUT, complete);
+            }
+            break;
+        case TimerKind::REPLY:
+            connections[index].replyTimerArmed = false;
+            if (connections[index].state == ConnectionState::OPEN) {
+                expireReplies(index, std::chrono::steady_clock::now(), complete);
+                armReplyTimer(index);
+            }
+            break;
+    }
+}
+
+void WebSocketLoop::startConnect(size_t index, const CompletionHandler& complete) {
+    Connection& connection = connections[index];
+    connection.connectStart = std::chrono::steady_clock::now();
+    connection.state = ConnectionState::CONNECTING;
+    timers.schedule(connection.connectStart + timeout, makeToken(TimerKind::HANDSHAKE, index));
+
+    curl_socket_t socket = ::socket(addressFamily, SOCK_STREAM, IPPROTO_TCP);
+    if (socket == CURL_SOCKET_BAD) {
+        closeConnection(index, CURLE_COULDNT_CONNECT, complete);
+        return;
+    }
+    connection.socket = socket;
+    int noDelay = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+    if (!setNonBlocking(socket)) {
+        closeConnection(index, CURLE_COULDNT_CONNECT, complete);
+        return;
+    }
+
+    if (::connect(socket, reinterpret_cast<const sockaddr*>(address.data()),
+                  static_cast<socklen_t>(address.size())) == 0) {
+        onConnected(index, complete);
+    } else if (!connectPending(lastSocketError())) {
+        closeConnection(index, CURLE_COULDNT_CONNECT, complete);
+    } else {
+        watch(index);
+    }
+}
+
+void WebSocketLoop::onConnected(size_t index, const CompletionHandler& complete) {
+    Connection& connection = connections[index];
+    int error = 0;
+    socklen_t length = sizeof(error);
+    getsockopt(connection.socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length);
+    if (error != 0) {
+        closeConnection(index, CURLE_COULDNT_CONNECT, complete);
+        return;
+    }
+    stats.connectLatency.add(toNs(std::chrono::steady_clock::now() - connection.connectStart) / 1e6);
+
+    unsigned char nonce[16];
+    for (size_t i = 0; i < sizeof(nonce); i += 8) {
+        uint64_t bits = rng();
+        std::memcpy(nonce + i, &bits, 8);
+    }
+    connection.outbound = upgradeRequest + "Sec-WebSocket-Key: " + base64(nonce, sizeof(nonce)) + "\r\n\r\n";
+    connection.state = ConnectionState::UPGRADING;
+    if (!flush(connection)) {
+        closeConnection(index, CURLE_SEND_ERROR, complete);
+        return;
+    }
+    watch(index);
+}
+
+void WebSocketLoop::sendMessage(size_t index, const DispatchHandler& dispatch, const CompletionHandler& complete) {
+    TRACE_SPAN("sendMessage");
+    Connection& connection = connections[index];
+    auto now = std::chrono::steady_clock::now();
+
+    int requestId = 0;
+    if (accepting) requestId = dispatch(std::max<int64_t>(0, toNs(now - connection.nextSend)));
+    if (requestId <= 0) {
+        // 消息配额已用完：连接保持打开，等待已发消息的回复
+        accepting = false;
+        return;
+    }
+
+    std::string text = renderPayload(index, connection.sequence);
+    connection.pending.push_back(PendingMessage{connection.sequence, requestId, now, text.size()});
+    connection.sequence++;
+    inFlight++;
+    stats.messagesSent++;
+
+    queueFrame(connection, OPCODE_TEXT, text.data(), text.size());
+    if (!flush(connection)) {
+        closeConnection(index, CURLE_SEND_ERROR, complete);
+        return;
+    }
+    watch(index);
+    armReplyTimer(index);
+
+    // 按计划时刻而不是实际发送时刻排下一条，发送落后时由调度延迟反映
+    connection.nextSend += interval;
+    timers.schedule(connection.nextSend, makeToken(TimerKind::SEND, index));
+}
+
+void WebSocketLoop::queueFrame(Connection& connection, uint8_t opcode, const char* data, size_t length) {
+    // 客户端发出的帧必须加掩码
+    char header[14];
+    size_t headerLength = 0;
+    header[headerLength++] = static_cast<char>(0x80 | opcode);
+    if (length < 126) {
+        header[headerLength++] = static_cast<char>(0x80 | length);
+    } else if (length <= 0xFFFF) {
+        header[headerLength++] = static_cast<char>(0x80 | 126);
+        header[headerLength++] = static_cast<char>((length >> 8) & 0xFF);
+        header[headerLength++] = static_cast<char>(length & 0xFF);
+    } else {
+        header[headerLength++] = static_cast<char>(0x80 | 127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            header[headerLength++] = static_cast<char>((static_cast<uint64_t>(length) >> shift) & 0xFF);
+        }
+    }
+    uint32_t maskBits = static_cast<uint32_t>(rng());
+    std::memcpy(header + headerLength, &maskBits, 4);
+    const char* mask = header + headerLength;
+    headerLength += 4;
+
+    connection.outbound.reserve(connection.outbound.size() + headerLength + length);
+    connection.outbound.append(header, headerLength);
+    for (size_t i = 0; i < length; ++i) {
+        connection.outbound += static_cast<char>(data[i] ^ mask[i & 3]);
+    }
+}
+
+bool WebSocketLoop::flush(Connection& connection) {
+    size_t sent = 0;
+    while (sent < connection.outbound.size()) {
+        auto count = ::send(connection.socket, connection.outbound.data() + sent,
+                            static_cast<int>(connection.outbound.size() - sent), SEND_FLAGS);
+        if (count > 0) {
+            sent += static_cast<size_t>(count);
+        } else if (count < 0 && wouldBlock(lastSocketError())) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    if (sent == connection.outbound.size()) {
+        // 空闲连接不保留发送缓冲区
+        std::string().swap(connection.outbound);
+    } else {
+        connection.outbound.erase(0, sent);
+    }
+    return true;
+}
+
+void WebSocketLoop::onReadable(size_t index, const CompletionHandler& complete) {
+    TRACE_SPAN("onReadable");
+    Connection& connection = connections[index];
+    for (;;) {
+        auto count = ::recv(connection.socket, readBuffer.data(), static_cast<int>(readBuffer.size()), 0);
+        if (count == 0 || (count < 0 && !wouldBlock(lastSocketError()))) {
+            closeConnection(index, CURLE_RECV_ERROR, complete);
+            return;
+        }
+        if (count < 0) break;
+
+        size_t received = static_cast<size_t>(count);
+        if (connection.inbound.empty()) {
+            // 常见情况：整帧在共用缓冲区中解析，只保留不完整的尾部
+            size_t used = consume(index, readBuffer.data(), received, complete);
+            if (connection.state == ConnectionState::CLOSED) return;
+            if (used < received) connection.inbound.assign(readBuffer.data() + used, received - used);
+        } else {
+            connection.inbound.append(readBuffer.data(), received);
+            size_t used = consume(index, connection.inbound.data(), connection.inbound.size(), complete);
+            if (connection.state == ConnectionState::CLOSED) return;
+            if (used == connection.inbound.size()) {
+                std::string().swap(connection.inbound);
+            } else {
+                connection.inbound.erase(0, used);
+            }
+        }
+        if (received < readBuffer.size()) break;
+    }
+
+    // 回复ping的pong立即发出
+    if (!connection.outbound.empty() && !flush(connection)) {
+        closeConnection(index, CURLE_SEND_ERROR, complete);
+    }
+}
+
+size_t WebSocketLoop::consume(size_t index, const char* data, size_t length, const CompletionHandler& complete) {
+    Connection& connection = connections[index];
+    size_t offset = 0;
+
+    if (connection.state == ConnectionState::UPGRADING) {
+        static const char terminator[] = "\r\n\r\n";
+        const char* end = std::search(data, data + length, terminator, terminator + 4);
+        if (end == data + length) {
+            if (length > MAX_HANDSHAKE_BYTES) closeConnection(index, CURLE_WEIRD_SERVER_REPLY, complete);
+            return 0;
+        }
+        // 只检查状态码，不校验Sec-WebSocket-Accept
+        if (length < 12 || std::memcmp(data, "HTTP/1.", 7) != 0 || std::memcmp(data + 8, " 101", 4) != 0) {
+            closeConnection(index, CURLE_WEIRD_SERVER_REPLY, complete);
+            return 0;
+        }
+        offset = static_cast<size_t>(end - data) + 4;
+
+        auto now = std::chrono::steady_clock::now();
+        connection.state = ConnectionState::OPEN;
+        stats.opened++;
+        stats.upgradeLatency.add(toNs(now - connection.connectStart) / 1e6);
+
+        // 第一条消息在一个发送间隔内随机错开，避免所有连接同时发送
+        std::uniform_int_distribution<int64_t> jitter(0, std::chrono::nanoseconds(interval).count() - 1);
+        connection.nextSend = now + std::chrono::nanoseconds(jitter(rng));
+        timers.schedule(connection.nextSend, makeToken(TimerKind::SEND, index));
+    }
+
+    while (connection.state == ConnectionState::OPEN) {
+        size_t available = length - offset;
+        if (available < 2) break;
+        const unsigned char* frame = reinterpret_cast<const unsigned char*>(data + offset);
+        bool fin = (frame[0] & 0x80) != 0;
+        uint8_t opcode = frame[0] & 0x0F;
+        bool masked = (frame[1] & 0x80) != 0;
+        uint64_t payloadLength = frame[1] & 0x7F;
+        size_t headerLength = 2;
+        if (payloadLength == 126) {
+            if (available < 4) break;
+            payloadLength = (static_cast<uint64_t>(frame[2]) << 8) | frame[3];
+            headerLength = 4;
+        } else if (payloadLength == 127) {
+            if (available < 10) break;
+            payloadLength = 0;
+            for (int i = 2; i < 10; ++i) payloadLength = (payloadLength << 8) | frame[i];
+            headerLength = 10;
+        }
+        if (payloadLength > MAX_FRAME_BYTES) {
+            closeConnection(index, CURLE_WEIRD_SERVER_REPLY, complete);
+            return offset;
+        }
+        size_t maskOffset = headerLength;
+        if (masked) headerLength += 4;
+        if (available < headerLength + payloadLength) break;
+
+        const char* payload = data + offset + headerLength;
+        size_t size = static_cast<size_t>(payloadLength);
+        std::string unmasked;
+        if (masked) {
+            // 服务端不应加掩码，兼容处理
+            unmasked.assign(payload, size);
+            for (size_t i = 0; i < size; ++i) unmasked[i] ^= static_cast<char>(frame[maskOffset + (i & 3)]);
+            payload = unmasked.data();
+        }
+        offset += headerLength + size;
+
+        switch (opcode) {
+            case OPCODE_TEXT:
+            case OPCODE_BINARY:
+            case OPCODE_CONTINUATION:
+                if (fin && connection.message.empty()) {
+                    onMessage(connection, payload, size, complete);
+                } else {
+                    connection.message.append(payload, size);
+                    if (fin) {
+                        onMessage(connection, connection.message.data(), connection.message.size(), complete);
+                        std::string().swap(connection.message);
+                    }
+                }
+                break;
+            case OPCODE_CLOSE:
+                closeConnection(index, CURLE_RECV_ERROR, complete);
+                return offset;
+            case OPCODE_PING:
+                queueFrame(connection, OPCODE_PONG, payload, size);
+                break;
+            default:
+                break;
+        }
+    }
+    return offset;
+}
+
+void WebSocketLoop::onMessage(Connection& connection, const char* data, size_t length,
+                              const CompletionHandler& complete) {
+    if (connection.pending.empty()) {
+        stats.unmatchedReplies++;
+        return;
+    }
+
+    // 回显按发送顺序匹配；关联模式查找回复中带的id
+    size_t match = 0;
+    if (options.correlate) {
+        size_t index = static_cast<size_t>(&connection - connections.data());
+        match = connection.pending.size();
+        for (size_t i = 0; i < connection.pending.size(); ++i) {
+            if (containsId(data, length, messageId(index, connection.pending[i].sequence))) {
+                match = i;
+                break;
+            }
+        }
+        if (match == connection.pending.size()) {
+            stats.unmatchedReplies++;
+            return;
+        }
+    }
+
+    TransferResult result;
+    result.code = CURLE_OK;
+    result.statusCode = 200;
+    result.elapsedNs = toNs(std::chrono::steady_clock::now() - connection.pending[match].sentAt);
+    result.bytesSent = connection.pending[match].bytes;
+    result.bytesReceived = length;
+    result.bodyBytes = length;
+    int requestId = connection.pending[match].requestId;
+    connection.pending.erase(connection.pending.begin() + static_cast<std::ptrdiff_t>(match));
+    inFlight--;
+    complete(requestId, result);
+}
+
+void WebSocketLoop::armReplyTimer(size_t index) {
+    Connection& connection = connections[index];
+    if (connection.replyTimerArmed || connection.pending.empty()) return;
+    // 未应答消息按发送顺序排列，只为最早的一条挂定时器；它被应答后定时器照常触发，再为新的最早一条重挂
+    timers.schedule(connection.pending.front().sentAt + timeout, makeToken(TimerKind::REPLY, index));
+    connection.replyTimerArmed = true;
+}
+
+void WebSocketLoop::expireReplies(size_t index, std::chrono::steady_clock::time_point now,
+                                  const CompletionHandler& complete) {
+    Connection& connection = connections[index];
+
+    // 超时的消息从未应答列表中移除，之后到达的回复计为未匹配
+    size_t expired = 0;
+    while (expired < connection.pending.size() && now - connection.pending[expired].sentAt >= timeout) {
+        expired++;
+    }
+    if (expired == 0) return;
+    std::vector<PendingMessage> timedOut(connection.pending.begin(),
+                                         connection.pending.begin() + static_cast<std::ptrdiff_t>(expired));
+    connection.pending.erase(connection.pending.begin(),
+                             connection.pending.begin() + static_cast<std::ptrdiff_t>(expired));
+    for (const auto& message : timedOut) {
+        TransferResult result;
+        result.code = CURLE_OPERATION_TIMEDOUT;
+        result.elapsedNs = toNs(now - message.sentAt);
+        inFlight--;
+        complete(message.requestId, result);
+    }
+}
+
+void WebSocketLoop::watch(size_t index) {
+    Connection& connection = connections[index];
+    short events = CURL_WAIT_POLLOUT;
+    if (connection.state != ConnectionState::CONNECTING) {
+        events = CURL_WAIT_POLLIN;
+        if (!connection.outbound.empty()) events |= CURL_WAIT_POLLOUT;
+    }
+    if (events == connection.watchedEvents) return;
+
+#ifdef __linux__
+    epoll_event event{};
+    event.events = ((events & CURL_WAIT_POLLIN) ? EPOLLIN : 0u) | ((events & CURL_WAIT_POLLOUT) ? EPOLLOUT : 0u);
+    event.data.u64 = index;
+    epoll_ctl(readiness, connection.watchedEvents == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, connection.socket, &event);
+#else
+    if (connection.watchedEvents == 0) {
+        connection.watchSlot = static_cast<uint32_t>(waitFds.size());
+        curl_waitfd fd{};
+        fd.fd = connection.socket;
+        waitFds.push_back(fd);
+        waitIndexes.push_back(index);
+    }
+    waitFds[connection.watchSlot].events = events;
+#endif
+    connection.watchedEvents = events;
+}
+
+void WebSocketLoop::unwatch(size_t index) {
+    Connection& connection = connections[index];
+    if (connection.watchedEvents == 0) return;
+
+#ifdef __linux__
+    epoll_event event{};
+    epoll_ctl(readiness, EPOLL_CTL_DEL, connection.socket, &event);
+#else
+    // 与末尾交换后移除，并更新被移动连接记录的位置
+    uint32_t slot = connection.watchSlot;
+    waitFds[slot] = waitFds.back();
+    waitIndexes[slot] = waitIndexes.back();
+    connections[waitIndexes[slot]].watchSlot = slot;
+    waitFds.pop_back();
+    waitIndexes.pop_back();
+#endif
+    connection.watchedEvents = 0;
+}
+
+void WebSocketLoop::waitForSockets(int timeoutMs) {
+    ready.clear();
+#ifdef __linux__
+    // 只等待epoll描述符本身，取消源的唤醒仍由curl_multi_poll处理
+    curl_waitfd fd{};
+    fd.fd = readiness;
+    fd.events = CURL_WAIT_POLLIN;
+    curl_multi_poll(multi, &fd, 1, timeoutMs, nullptr);
+    if (fd.revents == 0) return;
+
+    epoll_event events[MAX_READY_EVENTS];
+    int count = epoll_wait(readiness, events, MAX_READY_EVENTS, 0);
+    for (int i = 0; i < count; ++i) {
+        short revents = 0;
+        // 出错或挂断交给读写路径发现：connect检查SO_ERROR，recv返回错误
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) revents |= CURL_WAIT_POLLIN;
+        if (events[i].events & EPOLLOUT) revents |= CURL_WAIT_POLLOUT;
+        ready.push_back(ReadySocket{static_cast<size_t>(events[i].data.u64), revents});
+    }
+#else
+    curl_multi_poll(multi, waitFds.data(), static_cast<unsigned int>(waitFds.size()), timeoutMs, nullptr);
+    for (size_t k = 0; k < waitFds.size(); ++k) {
+        if (waitFds[k].revents != 0) ready.push_back(ReadySocket{waitIndexes[k], waitFds[k].revents});
+    }
+#endif
+}
+
+void WebSocketLoop::closeConnection(size_t index, CURLcode reason, const CompletionHandler& complete) {
+    Connection& connection = connections[index];
+    if (connection.state == ConnectionState::CLOSED) return;
+
+    if (connection.state == ConnectionState::OPEN) {
+        stats.dropped++;
+    } else {
+        stats.failed++;
+    }
+    if (connection.socket != CURL_SOCKET_BAD) {
+        unwatch(index);
+        closeSocket(connection.socket);
+        connection.socket = CURL_SOCKET_BAD;
+    }
+    connection.state = ConnectionState::CLOSED;
+    activeConnections--;
+
+    std::vector<PendingMessage> pending;
+    pending.swap(connection.pending);
+    std::string().swap(connection.inbound);
+    std::string().swap(connection.outbound);
+    std::string().swap(connection.message);
+
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& message : pending) {
+        TransferResult result;
+        result.code = reason;
+        result.elapsedNs = toNs(now - message.sentAt);
+        inFlight--;
+        complete(message.requestId, result);
+    }
+}
+
+std::string WebSocketLoop::renderPayload(size_t index, uint64_t sequence) const {
+    const std::string& pattern = options.payload;
+    std::string text;
+    text.reserve(pattern.size() + 16);
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern.compare(i, 4, "{id}") == 0) {
+            text += messageId(index, sequence);
+            i += 3;
+        } else if (pattern.compare(i, 5, "{seq}") == 0) {
+            text += std::to_string(sequence);
+            i += 4;
+        } else if (pattern.compare(i, 6, "{conn}") == 0) {
+            text += std::to_string(firstConnection + static_cast<int>(index));
+            i += 5;
+        } else {
+            text += pattern[i];
+        }
+    }
+    return text;
+}
+
+std::string WebSocketLoop::messageId(size_t index, uint64_t sequence) const {
+    return std::to_string(firstConnection + static_cast<int>(index)) + "." + std::to_string(sequence);
+}
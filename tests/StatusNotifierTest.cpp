@@ -0,0 +1,195 @@
+/**
+ * @file StatusNotifierTest.cpp
+ * @brief 用假的前端消费者验证合并式状态通知器（不依赖界面，可在Linux上运行）
+ *
+ * 时间点由测试传入，通知间隔的判断不依赖真实时钟；并发用例让多个工作线程
+ * 各写一个分片，同时由驱动线程轮询，核对增量既不丢失也不重复。
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../include/StatusNotifier.h"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::printf("%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @brief 假的前端：只把收到的通知存下来
+ */
+struct FakeConsumer {
+    std::mutex mutex;
+    std::vector<StatusUpdate> updates;
+
+    StatusNotifier::Callback callback() {
+        return [this](const StatusUpdate& update) {
+            std::lock_guard<std::mutex> lock(mutex);
+            updates.push_back(update);
+        };
+    }
+
+    StatusUpdate total() {
+        std::lock_guard<std::mutex> lock(mutex);
+        StatusUpdate sum;
+        for (const auto& update : updates) {
+            sum.deltaCompleted += update.deltaCompleted;
+            sum.deltaSuccessful += update.deltaSuccessful;
+            sum.deltaFailed += update.deltaFailed;
+            sum.deltaErrors += update.deltaErrors;
+            sum.droppedResults += update.droppedResults;
+        }
+        return sum;
+    }
+};
+
+RequestResult makeResult(int id, RequestStatus status, int64_t timestampNs) {
+    RequestResult result(id, status, status == RequestStatus::SUCCESS ? 200 : 500, 0, 1000000);
+    result.timestampNs = timestampNs;
+    return result;
+}
+
+void testCoalescing() {
+    StatusNotifier notifier(10);
+    FakeConsumer consumer;
+    notifier.setCallback(consumer.callback());
+    notifier.setInterval(std::chrono::milliseconds(100));
+    notifier.reset(1);
+
+    auto t0 = std::chrono::steady_clock::now();
+    CHECK(!notifier.poll(t0, 0, 100, 0.0));   // 没有新结果不投递
+
+    for (int i = 0; i < 30; ++i) notifier.record(0, makeResult(i, RequestStatus::SUCCESS, i));
+    CHECK(notifier.poll(t0, 30, 100, 100.0));
+    CHECK(consumer.updates.size() == 1);
+    CHECK(consumer.updates[0].deltaCompleted == 30);
+    CHECK(consumer.updates[0].recentResults.size() == 10);
+    CHECK(consumer.updates[0].droppedResults == 20);
+
+    // 间隔内的结果合并到下一次通知
+    for (int i = 30; i < 35; ++i) notifier.record(0, makeResult(i, RequestStatus::FAILED, i));
+    CHECK(!notifier.poll(t0 + std::chrono::milliseconds(50), 35, 100, 0.0));
+    for (int i = 35; i < 40; ++i) notifier.record(0, makeResult(i, RequestStatus::REQ_ERROR, i));
+    CHECK(notifier.poll(t0 + std::chrono::milliseconds(100), 40, 100, 75.0));
+    CHECK(consumer.updates.size() == 2);
+    CHECK(consumer.updates[1].deltaCompleted == 10);
+    CHECK(consumer.updates[1].deltaFailed == 5);
+    CHECK(consumer.updates[1].deltaErrors == 5);
+    CHECK(consumer.updates[1].completedRequests == 40);
+
+    // 最近结果按时间从新到旧
+    const auto& recent = consumer.updates[1].recentResults;
+    CHECK(recent.size() == 10);
+    for (size_t i = 0; i < recent.size(); ++i) {
+        CHECK(recent[i].id == static_cast<int>(39 - i));
+    }
+
+    // flush即使没有新结果也投递一次
+    notifier.flush(40, 100, 75.0);
+    CHECK(consumer.updates.size() == 3);
+    CHECK(consumer.updates[2].deltaCompleted == 0);
+    CHECK(notifier.getDeliveredCount() == 3);
+}
+
+void testMergesShardsNewestFirst() {
+    StatusNotifier notifier(4);
+    FakeConsumer consumer;
+    notifier.setCallback(consumer.callback());
+    notifier.reset(3);
+
+    // 三个分片交错写入，最新的四条分布在不同分片上
+    for (int i = 0; i < 12; ++i) {
+        notifier.record(static_cast<size_t>(i % 3), makeResult(i, RequestStatus::SUCCESS, 1000 + i));
+    }
+    notifier.flush(12, 12, 100.0);
+
+    CHECK(consumer.updates.size() == 1);
+    const auto& recent = consumer.updates[0].recentResults;
+    CHECK(recent.size() == 4);
+    for (size_t i = 0; i < recent.size(); ++i) {
+        CHECK(recent[i].id == static_cast<int>(11 - i));
+    }
+    CHECK(consumer.updates[0].droppedResults == 8);
+}
+
+void testConcurrentWorkers() {
+    const int WORKERS = 4;
+    const int PER_WORKER = 200000;
+
+    StatusNotifier notifier(10);
+    FakeConsumer consumer;
+    notifier.setCallback(consumer.callback());
+    notifier.setInterval(std::chrono::milliseconds(1));
+    notifier.reset(WORKERS);
+
+    std::atomic<int> finished{0};
+    std::vector<std::thread> workers;
+    for (int w = 0; w < WORKERS; ++w) {
+        workers.emplace_back([&notifier, &finished, w] {
+            for (int i = 0; i < PER_WORKER; ++i) {
+                RequestStatus status = i % 10 == 0 ? RequestStatus::REQ_ERROR
+                                     : i % 10 == 1 ? RequestStatus::FAILED : RequestStatus::SUCCESS;
+                notifier.record(static_cast<size_t>(w), RequestResult(w * PER_WORKER + i, status, 200, 0, 1000));
+            }
+            finished++;
+        });
+    }
+
+    // 驱动线程在写入期间持续轮询
+    while (finished < WORKERS) {
+        notifier.poll(std::chrono::steady_clock::now(), 0, WORKERS * PER_WORKER, 0.0);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    for (auto& worker : workers) worker.join();
+    notifier.flush(WORKERS * PER_WORKER, WORKERS * PER_WORKER, 0.0);
+
+    StatusUpdate total = consumer.total();
+    CHECK(total.deltaCompleted == WORKERS * PER_WORKER);
+    CHECK(total.deltaErrors == WORKERS * PER_WORKER / 10);
+    CHECK(total.deltaFailed == WORKERS * PER_WORKER / 10);
+    CHECK(total.deltaSuccessful == WORKERS * PER_WORKER * 8 / 10);
+
+    // 每条携带的结果都是完整写入的记录，且不会在两次通知中重复出现
+    std::vector<bool> seen(WORKERS * PER_WORKER, false);
+    size_t carried = 0;
+    for (const auto& update : consumer.updates) {
+        CHECK(update.recentResults.size() <= 10);
+        for (size_t i = 0; i < update.recentResults.size(); ++i) {
+            const RequestResult& result = update.recentResults[i];
+            CHECK(result.id >= 0 && result.id < WORKERS * PER_WORKER);
+            CHECK(result.responseTimeNs == 1000);
+            if (result.id < 0 || result.id >= WORKERS * PER_WORKER) continue;
+            CHECK(!seen[result.id]);
+            seen[result.id] = true;
+            if (i > 0) CHECK(update.recentResults[i - 1].timestampNs >= result.timestampNs);
+            carried++;
+        }
+    }
+    CHECK(carried + static_cast<size_t>(total.droppedResults) == static_cast<size_t>(WORKERS * PER_WORKER));
+    std::printf("并发: %zu次通知，携带%zu条结果\n", consumer.updates.size(), carried);
+}
+
+} // namespace
+
+int main() {
+    testCoalescing();
+    testMergesShardsNewestFirst();
+    testConcurrentWorkers();
+
+    if (failures > 0) {
+        std::printf("失败: %d\n", failures);
+        return 1;
+    }
+    std::printf("全部通过\n");
+    return 0;
+}